@@ -0,0 +1,192 @@
+/**
+ * BenchCases.cpp
+ *
+ * ファームウェアのホットパスのベンチマーク
+ *
+ * 共通（ホスト・ESP32）:
+ * - ControlPolicy::decide（determineOptimalMode のモード決定部）
+ * - 不快指数の計算
+ * - 天気予報JSONの解析（固定のレスポンス）
+ * - コルーチンの再開（CoroutineScheduler::run の1回分）
+ *
+ * ESP32のみ:
+ * - determineOptimalMode（時刻取得・シリアル出力込み）
+ * - DisplayController のフレーム構築（I2C転送なし）
+ * - Daikin IRフレームの取得（キャッシュ済み、送信なし）
+ */
+
+#include "BenchCases.h"
+
+#include <string.h>
+#include "BenchRunner.h"
+#include "Coroutine.h"
+#include "ControlPolicy.h"
+#include "SensorData.h"
+#include "WeatherParser.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <Wire.h>
+#include <sys/time.h>
+#include "AirConditionerController.h"
+#include "DisplayController.h"
+#include "TimeManager.h"
+#endif
+
+namespace {
+  // Open-Meteo の実レスポンスと同じ形式の固定データ
+  const char WEATHER_PAYLOAD[] =
+    "{\"latitude\":35.66,\"longitude\":139.6875,\"generationtime_ms\":0.0351667404174805,"
+    "\"utc_offset_seconds\":32400,\"timezone\":\"Asia/Tokyo\",\"timezone_abbreviation\":\"JST\","
+    "\"elevation\":40.0,\"daily_units\":{\"time\":\"iso8601\",\"weather_code\":\"wmo code\","
+    "\"temperature_2m_max\":\"°C\",\"temperature_2m_min\":\"°C\"},"
+    "\"daily\":{\"time\":[\"2025-10-11\"],\"weather_code\":[55],"
+    "\"temperature_2m_max\":[18.5],\"temperature_2m_min\":[15.4]}}";
+
+  // 入力のばらつきを持たせるためのテーブル
+  constexpr size_t INPUT_COUNT = 64;
+  PolicyInput policyInputs[INPUT_COUNT];
+
+  void buildInputs() {
+    for (size_t i = 0; i < INPUT_COUNT; i++) {
+      policyInputs[i].temperature = 22.0f + 0.1f * static_cast<float>(i % 60);
+      policyInputs[i].humidity = 45.0f + static_cast<float>(i % 25);
+      policyInputs[i].month = 1 + static_cast<int>(i % 12);
+      policyInputs[i].hour = static_cast<int>((i * 5) % 24);
+      policyInputs[i].extremeCold = (i % 7) == 0;
+    }
+  }
+
+  void benchPolicyDecide(uint32_t iterations) {
+    ControlPolicy policy;
+    ACMode mode = ACMode::OFF;
+    for (uint32_t i = 0; i < iterations; i++) {
+      mode = policy.decide(policyInputs[i % INPUT_COUNT], mode).mode;
+    }
+    BenchRunner::sink = static_cast<uint32_t>(mode);
+  }
+
+  void benchDiscomfortIndex(uint32_t iterations) {
+    float total = 0.0f;
+    for (uint32_t i = 0; i < iterations; i++) {
+      const PolicyInput& in = policyInputs[i % INPUT_COUNT];
+      total += discomfortIndex(in.temperature, in.humidity);
+    }
+    BenchRunner::sink = static_cast<uint32_t>(total);
+  }
+
+  void benchWeatherParse(uint32_t iterations) {
+    ForecastValues values;
+    for (uint32_t i = 0; i < iterations; i++) {
+      WeatherParser::parseDaily(WEATHER_PAYLOAD, sizeof(WEATHER_PAYLOAD) - 1, values,
+                                CountingJsonAllocator::instance());
+    }
+    BenchRunner::sink = static_cast<uint32_t>(values.weatherCode);
+  }
+
+  // 再開のたびに数えて中断するコルーチン（待機の処理の負荷）
+  class CountingCoroutine : public Coroutine {
+  public:
+    uint32_t count = 0;
+  protected:
+    bool run(uint32_t nowMs) override {
+      CO_BEGIN();
+      for (;;) {
+        count++;
+        CO_YIELD();
+      }
+      CO_END();
+    }
+  };
+
+  void benchCoroutineResume(uint32_t iterations) {
+    CountingCoroutine coroutine;
+    CoroutineScheduler scheduler;
+    scheduler.add(&coroutine);
+    coroutine.start(0);
+    for (uint32_t i = 0; i < iterations; i++) {
+      scheduler.run(i);
+    }
+    BenchRunner::sink = coroutine.count;
+  }
+
+#ifdef ARDUINO
+  // ハードウェアピン設定（main.cpp と同じ配線）
+  namespace BenchHardware {
+    constexpr uint8_t IR_RECV_PIN = 18;
+    constexpr uint8_t IR_SEND_PIN = 5;
+  }
+
+  AirConditionerController* benchAC = nullptr;
+  DisplayController* benchDisplay = nullptr;
+  TimeManager benchTime("pool.ntp.org", 9 * 3600, 0);
+  WeatherData benchWeather;
+
+  void benchDetermineOptimalMode(uint32_t iterations) {
+    ACMode mode = ACMode::OFF;
+    for (uint32_t i = 0; i < iterations; i++) {
+      const PolicyInput& in = policyInputs[i % INPUT_COUNT];
+      mode = benchAC->determineOptimalMode(in.temperature, in.humidity, benchTime, benchWeather);
+    }
+    BenchRunner::sink = static_cast<uint32_t>(mode);
+  }
+
+  void benchDisplayFrame(uint32_t iterations) {
+    for (uint32_t i = 0; i < iterations; i++) {
+      const PolicyInput& in = policyInputs[i % INPUT_COUNT];
+      SensorData data(in.temperature, in.humidity, discomfortIndex(in.temperature, in.humidity), true);
+      benchDisplay->renderSensorDataWithWeatherAndAC(data, "2025-10-11 22:30", benchWeather, ACMode::HEATING_23_5);
+    }
+  }
+
+  void benchIRFrameEncode(uint32_t iterations) {
+    static const ACMode modes[] = {
+      ACMode::OFF, ACMode::HEATING_23_5, ACMode::HEATING_18, ACMode::COOLING_25, ACMode::DEHUMID_MINUS_1_5
+    };
+    uint32_t checksum = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+      const uint8_t* frame = benchAC->encodeFrame(ACCommand::fromMode(modes[i % 5]));
+      checksum += frame[kDaikinStateLength - 1];
+    }
+    BenchRunner::sink = checksum;
+  }
+
+  void setupHardware() {
+    // 時刻取得で待たされないよう固定の時刻を設定（2025-01-15 10:00 JST）
+    struct timeval tv = {1736902800, 0};
+    settimeofday(&tv, nullptr);
+    setenv("TZ", "JST-9", 1);
+    tzset();
+
+    benchWeather.isValid = true;
+    benchWeather.tempMax = 8.5f;
+    benchWeather.tempMin = -0.5f;
+    benchWeather.weatherCode = 1;
+    benchWeather.category = weatherCategoryFromCode(benchWeather.weatherCode);
+    benchWeather.lastUpdate = 0;
+    benchWeather.fetchedEpoch = 0;
+
+    benchAC = new AirConditionerController(BenchHardware::IR_SEND_PIN, BenchHardware::IR_RECV_PIN);
+    benchAC->begin();
+    benchDisplay = new DisplayController(128, 64, &Wire, -1, 0x3C);
+    benchDisplay->begin();
+  }
+#endif
+}
+
+void runAllBenchmarks() {
+  buildInputs();
+
+  BenchRunner::printHeader();
+  BenchRunner::run("policy_decide", 200000, benchPolicyDecide);
+  BenchRunner::run("discomfort_index", 1000000, benchDiscomfortIndex);
+  BenchRunner::run("weather_json_parse", 2000, benchWeatherParse);
+  BenchRunner::run("coroutine_resume", 1000000, benchCoroutineResume);
+
+#ifdef ARDUINO
+  setupHardware();
+  BenchRunner::run("determine_optimal_mode", 200, benchDetermineOptimalMode);
+  BenchRunner::run("display_frame_build", 500, benchDisplayFrame);
+  BenchRunner::run("ir_frame_encode", 20000, benchIRFrameEncode);
+#endif
+}
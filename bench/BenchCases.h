@@ -0,0 +1,13 @@
+/**
+ * BenchCases.h
+ *
+ * ホットパスのベンチマーク一覧
+ */
+
+#ifndef BENCH_CASES_H
+#define BENCH_CASES_H
+
+// すべてのベンチマークを実行して結果を出力
+void runAllBenchmarks();
+
+#endif // BENCH_CASES_H
@@ -0,0 +1,270 @@
+/**
+ * BenchRunner.cpp
+ *
+ * マイクロベンチマーク実行基盤の実装（ホスト・ESP32共通）
+ */
+
+#include "BenchRunner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#else
+#include <pthread.h>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+volatile uint32_t BenchRunner::sink = 0;
+
+// ========================================
+// ヒープ使用量の追跡
+// ========================================
+
+namespace {
+  // operator new は全タスク（ESP32 の WiFi・ログ出力など）から呼ばれるため、アトミックに更新
+  size_t heapInUse = 0;
+  size_t heapPeak = 0;
+  size_t heapBaseline = 0;  // resetPeak() を呼ぶタスクのみ
+
+  // 計測中のタスク（スレッド）か。他のタスクの確保は数えない（計測値に混ざらないように）
+  thread_local bool benchThread = false;
+
+  // サイズと追跡の有無を記録するためのヘッダー（アライメント維持のため16バイト）
+  constexpr size_t HEADER_SIZE = 16;
+  constexpr size_t TRACKED_OFFSET = sizeof(size_t);
+
+  void* trackedAlloc(size_t size) {
+    uint8_t* block = static_cast<uint8_t*>(malloc(size + HEADER_SIZE));
+    if (!block) {
+      return nullptr;
+    }
+    memcpy(block, &size, sizeof(size));
+    // 計測中のタスクで確保したものは、別のタスクで解放されても差し引く
+    block[TRACKED_OFFSET] = benchThread ? 1 : 0;
+    if (benchThread) {
+      HeapTracker::onAlloc(size);
+    }
+    return block + HEADER_SIZE;
+  }
+
+  void trackedFree(void* pointer) {
+    if (!pointer) {
+      return;
+    }
+    uint8_t* block = static_cast<uint8_t*>(pointer) - HEADER_SIZE;
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    if (block[TRACKED_OFFSET]) {
+      HeapTracker::onFree(size);
+    }
+    free(block);
+  }
+}
+
+void HeapTracker::onAlloc(size_t size) {
+  size_t inUse = __atomic_add_fetch(&heapInUse, size, __ATOMIC_RELAXED);
+  size_t peak = __atomic_load_n(&heapPeak, __ATOMIC_RELAXED);
+  while (inUse > peak &&
+         !__atomic_compare_exchange_n(&heapPeak, &peak, inUse, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+void HeapTracker::onFree(size_t size) {
+  __atomic_sub_fetch(&heapInUse, size, __ATOMIC_RELAXED);
+}
+
+void HeapTracker::resetPeak() {
+  heapBaseline = __atomic_load_n(&heapInUse, __ATOMIC_RELAXED);
+  __atomic_store_n(&heapPeak, heapBaseline, __ATOMIC_RELAXED);
+}
+
+size_t HeapTracker::peak() {
+  return __atomic_load_n(&heapPeak, __ATOMIC_RELAXED) - heapBaseline;
+}
+
+// C++ の動的確保をすべて追跡（ベンチマークビルドのみ）
+void* operator new(size_t size) {
+  void* p = trackedAlloc(size);
+  if (!p) {
+    abort();
+  }
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, size_t) noexcept { trackedFree(p); }
+
+void* CountingJsonAllocator::allocate(size_t size) {
+  return trackedAlloc(size);
+}
+
+void CountingJsonAllocator::deallocate(void* pointer) {
+  trackedFree(pointer);
+}
+
+void* CountingJsonAllocator::reallocate(void* pointer, size_t newSize) {
+  void* fresh = trackedAlloc(newSize);
+  if (fresh && pointer) {
+    size_t oldSize;
+    memcpy(&oldSize, static_cast<uint8_t*>(pointer) - HEADER_SIZE, sizeof(oldSize));
+    memcpy(fresh, pointer, oldSize < newSize ? oldSize : newSize);
+    trackedFree(pointer);
+  }
+  return fresh;
+}
+
+CountingJsonAllocator* CountingJsonAllocator::instance() {
+  static CountingJsonAllocator allocator;
+  return &allocator;
+}
+
+// ========================================
+// プラットフォーム依存部
+// ========================================
+
+namespace {
+  struct BenchJob {
+    BenchBody body;
+    uint32_t iterations;
+    uint32_t cycles;
+    double elapsedNs;
+    size_t stackUsed;
+  };
+
+#ifdef ARDUINO
+  inline uint32_t cycleCount() { return ESP.getCycleCount(); }
+  inline int64_t nowNs() { return esp_timer_get_time() * 1000; }
+  size_t freeHeap() { return ESP.getFreeHeap(); }
+#else
+  inline uint32_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return static_cast<uint32_t>(__rdtsc());
+#else
+    return 0;
+#endif
+  }
+  inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+  size_t freeHeap() { return 0; }  // ホストでは空きヒープを計測しない
+#endif
+
+  // ウォームアップ後に本計測（cycleCount は32bitなので計測時間は数秒以内に収める）
+  void measure(BenchJob& job) {
+    job.body(job.iterations / 10 + 1);
+
+    int64_t startNs = nowNs();
+    uint32_t startCycles = cycleCount();
+    job.body(job.iterations);
+    job.cycles = cycleCount() - startCycles;
+    job.elapsedNs = static_cast<double>(nowNs() - startNs);
+  }
+
+#ifdef ARDUINO
+  SemaphoreHandle_t doneSemaphore = nullptr;
+
+  void benchTask(void* arg) {
+    BenchJob& job = *static_cast<BenchJob*>(arg);
+    benchThread = true;
+    measure(job);
+    // ESP-IDF の StackType_t は1バイト単位
+    job.stackUsed = job.stackUsed - uxTaskGetStackHighWaterMark(nullptr);
+    xSemaphoreGive(doneSemaphore);
+    vTaskDelete(nullptr);
+  }
+
+  void runOnFreshStack(BenchJob& job, size_t stackSize) {
+    if (!doneSemaphore) {
+      doneSemaphore = xSemaphoreCreateBinary();
+    }
+    job.stackUsed = stackSize;
+    xTaskCreatePinnedToCore(benchTask, "bench", stackSize, &job, 1, nullptr, 1);
+    xSemaphoreTake(doneSemaphore, portMAX_DELAY);
+    // 削除したタスクのスタックはアイドルタスクが解放するので少し待つ
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+#else
+  constexpr uint8_t STACK_PATTERN = 0xA5;
+
+  void* benchMain(void* arg) {
+    benchThread = true;
+    measure(*static_cast<BenchJob*>(arg));
+    return nullptr;
+  }
+
+  // 塗りつぶした専用スタックでスレッドを実行し、書き換えられた範囲を数える
+  void runOnFreshStack(BenchJob& job, size_t stackSize) {
+    size_t size = stackSize + 65536;  // libc の初期化分の余裕
+    uint8_t* stack = static_cast<uint8_t*>(aligned_alloc(4096, size));
+    memset(stack, STACK_PATTERN, size);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, size);
+    pthread_t thread;
+    pthread_create(&thread, &attr, benchMain, &job);
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attr);
+
+    // スタックは高位アドレスから低位へ伸びる
+    size_t untouched = 0;
+    while (untouched < size && stack[untouched] == STACK_PATTERN) {
+      untouched++;
+    }
+    job.stackUsed = size - untouched;
+    free(stack);
+  }
+#endif
+}
+
+// ========================================
+// 実行・出力
+// ========================================
+
+BenchResult BenchRunner::run(const char* name, uint32_t iterations, BenchBody body) {
+  BenchJob job = {body, iterations, 0, 0.0, 0};
+
+  size_t heapBefore = freeHeap();
+  HeapTracker::resetPeak();
+  runOnFreshStack(job, STACK_SIZE);
+
+  BenchResult result;
+  result.name = name;
+  result.iterations = iterations;
+  result.cyclesPerIter = static_cast<double>(job.cycles) / iterations;
+  result.usPerIter = job.elapsedNs / 1000.0 / iterations;
+  result.heapPeakBytes = HeapTracker::peak();
+  result.heapLeakBytes = static_cast<long>(heapBefore) - static_cast<long>(freeHeap());
+  result.stackBytes = job.stackUsed;
+
+  printResult(result);
+  return result;
+}
+
+void BenchRunner::printHeader() {
+  printf("[Bench] %-26s %8s %12s %10s %10s %10s %8s\n",
+         "name", "iters", "cycles/iter", "us/iter", "heap_peak", "heap_leak", "stack");
+}
+
+void BenchRunner::printResult(const BenchResult& r) {
+  printf("[Bench] %-26s %8u %12.1f %10.3f %10u %10ld %8u\n",
+         r.name, static_cast<unsigned>(r.iterations), r.cyclesPerIter, r.usPerIter,
+         static_cast<unsigned>(r.heapPeakBytes), r.heapLeakBytes, static_cast<unsigned>(r.stackBytes));
+  fflush(stdout);
+}
@@ -0,0 +1,72 @@
+/**
+ * BenchRunner.h
+ *
+ * ホットパス用マイクロベンチマークの実行基盤
+ * ホスト（native）とESP32の両方で動作し、1回あたりのサイクル数・時間、
+ * ヒープ使用量のピーク、スタック使用量を計測します。
+ */
+
+#ifndef BENCH_RUNNER_H
+#define BENCH_RUNNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+// ベンチマーク本体（指定回数だけ処理を繰り返す）
+typedef void (*BenchBody)(uint32_t iterations);
+
+// 計測結果
+struct BenchResult {
+  const char* name;
+  uint32_t iterations;
+  double cyclesPerIter;   // 1回あたりのCPUサイクル数
+  double usPerIter;       // 1回あたりの時間（µs）
+  size_t heapPeakBytes;   // 計測中のヒープ使用量ピーク（計測中のタスクの new/delete と JSON アロケーター）
+  long heapLeakBytes;     // 計測前後の空きヒープ差（正ならリーク）
+  size_t stackBytes;      // 最大スタック使用量
+};
+
+// ヒープ使用量の追跡（operator new/delete とベンチ用アロケーターが、計測中のタスクの確保のみ更新）
+class HeapTracker {
+public:
+  static void onAlloc(size_t size);
+  static void onFree(size_t size);
+  static void resetPeak();
+  static size_t peak();
+};
+
+// 使用量を記録する ArduinoJson 用アロケーター
+class CountingJsonAllocator : public ArduinoJson::Allocator {
+public:
+  void* allocate(size_t size) override;
+  void deallocate(void* pointer) override;
+  void* reallocate(void* pointer, size_t newSize) override;
+
+  static CountingJsonAllocator* instance();
+};
+
+// ベンチマーク実行クラス
+class BenchRunner {
+public:
+  /**
+   * ベンチマークを実行して結果を出力
+   * 専用スタック上で実行し、ウォームアップ後に本計測を行います。
+   * @param name 名前
+   * @param iterations 繰り返し回数
+   * @param body ベンチマーク本体
+   */
+  static BenchResult run(const char* name, uint32_t iterations, BenchBody body);
+
+  // ヘッダー行・結果行を出力
+  static void printHeader();
+  static void printResult(const BenchResult& result);
+
+  // 最適化による削除を防ぐための書き込み先
+  static volatile uint32_t sink;
+
+private:
+  static constexpr size_t STACK_SIZE = 16384;  // 計測用スタックサイズ（バイト）
+};
+
+#endif // BENCH_RUNNER_H
@@ -0,0 +1,33 @@
+/**
+ * main.cpp（ベンチマーク）
+ *
+ * ホスト: pio run -e bench_native && .pio/build/bench_native/program
+ * ESP32:  pio run -e bench_esp32 -t upload && pio device monitor
+ */
+
+#include "BenchCases.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+  Serial.println("\n[Bench] ホットパス ベンチマーク開始");
+  runAllBenchmarks();
+  Serial.println("[Bench] 完了");
+}
+
+void loop() {
+  delay(1000);
+}
+#else
+#include <stdio.h>
+
+int main() {
+  printf("[Bench] ホットパス ベンチマーク開始\n");
+  runAllBenchmarks();
+  printf("[Bench] 完了\n");
+  return 0;
+}
+#endif
@@ -0,0 +1,122 @@
+/**
+ * ACCommand.h
+ *
+ * エアコンへの指令（運転モード・設定温度・風量・風向・パワフル/エコノ）（Arduino非依存）
+ *
+ * 全項目を32ビットに詰めた値として保持し、比較・差分はビット演算で行います。
+ * 停止はほかの項目に関係なく同じ値（0）になるため、「停止中に停止」は差分なしになります。
+ *
+ * ビット配置:
+ *   0-2   運転モード（ACOperation）
+ *   3-8   設定温度（MIN_SETPOINT からの 0.5℃ 単位）
+ *   9-11  風量（ACFan）
+ *   12    上下スイング
+ *   13    左右スイング
+ *   14    パワフル
+ *   15    エコノ
+ *
+ * 制御ポリシーが返す ACMode は、fromMode() で決まった指令（プリセット）に変換します。
+ */
+
+#ifndef AC_COMMAND_H
+#define AC_COMMAND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ControlPolicy.h"
+
+// 運転モード
+enum class ACOperation : uint8_t {
+  OFF = 0,
+  HEAT,
+  COOL,
+  DRY,
+  FAN,
+  AUTO
+};
+
+// 風量
+enum class ACFan : uint8_t {
+  AUTO = 0,
+  QUIET,
+  LEVEL_1,
+  LEVEL_2,
+  LEVEL_3,
+  LEVEL_4,
+  LEVEL_5
+};
+
+class ACCommand {
+public:
+  static constexpr float MIN_SETPOINT = 10.0f;  // 設定できる温度の範囲（ダイキンの上限・下限）
+  static constexpr float MAX_SETPOINT = 32.0f;
+
+  // 各項目のビット（diff() の結果と AND して変更された項目を調べる）
+  static constexpr uint32_t FIELD_OPERATION = 0x0007;
+  static constexpr uint32_t FIELD_SETPOINT = 0x01F8;
+  static constexpr uint32_t FIELD_FAN = 0x0E00;
+  static constexpr uint32_t FIELD_SWING_VERTICAL = 0x1000;
+  static constexpr uint32_t FIELD_SWING_HORIZONTAL = 0x2000;
+  static constexpr uint32_t FIELD_POWERFUL = 0x4000;
+  static constexpr uint32_t FIELD_ECONO = 0x8000;
+
+  // 不明（まだ送信していない）。どの指令とも異なる
+  constexpr ACCommand() : bits_(UNKNOWN_BITS) {}
+
+  static ACCommand off() { return ACCommand(0); }
+
+  /**
+   * 運転の指令
+   * @param setpoint 設定温度（0.5℃単位に丸め、範囲外は上限・下限に収める）
+   */
+  static ACCommand run(ACOperation operation, float setpoint, ACFan fan = ACFan::AUTO);
+
+  // 制御ポリシーのモードに対応する指令（ACMode::NONE は不明）
+  static ACCommand fromMode(ACMode mode);
+
+  // 詰めた値から復元（保存・通信用）
+  static ACCommand fromPacked(uint32_t bits) { return ACCommand(bits); }
+
+  // 項目を変更した指令（元の値は変わらない）
+  ACCommand withSetpoint(float setpoint) const;
+  ACCommand withFan(ACFan fan) const;
+  ACCommand withSwing(bool vertical, bool horizontal) const;
+  ACCommand withPowerful(bool on) const;  // エコノは解除
+  ACCommand withEcono(bool on) const;     // パワフルは解除
+
+  uint32_t packed() const { return bits_; }
+  bool isKnown() const { return bits_ != UNKNOWN_BITS; }
+  bool isOff() const { return bits_ == 0; }
+
+  ACOperation getOperation() const { return static_cast<ACOperation>(bits_ & FIELD_OPERATION); }
+  float getSetpoint() const { return MIN_SETPOINT + ((bits_ & FIELD_SETPOINT) >> 3) * 0.5f; }
+  ACFan getFan() const { return static_cast<ACFan>((bits_ & FIELD_FAN) >> 9); }
+  bool getSwingVertical() const { return (bits_ & FIELD_SWING_VERTICAL) != 0; }
+  bool getSwingHorizontal() const { return (bits_ & FIELD_SWING_HORIZONTAL) != 0; }
+  bool getPowerful() const { return (bits_ & FIELD_POWERFUL) != 0; }
+  bool getEcono() const { return (bits_ & FIELD_ECONO) != 0; }
+
+  // 異なる項目のビット（0: 同じ指令）
+  uint32_t diff(const ACCommand& other) const { return bits_ ^ other.bits_; }
+
+  bool operator==(const ACCommand& other) const { return bits_ == other.bits_; }
+  bool operator!=(const ACCommand& other) const { return bits_ != other.bits_; }
+
+  // 同じ指令になる ACMode（該当なしは ACMode::NONE）
+  ACMode toMode() const;
+
+  // 運転モードが同じで設定温度が最も近い ACMode（設定温度を調整した指令の表示・消費電力・履歴用。該当なしは ACMode::NONE）
+  ACMode nearestMode() const;
+
+  // 運転モードの表示名（例: "冷房"）
+  static const char* operationToString(ACOperation operation);
+
+private:
+  static constexpr uint32_t UNKNOWN_BITS = 0xFFFFFFFF;
+
+  explicit constexpr ACCommand(uint32_t bits) : bits_(bits) {}
+
+  uint32_t bits_;
+};
+
+#endif // AC_COMMAND_H
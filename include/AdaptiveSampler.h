@@ -0,0 +1,89 @@
+/**
+ * AdaptiveSampler.h
+ *
+ * 温湿度の変化に応じたセンサー読み取り間隔の調整（Arduino非依存）
+ *
+ * 読み取り値を指数移動平均で平滑化し、次の場合は最短間隔で読み取ります。
+ * - 平滑化した温度・湿度が動いている（前回動いた時点の値から TEMP_STEP・HUMIDITY_STEP 以上変化）
+ * - 制御の境界（目標範囲の下限・上限・停止温度、湿度上限）の近く
+ * - 読み取りに失敗した
+ * それ以外（安定）は読み取りのたびに間隔を2倍にし、最長間隔まで延ばします。
+ * 変化は読み取り間隔あたりではなく基準値からの差で判定するため、短い間隔での読み取りの揺らぎ
+ * （DHT22 は ±0.1℃ 程度）では動いているとみなさず、ゆっくりした変化も積み重なれば捉えます。
+ * DHT22 の自己発熱と不要な読み取りを減らしつつ、制御に効く変化はすぐに捉えます。
+ * 時刻はすべて呼び出し側から渡します（ホストでそのまま動作確認できます）。
+ */
+
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+#include <stdint.h>
+#include "ControlPolicy.h"
+
+class AdaptiveSampler {
+public:
+  static constexpr float FILTER_ALPHA = 0.3f;           // 平滑化の重み（新しい値）
+  static constexpr float TEMP_STEP = 0.2f;              // 動いているとみなす温度の変化（℃）
+  static constexpr float HUMIDITY_STEP = 1.5f;          // 動いているとみなす湿度の変化（%）
+  static constexpr float TEMP_EDGE_MARGIN = 0.3f;       // 境界の近くとみなす温度の幅（℃）
+  static constexpr float HUMIDITY_EDGE_MARGIN = 2.0f;   // 境界の近くとみなす湿度の幅（%）
+
+  /**
+   * コンストラクタ
+   * @param minIntervalMs 最短の読み取り間隔（センサーの仕様上の下限以上）
+   * @param maxIntervalMs 安定時の最長の読み取り間隔
+   */
+  AdaptiveSampler(uint32_t minIntervalMs, uint32_t maxIntervalMs);
+
+  // 最短の読み取り間隔を変更（実行時設定の変更時）
+  void setMinInterval(uint32_t minIntervalMs);
+
+  // 制御の境界を設定（境界の近くでは最短間隔で読み取る）
+  void setThresholds(const PolicyThresholds& thresholds) { thresholds_ = thresholds; }
+
+  /**
+   * 読み取り結果を渡し、次の読み取りまでの間隔を決める
+   * @param nowMs 読み取った時刻（millis）
+   * @param valid 読み取りに成功したか
+   * @return 次の読み取りまでの間隔（ミリ秒）
+   */
+  uint32_t onReading(uint32_t nowMs, bool valid, float temperature, float humidity);
+
+  // 次の読み取りを最短間隔に戻す（すぐに最新の値が必要な場合）
+  void expedite() { intervalMs_ = minIntervalMs_; }
+
+  // 現在の読み取り間隔（ミリ秒）
+  uint32_t getIntervalMs() const { return intervalMs_; }
+
+  // 読み取り回数
+  uint32_t getReads() const { return reads_; }
+
+  // 最短間隔で読み取り続けた場合と比べて省略した読み取り回数
+  uint32_t getSavedReads() const { return saved_; }
+
+  // 平均の読み取り頻度（回/時、最初の読み取りから）
+  float getReadsPerHour(uint32_t nowMs) const;
+
+private:
+  bool nearEdge(float temperature, float humidity) const;
+
+  uint32_t minIntervalMs_;
+  uint32_t maxIntervalMs_;
+  uint32_t intervalMs_;
+  PolicyThresholds thresholds_;
+
+  // 平滑化した値
+  bool filtered_;         // 平滑化の初期値を設定済み
+  float temperature_;
+  float humidity_;
+  float baseTemperature_; // 変化の基準（前回動いたと判定した時点の平滑化した値）
+  float baseHumidity_;
+
+  // 統計
+  uint32_t firstMs_;      // 最初の読み取りの時刻
+  uint32_t lastReadMs_;   // 前回の読み取りの時刻（失敗を含む）
+  uint32_t reads_;
+  uint32_t saved_;
+};
+
+#endif // ADAPTIVE_SAMPLER_H
@@ -7,43 +7,59 @@
 #include <ir_Daikin.h>
 #include "TimeManager.h"
 #include "WeatherForecast.h"
+#include "ControlPolicy.h"
+#include "ACCommand.h"
+#include "SetpointModulator.h"
+#include "Coroutine.h"
 
-// 季節の定義
-enum class Season {
-  SPRING,  // 春季（3〜5月）
-  SUMMER,  // 夏季（6〜9月）
-  AUTUMN,  // 秋季（10〜11月）
-  WINTER   // 冬季（12〜2月）
-};
-
-// 時間帯の定義
-enum class TimeOfDay {
-  DAYTIME,  // 日中（7:00〜23:00）
-  NIGHT     // 夜間（23:00〜翌7:00）
-};
-
-// エアコンの動作モード
-enum class ACMode {
-  NONE,
-  OFF,               // エアコン停止（電源オフ）
-  HEATING_23_5,      // 暖房23.5度
-  HEATING_18,        // 暖房18度（極寒日の夜間用）
-  COOLING_25,        // 冷房25度
-  DEHUMID_MINUS_1_5  // 除湿-1.5度
-};
+// 赤外線信号を受信した時に呼ぶ関数（トレースの記録用）
+typedef void (*IRReceiveHandler)(int16_t protocol, uint16_t bits, uint64_t value, void* context);
 
 // エアコン制御クラス
 class AirConditionerController {
 public:
+  // 受信ピンなし（送信専用。IRrecv は1台のみ使用可能なため、追加ゾーンはこれを指定）
+  static constexpr uint8_t NO_RECEIVER = 0xFF;
+
   AirConditionerController(uint8_t sendPin, uint8_t recvPin);
 
+  // 送信後に受信を再開するまでの時間（自分の送信の反射を受信しない）
+  static constexpr uint32_t RECEIVE_RESUME_MS = 200;
+
   // 初期化
   void begin();
 
-  // 指定されたモードでエアコンを制御
+  /**
+   * 受信の再開を待つコルーチンを登録（setup() で呼び出す）
+   * 登録しない場合、送信は受信の再開まで待ちます（ディープスリープの起床時など）。
+   */
+  bool attach(CoroutineScheduler& scheduler);
+
+  // 受信した信号を渡す関数を設定（受信ダンプのログ出力に加えて呼び出す）
+  void setReceiveHandler(IRReceiveHandler handler, void* context) {
+    receiveHandler_ = handler;
+    receiveContext_ = context;
+  }
+
+  // 指定されたモードでエアコンを制御（モードに対応する指令を setCommand() で送信）
   void setMode(ACMode mode);
 
-  // 現在のモードを取得
+  /**
+   * 指令を送信（現在の指令と同じ場合は送信しない）
+   * @return true: 送信した
+   */
+  bool setCommand(const ACCommand& command);
+
+  // 現在のモードを復元（信号は送信しない、ディープスリープからの復帰用）
+  void restoreMode(ACMode mode) {
+    currentMode_ = mode;
+    currentCommand_ = ACCommand::fromMode(mode);
+  }
+
+  // 最後に送信した指令
+  const ACCommand& getCurrentCommand() const { return currentCommand_; }
+
+  // 現在のモードを取得（モードに対応しない指令を送信した場合は ACMode::NONE）
   ACMode getCurrentMode() const { return currentMode_; }
 
   // エアコンが停止状態かどうかを確認
@@ -52,31 +68,78 @@ public:
   // 温度・湿度・時刻・天気予報に基づいて最適なモードを決定
   ACMode determineOptimalMode(float temperature, float humidity, TimeManager& timeMgr, const WeatherData& weather);
 
+  // 取得済みの時刻で判定（複数ゾーンをまとめて判定する場合に時刻取得を1回にする）
+  ACMode determineOptimalMode(float temperature, float humidity, const struct tm& timeinfo, const WeatherData& weather);
+
+  /**
+   * 設定温度を調整する制御で指令を決定（運転を続け、設定温度を0.5℃単位で変更）
+   * オン・オフ制御の判定は modulator の比較用の状態で行います。
+   * @param nowMs 判定の時刻（millis。トレースの再生と同じ値にするため呼び出し側から渡す）
+   */
+  ACCommand determineCommand(float temperature, float humidity, const struct tm& timeinfo, const WeatherData& weather,
+                             SetpointModulator& modulator, uint32_t nowMs);
+
   // 赤外線信号の受信処理
   void handleIRReceive();
 
+  /**
+   * 指令のIRフレーム（Daikinステート、kDaikinStateLength バイト）を取得（送信はしない）
+   * 生成済みのフレームはキャッシュから返します。
+   * @return 不明な指令の場合は nullptr
+   */
+  const uint8_t* encodeFrame(const ACCommand& command);
+
+  // フレームキャッシュの統計
+  uint32_t getFrameCacheHits() const { return frameCacheHits_; }
+  uint32_t getFrameCacheMisses() const { return frameCacheMisses_; }
+
+  // 制御ポリシー（閾値の参照・変更用）
+  ControlPolicy& getPolicy() { return policy_; }
+
 private:
+  static constexpr uint8_t IR_RAW_VALUES_PER_LINE = 10;  // 受信ダンプの1行あたりの値の数
+  static constexpr size_t FRAME_CACHE_SIZE = 8;          // キャッシュするフレーム数
+
+  // 生成済みのフレーム（指令の値で検索）
+  struct CachedFrame {
+    ACCommand command;  // 不明: 未使用
+    uint8_t state[kDaikinStateLength];
+  };
+
+  // 送信後 RECEIVE_RESUME_MS 待って受信を再開（送信のたびに最初からやり直す）
+  class ReceiveResumeTask : public Coroutine {
+  public:
+    explicit ReceiveResumeTask(IRrecv* irRecv) : irRecv_(irRecv) {}
+  protected:
+    bool run(uint32_t nowMs) override;
+  private:
+    IRrecv* irRecv_;
+  };
+
   IRDaikinESP daikinAC_;
-  IRrecv irRecv_;
+  IRrecv* irRecv_;  // 受信なしの場合は nullptr
+  ReceiveResumeTask receiveResume_;
+  bool attached_;   // 受信の再開をコルーチンで待つ
+  IRReceiveHandler receiveHandler_;
+  void* receiveContext_;
   ACMode currentMode_;
+  ACCommand currentCommand_;
+  ControlPolicy policy_;
+
+  CachedFrame frameCache_[FRAME_CACHE_SIZE];
+  uint8_t frameCacheNext_;  // 次に上書きする位置（古い順）
+  uint32_t frameCacheHits_;
+  uint32_t frameCacheMisses_;
+
+  // 制御ポリシーへの入力を作成（ログ出力付き）
+  PolicyInput makeInput(float temperature, float humidity, const struct tm& timeinfo, const WeatherData& weather) const;
+
+  // 判定結果をログ出力
+  void printDecision(const PolicyDecision& decision, float temperature, float humidity) const;
 
-  // ヘルパー関数
-  Season getCurrentSeason(int month) const;
-  TimeOfDay getTimeOfDay(int hour) const;
-  bool isExtremeColdDay(const WeatherData& weather) const;
-
-  // 季節別制御関数
-  ACMode determineSpringMode(float temperature, float humidity, TimeOfDay timeOfDay);
-  ACMode determineSummerMode(float temperature, float humidity);
-  ACMode determineAutumnMode(float temperature, float humidity, TimeOfDay timeOfDay);
-  ACMode determineWinterMode(float temperature, float humidity, TimeOfDay timeOfDay, bool isExtremeCold);
-
-  // 各モードの送信関数
-  void sendOff();                // エアコン停止（電源オフ）
-  void sendHeating23_5();        // 暖房23.5度
-  void sendHeating18();          // 暖房18度
-  void sendCooling25();          // 冷房25度
-  void sendDehumidMinus1_5();    // 除湿-1.5度
+  // 送信関数
+  void sendFrame(const ACCommand& command);      // 指令の信号を送信
+  void applyCommand(const ACCommand& command);  // ダイキンのステートに指令を設定
 };
 
 #endif // AIR_CONDITIONER_CONTROLLER_H
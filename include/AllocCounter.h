@@ -0,0 +1,111 @@
+/**
+ * AllocCounter.h
+ *
+ * ヒープ確保の回数計測
+ *
+ * リンカーの --wrap で malloc / calloc / realloc を置き換え、確保の回数を数えます。
+ * 監視するタスク（loop() を実行するタスク）の回数は別に数え、LoopProfiler が
+ * フェーズごとに振り分けて「起動後の loop() で確保が発生していないこと」を確認します。
+ * new / String / std::function などの確保も malloc を経由するため含まれます。
+ *
+ * フラッシュ書き込み（LittleFS・NVS）・ESP-NOW の送信・WiFi の再接続のように、SDK の内部で確保する呼び出しは
+ * AllocExemption で囲むと、監視するタスクの回数から除きます（全タスクの合計・呼び出し元の記録には含めます）。
+ * 除くのは囲んだ呼び出しだけで、同じフェーズの他の処理の確保は検出されます。
+ *
+ * seal() の後（初期化の完了後）は、全タスクの確保を呼び出し元（スタック上位の数フレームの
+ * アドレス）ごとに固定長の表へ記録します。printSites() の出力を addr2line で関数名に変換して、
+ * 長時間稼働でヒープを断片化させる確保を特定します。
+ *
+ * 有効にするには次のビルドフラグが必要です（env:esp32dev_alloccheck に設定済み）:
+ *   -DALLOC_COUNTER -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
+ * ALLOC_COUNTER が未定義の場合（ホストを含む）は何も数えず、すべて 0 を返します。
+ */
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(ARDUINO) && defined(ALLOC_COUNTER)
+#define ALLOC_COUNTER_ENABLED 1
+#else
+#define ALLOC_COUNTER_ENABLED 0
+#endif
+
+// 初期化後の確保の呼び出し元
+struct AllocSite {
+  static constexpr size_t DEPTH = 3;  // 記録するフレーム数（malloc を呼んだ関数から上位へ）
+  uint32_t pc[DEPTH];
+  uint32_t count;
+  uint32_t bytes;
+};
+
+class AllocCounter {
+public:
+  static constexpr size_t MAX_SITES = 16;  // 記録する呼び出し元の数
+
+  // 計測が有効なビルドか
+  static constexpr bool isEnabled() { return ALLOC_COUNTER_ENABLED != 0; }
+
+#if ALLOC_COUNTER_ENABLED
+  // 呼び出したタスクを監視対象にする（setup() の末尾で呼び出す）
+  static void watchCurrentTask();
+
+  // 監視対象のタスクの前回の呼び出しからの確保回数を取得してリセット（AllocExemption の区間を除く）
+  static uint32_t takeTaskCount();
+
+  // 監視対象のタスクの確保を数えない区間の開始・終了（AllocExemption から呼ぶ。入れ子可、他のタスクでは何もしない）
+  static void beginExemption();
+  static void endExemption();
+
+  // 全タスクの確保回数の合計（起動から）
+  static uint32_t getTotal();
+
+  // 以降の確保を呼び出し元ごとに記録する（setup() の末尾で呼び出す）
+  static void seal();
+
+  /**
+   * 記録した呼び出し元を取得
+   * @return 件数（max まで）
+   */
+  static size_t getSites(AllocSite* out, size_t max);
+
+  // 表が満杯で記録できなかった確保の回数
+  static uint32_t getUntrackedCount();
+
+  // 記録した呼び出し元の一覧をログ出力
+  static void printSites();
+#else
+  // 無効なビルド（ホストを含む）では何もしない
+  static void watchCurrentTask() {}
+  static uint32_t takeTaskCount() { return 0; }
+  static void beginExemption() {}
+  static void endExemption() {}
+  static uint32_t getTotal() { return 0; }
+  static void seal() {}
+  static size_t getSites(AllocSite*, size_t) { return 0; }
+  static uint32_t getUntrackedCount() { return 0; }
+  static void printSites() {}
+#endif
+};
+
+/**
+ * 確保を許可する区間（スコープの終わりまで）
+ *
+ * 使い方:
+ *   {
+ *     AllocExemption exemption;  // NVS への書き込みは内部で確保する
+ *     prefs.putBytes(...);
+ *   }
+ */
+class AllocExemption {
+public:
+  AllocExemption() { AllocCounter::beginExemption(); }
+  ~AllocExemption() { AllocCounter::endExemption(); }
+
+  AllocExemption(const AllocExemption&) = delete;
+  AllocExemption& operator=(const AllocExemption&) = delete;
+};
+
+#endif // ALLOC_COUNTER_H
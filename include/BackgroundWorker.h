@@ -0,0 +1,63 @@
+/**
+ * BackgroundWorker.h
+ *
+ * 途中で待たせられない処理（HTTP 通信など）を別タスクで1件ずつ実行するクラス
+ *
+ * HTTPClient の GET・本文の受信はライブラリの中で完了まで待つため、コルーチンでは分割できません。
+ * この処理を専用のタスク（ESP32: FreeRTOS のタスク、ホスト: スレッド）に渡し、
+ * loop() 側のコルーチンは isIdle() になるまで CO_WAIT_UNTIL() で待ちます。
+ *
+ * - 同時に実行する処理は1件（実行中は submit() が false を返す）
+ * - 処理が書き込んだ値は isIdle() が true を返した後に loop() から読む（それまでは触らない）
+ * - タスクを作成できなかった場合は submit() の中でその場で実行する
+ */
+
+#ifndef BACKGROUND_WORKER_H
+#define BACKGROUND_WORKER_H
+
+#include <stdint.h>
+
+class BackgroundWorker {
+public:
+  // 別タスクで行う処理
+  typedef void (*Job)(void* context);
+
+  /**
+   * コンストラクタ
+   * @param name タスク名（ログ出力にも使用）
+   * @param stackSize タスクのスタックサイズ（バイト、ESP32のみ）
+   */
+  BackgroundWorker(const char* name, uint32_t stackSize);
+
+  /**
+   * タスクを作成（setup() で呼び出す）
+   * @return false: 作成できず、以降はその場で実行する
+   */
+  bool begin();
+
+  /**
+   * 処理を依頼
+   * @return false: 前の処理が実行中
+   */
+  bool submit(Job job, void* context);
+
+  // 依頼した処理がすべて終わったか（true の後は処理が書き込んだ値を読んでよい）
+  bool isIdle() const;
+
+  // 終えた処理の数
+  uint32_t getCompleted() const;
+
+private:
+  static void taskMain(void* param);
+  void runJob();
+
+  const char* name_;
+  uint32_t stackSize_;
+  void* task_;           // ESP32: タスクハンドル（nullptr: 作成前・失敗）
+  Job job_;
+  void* context_;
+  uint32_t submitted_;   // 依頼した数（loop() タスクのみ書き込む）
+  uint32_t completed_;   // 終えた数（処理の書き込みの後に release で更新）
+};
+
+#endif // BACKGROUND_WORKER_H
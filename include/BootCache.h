@@ -0,0 +1,71 @@
+/**
+ * BootCache.h
+ *
+ * 停電からの復帰時に使う前回の状態（NVS に保存）
+ *
+ * 最後に確認した時刻と天気予報（取得時刻付き）を保存しておき、起動直後（NTP同期・天気予報の取得前）の
+ * 最初の制御判定と、取得に失敗した場合の WeatherForecast の予報に使います。時刻は「保存した時刻 + 起動からの経過時間」の仮の値で、
+ * 停電していた時間は含みません（季節・時間帯の判定用。NTP同期後に判定し直します）。
+ * 書き込み回数を抑えるため、保存は天気予報の更新時と SAVE_INTERVAL_SEC ごとのみです。
+ */
+
+#ifndef BOOT_CACHE_H
+#define BOOT_CACHE_H
+
+#include <stdint.h>
+#include <time.h>
+#include "WeatherData.h"
+
+class BootCache {
+public:
+  static constexpr uint32_t SAVE_INTERVAL_SEC = 3600;  // 天気予報が変わらない場合の時刻の保存間隔
+
+  BootCache();
+
+  /**
+   * 保存済みの状態を読み込む（setup() で呼び出す）
+   * @return true: 前回の状態あり
+   */
+  bool begin();
+
+  // 前回の時刻があるか
+  bool hasTime() const { return savedEpoch_ != 0; }
+
+  /**
+   * 仮の現在時刻（保存した時刻 + 起動からの経過）
+   * @param nowMs 現在の millis()
+   * @param out 現地時刻（出力）
+   * @return false: 前回の時刻なし
+   */
+  bool provisionalTime(uint32_t nowMs, struct tm& out) const;
+
+  // 前回の天気予報（なければ isValid = false）
+  const WeatherData& getForecast() const { return forecast_; }
+
+  /**
+   * 現在の状態を渡す（時刻の同期後、センサー読み取りごとに呼び出す）
+   * 天気予報が更新された場合と、前回の保存から SAVE_INTERVAL_SEC 経過した場合のみ保存します。
+   */
+  void update(uint32_t epoch, const WeatherData& weather);
+
+private:
+  // NVS に保存する形式
+  struct Record {
+    uint32_t epoch;
+    float tempMax;
+    float tempMin;
+    uint32_t fetchedEpoch;
+    int16_t weatherCode;
+    uint8_t forecastValid;
+    uint8_t version;
+  };
+  static constexpr uint8_t RECORD_VERSION = 2;
+
+  bool save(uint32_t epoch, const WeatherData& weather);
+
+  uint32_t savedEpoch_;          // 保存済みの時刻（0: なし）
+  uint32_t savedForecast_;       // 保存済みの天気予報の取得時刻（WeatherData::fetchedEpoch）
+  WeatherData forecast_;
+};
+
+#endif // BOOT_CACHE_H
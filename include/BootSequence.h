@@ -0,0 +1,83 @@
+/**
+ * BootSequence.h
+ *
+ * 起動処理の並列化と所要時間の記録
+ *
+ * WiFi接続・NTP同期・天気予報の取得（合わせて20秒以上かかることがある）を起動用の
+ * バックグラウンドタスクで行い、その間に setup() はセンサー・ディスプレイ・IR を初期化して
+ * loop() を始めます。停電からの復帰直後でもすぐに最初の制御判定を行えます。
+ *
+ * 起動からの各段階（マイルストーン）の時刻を記録し、最初にエアコンへ送信するまでの時間を
+ * 起動性能の指標としてログ・ステータスAPIに出力します。
+ */
+
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <Arduino.h>
+
+// 起動の段階
+enum class BootMilestone : uint8_t {
+  SENSOR_READY,    // センサー初期化
+  IR_READY,        // IR送信・ゾーンの準備
+  DISPLAY_READY,   // ディスプレイ初期化
+  SETUP_DONE,      // setup() 完了（loop() 開始）
+  FIRST_READING,   // 最初の有効なセンサー値
+  WIFI_CONNECTED,  // WiFi接続
+  TIME_SYNCED,     // NTP同期
+  WEATHER_READY,   // 天気予報の取得
+  NETWORK_DONE,    // 起動用タスクの終了（成否を問わない）
+  FIRST_CONTROL,   // 最初のエアコンへの送信
+  COUNT
+};
+
+class BootSequence {
+public:
+  // 起動用タスクで行う処理（戻ると NETWORK_DONE を記録してタスクを終了）
+  typedef void (*NetworkStep)(void* context);
+
+  BootSequence();
+
+  /**
+   * 段階の到達を記録（最初の1回のみ。どのタスクから呼んでもよい）
+   * 記録した時刻（起動からのミリ秒）をログ出力します。
+   */
+  void mark(BootMilestone milestone);
+
+  // 到達済みか
+  bool reached(BootMilestone milestone) const;
+
+  /**
+   * 到達した時刻
+   * @return 起動からのミリ秒（未到達は 0）
+   */
+  uint32_t getMs(BootMilestone milestone) const;
+
+  /**
+   * ネットワークの起動処理をバックグラウンドタスクで開始
+   * @param step タスクで行う処理
+   * @param context step に渡す値
+   * @return false: タスクを作成できず、その場で実行した
+   */
+  bool startNetwork(NetworkStep step, void* context);
+
+  // 起動用タスクが終了したか（true の後は step が書き込んだ値を loop() から読んでよい）
+  bool isNetworkDone() const { return reached(BootMilestone::NETWORK_DONE); }
+
+  // 段階の名前
+  static const char* milestoneName(BootMilestone milestone);
+
+private:
+  static constexpr size_t MILESTONE_COUNT = static_cast<size_t>(BootMilestone::COUNT);
+  static constexpr uint32_t TASK_STACK_SIZE = 8192;  // HTTPS（TLS）の天気予報取得を含むため大きめ
+  static constexpr UBaseType_t TASK_PRIORITY = 1;
+  static constexpr BaseType_t TASK_CORE = 0;         // WiFi と同じコア（loop() は 1）
+
+  static void networkTask(void* param);
+
+  volatile uint32_t times_[MILESTONE_COUNT];  // 到達時刻 + 1（0: 未到達）
+  NetworkStep step_;
+  void* context_;
+};
+
+#endif // BOOT_SEQUENCE_H
@@ -0,0 +1,85 @@
+/**
+ * ConfigManager.h
+ *
+ * 実行時設定の読み込み・保存・差し替えクラス
+ *
+ * 起動時に NVS から一度だけ読み込み、以降は get() が返すコピーのフィールドを直接参照します。
+ * 変更（HTTP・MQTT・シリアルコンソールから）は、使用中でない側のバッファに書き込んでから
+ * ポインターを atomic に切り替えます。get() はコピーの前後で世代を比べ、コピー中に変更された
+ * 場合はコピーし直すため、読み出し側はロック不要で、途中まで書き換わった設定を見ることはありません
+ * （loop() 1回分はそのコピーを使います）。
+ *
+ * 現在の値を元にした変更は modify() で行います（読み出し・変更・差し替えを書き込み側のロック中に行うため、
+ * 同時に来た変更が互いの項目を上書きしません）。変更の有無は getGeneration() で判定できます。
+ */
+
+#ifndef CONFIG_MANAGER_H
+#define CONFIG_MANAGER_H
+
+#include <atomic>
+#include <mutex>
+#include "RuntimeConfig.h"
+
+/**
+ * modify() で現在の設定を書き換える関数
+ * @return false: 変更しない（error に理由）
+ */
+typedef bool (*ConfigEditor)(RuntimeConfig& config, void* context, const char** error);
+
+class ConfigManager {
+public:
+  /**
+   * コンストラクタ
+   * @param defaults 初期値（NVS に保存がない・壊れている場合に使用）
+   */
+  explicit ConfigManager(const RuntimeConfig& defaults);
+
+  /**
+   * NVS から設定を読み込む（ホストでは初期値のまま）
+   * @return true: 保存済みの設定を読み込んだ, false: 初期値を使用
+   */
+  bool begin();
+
+  // 現在の設定のコピー（ロック不要）
+  RuntimeConfig get() const;
+
+  // 変更のたびに増える番号
+  uint32_t getGeneration() const { return generation_.load(std::memory_order_acquire); }
+
+  /**
+   * 設定を検証して保存し、差し替える
+   * @param error 失敗時の理由
+   * @return false: 値が不正（保存・差し替えは行わない）
+   */
+  bool update(const RuntimeConfig& next, const char** error);
+
+  /**
+   * 現在の設定を edit で書き換えて検証・保存し、差し替える（書き込み側のロック中に行う）
+   * @param error 失敗時の理由
+   * @return false: edit が失敗、または値が不正
+   */
+  bool modify(ConfigEditor edit, void* context, const char** error);
+
+  /**
+   * "名前=値" を & または改行で区切った文字列で変更（例: "tempLower=24.0&tempUpper=26.0"）
+   * すべての項目が正しい場合のみまとめて反映します。
+   * @param text 変更内容（書き換えられます）
+   * @param error 失敗時の理由
+   */
+  bool applyText(char* text, const char** error);
+
+  // 初期値に戻す
+  bool reset();
+
+private:
+  bool save(const RuntimeConfig& config);
+  bool commit(const RuntimeConfig& next, const char** error);  // writeLock_ を保持して呼び出す
+
+  const RuntimeConfig defaults_;
+  RuntimeConfig buffers_[2];
+  std::atomic<const RuntimeConfig*> current_;
+  std::atomic<uint32_t> generation_;
+  std::mutex writeLock_;  // 書き込み側どうしの排他
+};
+
+#endif // CONFIG_MANAGER_H
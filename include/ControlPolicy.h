@@ -0,0 +1,143 @@
+/**
+ * ControlPolicy.h
+ *
+ * エアコン制御ポリシー（季節・時間帯・温湿度からモードを決定する純粋ロジック）
+ * Arduino/IRライブラリに依存しないため、ホスト側のシミュレーターからも利用できます。
+ */
+
+#ifndef CONTROL_POLICY_H
+#define CONTROL_POLICY_H
+
+#include <stdint.h>
+#include <time.h>
+
+struct WeatherData;
+
+// 季節の定義
+enum class Season {
+  SPRING,  // 春季（3〜5月）
+  SUMMER,  // 夏季（6〜9月）
+  AUTUMN,  // 秋季（10〜11月）
+  WINTER   // 冬季（12〜2月）
+};
+
+// 時間帯の定義
+enum class TimeOfDay {
+  DAYTIME,  // 日中（7:00〜23:00）
+  NIGHT     // 夜間（23:00〜翌7:00）
+};
+
+// エアコンの動作モード
+enum class ACMode {
+  NONE,
+  OFF,               // エアコン停止（電源オフ）
+  HEATING_23_5,      // 暖房23.5度
+  HEATING_18,        // 暖房18度（極寒日の夜間用）
+  COOLING_25,        // 冷房25度
+  DEHUMID_MINUS_1_5  // 除湿-1.5度
+};
+
+// 温度・湿度の閾値設定（デフォルト値）
+namespace Threshold {
+  // 温度範囲
+  constexpr float TEMP_LOWER = 24.2f;   // 目標室温下限
+  constexpr float TEMP_UPPER = 26.5f;   // 目標室温上限
+
+  // ヒステリシス（不感帯）設定
+  constexpr float TEMP_HYSTERESIS = 0.3f;   // 温度ヒステリシス幅（℃）
+
+  // 湿度範囲
+  constexpr float HUMIDITY_LOWER = 40.0f;   // 目標湿度下限
+  constexpr float HUMIDITY_UPPER = 62.0f;   // 目標湿度上限
+  constexpr float HUMIDITY_HIGH = 65.0f;    // 高湿度の閾値
+  constexpr float HUMIDITY_VERY_HIGH = 70.0f; // 非常に高湿度の閾値
+
+  // 極寒日の判定（予報最低気温）
+  constexpr float EXTREME_COLD_TEMP = 0.0f;
+}
+
+// 制御ポリシーの閾値（シミュレーター等で差し替え可能）
+struct PolicyThresholds {
+  float tempLower;       // 目標室温下限
+  float tempUpper;       // 目標室温上限
+  float tempHysteresis;  // 温度ヒステリシス幅
+  float humidityUpper;   // 目標湿度上限
+
+  // 暖房停止温度（例: 24.5℃）
+  float tempLowerOff() const { return tempLower + tempHysteresis; }
+  // 冷房停止温度（例: 26.2℃）
+  float tempUpperOff() const { return tempUpper - tempHysteresis; }
+};
+
+constexpr PolicyThresholds DEFAULT_THRESHOLDS = {
+  Threshold::TEMP_LOWER, Threshold::TEMP_UPPER,
+  Threshold::TEMP_HYSTERESIS, Threshold::HUMIDITY_UPPER
+};
+
+// モード決定の理由（ログ出力・解析用）
+enum class PolicyReason : uint8_t {
+  TIME_UNAVAILABLE,     // 時刻取得失敗
+  NIGHT_OFF,            // 夜間停止
+  EXTREME_COLD_NIGHT,   // 極寒日の夜間 → 暖房18度
+  HEAT_START,           // 室温 < 下限 → 暖房
+  HEAT_HOLD,            // 暖房中（ヒステリシス）→ 暖房継続
+  COOL_START,           // 室温 > 上限 → 冷房
+  COOL_HOLD,            // 冷房中（ヒステリシス）→ 冷房継続
+  DEHUMID_START,        // 湿度 > 上限 → 除湿
+  DEHUMID_HOLD,         // 除湿中（ヒステリシス）→ 除湿継続
+  COMFORT_OFF,          // 快適範囲内 → 停止
+  OVERCOOL_OFF,         // 夏季の過冷房防止 → 停止
+  WARM_WAIT_OFF         // 冬季の高温時 → 自然冷却待ち
+};
+
+// モード決定に必要な入力
+struct PolicyInput {
+  float temperature;  // 室温（℃）
+  float humidity;     // 湿度（%）
+  int month;          // 月（1-12）
+  int hour;           // 時（0-23）
+  bool extremeCold;   // 極寒日（予報最低気温0度以下）かどうか
+};
+
+// モード決定の結果
+struct PolicyDecision {
+  ACMode mode;
+  PolicyReason reason;
+  Season season;
+  TimeOfDay timeOfDay;
+};
+
+// 制御ポリシークラス
+class ControlPolicy {
+public:
+  explicit ControlPolicy(const PolicyThresholds& thresholds = DEFAULT_THRESHOLDS);
+
+  // 現在のモードと入力から最適なモードを決定
+  PolicyDecision decide(const PolicyInput& input, ACMode currentMode) const;
+
+  // 閾値の取得・設定
+  const PolicyThresholds& getThresholds() const { return thresholds_; }
+  void setThresholds(const PolicyThresholds& thresholds) { thresholds_ = thresholds; }
+
+  // ヘルパー関数
+  static Season getSeason(int month);
+  static TimeOfDay getTimeOfDay(int hour);
+  static bool isExtremeCold(bool forecastValid, float forecastTempMin);
+
+  // センサー値・時刻・天気予報から入力を作成（実機とトレースの再生で同じ変換を使う）
+  static PolicyInput makeInput(float temperature, float humidity, const struct tm& timeinfo, const WeatherData& weather);
+
+  // 文字列変換（ログ出力用）
+  static const char* seasonToString(Season season);
+  static const char* modeToString(ACMode mode);
+
+private:
+  PolicyThresholds thresholds_;
+
+  // 季節別制御関数
+  PolicyReason decideIntermediate(float temperature, TimeOfDay timeOfDay, ACMode currentMode, ACMode& mode) const;
+  PolicyReason decideSummer(float temperature, float humidity, ACMode currentMode, ACMode& mode) const;
+  PolicyReason decideWinter(float temperature, TimeOfDay timeOfDay, bool extremeCold, ACMode currentMode, ACMode& mode) const;
+};
+
+#endif // CONTROL_POLICY_H
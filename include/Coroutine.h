@@ -0,0 +1,152 @@
+/**
+ * Coroutine.h
+ *
+ * 待ち時間のある処理を順番に書くためのスタックレスのコルーチンと、その実行管理（Arduino非依存）
+ *
+ * 赤外線送信後の待ち・WiFi の接続待ち・天気予報の取得待ちを delay() やポーリングのループで
+ * 書くと、その間 loop() が止まります。このクラスを継承して run() に処理を順番に書き、
+ * 待つところで CO_SLEEP() / CO_WAIT_UNTIL() を使うと、そこで run() から戻り、
+ * 再開時刻を過ぎた後の CoroutineScheduler::run() で続きから実行されます。
+ *
+ * - 実行位置（行番号）と再開時刻はオブジェクト（フレーム）に保存する。フレームは
+ *   各クラスのメンバーとして静的に確保し、スケジューラーは固定長の表で管理する（ヒープを使わない）
+ * - 待機をまたぐ値は局所変数ではなくメンバーに置く（run() から戻ると局所変数は失われる。
+ *   待機の後ろで初期化付きの局所変数を宣言するとコンパイルエラーになる）
+ * - 待機のマクロは1行に1つまで（行番号を再開位置に使うため）
+ * - loop() は次の再開時刻まで PowerManager で待機する（FreeRTOS のタスク待機・ライトスリープ）
+ *
+ * C++20 の co_await は ESP32 のツールチェーン（GCC 8）が対応していないため、
+ * switch 文で再開位置へ移動する方式（プロトスレッド）で実装しています。
+ */
+
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * コルーチンの本体の開始・終了（run(uint32_t nowMs) の中で使う）
+ */
+#define CO_BEGIN() switch (line_) { case 0:
+#define CO_END() } line_ = 0; return false
+
+// 途中で終了（CO_END() と同じ）
+#define CO_EXIT() do { line_ = 0; return false; } while (0)
+
+/**
+ * 次の再開まで中断（次の CoroutineScheduler::run() で続きから）
+ */
+#define CO_YIELD() do { line_ = __LINE__; return true; case __LINE__:; } while (0)
+
+/**
+ * 指定時間中断
+ * @param ms 待つ時間（ミリ秒）
+ */
+#define CO_SLEEP(ms) do { wakeMs_ = nowMs + (ms); CO_YIELD(); } while (0)
+
+/**
+ * 条件が成り立つまで一定間隔で確認しながら中断（最初の確認は pollMs 後）
+ * @param cond 再開の条件
+ * @param pollMs 確認の間隔（ミリ秒）
+ */
+#define CO_WAIT_UNTIL(cond, pollMs) do { CO_SLEEP(pollMs); } while (!(cond))
+
+class Coroutine {
+public:
+  Coroutine() : line_(0), wakeMs_(0), running_(false) {}
+  virtual ~Coroutine() {}
+
+  /**
+   * 先頭から開始（実行中の場合は中断して最初からやり直す）
+   * 最初の実行は次の CoroutineScheduler::run() で行います。
+   */
+  void start(uint32_t nowMs) {
+    line_ = 0;
+    wakeMs_ = nowMs;
+    running_ = true;
+  }
+
+  // 中断して終了（続きは実行しない）
+  void cancel() {
+    line_ = 0;
+    running_ = false;
+  }
+
+  // 実行中か（終了・未開始は false）
+  bool isRunning() const { return running_; }
+
+  // 再開時刻（millis）
+  uint32_t getWakeMs() const { return wakeMs_; }
+
+  // 再開時刻を過ぎたか
+  bool isReady(uint32_t nowMs) const {
+    return running_ && static_cast<int32_t>(nowMs - wakeMs_) >= 0;
+  }
+
+  /**
+   * 再開時刻を過ぎていれば次の待機（または終了）まで進める
+   * @return true: 実行中
+   */
+  bool resume(uint32_t nowMs) {
+    if (isReady(nowMs)) {
+      running_ = run(nowMs);
+    }
+    return running_;
+  }
+
+protected:
+  /**
+   * 本体（CO_BEGIN() と CO_END() の間に書く）
+   * @return true: 待機中（続きあり）, false: 終了
+   */
+  virtual bool run(uint32_t nowMs) = 0;
+
+  uint16_t line_;    // 再開する位置（行番号、0: 先頭）
+  uint32_t wakeMs_;  // 再開時刻（millis）
+
+private:
+  bool running_;
+};
+
+/**
+ * コルーチンの実行管理（loop() タスクで使う）
+ */
+class CoroutineScheduler {
+public:
+  static constexpr size_t MAX_COROUTINES = 8;
+
+  CoroutineScheduler();
+
+  /**
+   * コルーチンを登録（setup() で登録し、start() で開始する）
+   * @return false: 上限を超えた
+   */
+  bool add(Coroutine* coroutine);
+
+  /**
+   * 再開時刻を過ぎたコルーチンを進める（loop() ごとに呼び出す）
+   * @return 進めたコルーチンの数
+   */
+  size_t run(uint32_t nowMs);
+
+  /**
+   * 実行中のコルーチンの最も早い再開時刻
+   * @param wakeMs 再開時刻（millis）
+   * @return false: 実行中のコルーチンがない
+   */
+  bool getNextWakeMs(uint32_t nowMs, uint32_t& wakeMs) const;
+
+  // 実行中のコルーチンの数
+  size_t getRunning() const;
+
+  // これまでに進めた回数
+  uint32_t getResumes() const { return resumes_; }
+
+private:
+  Coroutine* coroutines_[MAX_COROUTINES];
+  size_t count_;
+  uint32_t resumes_;
+};
+
+#endif // COROUTINE_H
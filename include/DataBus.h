@@ -0,0 +1,125 @@
+/**
+ * DataBus.h
+ *
+ * サブシステム間の値の受け渡し（型付き・固定トピックの最新値スロット、Arduino非依存）
+ *
+ * 各トピックは最新値を2面のスロットに保持し、公開のたびに裏のスロットへ書いてから表裏を切り替えます。
+ * - 読み手は get() でスロットへの参照を受け取る（コピーしない）。参照先は次の公開までは
+ *   そのまま、次の公開の後も前の値のまま残り、書き換わるのは2回後の公開から
+ * - 公開した値が前回と同じ（operator==）なら版を進めず、購読者にも通知しない
+ * - 購読者は関数ポインタ（公開と同じタスクで同期的に呼ばれる）か、
+ *   TopicReader で版を確認して変わった場合のみ処理する
+ * 書き込み・読み取りは loop() タスクのみで行う前提のため、ロックはありません
+ * （他のタスクに渡す値は StatusServer のように別途コピーしてください）。
+ */
+
+#ifndef DATA_BUS_H
+#define DATA_BUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "SensorData.h"
+#include "WeatherData.h"
+#include "ControlPolicy.h"
+
+template <typename T>
+class Topic {
+public:
+  static constexpr size_t MAX_SUBSCRIBERS = 4;
+
+  /**
+   * 値が変わったときに呼ばれる関数
+   * @param value 新しい値（スロットへの参照）
+   */
+  typedef void (*Handler)(const T& value, void* context);
+
+  Topic() : slots_(), front_(0), version_(0), published_(0), handlers_(), contexts_(), count_(0) {}
+
+  /**
+   * 購読者を追加（setup() で登録する）
+   * @return false: 上限を超えた
+   */
+  bool subscribe(Handler handler, void* context = nullptr) {
+    if (count_ >= MAX_SUBSCRIBERS) {
+      return false;
+    }
+    handlers_[count_] = handler;
+    contexts_[count_] = context;
+    count_++;
+    return true;
+  }
+
+  /**
+   * 値を公開（前回と同じ値なら何もしない）
+   * @return true: 値が変わった（購読者に通知した）
+   */
+  bool publish(const T& value) {
+    published_++;
+    if (version_ != 0 && value == slots_[front_]) {
+      return false;
+    }
+    uint8_t back = front_ ^ 1;
+    slots_[back] = value;
+    front_ = back;
+    version_++;
+    for (size_t i = 0; i < count_; i++) {
+      handlers_[i](slots_[front_], contexts_[i]);
+    }
+    return true;
+  }
+
+  // 最新の値（未公開の場合は T の初期値）
+  const T& get() const { return slots_[front_]; }
+
+  // 値の版（変わるたびに増える、0: 未公開）
+  uint32_t getVersion() const { return version_; }
+
+  // publish() の呼び出し回数（値が変わらなかった回数は getPublished() - getVersion()）
+  uint32_t getPublished() const { return published_; }
+
+private:
+  T slots_[2];
+  uint8_t front_;        // 最新の値のスロット
+  uint32_t version_;
+  uint32_t published_;
+  Handler handlers_[MAX_SUBSCRIBERS];
+  void* contexts_[MAX_SUBSCRIBERS];
+  size_t count_;
+};
+
+/**
+ * トピックの読み手（前回確認した版を覚えておき、変わった場合のみ処理する）
+ */
+template <typename T>
+class TopicReader {
+public:
+  explicit TopicReader(const Topic<T>& topic) : topic_(topic), seen_(0) {}
+
+  /**
+   * 前回の確認から値が変わったか（true を返した時点で既読にする）
+   */
+  bool changed() {
+    uint32_t version = topic_.getVersion();
+    if (version == seen_) {
+      return false;
+    }
+    seen_ = version;
+    return true;
+  }
+
+  // 最新の値（コピーしない）
+  const T& get() const { return topic_.get(); }
+
+private:
+  const Topic<T>& topic_;
+  uint32_t seen_;
+};
+
+// このシステムのトピック（main.cpp の bus）
+struct DataBus {
+  Topic<SensorData> sensor;    // メインの室温・湿度（読み取りごとに公開）
+  Topic<WeatherData> weather;  // 制御・表示に使う天気予報（loop() ごとに公開、取得・受信・破棄で変わる）
+  Topic<ACMode> mode;          // メインのエアコンのモード（送信完了時に公開。設定温度の調整中は近いプリセット）
+};
+
+#endif // DATA_BUS_H
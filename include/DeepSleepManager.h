@@ -0,0 +1,86 @@
+/**
+ * DeepSleepManager.h
+ *
+ * 電池駆動ノード向けのディープスリープ管理クラス
+ *
+ * 一定間隔でタイマー起床し、センサーを1回読んで制御判定した後すぐにディープスリープに戻ります。
+ * 再起動をまたいで必要な状態（現在のエアコンモード・天気予報・起床時間の統計）は
+ * RTC低速メモリに保持するため、通常の起床では WiFi・NVS の天気予報取得は不要です。
+ *
+ * 起床時間は esp_timer（アプリ起動時点から）で計測します。ブートローダーの時間は含みません。
+ */
+
+#ifndef DEEP_SLEEP_MANAGER_H
+#define DEEP_SLEEP_MANAGER_H
+
+#include <Arduino.h>
+#include "ControlPolicy.h"
+#include "WeatherData.h"
+
+// RTC低速メモリに保持する状態（ディープスリープ中も維持、電源断で消失）
+struct DeepSleepState {
+  uint32_t magic;            // 有効な状態かどうかの判定用
+  uint32_t wakeCount;        // 起床回数
+  ACMode mode;               // 最後に送信したエアコンモード
+
+  // 最後に取得した天気予報
+  bool forecastValid;
+  float forecastTempMax;
+  float forecastTempMin;
+  int16_t forecastWeatherCode;
+  uint32_t forecastEpoch;    // 取得時刻（UNIX時刻）
+
+  // 起床時間の統計（µs）
+  uint32_t lastAwakeUs;
+  uint32_t maxAwakeUs;
+  uint64_t totalAwakeUs;
+  uint32_t wifiWakeCount;    // WiFi接続が必要だった起床回数
+};
+
+class DeepSleepManager {
+public:
+  /**
+   * コンストラクタ
+   * @param wakeIntervalSec 起床間隔（秒）
+   * @param forecastMaxAgeSec 天気予報を再取得するまでの時間（秒）
+   */
+  DeepSleepManager(uint32_t wakeIntervalSec, uint32_t forecastMaxAgeSec);
+
+  /**
+   * RTCメモリの状態を確認
+   * @return true: ディープスリープからの復帰（状態が有効）, false: 電源投入・リセット
+   */
+  bool begin();
+
+  // 保持しているエアコンモード（電源投入時は ACMode::NONE）
+  ACMode getMode() const;
+  void setMode(ACMode mode);
+
+  /**
+   * 天気予報の再取得が必要か
+   * @param epoch 現在のUNIX時刻
+   * @param timeValid 時刻が有効か（false の場合は時刻同期のため常に true）
+   */
+  bool needsNetwork(uint32_t epoch, bool timeValid) const;
+
+  // 保持している天気予報（分類は天気コードから復元）
+  WeatherData getForecast() const;
+  void setForecast(const WeatherData& weather, uint32_t epoch);
+
+  // WiFi接続が必要だった起床として記録
+  void markWifiWake();
+
+  /**
+   * 起床時間を記録してディープスリープに入る（戻らない）
+   * 起床間隔が一定になるよう、起床していた時間を差し引いてタイマーを設定します。
+   */
+  [[noreturn]] void sleep();
+
+private:
+  static constexpr uint32_t STATE_MAGIC = 0xD5EE0001;
+
+  uint32_t wakeIntervalSec_;
+  uint32_t forecastMaxAgeSec_;
+};
+
+#endif // DEEP_SLEEP_MANAGER_H
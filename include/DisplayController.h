@@ -28,10 +28,16 @@ public:
   // センサーデータと天気予報とエアコン状態を表示
   void showSensorDataWithWeatherAndAC(const SensorData& data, const char* datetime, const WeatherData& weather, ACMode acMode);
 
+  // センサーデータと天気予報とエアコン状態をフレームバッファに描画（転送なし）
+  void renderSensorDataWithWeatherAndAC(const SensorData& data, const char* datetime, const WeatherData& weather, ACMode acMode);
+
   // エラー画面を表示
   void showError(const char* message);
 
 private:
+  // エラー画面をフレームバッファに描画（転送なし）
+  void renderError(const char* message);
+
   Adafruit_SSD1306 display_;
   uint8_t width_;
   uint8_t height_;
@@ -0,0 +1,119 @@
+/**
+ * EnergyModel.h
+ *
+ * 消費電力量・電気代の推定（Arduino非依存）
+ *
+ * エアコンモードごとの推定消費電力を時間で積算し、時間帯別の料金表で電気代に換算します。
+ * パルス出力付きの電力量計がある場合は計測値を使い、同じモードが続いた区間の
+ * 「計測 / 推定」の比でモードごとの推定値を補正します（計測器を外した後も補正後の値で推定）。
+ *
+ * 日別（直近 DAY_SLOTS 日）・月別（直近 MONTH_SLOTS か月）の集計を固定長のリングに保持します。
+ * 時刻はすべて呼び出し側から渡します（ホストでそのまま動作確認できます）。
+ */
+
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "ControlPolicy.h"
+
+// 料金表の時間帯（startHour から次の時間帯の開始まで）
+struct TariffBand {
+  uint8_t startHour;    // 0-23（先頭は0）
+  float pricePerKWh;    // 円/kWh
+  bool peak;            // true: ピーク時間帯（制御を控えめにする）
+};
+
+// 日別・月別の集計
+struct EnergyTotals {
+  uint32_t key;         // 日別: YYYYMMDD, 月別: YYYYMM（0: 未使用）
+  float kWh;
+  float cost;           // 円
+};
+
+class EnergyModel {
+public:
+  static constexpr size_t MODE_COUNT = 6;            // ACMode の数（NONE を含む）
+  static constexpr size_t MAX_BANDS = 8;             // 料金表の時間帯の上限
+  static constexpr size_t DAY_SLOTS = 31;
+  static constexpr size_t MONTH_SLOTS = 12;
+  static constexpr uint32_t MAX_GAP_SEC = 600;       // これより長い間隔は積算しない（時刻合わせ・停止中）
+  static constexpr uint32_t CALIBRATION_SEC = 900;   // 補正に使う区間の長さ（同じモードが続いた場合）
+  static constexpr float MIN_CALIBRATION_WH = 10.0f;  // 補正に必要な推定値（パルスの分解能に対して十分な量）
+  static constexpr float CALIBRATION_WEIGHT = 0.2f;  // 補正係数の更新の重み
+  static constexpr float MIN_SCALE = 0.3f;           // 補正係数の範囲（計測器の故障・配線違いへの備え）
+  static constexpr float MAX_SCALE = 3.0f;
+
+  /**
+   * コンストラクタ
+   * @param modeWatts ACMode ごとの推定消費電力（W、MODE_COUNT 個、ACMode の順）
+   */
+  explicit EnergyModel(const float* modeWatts);
+
+  /**
+   * 料金表を設定（startHour の昇順、MAX_BANDS まで）
+   * @return false: 件数・並びが不正（料金表なしのまま）
+   */
+  bool setTariff(const TariffBand* bands, size_t count);
+
+  // 指定した時（0-23）の料金・ピークか
+  float getPrice(int hour) const;
+  bool isPeak(int hour) const;
+
+  /**
+   * 前回の呼び出しからの消費電力量を積算（センサー読み取りごとに呼び出す）
+   * @param epoch 現在のUNIX時刻
+   * @param local epoch の現地時刻（料金の時間帯・日付の判定に使用）
+   * @param mode 現在のエアコンモード（次回の呼び出しまでこのモードとして積算）
+   * @param measuredWh 前回からの計測値（Wh、計測器なしは負の値）
+   */
+  void accumulate(uint32_t epoch, const struct tm& local, ACMode mode, float measuredWh);
+
+  // 現在のモードの推定消費電力（W、補正後）
+  float getPowerW() const { return estimateW(mode_); }
+
+  // モードごとの補正係数（1.0: 補正なし）
+  float getScale(ACMode mode) const { return scale_[index(mode)]; }
+
+  // 今日・今月の集計
+  const EnergyTotals& getToday() const { return days_[dayIndex_]; }
+  const EnergyTotals& getMonth() const { return months_[monthIndex_]; }
+
+  /**
+   * 過去の集計
+   * @param ago 0: 今日（今月）, 1: 前日（前月）...
+   * @return false: 記録なし
+   */
+  bool getDay(size_t ago, EnergyTotals& out) const;
+  bool getMonthTotals(size_t ago, EnergyTotals& out) const;
+
+private:
+  static size_t index(ACMode mode) { return static_cast<size_t>(mode); }
+  float estimateW(ACMode mode) const { return modeWatts_[index(mode)] * scale_[index(mode)]; }
+  void add(uint32_t dayKey, float wh, float price);
+  void calibrate(ACMode mode, uint32_t seconds, float measuredWh);
+
+  float modeWatts_[MODE_COUNT];
+  float scale_[MODE_COUNT];
+
+  TariffBand bands_[MAX_BANDS];
+  size_t bandCount_;
+
+  // 前回の呼び出し
+  uint32_t lastEpoch_;      // 0: 未呼び出し
+  ACMode mode_;
+  float lastPrice_;         // 前回の時間帯の料金（区間の料金は区間の開始時で決める）
+
+  // 補正用の区間（同じモードが続いている間の積算）
+  uint32_t calibrationSec_;
+  float calibrationWh_;
+
+  EnergyTotals days_[DAY_SLOTS];
+  EnergyTotals months_[MONTH_SLOTS];
+  size_t dayIndex_;
+  size_t monthIndex_;
+};
+
+#endif // ENERGY_MODEL_H
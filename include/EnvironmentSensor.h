@@ -3,20 +3,7 @@
 
 #include <Arduino.h>
 #include <DHT.h>
-
-// センサーデータ構造体
-struct SensorData {
-  float temperature;
-  float humidity;
-  float discomfortIndex;  // 不快指数（DI）
-  bool isValid;
-
-  SensorData() : temperature(0.0f), humidity(0.0f), discomfortIndex(0.0f), isValid(false) {}
-  SensorData(float temp, float hum, bool valid)
-    : temperature(temp), humidity(hum), discomfortIndex(0.0f), isValid(valid) {}
-  SensorData(float temp, float hum, float di, bool valid)
-    : temperature(temp), humidity(hum), discomfortIndex(di), isValid(valid) {}
-};
+#include "SensorData.h"
 
 // 環境センサークラス
 class EnvironmentSensor {
@@ -32,6 +19,8 @@ public:
   // オフセットを設定
   void setTemperatureOffset(float offset) { temperatureOffset_ = offset; }
   void setHumidityOffset(float offset) { humidityOffset_ = offset; }
+  float getTemperatureOffset() const { return temperatureOffset_; }
+  float getHumidityOffset() const { return humidityOffset_; }
 
   // 不快指数（DI）を計算
   static float calculateDiscomfortIndex(float temperature, float humidity);
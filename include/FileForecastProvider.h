@@ -0,0 +1,30 @@
+/**
+ * FileForecastProvider.h
+ *
+ * LittleFS に置いたファイルからの天気予報の取得（予備の取得元）
+ *
+ * ファイルは Open-Meteo API のレスポンスと同じ形式です（PC などで取得した内容を書き込む、
+ * ネットワークのない環境での固定値など）。API が使えない場合に WeatherForecast が読み込みます。
+ * LittleFS のマウントは HistoryStore::begin() で行います。
+ */
+
+#ifndef FILE_FORECAST_PROVIDER_H
+#define FILE_FORECAST_PROVIDER_H
+
+#include "ForecastProvider.h"
+
+class FileForecastProvider : public ForecastProvider {
+public:
+  static constexpr const char* DEFAULT_PATH = "/forecast.json";
+
+  explicit FileForecastProvider(const char* path = DEFAULT_PATH);
+
+  const char* name() const override { return "file"; }
+
+  bool fetch(ForecastScratch& scratch, ForecastValues& out) override;
+
+private:
+  const char* path_;
+};
+
+#endif // FILE_FORECAST_PROVIDER_H
@@ -0,0 +1,51 @@
+/**
+ * ForecastProvider.h
+ *
+ * 天気予報の取得元のインターフェース（Arduino非依存）
+ *
+ * WeatherForecast は登録された順に取得元を試し、最初に成功した値を使います
+ * （例: Open-Meteo API → LittleFS に置いたファイル）。
+ * 取得元は本文の受信・JSON解析に WeatherForecast の固定領域（ForecastScratch）を借りて使うため、
+ * 取得元を増やしてもバッファは増えません。
+ */
+
+#ifndef FORECAST_PROVIDER_H
+#define FORECAST_PROVIDER_H
+
+#include <stddef.h>
+#include "WeatherParser.h"
+
+// 取得時に借りる作業領域
+struct ForecastScratch {
+  char* body;                         // 本文の読み込み先（nullptr: 固定領域なし、ヒープの String を使う）
+  size_t bodySize;                    // body の大きさ（終端の '\0' を含む）
+  ArduinoJson::Allocator* allocator;  // JsonDocument の確保先（nullptr: ヒープ）
+};
+
+class ForecastProvider {
+public:
+  virtual ~ForecastProvider() {}
+
+  // 取得元の名前（ログ・ステータスAPI用の定数文字列）
+  virtual const char* name() const = 0;
+
+  // 予報地点を変更（地点を使わない取得元は無視）
+  virtual void setLocation(float latitude, float longitude) {}
+
+  /**
+   * 当日分の予報を取得
+   * @param scratch 作業領域（呼び出しごとに JSON の確保先は空に戻してある）
+   * @param out 取得結果（出力、true の場合のみ更新）
+   * @return true: 成功
+   */
+  virtual bool fetch(ForecastScratch& scratch, ForecastValues& out) = 0;
+
+protected:
+  /**
+   * Open-Meteo 形式の本文を解析（失敗時は内容をログ出力）
+   * @return true: 成功（out を更新）
+   */
+  static bool parseBody(const char* json, size_t length, ForecastScratch& scratch, ForecastValues& out);
+};
+
+#endif // FORECAST_PROVIDER_H
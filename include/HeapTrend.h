@@ -0,0 +1,63 @@
+/**
+ * HeapTrend.h
+ *
+ * ヒープの断片化の傾向（Arduino非依存）
+ *
+ * 確保可能な最大ブロックと空き容量を一定間隔で固定長のリングに記録し、
+ * 直近の記録から最大ブロックの減り方（バイト/日）を最小二乗法で求めます。
+ * 空き容量が減っていないのに最大ブロックだけが減り続ける場合は断片化が進んでいます。
+ * 時刻は呼び出し側から渡します（ホストでそのまま動作確認できます）。
+ */
+
+#ifndef HEAP_TREND_H
+#define HEAP_TREND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 1回分の記録
+struct HeapSample {
+  uint32_t uptimeSec;     // 起動からの経過秒
+  uint32_t largestBlock;  // 確保可能な最大ブロック（バイト）
+  uint32_t freeBytes;     // 空き容量（バイト）
+};
+
+class HeapTrend {
+public:
+  static constexpr size_t SLOT_COUNT = 48;  // 傾きの計算に使う記録数
+
+  /**
+   * コンストラクタ
+   * @param intervalSec 記録の間隔（秒）
+   */
+  explicit HeapTrend(uint32_t intervalSec);
+
+  /**
+   * ヒープの状態を渡す（間隔より頻繁に呼び出してよい）
+   * 最小値は毎回更新し、前回の記録から intervalSec 経過していればリングに記録してログ出力します。
+   * @return true: 記録した
+   */
+  bool sample(uint32_t uptimeSec, uint32_t largestBlock, uint32_t freeBytes);
+
+  // 最初の記録（起動直後の基準）・最新の記録
+  const HeapSample& getFirst() const { return first_; }
+  const HeapSample& getLatest() const { return samples_[(next_ + SLOT_COUNT - 1) % SLOT_COUNT]; }
+
+  // 起動後の最大ブロックの最小値
+  uint32_t getMinLargestBlock() const { return minLargest_; }
+
+  // 直近の記録での最大ブロックの傾き（バイト/日、記録が2件未満は0）
+  float getSlopePerDay() const;
+
+  size_t getCount() const { return count_; }
+
+private:
+  uint32_t intervalSec_;
+  HeapSample samples_[SLOT_COUNT];
+  size_t next_;       // 次に書き込む位置
+  size_t count_;      // 記録数（SLOT_COUNT で頭打ち）
+  HeapSample first_;
+  uint32_t minLargest_;
+};
+
+#endif // HEAP_TREND_H
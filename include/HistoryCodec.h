@@ -0,0 +1,122 @@
+/**
+ * HistoryCodec.h
+ *
+ * 履歴データ（センサー値・エアコンモード・天気予報）の圧縮形式
+ * Arduino非依存のため、ホスト側のツールでも同じ形式を読み書きできます。
+ *
+ * ブロック: [ヘッダー 12バイト][レコード...]
+ * レコード: [varint: (zigzag(経過秒 - 基準間隔) << 2) | 種別][種別ごとの値]
+ *   SAMPLE:   zigzag varint（温度の差分, 0.1℃）, zigzag varint（湿度の差分, 0.1%）
+ *   MODE:     1バイト（ACMode）
+ *   FORECAST: zigzag varint（最高気温, 0.1℃）, zigzag varint（最低気温, 0.1℃）, varint（天気コード）
+ *
+ * 差分はブロック内の直前の値に対するもので、各ブロックの先頭は0を基準にします
+ * （ブロック単位で独立して復号できます）。1分間隔の温湿度はおおむね1件3バイトです。
+ *
+ * ブロック内の時刻は昇順です。時刻が戻った場合（NTP での補正・連携ノードからの時刻の設定）は
+ * append() が false を返すため、呼び出し側がブロックを書き出して新しいブロックから記録します。
+ */
+
+#ifndef HISTORY_CODEC_H
+#define HISTORY_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// レコードの種別
+enum class HistoryKind : uint8_t {
+  SAMPLE = 0,    // 温湿度（1分平均）
+  MODE = 1,      // エアコンモードの変更
+  FORECAST = 2   // 天気予報の更新
+};
+
+// 1件分の履歴（復号後）
+struct HistoryEvent {
+  uint32_t time;         // UNIX時刻（秒）
+  HistoryKind kind;
+  int16_t temperature;   // 0.1℃単位（SAMPLE）
+  int16_t humidity;      // 0.1%単位（SAMPLE）
+  uint8_t mode;          // ACMode（MODE）
+  int16_t tempMax;       // 0.1℃単位（FORECAST）
+  int16_t tempMin;       // 0.1℃単位（FORECAST）
+  uint8_t weatherCode;   // 天気コード（FORECAST）
+};
+
+// ブロックヘッダー（ファイル上はリトルエンディアンでこの順に格納）
+struct HistoryBlockHeader {
+  static constexpr uint8_t MAGIC = 0xB7;
+  static constexpr size_t SIZE = 12;
+
+  uint16_t payloadLength;  // レコード部のバイト数
+  uint8_t recordCount;
+  uint32_t startTime;      // 先頭レコードの時刻
+  uint32_t endTime;        // 末尾レコードの時刻（範囲検索でブロックを読み飛ばすために使用）
+
+  void serialize(uint8_t* out) const;
+  bool deserialize(const uint8_t* in);
+};
+
+/**
+ * ブロックの符号化
+ * 固定サイズのバッファに追記し、満杯になったら呼び出し側がフラッシュします。
+ */
+class HistoryEncoder {
+public:
+  static constexpr size_t CAPACITY = 512;           // レコード部の最大バイト数
+  static constexpr uint32_t SAMPLE_INTERVAL_SEC = 60;  // SAMPLE の基準間隔
+  static constexpr size_t MAX_RECORD_SIZE = 16;
+  static constexpr uint32_t MAX_STEP_SEC = 1u << 28;  // ブロック内の1件の経過秒の上限（先頭の varint に収まる範囲）
+
+  HistoryEncoder();
+
+  /**
+   * レコードを追加
+   * @return false: 空き不足、または直前のレコードより前の時刻（フラッシュ後に再度追加してください）
+   */
+  bool append(const HistoryEvent& event);
+
+  // 現在のブロックを消去
+  void reset();
+
+  bool isEmpty() const { return header_.recordCount == 0; }
+  const HistoryBlockHeader& getHeader() const { return header_; }
+  const uint8_t* getPayload() const { return payload_; }
+
+private:
+  void putVarint(uint32_t value);
+  void putSigned(int32_t value);
+
+  HistoryBlockHeader header_;
+  uint8_t payload_[CAPACITY];
+  uint32_t lastTime_;
+  int16_t lastTemperature_;
+  int16_t lastHumidity_;
+};
+
+/**
+ * ブロックの復号
+ */
+class HistoryDecoder {
+public:
+  HistoryDecoder(const HistoryBlockHeader& header, const uint8_t* payload);
+
+  /**
+   * 次のレコードを取得
+   * @return false: 末尾、または破損
+   */
+  bool next(HistoryEvent& event);
+
+private:
+  bool getVarint(uint32_t& value);
+  bool getSigned(int32_t& value);
+
+  const uint8_t* payload_;
+  size_t length_;
+  size_t pos_;
+  uint8_t remaining_;
+  uint32_t lastTime_;
+  int16_t lastTemperature_;
+  int16_t lastHumidity_;
+};
+
+#endif // HISTORY_CODEC_H
@@ -0,0 +1,112 @@
+/**
+ * HistoryStore.h
+ *
+ * 履歴データの保存クラス（LittleFS上の追記専用ログ）
+ *
+ * 温湿度（1分平均）・エアコンモードの変更・天気予報の更新を
+ * HistoryCodec の形式で圧縮し、RAM上のブロックにまとめてからフラッシュに追記します。
+ * 書き込みはブロック単位（既定30分ごと）のため、消去回数とCPU負荷を抑えられます。
+ *
+ * ファイル構成: /history/00000001.bin, 00000002.bin, ...（セグメント）
+ * - セグメントが SEGMENT_SIZE を超えたら次のファイルへ切り替え
+ * - セグメント数が MAX_SEGMENTS を超えたら最も古いファイルを削除
+ * - 各セグメントの開始時刻をRAMに保持し（時刻インデックス）、範囲検索では
+ *   対象セグメントのみを開き、ブロックヘッダーの時刻で範囲外のブロックを読み飛ばします
+ *
+ * 摩耗平準化と電源断への耐性は LittleFS に任せています。
+ */
+
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <Arduino.h>
+#include "HistoryCodec.h"
+#include "ControlPolicy.h"
+
+struct WeatherData;
+
+// 範囲検索の結果を受け取る関数（false を返すと検索を中断）
+typedef bool (*HistoryVisitor)(const HistoryEvent& event, void* context);
+
+class HistoryStore {
+public:
+  static constexpr size_t SEGMENT_SIZE = 32 * 1024;        // 1セグメントの上限（バイト）
+  static constexpr size_t MAX_SEGMENTS = 32;                // 保持するセグメント数（約1MB）
+  static constexpr uint32_t FLUSH_INTERVAL_SEC = 30 * 60;   // ブロックを書き出す間隔
+
+  HistoryStore();
+
+  /**
+   * LittleFS をマウントし、既存のセグメントから時刻インデックスを構築
+   * @return true: 成功, false: マウント失敗（以降の記録は無視されます）
+   */
+  bool begin();
+
+  /**
+   * 温湿度を記録（1分ごとの平均値として保存）
+   * @param epoch UNIX時刻（秒）
+   * @param temperature 温度（℃）
+   * @param humidity 湿度（%）
+   */
+  void addSample(uint32_t epoch, float temperature, float humidity);
+
+  // エアコンモードの変更を記録
+  void recordMode(uint32_t epoch, ACMode mode);
+
+  // 天気予報の更新を記録
+  void recordForecast(uint32_t epoch, const WeatherData& weather);
+
+  // RAM上のブロックをフラッシュに書き出す（再起動・スリープの直前用）
+  void flush();
+
+  /**
+   * 指定期間の履歴を記録順に取得（未書き出しのデータを含む。時刻が戻った場合は戻った後の記録も含む）
+   * @param from 開始時刻（UNIX時刻、含む）
+   * @param to 終了時刻（UNIX時刻、含む）
+   * @param visitor 1件ごとに呼び出す関数
+   * @param context visitor に渡す値
+   * @return 取得した件数
+   */
+  size_t query(uint32_t from, uint32_t to, HistoryVisitor visitor, void* context);
+
+  // 使用中のセグメント数
+  size_t getSegmentCount() const { return segmentCount_; }
+
+  // 最も古い記録の時刻（記録がなければ0）
+  uint32_t getOldestTime() const;
+
+  // フラッシュ上の使用量（バイト）
+  size_t getStoredBytes() const;
+
+private:
+  struct Segment {
+    uint32_t sequence;   // ファイル番号
+    uint32_t startTime;  // 先頭ブロックの開始時刻
+    uint32_t minTime;    // 全ブロックの最も古い時刻（時刻が戻った場合は startTime より前になる）
+    uint32_t maxTime;    // 全ブロックの最も新しい時刻
+    size_t size;         // ファイルサイズ
+  };
+
+  void append(const HistoryEvent& event);
+  void emitSampleAverage();
+  bool writeBlock();
+  bool openNewSegment(uint32_t startTime);
+  static void includeBlock(Segment& segment, const HistoryBlockHeader& header);
+  size_t querySegment(const Segment& segment, uint32_t from, uint32_t to,
+                      HistoryVisitor visitor, void* context, bool& stop);
+  static void segmentPath(uint32_t sequence, char* path, size_t size);
+
+  HistoryEncoder encoder_;
+  Segment segments_[MAX_SEGMENTS];
+  size_t segmentCount_;
+  bool ready_;
+
+  // 1分平均の集計
+  uint32_t sampleMinute_;
+  uint32_t lastSampleTime_;
+  float temperatureSum_;
+  float humiditySum_;
+  uint16_t sampleCount_;
+};
+
+#endif // HISTORY_STORE_H
@@ -0,0 +1,103 @@
+/**
+ * LogFormat.h
+ *
+ * バイナリログレコードの形式と、テキストへの復元処理
+ * ファームウェア（LOG_TEXT_OUTPUT 時）とホスト側デコーダーで共用します（Arduino非依存）。
+ *
+ * レコード: [時刻ms:4][ID:2][引数長:1][引数...]
+ * 引数:     [型:1][値]（'i' int32 / 'u' uint32 / 'f' float / 's' 長さ1バイト+文字列 / 'v' 個数1バイト+uint16配列）
+ * フレーム: [0xA5][0x5A][レコード長:1][レコード][CRC-8]（数値はすべてリトルエンディアン）
+ */
+
+#ifndef LOG_FORMAT_H
+#define LOG_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "LogMessages.h"
+
+// 引数の型タグ
+namespace LogArgType {
+  constexpr uint8_t INT = 'i';
+  constexpr uint8_t UINT = 'u';
+  constexpr uint8_t FLOAT = 'f';
+  constexpr uint8_t STRING = 's';
+  constexpr uint8_t U16_ARRAY = 'v';
+}
+
+// 1件分のログレコード（固定長）
+struct LogRecord {
+  static constexpr size_t PAYLOAD_SIZE = 48;
+
+  uint32_t timestampMs;  // 記録時刻（起動からのミリ秒）
+  uint16_t id;           // LogId
+  uint8_t length;        // payload の使用バイト数
+  uint8_t payload[PAYLOAD_SIZE];
+};
+
+// %v に渡す uint16_t 配列
+struct LogU16Array {
+  const uint16_t* data;
+  uint8_t count;
+};
+
+namespace LogFormat {
+  constexpr uint8_t SYNC_0 = 0xA5;
+  constexpr uint8_t SYNC_1 = 0x5A;
+  constexpr size_t RECORD_HEADER_SIZE = 7;
+  constexpr size_t MAX_FRAME_SIZE = 3 + RECORD_HEADER_SIZE + LogRecord::PAYLOAD_SIZE + 1;
+
+  /**
+   * レコードの本文をテキストに復元（改行・時刻は含まない）
+   * @return 書き込んだ文字数（終端を除く）
+   */
+  size_t formatMessage(const LogRecord& record, char* out, size_t outSize);
+
+  /**
+   * 時刻付きの1行に復元（"  12.345 本文\n"）
+   * @return 書き込んだ文字数（終端を除く）
+   */
+  size_t formatLine(const LogRecord& record, char* out, size_t outSize);
+
+  /**
+   * シリアル送信用のフレームを生成
+   * @param out MAX_FRAME_SIZE バイト以上のバッファ
+   * @return フレームのバイト数
+   */
+  size_t encodeFrame(const LogRecord& record, uint8_t* out);
+
+  uint8_t crc8(const uint8_t* data, size_t length, uint8_t crc = 0);
+}
+
+/**
+ * バイト列からフレームを取り出すパーサー
+ * フレーム以外のバイト（ブートローダーやパニック時の出力など）はテキストとして通知します。
+ */
+class LogFrameParser {
+public:
+  typedef void (*RecordHandler)(const LogRecord& record, void* context);
+  typedef void (*TextHandler)(const uint8_t* data, size_t length, void* context);
+
+  LogFrameParser(RecordHandler onRecord, TextHandler onText, void* context);
+
+  void feed(uint8_t byte);
+
+  // CRC不一致などで破棄したフレーム数
+  uint32_t getErrorCount() const { return errorCount_; }
+
+private:
+  enum class State : uint8_t { IDLE, SYNC, LENGTH, BODY };
+
+  void flushAsText();
+
+  RecordHandler onRecord_;
+  TextHandler onText_;
+  void* context_;
+  State state_;
+  uint8_t buffer_[LogFormat::MAX_FRAME_SIZE];
+  size_t received_;
+  size_t expected_;
+  uint32_t errorCount_;
+};
+
+#endif // LOG_FORMAT_H
@@ -0,0 +1,285 @@
+/**
+ * LogMessages.h
+ *
+ * ログメッセージの定義表（X-macro）
+ *
+ * ファームウェアはメッセージID（表の並び順）と引数だけを記録し、
+ * 書式文字列はホスト側デコーダー（tools/logdecode）が同じ表から復元します。
+ * 表を変更したらファームウェアとデコーダーの両方を再ビルドしてください
+ * （起動時の LOG_STARTED に表のハッシュ値が出力され、不一致はデコーダーが警告します）。
+ *
+ * 書式は printf 互換（%d %u %x %f %s など、幅・精度指定可）に加え、
+ * %v（uint16_t配列を ", " 区切りで出力）が使えます。
+ */
+
+#ifndef LOG_MESSAGES_H
+#define LOG_MESSAGES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ログレベル（プリプロセッサで比較するため数値で定義）
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+// コンパイル時のログレベル（これより詳細なメッセージはコードごと除去されます）
+// 変更例: build_flags = -DLOG_LEVEL=LOG_LEVEL_DEBUG
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// X(ID, レベル, 1秒あたりの出力上限（0は無制限）, 書式)
+#define LOG_MESSAGE_TABLE(X) \
+  /* ログ基盤 */ \
+  X(LOG_STARTED,             INFO,  0, "[Log] ログ開始（メッセージ表 %08x）") \
+  X(LOG_DROPPED,             WARN,  0, "[Log] バッファ溢れのため%u件を破棄") \
+  X(LOG_SUPPRESSED,          WARN,  0, "[Log] %s: 頻度制限により%u件を抑制") \
+  /* システム */ \
+  X(SYS_SEPARATOR,           INFO,  0, "========================================") \
+  X(SYS_TITLE,               INFO,  0, "エアコン自動制御システム起動") \
+  X(SYS_WIFI_OK,             INFO,  0, "[System] WiFi接続完了") \
+  X(SYS_WIFI_FAIL,           WARN,  0, "[System] WiFi接続失敗 - WiFiなしで継続") \
+  X(SYS_DISPLAY_FAIL,        WARN,  0, "[System] ディスプレイ初期化失敗 - 継続") \
+  X(SYS_READY,               INFO,  0, "[System] システム起動完了") \
+  /* WiFi */ \
+  X(WIFI_CONNECT_START,      INFO,  0, "[WiFi] WiFi接続を開始します...") \
+  X(WIFI_SSID,               INFO,  0, "[WiFi] SSID: %s") \
+  X(WIFI_WAITING,            DEBUG, 0, "[WiFi] 接続待機中（%lu ms経過）") \
+  X(WIFI_TIMEOUT,            WARN,  0, "[WiFi] 接続タイムアウト") \
+  X(WIFI_CONNECTED,          INFO,  0, "[WiFi] WiFi接続成功！") \
+  X(WIFI_LOST,               WARN,  1, "[WiFi] WiFi切断を検出、再接続を試みます...") \
+  X(WIFI_IP,                 INFO,  0, "[WiFi] IPアドレス: %u.%u.%u.%u") \
+  X(WIFI_RSSI,               INFO,  0, "[WiFi] 電波強度 (RSSI): %d dBm") \
+  /* 時刻 */ \
+  X(TIME_SYNC_START,         INFO,  0, "[Time] NTP時刻同期を開始...") \
+  X(TIME_SYNC_WAITING,       DEBUG, 0, "[Time] 同期待機中（%d回目）") \
+  X(TIME_SYNC_FAIL,          WARN,  0, "[Time] 時刻同期失敗") \
+  X(TIME_SYNC_OK,            INFO,  0, "[Time] 時刻同期成功") \
+  X(TIME_GET_FAIL,           WARN,  1, "[Time] 時刻取得失敗") \
+  X(TIME_NOW,                INFO,  0, "[Time] 現在時刻: %04d/%02d/%02d %02d:%02d:%02d") \
+  /* センサー */ \
+  X(SENSOR_READY,            INFO,  0, "[Sensor] 環境センサー初期化完了") \
+  X(SENSOR_READ_ERROR,       WARN,  1, "[Sensor] 読み取りエラー") \
+  X(SENSOR_SAMPLING,         INFO,  0, "[Sensor] 読み取り間隔 %u ms（平均 %.0f 回/時, 省略 %u 回）") \
+  X(BUS_STATS,               INFO,  0, "[Bus] センサー 変化 %u 回 / 公開 %u 回, 天気予報 %u 回, モード %u 回") \
+  X(CO_STATS,                INFO,  0, "[Co] コルーチン 実行中 %u 件, 再開 %u 回") \
+  X(SENSOR_READING,          INFO,  1, "[Sensor] 温度: %.1f°C, 湿度: %.1f%%, DI: %.1f") \
+  /* ディスプレイ */ \
+  X(DISPLAY_INIT_FAIL,       ERROR, 0, "[Display] 初期化失敗") \
+  X(DISPLAY_READY,           INFO,  0, "[Display] ディスプレイ初期化完了") \
+  /* 天気予報 */ \
+  X(WEATHER_READY,           INFO,  0, "[Weather] WeatherForecast初期化完了") \
+  X(WEATHER_LOCATION,        INFO,  0, "[Weather] 取得地点: 緯度%.6f, 経度%.6f") \
+  X(WEATHER_INITIAL_FETCH,   INFO,  0, "[Weather] 初回天気予報データ取得開始") \
+  X(WEATHER_SCHEDULED_FETCH, INFO,  0, "[Weather] 定期更新: 天気予報データ取得開始（期限から %u 秒）") \
+  X(WEATHER_RETRY,           WARN,  0, "[Weather] %u 回連続で失敗 - %u 秒後に再試行") \
+  X(WEATHER_REQUEST,         INFO,  0, "[Weather] APIリクエスト送信") \
+  X(WEATHER_RESPONSE_OK,     INFO,  0, "[Weather] APIレスポンス受信成功") \
+  X(WEATHER_JSON_ERROR,      WARN,  0, "[Weather] JSONパースエラー: %s") \
+  X(WEATHER_JSON_INCOMPLETE, WARN,  0, "[Weather] JSONデータが不完全です") \
+  X(WEATHER_UPDATED,         INFO,  0, "[Weather] 天気予報データ更新完了（%s）") \
+  X(WEATHER_TEMP_MAX,        INFO,  0, "  - 最高気温: %.1f °C") \
+  X(WEATHER_TEMP_MIN,        INFO,  0, "  - 最低気温: %.1f °C") \
+  X(WEATHER_CODE,            INFO,  0, "  - 天気コード: %d") \
+  X(WEATHER_STRING,          INFO,  0, "  - 天気: %s") \
+  X(WEATHER_HTTP_ERROR,      WARN,  0, "[Weather] HTTPエラー: %d") \
+  X(WEATHER_FILE_ERROR,      WARN,  0, "[Weather] 予報ファイルを読み込めません: %s") \
+  X(WEATHER_ALL_FAILED,      WARN,  0, "[Weather] すべての取得元で失敗（使用中: %s）") \
+  X(WEATHER_RESTORED,        INFO,  0, "[Weather] 保存した予報を使用: 最高 %.1f °C, 最低 %.1f °C（取得 %u）") \
+  X(WEATHER_STALE,           WARN,  0, "[Weather] 予報が古くなっています（%s, %u 時間前）") \
+  X(WEATHER_EXPIRED,         WARN,  0, "[Weather] 予報が古すぎるため破棄（%u 時間前）") \
+  X(WEATHER_BODY_ERROR,      WARN,  0, "[Weather] レスポンス本文を受信できません（%u バイト超過・切断・タイムアウト）") \
+  /* エアコン制御 */ \
+  X(AC_READY,                INFO,  0, "[AC] エアコンコントローラー初期化完了") \
+  X(AC_MODE_UNCHANGED,       INFO,  0, "[AC] モード変更なし（すでに同じモード）") \
+  X(AC_ALREADY_OFF,          INFO,  0, "[AC] すでに停止状態のため、停止信号を送信しません") \
+  X(AC_COMMAND_DIFF,         DEBUG, 0, "[AC] 指令 %04x → %04x（変更ビット %04x）") \
+  X(AC_INVALID_MODE,         WARN,  0, "[AC] 無効なモード") \
+  X(AC_TIME_FAIL,            WARN,  0, "[AC] 時刻取得失敗、デフォルトモード") \
+  X(AC_INPUT,                INFO,  0, "[AC] 温度:%.1f℃, 湿度:%.1f%%, 月:%d, 時:%d") \
+  X(AC_SEASON,               INFO,  0, "[AC] 季節: %s") \
+  X(AC_NIGHT_OFF,            INFO,  0, "[AC] %s%s → 停止") \
+  X(AC_EXTREME_COLD_NIGHT,   INFO,  0, "[AC] %s%s・極寒日（最低気温0度以下）→ 暖房18度") \
+  X(AC_HEAT_START,           INFO,  0, "[AC] %s%s: 室温%.1f℃ < %.1f℃ → 暖房23.5度") \
+  X(AC_HEAT_HOLD,            INFO,  0, "[AC] %s%s: 暖房中（室温%.1f℃ < %.1f℃）→ 暖房継続") \
+  X(AC_COOL_START,           INFO,  0, "[AC] %s%s: 室温%.1f℃ > %.1f℃ → 冷房25度") \
+  X(AC_COOL_HOLD,            INFO,  0, "[AC] %s%s: 冷房中（室温%.1f℃ > %.1f℃）→ 冷房継続") \
+  X(AC_DEHUMID_START,        INFO,  0, "[AC] %s%s: 湿度%.1f%% > %.1f%% → 除湿-1.5度") \
+  X(AC_DEHUMID_HOLD,         INFO,  0, "[AC] %s%s: 除湿中（室温%.1f℃ > %.1f℃, 湿度%.1f%% > %.1f%%）→ 除湿継続") \
+  X(AC_COMFORT_OFF,          INFO,  0, "[AC] %s%s: 快適範囲内（温度%.1f℃, 湿度%.1f%%）→ 停止") \
+  X(AC_OVERCOOL_OFF,         INFO,  0, "[AC] %s%s: 室温%.1f℃ < %.1f℃ → 過冷房防止のため停止") \
+  X(AC_WARM_WAIT_OFF,        INFO,  0, "[AC] %s%s: 室温%.1f℃ > %.1f℃ → 自然冷却待ち（停止）") \
+  X(AC_SEND_START,           INFO,  0, "[AC] %s 送信開始") \
+  X(AC_SEND_DONE,            INFO,  0, "[AC] %s 送信完了") \
+  X(MOD_START,               INFO,  0, "[Modulate] %s開始（設定 %.1f℃、目標 %.1f℃）") \
+  X(MOD_STEP,                INFO,  0, "[Modulate] 設定温度 %.1f℃ → %.1f℃（室温 %.2f℃、目標 %.1f℃）") \
+  X(MOD_KEEP,                INFO,  0, "[Modulate] 設定 %.1f℃ を維持（室温 %.2f℃、目標 %.1f℃）") \
+  X(MOD_RELEASE,             INFO,  0, "[Modulate] 室温 %.2f℃ が目標 %.1f℃ から離れたため停止") \
+  X(MOD_STARTS,              INFO,  0, "[Modulate] 圧縮機の起動 %u 回（オン・オフ制御では %u 回）、設定変更 %u 回") \
+  /* ゾーン */ \
+  X(ZONE_ADDED,              INFO,  0, "[Zone] #%u %s（センサー: %s, 制御: %s）") \
+  X(ZONE_FULL,               WARN,  0, "[Zone] %s を追加できません（最大 %u ゾーン）") \
+  X(ZONE_SENSOR_INVALID,     WARN,  1, "[Zone] %s: センサー値が無効のため判定を省略") \
+  X(ZONE_REPLACED,           INFO,  0, "[Zone] %s: 未送信の %s を新しいモードで置き換え") \
+  X(ZONE_TRANSMIT,           INFO,  0, "[Zone] %s へ送信") \
+  /* 赤外線受信（デバッグ用ダンプ） */ \
+  X(IR_SEPARATOR,            INFO,  0, "====================================") \
+  X(IR_CODE,                 INFO,  0, "[IR] 受信コード: %s") \
+  X(IR_PROTOCOL,             INFO,  0, "[IR] プロトコル: %d（decode_type_t）") \
+  X(IR_BITS,                 INFO,  0, "[IR] ビット数: %u") \
+  X(IR_RAW_BEGIN,            INFO,  0, "uint16_t rawData[%u] = {") \
+  X(IR_RAW_LINE,             INFO,  0, "  %v,") \
+  X(IR_RAW_LAST_LINE,        INFO,  0, "  %v") \
+  X(IR_RAW_END,              INFO,  0, "};") \
+  /* 設定 */ \
+  X(CONFIG_LOADED,           INFO,  0, "[Config] 保存済みの設定を読み込みました（スキーマ v%u）") \
+  X(CONFIG_DEFAULTS,         INFO,  0, "[Config] 初期値を使用します（スキーマ v%u）") \
+  X(CONFIG_INVALID,          WARN,  0, "[Config] 保存された設定が壊れているか新しすぎるため無視します") \
+  X(CONFIG_UPDATED,          INFO,  0, "[Config] 設定を更新しました（世代 %u）") \
+  X(CONFIG_REJECTED,         WARN,  0, "[Config] 設定が不正です: %s") \
+  X(CONFIG_BAD_FIELD,        WARN,  0, "[Config] %s: %s") \
+  X(CONFIG_SAVE_FAIL,        WARN,  0, "[Config] NVSへの保存に失敗しました") \
+  /* 履歴 */ \
+  X(HISTORY_MOUNT_FAIL,      ERROR, 0, "[History] LittleFSのマウント失敗（履歴は保存されません）") \
+  X(HISTORY_READY,           INFO,  0, "[History] 履歴ストア準備完了（セグメント%u個, %u KB）") \
+  X(HISTORY_WRITE_FAIL,      WARN,  1, "[History] 書き込み失敗: %s") \
+  X(HISTORY_SEGMENT_REMOVED, INFO,  0, "[History] 古いセグメントを削除: %s") \
+  /* 制御の入力トレース */ \
+  X(TRACE_READY,             INFO,  0, "[Trace] 入力トレースの記録を開始（ファイル%u個, %u KB）") \
+  X(TRACE_WRITE_FAIL,        WARN,  1, "[Trace] 書き込み失敗: %s") \
+  X(TRACE_FILE_REMOVED,      INFO,  0, "[Trace] 古いファイルを削除: %s") \
+  /* HTTPステータスサーバー */ \
+  X(HTTP_STARTED,            INFO,  0, "[HTTP] ステータスサーバー起動（ポート%u）") \
+  X(HTTP_SOCKET_FAIL,        ERROR, 0, "[HTTP] %s 失敗 (errno %d)") \
+  X(HTTP_REQUEST,            DEBUG, 1, "[HTTP] %s 応答（%u バイト）") \
+  X(HTTP_SEND_FAIL,          WARN,  1, "[HTTP] 送信失敗 (errno %d)") \
+  X(HTTP_CONFIG_DENIED,      WARN,  1, "[HTTP] POST /config を拒否（%s）") \
+  /* MQTT */ \
+  X(MQTT_CONNECTING,         INFO,  0, "[MQTT] %s:%u に接続中...") \
+  X(MQTT_CONNECTED,          INFO,  0, "[MQTT] 接続完了（%s）") \
+  X(MQTT_CONNECT_FAIL,       WARN,  0, "[MQTT] 接続失敗: %s (%d)") \
+  X(MQTT_DISCONNECTED,       WARN,  0, "[MQTT] 切断: %s") \
+  X(MQTT_QUEUE_DROP,         WARN,  1, "[MQTT] 送信キューが満杯のため破棄（累計%u件）") \
+  X(MQTT_COMMAND_MODE,       INFO,  0, "[MQTT] コマンド受信: モード %s") \
+  X(MQTT_COMMAND_SETPOINT,   INFO,  0, "[MQTT] コマンド受信: 目標室温 %.1f〜%.1f℃") \
+  X(MQTT_BAD_COMMAND,        WARN,  1, "[MQTT] 不正なコマンド（%s）: %s") \
+  /* シリアルコンソール */ \
+  X(CONSOLE_READY,           INFO,  0, "[Console] コマンド入力を受け付けます（help で一覧）") \
+  X(CONSOLE_INPUT,           INFO,  0, "[Console] > %s") \
+  X(CONSOLE_UNKNOWN,         WARN,  0, "[Console] 不明なコマンド: %s（help で一覧）") \
+  X(CONSOLE_USAGE,           WARN,  0, "[Console] 使い方: %s %s") \
+  X(CONSOLE_TOO_LONG,        WARN,  0, "[Console] 入力が長すぎるため破棄（%u 文字まで）") \
+  X(CONSOLE_SLOW,            WARN,  0, "[Console] コマンドの処理に %u µs（目安 %u µs）") \
+  X(CONSOLE_HELP_HEADER,     INFO,  0, "[Console] コマンド一覧:") \
+  X(CONSOLE_HELP,            INFO,  0, "[Console]   %s %s") \
+  X(CONSOLE_MODE,            INFO,  0, "[Console] モードを %s に固定（auto on で自動制御に戻す）") \
+  X(CONSOLE_AUTO,            INFO,  0, "[Console] 自動制御: %s") \
+  X(CONSOLE_HEAP,            INFO,  0, "[Console] ヒープ 空き %u バイト（最小 %u）, 最大ブロック %u バイト") \
+  X(CONSOLE_WEATHER,         INFO,  0, "[Console] 天気予報を取得します（%s）") \
+  X(CONSOLE_OFFSET,          INFO,  0, "[Console] センサー補正: 温度 %+.1f ℃, 湿度 %+.1f %%（保存しない。set で保存）") \
+  X(CONSOLE_SET_FAIL,        WARN,  0, "[Console] 設定を変更できません: %s") \
+  X(CONSOLE_HISTORY,         INFO,  0, "[Console] 直近 %u 時間の履歴: 温湿度 %u 件（%.1f〜%.1f ℃）, モード変更 %u 件, 天気予報 %u 件") \
+  X(CONSOLE_HISTORY_NO_TIME, WARN,  0, "[Console] 時刻の同期前のため履歴を検索できません") \
+  X(CONSOLE_REBOOT,          INFO,  0, "[Console] 履歴・トレースを書き出して再起動します") \
+  /* 複数台の連携 */ \
+  X(MESH_STARTED,            INFO,  0, "[Mesh] %s で連携開始（ノードID %08x）") \
+  X(MESH_INIT_FAIL,          WARN,  0, "[Mesh] %s 失敗 (%d)") \
+  X(MESH_SEND_FAIL,          WARN,  1, "[Mesh] 送信失敗") \
+  X(MESH_BAD_MESSAGE,        DEBUG, 1, "[Mesh] 不正なメッセージを破棄（%u バイト）") \
+  X(MESH_BAD_MAC,            WARN,  1, "[Mesh] 認証できないメッセージを破棄（%u バイト、鍵の違うノード）") \
+  X(MESH_REPLAYED,           WARN,  1, "[Mesh] %08x の古いメッセージを破棄（起動 %u, 番号 %u。再送）") \
+  X(MESH_PEER,               INFO,  0, "[Mesh] ノード %08x を検出") \
+  X(MESH_SECOND_SOURCE,      WARN,  1, "[Mesh] 天気予報の取得担当が複数あります（%08x）") \
+  X(MESH_FORECAST_SENT,      INFO,  0, "[Mesh] 天気予報を送信（最高 %.1f℃, 最低 %.1f℃）") \
+  X(MESH_FORECAST_RECEIVED,  INFO,  0, "[Mesh] %08x から天気予報を受信（最高 %.1f℃, 最低 %.1f℃）") \
+  X(MESH_CLAIM,              INFO,  0, "[Mesh] コンプレッサー起動を %u ms 後に予約") \
+  X(MESH_CLAIM_YIELD,        INFO,  0, "[Mesh] %08x の予約を優先し、予約し直します") \
+  X(MESH_START,              INFO,  0, "[Mesh] コンプレッサー起動") \
+  X(MESH_RELEASE,            INFO,  0, "[Mesh] 起動の予約を取り消し") \
+  X(MESH_FORECAST_STALE,     WARN,  1, "[Mesh] 天気予報を %u 分受信していないため自分で取得します") \
+  X(MESH_TIME_SET,           INFO,  0, "[Mesh] 受信した時刻で時計を設定（ずれ %d 秒）") \
+  X(MESH_TIME_REJECTED,      WARN,  1, "[Mesh] 受信した時刻が %d 秒ずれているため天気予報・時刻を無視") \
+  X(MESH_NO_KEY,             WARN,  0, "[Mesh] secrets.h の MeshSecrets::KEY が未設定のため連携しません") \
+  /* 消費電力量・電気代 */ \
+  X(ENERGY_BAD_TARIFF,       WARN,  0, "[Energy] 料金表が不正です（%u 件、先頭は0時・昇順・最大8件）") \
+  X(ENERGY_METER_READY,      INFO,  0, "[Energy] 電力量計を GPIO%u で計測（%u imp/kWh）") \
+  X(ENERGY_CALIBRATED,       INFO,  0, "[Energy] %s: 計測 %.1f Wh / 推定 %.1f Wh → 補正係数 %.2f") \
+  X(ENERGY_DAY,              INFO,  0, "[Energy] %u: %.2f kWh, %.0f 円") \
+  X(ENERGY_MONTH,            INFO,  0, "[Energy] %u 月計: %.1f kWh, %.0f 円") \
+  X(ENERGY_PEAK_START,       INFO,  0, "[Energy] ピーク時間帯（%.1f 円/kWh）: 目標範囲を上下 %.1f℃ 広げます") \
+  X(ENERGY_PEAK_END,         INFO,  0, "[Energy] ピーク時間帯終了: 目標範囲を戻します") \
+  /* 自動停止 */ \
+  X(AUTOSTOP_NOW,            DEBUG, 0, "[AutoStop] 現在時刻: %02d時, 月: %d月") \
+  X(AUTOSTOP_SEPARATOR,      INFO,  0, "[AutoStop] ========================================") \
+  X(AUTOSTOP_TRIGGER,        INFO,  0, "[AutoStop] %d時になりました。エアコンを自動停止します（%d月は対象期間）") \
+  X(AUTOSTOP_ENABLED,        INFO,  0, "[AutoStop] 自動停止機能: %s") \
+  /* 省電力 */ \
+  X(POWER_LIGHT_SLEEP,       INFO,  0, "[Power] 自動ライトスリープ有効（起床: タイマー, IR起床 GPIO%u, WiFi DTIM）") \
+  X(POWER_NO_IR_WAKE,        WARN,  0, "[Power] IR起床ピンが未設定のため待機のみ行います（HardwareConfig::IR_WAKE_PIN）") \
+  X(POWER_NO_PM,             WARN,  0, "[Power] 電源管理が無効なビルドのため待機のみ行います（ライトスリープは esp32dev_lightsleep 環境でビルド）") \
+  X(POWER_PM_FAIL,           WARN,  0, "[Power] 電源管理の設定に失敗しました（エラー %d）") \
+  X(POWER_IDLE_ONLY,         INFO,  0, "[Power] ライトスリープ無効（待機のみ）") \
+  X(POWER_DUTY,              INFO,  0, "[Power] 稼働率: %.2f%%（待機 %u 回, 平均 %u ms, %s）") \
+  X(DEEPSLEEP_COLD_BOOT,     INFO,  0, "[Sleep] 電源投入: ディープスリープモード（%u 秒ごとに起床）") \
+  X(DEEPSLEEP_WAKE,          INFO,  0, "[Sleep] 起床 #%u（モード: %s, 前回の起床時間 %u ms）") \
+  X(DEEPSLEEP_NETWORK,       INFO,  0, "[Sleep] 天気予報・時刻の更新のため WiFi に接続します") \
+  X(DEEPSLEEP_SKIP_CONTROL,  WARN,  0, "[Sleep] センサーまたは時刻が無効のため制御を省略") \
+  X(DEEPSLEEP_SLEEP,         INFO,  0, "[Sleep] 起床時間 %.1f ms（平均 %.1f, 最大 %.1f, WiFi %u/%u 回）, %u 秒スリープ") \
+  /* loop() 計測 */ \
+  X(PROFILE_HEADER,          INFO,  0, "[Profile] phase       count       min       p50       p99       max   cpu%%  (µs)") \
+  X(PROFILE_ROW,             INFO,  0, "[Profile] %-8s %8u %9.1f %9.1f %9.1f %9.1f %6.1f") \
+  X(PROFILE_OVERHEAD,        INFO,  0, "[Profile] 計測オーバーヘッド: %.3f%%") \
+  X(PROFILE_ALLOC_ROW,       INFO,  0, "[Profile] ヒープ確保 %-8s %8u 回") \
+  X(PROFILE_ALLOC_TOTAL,     INFO,  0, "[Profile] ヒープ確保 全タスク合計 %u 回") \
+  X(MEM_ARENA_READY,         INFO,  0, "[Memory] 固定領域 %u / %u バイトを割り当て") \
+  X(MEM_ARENA_FAIL,          WARN,  0, "[Memory] 固定領域（%u バイト）を確保できません - 使用時にヒープを確保します") \
+  X(HEAP_TREND,              INFO,  0, "[Memory] 最大ブロック %u バイト（空き %u, 最小 %u, 起動時 %u, 傾き %+.0f バイト/日）") \
+  X(ALLOC_SITES_HEADER,      INFO,  0, "[Alloc] 初期化後の確保: 呼び出し元 %u 件（表に入らなかった確保 %u 回）") \
+  X(ALLOC_SITE,              INFO,  0, "[Alloc]   0x%08x < 0x%08x < 0x%08x: %u 回, %u バイト") \
+  /* 起動 */ \
+  X(BOOT_MILESTONE,          INFO,  0, "[Boot] %s: %u ms") \
+  X(BOOT_TASK_FAIL,          WARN,  0, "[Boot] 起動用タスクを作成できません - ネットワークの準備をその場で行います") \
+  X(WORKER_TASK_FAIL,        WARN,  0, "[Worker] %s タスクを作成できません - 処理をその場で行います") \
+  X(BOOT_CACHE_EMPTY,        INFO,  0, "[Boot] 前回の時刻・天気予報なし") \
+  X(BOOT_CACHE_LOADED,       INFO,  0, "[Boot] 前回の時刻 %u（天気予報 %s）") \
+  X(BOOT_CACHE_SAVE_FAIL,    WARN,  0, "[Boot] 時刻・天気予報を保存できません") \
+  X(BOOT_PROVISIONAL,        INFO,  0, "[Boot] 仮の時刻 %d/%d %02d:%02d で制御を判定（時刻の同期後に再判定）") \
+  X(ALLOC_IN_LOOP,           ERROR, 1, "[Alloc] loop() の %s でヒープ確保 %u 回（起動後は確保しない想定）")
+
+// メッセージID（表の並び順）
+enum class LogId : uint16_t {
+#define LOG_ID_ENTRY(id, level, rate, format) id,
+  LOG_MESSAGE_TABLE(LOG_ID_ENTRY)
+#undef LOG_ID_ENTRY
+  COUNT
+};
+
+namespace LogTable {
+  constexpr size_t MESSAGE_COUNT = static_cast<size_t>(LogId::COUNT);
+
+  // レベル（コンパイル時の除去判定に使用）
+  constexpr uint8_t LEVELS[] = {
+#define LOG_LEVEL_ENTRY(id, level, rate, format) LOG_LEVEL_##level,
+    LOG_MESSAGE_TABLE(LOG_LEVEL_ENTRY)
+#undef LOG_LEVEL_ENTRY
+  };
+
+  // 1秒あたりの出力上限
+  constexpr uint8_t RATE_LIMITS[] = {
+#define LOG_RATE_ENTRY(id, level, rate, format) rate,
+    LOG_MESSAGE_TABLE(LOG_RATE_ENTRY)
+#undef LOG_RATE_ENTRY
+  };
+
+  // 書式文字列・ID名（LogFormat.cpp で定義）
+  extern const char* const FORMATS[MESSAGE_COUNT];
+  extern const char* const NAMES[MESSAGE_COUNT];
+
+  // 表全体のハッシュ値（ファームウェアとデコーダーの不一致検出用）
+  uint32_t hash();
+}
+
+#endif // LOG_MESSAGES_H
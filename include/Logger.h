@@ -0,0 +1,168 @@
+/**
+ * Logger.h
+ *
+ * 非同期バイナリログ
+ *
+ * LOG(ID, 引数...) はメッセージIDと引数だけを固定長レコードに詰めて
+ * ロックフリーのリングバッファに積みます（書式化・シリアル送信はしません）。
+ * 優先度の低い送信タスクがバッファを取り出してシリアルに送るため、
+ * UARTのFIFOが詰まっても呼び出し側は待たされません。
+ *
+ * - LOG_LEVEL より詳細なメッセージは呼び出しごとコンパイル時に除去されます。
+ * - メッセージ表の上限（1秒あたり）を超えた分は捨て、後でまとめて件数を出力します。
+ * - バッファが一杯のときは新しいレコードを捨て、破棄件数を出力します。
+ *
+ * 通常はバイナリフレームで送信し、ホスト側の tools/logdecode でテキストに復元します。
+ * -DLOG_TEXT_OUTPUT を指定すると送信タスク内で書式化し、テキストのまま送信します。
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include "LogFormat.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/**
+ * ログ出力マクロ
+ * 例: LOG(SENSOR_READING, temperature, humidity, di);
+ */
+#define LOG(id, ...) \
+  do { \
+    if (LogTable::LEVELS[static_cast<size_t>(LogId::id)] <= LOG_LEVEL) { \
+      Logger::write(LogId::id, ##__VA_ARGS__); \
+    } \
+  } while (0)
+
+// レコードへの引数の書き込み
+class LogEncoder {
+public:
+  explicit LogEncoder(LogRecord& record) : record_(record) { record_.length = 0; }
+
+  void putInt(int32_t value) { putTagged(LogArgType::INT, &value, sizeof(value)); }
+  void putUint(uint32_t value) { putTagged(LogArgType::UINT, &value, sizeof(value)); }
+  void putFloat(float value) { putTagged(LogArgType::FLOAT, &value, sizeof(value)); }
+
+  // 入りきらない分は切り詰める
+  void putString(const char* text) {
+    if (!text) text = "";
+    size_t room = LogRecord::PAYLOAD_SIZE - record_.length;
+    if (room < 2) return;
+    size_t len = strlen(text);
+    if (len > room - 2) len = room - 2;
+    uint8_t* p = record_.payload + record_.length;
+    p[0] = LogArgType::STRING;
+    p[1] = static_cast<uint8_t>(len);
+    memcpy(p + 2, text, len);
+    record_.length += 2 + len;
+  }
+
+  void putArray(const LogU16Array& array) {
+    size_t room = LogRecord::PAYLOAD_SIZE - record_.length;
+    if (room < 2) return;
+    size_t count = array.count;
+    if (count > (room - 2) / 2) count = (room - 2) / 2;
+    uint8_t* p = record_.payload + record_.length;
+    p[0] = LogArgType::U16_ARRAY;
+    p[1] = static_cast<uint8_t>(count);
+    memcpy(p + 2, array.data, count * 2);
+    record_.length += 2 + count * 2;
+  }
+
+private:
+  void putTagged(uint8_t type, const void* value, size_t size) {
+    if (record_.length + 1 + size > LogRecord::PAYLOAD_SIZE) return;
+    uint8_t* p = record_.payload + record_.length;
+    p[0] = type;
+    memcpy(p + 1, value, size);
+    record_.length += 1 + size;
+  }
+
+  LogRecord& record_;
+};
+
+// 引数の型ごとの書き込み
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+encodeLogArg(LogEncoder& encoder, T value) { encoder.putInt(static_cast<int32_t>(value)); }
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+encodeLogArg(LogEncoder& encoder, T value) { encoder.putUint(static_cast<uint32_t>(value)); }
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value>::type
+encodeLogArg(LogEncoder& encoder, T value) { encoder.putFloat(static_cast<float>(value)); }
+
+inline void encodeLogArg(LogEncoder& encoder, const char* text) { encoder.putString(text); }
+inline void encodeLogArg(LogEncoder& encoder, const LogU16Array& array) { encoder.putArray(array); }
+#ifdef ARDUINO
+inline void encodeLogArg(LogEncoder& encoder, const String& text) { encoder.putString(text.c_str()); }
+#endif
+
+inline void encodeLogArgs(LogEncoder&) {}
+
+template <typename T, typename... Rest>
+void encodeLogArgs(LogEncoder& encoder, const T& first, const Rest&... rest) {
+  encodeLogArg(encoder, first);
+  encodeLogArgs(encoder, rest...);
+}
+
+class Logger {
+public:
+  static constexpr size_t RING_SIZE = 128;             // レコード数（2のべき乗）
+  static constexpr uint32_t DRAIN_INTERVAL_MS = 10;    // 送信タスクの周期
+  static constexpr uint32_t RATE_WINDOW_MS = 1000;     // 頻度制限の単位時間
+
+  // 送信タスクを開始（setup() の先頭、Serial.begin() の直後に呼び出す）
+  static void begin();
+
+  /**
+   * レコードを記録（LOG マクロから呼び出す）
+   * @param id メッセージID
+   */
+  template <typename... Args>
+  static void write(LogId id, const Args&... args) {
+    if (!allow(id)) {
+      return;
+    }
+    uint32_t position;
+    LogRecord* record = reserve(position);
+    if (!record) {
+      return;
+    }
+    record->timestampMs = now();
+    record->id = static_cast<uint16_t>(id);
+    LogEncoder encoder(*record);
+    encodeLogArgs(encoder, args...);
+    commit(position);
+  }
+
+  /**
+   * バッファに溜まったレコードを出力
+   * @param maxRecords 1回に出力する最大件数
+   * @return 出力した件数
+   */
+  static size_t drain(size_t maxRecords = RING_SIZE);
+
+  // バッファが空になるまで出力（再起動・スリープの直前用）
+  static void flush();
+
+  // バッファ溢れで破棄した累計件数
+  static uint32_t getDroppedCount();
+
+private:
+  static bool allow(LogId id);
+  static LogRecord* reserve(uint32_t& position);
+  static void commit(uint32_t position);
+  static uint32_t now();
+  static void output(const LogRecord& record);
+};
+
+#endif // LOGGER_H
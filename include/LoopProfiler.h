@@ -0,0 +1,159 @@
+/**
+ * LoopProfiler.h
+ *
+ * loop() の処理時間計測クラス
+ * フェーズ（WiFi確認・IR受信・MQTT・コンソール・連携・天気更新・定期出力・センサー・表示・制御・履歴）ごとに
+ * CPUサイクル数の分布を固定サイズのヒストグラムに記録します。
+ */
+
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// loop() の処理フェーズ
+enum class LoopPhase : uint8_t {
+  WIFI_CHECK,      // WiFi接続確認
+  IR_RECEIVE,      // 赤外線受信
+  MQTT_COMMAND,    // MQTTコマンドの反映
+  CONSOLE,         // シリアルコンソール
+  MESH,            // 複数台の連携
+  WEATHER_UPDATE,  // 天気予報更新
+  REPORT,          // 計測結果の定期出力
+  SENSOR_READ,     // センサー読み取り
+  DISPLAY,         // ディスプレイ更新
+  CONTROL,         // エアコン制御
+  HISTORY,         // 履歴の記録（モードの変更は IR_RECEIVE の直後にも記録）
+  LOOP_TOTAL,      // loop() 1回分の合計
+  COUNT
+};
+
+// 1フェーズ分の統計値（サイクル数）
+struct PhaseStats {
+  uint32_t count;  // 記録回数（減衰後）
+  uint32_t min;
+  uint32_t p50;
+  uint32_t p99;
+  uint32_t max;
+  uint64_t totalCycles;  // 累積サイクル数（CPU占有率の計算用）
+};
+
+/**
+ * 対数スケールのヒストグラム（2のべき乗ごとに4分割、固定124バケット）
+ * 相対誤差は約±12%です。
+ */
+class CycleHistogram {
+public:
+  static constexpr uint8_t BUCKET_COUNT = 124;
+
+  void record(uint32_t cycles, uint32_t weight);  // 分布に記録（間引き分の重み付き）
+  void observe(uint32_t cycles);                  // 最小・最大・合計のみ更新
+  void decay();  // 全カウントを半分にする（古いデータの影響を減らす）
+  void stats(PhaseStats& out) const;
+
+private:
+  uint32_t counts_[BUCKET_COUNT] = {};
+  uint32_t windowMin_ = UINT32_MAX;   // 現在のウィンドウの最小値
+  uint32_t windowMax_ = 0;            // 現在のウィンドウの最大値
+  uint32_t prevMin_ = UINT32_MAX;     // 前のウィンドウの最小値
+  uint32_t prevMax_ = 0;              // 前のウィンドウの最大値
+  uint64_t totalCycles_ = 0;
+
+  static uint8_t bucketOf(uint32_t value);
+  static uint32_t bucketValue(uint8_t index);
+  uint32_t percentile(uint32_t total, float ratio) const;
+};
+
+/**
+ * loop() 計測クラス
+ *
+ * 使い方:
+ *   profiler.beginLoop();
+ *   wifiMgr.checkConnection();
+ *   profiler.mark(LoopPhase::WIFI_CHECK);   // 直前のマークからの区間を記録
+ *   ...
+ *   profiler.endLoop();
+ *
+ * ESP32 のサイクルカウンター（CCOUNT）はタスク待機中も進むため、
+ * サイクル数をCPU周波数で割った値がそのまま経過時間（µs）になります。
+ *
+ * オーバーヘッドを1%未満に抑えるため、短い区間（TAIL_THRESHOLD_US未満）は
+ * フェーズごとに SAMPLE_EVERY 回に1回だけ重み付きでヒストグラムに記録します。
+ * 長い区間（p99・最大値に効くもの）は毎回記録します。最小・最大・合計は常に更新します。
+ *
+ * ヒープ確保の計測（AllocCounter）が有効なビルドでは、確保の回数もフェーズごとに数えます。
+ * setAllocationCheck(true) の後は、どのフェーズでも確保があるとログに出力し、ALLOC_ASSERT を定義した
+ * ビルドでは停止します。SDK の内部で確保する呼び出し（フラッシュ書き込み・ESP-NOW・WiFi再接続）は、
+ * 呼び出し側で AllocExemption で囲んで除きます（フェーズ単位では除外しません）。
+ */
+class LoopProfiler {
+public:
+  /**
+   * コンストラクタ
+   * @param decayIntervalMs ヒストグラムを半減させる間隔（ミリ秒）
+   */
+  explicit LoopProfiler(uint32_t decayIntervalMs = 60000);
+
+  // loop() の先頭で呼び出す
+  void beginLoop();
+
+  /**
+   * 直前のマーク（または beginLoop）からの区間を指定フェーズとして記録
+   * @param phase フェーズ
+   */
+  void mark(LoopPhase phase);
+
+  // loop() の末尾（return の直前を含む）で呼び出す
+  void endLoop();
+
+  // フェーズの統計値を取得
+  void getStats(LoopPhase phase, PhaseStats& out) const;
+
+  /**
+   * loop() 中のヒープ確保の確認を有効にする（起動後の初期化が一巡してから）
+   * @param enabled true: AllocExemption の外での確保を報告
+   */
+  void setAllocationCheck(bool enabled) { allocationCheck_ = enabled; }
+
+  // フェーズのヒープ確保の回数（起動から。LOOP_TOTAL はマーク外の区間の分）
+  uint32_t getAllocations(LoopPhase phase) const { return allocations_[static_cast<size_t>(phase)]; }
+
+  // 計測のオーバーヘッド（loop() 時間に対する割合、%）
+  float getOverheadPercent() const;
+
+  // CPU周波数（MHz、サイクル数→µsの換算用）
+  uint32_t getCpuMHz() const { return cpuMHz_; }
+
+  // フェーズ名を取得
+  static const char* phaseName(LoopPhase phase);
+
+  // 統計の一覧をログ出力
+  void printSummary() const;
+
+private:
+  static constexpr size_t PHASE_COUNT = static_cast<size_t>(LoopPhase::COUNT);
+  static constexpr uint32_t SAMPLE_EVERY = 16;         // 短い区間の記録間隔（回数）
+  static constexpr uint32_t TAIL_THRESHOLD_US = 500;   // これ以上の区間は毎回記録
+
+  void record(LoopPhase phase, uint32_t cycles);
+  void countAllocations(LoopPhase phase);
+
+  CycleHistogram histograms_[PHASE_COUNT];
+  uint32_t loopStart_;          // loop() 開始時のサイクル数
+  uint32_t lastMark_;           // 直前のマークのサイクル数
+  uint64_t cycleAccumulator_;   // 減衰判定用の経過サイクル数
+  uint64_t decayIntervalCycles_;
+  uint64_t overheadCycles_;     // 計測処理に要したサイクル数（サンプリングしたloopのみ）
+  uint64_t sampledLoopCycles_;  // サンプリングしたloopのサイクル数の合計
+  uint32_t tailThresholdCycles_;
+  uint32_t loopCounter_;
+  uint32_t phaseCounters_[PHASE_COUNT];  // 間引き判定用のフェーズごとの回数
+  uint32_t allocations_[PHASE_COUNT];    // フェーズごとのヒープ確保の回数
+  uint32_t cpuMHz_;
+  bool allocationCheck_;        // AllocExemption の外での確保を報告するか
+  bool sampled_;                // 今回のloopでオーバーヘッドを計測するか
+  bool inLoop_;
+};
+
+#endif // LOOP_PROFILER_H
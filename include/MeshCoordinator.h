@@ -0,0 +1,140 @@
+/**
+ * MeshCoordinator.h
+ *
+ * 複数台の連携（天気予報・時刻の共有、コンプレッサー起動の分散）（Arduino非依存）
+ *
+ * 天気予報・時刻:
+ *   取得担当ノード（forecastSource）だけが Open-Meteo・NTP にアクセスし、結果を FORECAST で
+ *   全ノードへ送信します（更新時と FORECAST_INTERVAL_MS ごと）。他のノードは受信した値を使います。
+ *   メッセージはすべて共有鍵の MAC で認証し、鍵の違うノードからのものは破棄します。
+ *   送信元の起動回数・送信番号がそのノードの前回のメッセージより古い・同じものは、再送として破棄します
+ *   （記録するのは MAX_PEERS 台まで。受信側の再起動直後は、各ノードの最初の1件は確認できません）。
+ *
+ * コンプレッサー起動の分散:
+ *   停止状態から運転を始める前に requestStart() を呼び、true になるまで送信を待ちます。
+ *   1. 直近・予定の起動（自分・他ノード）と STAGGER_WINDOW_MS 以上離れた時刻を選び、CLAIM で予約
+ *   2. CLAIM_WAIT_MS の間に同じ時間帯を予約したノードがあれば、ノードIDの小さい方を優先し、
+ *      大きい方は予約し直す
+ *   3. 予約時刻になったら START を送って起動（不要になった場合は cancelStart() で RELEASE を送信）
+ *   メッセージが失われた場合は同時に起動することがありますが、制御が止まることはありません。
+ *
+ * 時刻はすべて呼び出し側の millis() を渡します（ホストでそのまま動作確認できます）。
+ */
+
+#ifndef MESH_COORDINATOR_H
+#define MESH_COORDINATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "MeshProtocol.h"
+#include "MeshTransport.h"
+
+class MeshCoordinator {
+public:
+  static constexpr uint32_t STAGGER_WINDOW_MS = 30000;     // この時間内の起動数を制限
+  static constexpr uint8_t MAX_STARTS_PER_WINDOW = 1;      // 上記時間内に起動できる台数
+  static constexpr uint32_t CLAIM_WAIT_MS = 500;           // 予約後に競合を待つ時間
+  static constexpr uint32_t FORECAST_INTERVAL_MS = 60000;  // 天気予報の再送間隔（後から起動したノード用）
+  static constexpr size_t MAX_RECORDS = 16;                // 記録する起動・予約の数
+
+  /**
+   * コンストラクタ
+   * @param transport 送受信に使う通信（begin() 済みであること）
+   * @param forecastSource true: 天気予報・時刻の取得担当
+   * @param key メッセージ認証の共有鍵（MeshProtocol::KEY_SIZE バイト、全ノードで同じ値）
+   */
+  MeshCoordinator(MeshTransport& transport, bool forecastSource, const uint8_t* key);
+
+  // 受信メッセージの処理と天気予報の再送（loop() から毎回呼び出す）
+  void service(uint32_t nowMs);
+
+  bool isForecastSource() const { return forecastSource_; }
+
+  /**
+   * 天気予報・時刻を送信（取得担当ノードのみ）
+   * @param forecast epoch は現在のUNIX時刻
+   */
+  void publishForecast(const MeshForecast& forecast, uint32_t nowMs);
+
+  /**
+   * 最新の天気予報・時刻を取得（epoch は受信後の経過時間を加えた現在時刻）
+   * @param ageMs 受信（送信）からの経過時間
+   * @return false: まだ受信していない
+   */
+  bool getForecast(MeshForecast& out, uint32_t& ageMs, uint32_t nowMs) const;
+
+  // 天気予報を受信するたびに増える番号
+  uint32_t getForecastGeneration() const { return forecastGeneration_; }
+
+  /**
+   * コンプレッサーの起動を要求
+   * @return true: 今起動してよい, false: 待機中（後でもう一度呼び出す）
+   */
+  bool requestStart(uint32_t nowMs);
+
+  // 起動が不要になった場合に予約を取り消す（予約中でなければ何もしない）
+  void cancelStart();
+
+  // 起動の予約中か
+  bool isClaiming() const { return state_ == ClaimState::CLAIMING; }
+
+  // 予約中の起動を判定する時刻（millis()。この時刻以降に requestStart() を呼ぶ）
+  uint32_t getClaimDecideTime() const { return decideAtMs_; }
+
+  // 最近メッセージを受信したノード数（自分を除く）
+  size_t getPeerCount(uint32_t nowMs) const;
+
+  // 再送として破棄したメッセージの数
+  uint32_t getReplayedCount() const { return replayed_; }
+
+private:
+  enum class ClaimState : uint8_t { IDLE, CLAIMING };
+
+  struct StartRecord {
+    uint32_t nodeId;
+    uint32_t atMs;     // 起動（予定）時刻（自分の millis() 基準）
+    bool planned;      // true: 予約, false: 起動済み
+    bool used;
+  };
+
+  struct Peer {
+    uint32_t nodeId;
+    uint32_t lastSeenMs;
+    uint32_t boot;       // 最後に受け付けたメッセージの起動回数
+    uint32_t sequence;   // 同じく送信番号
+  };
+
+  void handleMessage(const MeshMessage& message, uint32_t nowMs);
+  void record(uint32_t nodeId, uint32_t atMs, bool planned);
+  void removePlanned(uint32_t nodeId);
+  void prune(uint32_t nowMs);
+  uint32_t findSlot(uint32_t nowMs) const;
+  bool acceptPeer(const MeshOrigin& origin, uint32_t nowMs);
+  MeshOrigin nextOrigin();
+  void send(const uint8_t* data, size_t length);
+
+  MeshTransport& transport_;
+  bool forecastSource_;
+  const uint8_t* key_;
+  uint32_t sequence_;           // 最後に送信したメッセージの送信番号
+  uint32_t replayed_;
+
+  // 天気予報
+  MeshForecast forecast_;
+  bool hasForecast_;
+  uint32_t forecastAtMs_;       // 受信（送信）した時刻
+  uint32_t lastPublishMs_;
+  uint32_t forecastGeneration_;
+
+  // 起動の予約
+  ClaimState state_;
+  uint32_t claimSlotMs_;
+  uint32_t decideAtMs_;
+  StartRecord records_[MAX_RECORDS];
+
+  static constexpr size_t MAX_PEERS = 8;
+  static constexpr uint32_t PEER_TIMEOUT_MS = 3 * FORECAST_INTERVAL_MS;
+  Peer peers_[MAX_PEERS];
+};
+
+#endif // MESH_COORDINATOR_H
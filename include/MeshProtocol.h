@@ -0,0 +1,95 @@
+/**
+ * MeshProtocol.h
+ *
+ * 複数台の連携用メッセージ（ESP-NOW / UDP）の符号化・復号（Arduino非依存）
+ *
+ * 形式（リトルエンディアン）:
+ *   ヘッダー 16バイト: [マジック:1][バージョン:1][種別:1][予約:1][送信元ノードID:4][起動回数:4][送信番号:4]
+ *   FORECAST 10バイト: [UNIX時刻:4][最高気温×10:2][最低気温×10:2][天気コード:1][有効:1]
+ *   CLAIM     4バイト: [開始までの時間ms:4]（受信側は受信時刻からの相対時間として扱う）
+ *   START     0バイト
+ *   RELEASE   0バイト
+ *   末尾 8バイト: [MAC:8]（ヘッダーと本文の SipHash-2-4、全ノード共通の鍵）
+ *
+ * ノード間で millis() は共有できないため、時刻は相対時間（CLAIM）か UNIX 時刻（FORECAST）で表します。
+ * ESP-NOW のブロードキャストは暗号化できず誰でも送信できるため、鍵を持たないノードのメッセージは
+ * MAC で拒否します。MAC だけでは正しいメッセージの再送を見分けられないため、ヘッダー（MAC の対象）に
+ * 送信元の起動回数（起動ごとに増やして保存）と起動後の送信番号を入れ、受信側はノードごとに前回より
+ * 新しいものだけを受け付けます（全種別）。
+ */
+
+#ifndef MESH_PROTOCOL_H
+#define MESH_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// メッセージ種別
+enum class MeshMessageType : uint8_t {
+  FORECAST = 1,   // 天気予報・時刻（取得担当ノードが送信）
+  CLAIM = 2,      // コンプレッサー起動の予約
+  START = 3,      // 起動した
+  RELEASE = 4     // 予約の取り消し
+};
+
+// 天気予報・時刻のスナップショット
+struct MeshForecast {
+  uint32_t epoch;        // 送信時のUNIX時刻
+  float tempMax;         // ℃（0.1℃単位で送信）
+  float tempMin;
+  uint8_t weatherCode;
+  bool valid;
+};
+
+// 送信元（ヘッダー）
+struct MeshOrigin {
+  uint32_t nodeId;
+  uint32_t boot;       // 送信元の起動回数（起動ごとに増える）
+  uint32_t sequence;   // 起動後の送信番号（送信ごとに増える）
+};
+
+// 受信したメッセージ
+struct MeshMessage {
+  MeshMessageType type;
+  MeshOrigin origin;
+  MeshForecast forecast;   // FORECAST のみ
+  uint32_t delayMs;        // CLAIM のみ
+};
+
+namespace MeshProtocol {
+  constexpr uint8_t MAGIC = 0xAC;
+  constexpr uint8_t VERSION = 3;  // 2: MAC を追加, 3: 起動回数・送信番号を追加
+  constexpr size_t HEADER_SIZE = 16;
+  constexpr size_t MAC_SIZE = 8;
+  constexpr size_t KEY_SIZE = 16;
+  constexpr size_t MAX_MESSAGE_SIZE = HEADER_SIZE + 10 + MAC_SIZE;  // ESP-NOW の上限（250バイト）より十分小さい
+
+  // 鍵が設定されているか（すべて0は未設定）
+  bool isKeySet(const uint8_t* key);
+
+  /**
+   * 各メッセージの符号化（末尾に MAC を付ける）
+   * @param key 共有鍵（KEY_SIZE バイト）
+   * @param origin 送信元（送信番号はメッセージごとに増やす）
+   * @param out 書き込み先（MAX_MESSAGE_SIZE バイト以上）
+   * @return 書き込んだバイト数
+   */
+  size_t encodeForecast(const uint8_t* key, const MeshOrigin& origin, const MeshForecast& forecast, uint8_t* out);
+  size_t encodeClaim(const uint8_t* key, const MeshOrigin& origin, uint32_t delayMs, uint8_t* out);
+  size_t encodeStart(const uint8_t* key, const MeshOrigin& origin, uint8_t* out);
+  size_t encodeRelease(const uint8_t* key, const MeshOrigin& origin, uint8_t* out);
+
+  /**
+   * 受信データの MAC を確認
+   * @return false: 短すぎる、または MAC が一致しない（鍵の違うノード・改ざん）
+   */
+  bool verify(const uint8_t* key, const uint8_t* data, size_t length);
+
+  /**
+   * verify() 済みの受信データを復号
+   * @return false: マジック・バージョン・長さ・種別が不正
+   */
+  bool decode(const uint8_t* data, size_t length, MeshMessage& out);
+}
+
+#endif // MESH_PROTOCOL_H
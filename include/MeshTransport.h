@@ -0,0 +1,88 @@
+/**
+ * MeshTransport.h
+ *
+ * 複数台の連携用のブロードキャスト通信
+ *
+ * ESP32 では ESP-NOW（アクセスポイント不要、WiFi と同じチャンネル）でブロードキャストします。
+ * ホストでは同じインターフェースを UDP ブロードキャストで実装し、1台の PC 上で
+ * 複数ノードを動かして連携を確認できます（自分が送信したメッセージも受信します）。
+ *
+ * 受信はコールバック（ESP32 では WiFi タスク）で固定長のキューに積み、receive() で取り出します。
+ */
+
+#ifndef MESH_TRANSPORT_H
+#define MESH_TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "MeshProtocol.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#endif
+
+class MeshTransport {
+public:
+  static constexpr size_t QUEUE_SIZE = 8;
+  static constexpr uint16_t DEFAULT_UDP_PORT = 47800;  // ホストのみ
+
+  /**
+   * コンストラクタ
+   * @param udpPort ホストで使う UDP ポート（ESP32 では無視）
+   */
+  explicit MeshTransport(uint16_t udpPort = DEFAULT_UDP_PORT);
+  ~MeshTransport();
+
+  /**
+   * 通信を開始（ESP32 では WiFi の STA 起動後に呼び出す）
+   * @return true: 成功
+   */
+  bool begin();
+
+  // このノードのID（ESP32 は MAC アドレスの下位4バイト）
+  uint32_t getNodeId() const { return nodeId_; }
+  void setNodeId(uint32_t nodeId) { nodeId_ = nodeId; }
+
+  // このノードの起動回数（begin() ごとに増える。ESP32 は NVS に保存、ホストは起動時の UNIX 時刻）
+  uint32_t getBootCount() const { return bootCount_; }
+
+  // 全ノードへ送信
+  bool broadcast(const uint8_t* data, size_t length);
+
+  /**
+   * 受信したメッセージを1件取り出す
+   * @param out 書き込み先（MeshProtocol::MAX_MESSAGE_SIZE バイト以上）
+   * @return メッセージの長さ（なければ0）
+   */
+  size_t receive(uint8_t* out);
+
+  // キュー満杯で破棄した件数
+  uint32_t getDroppedCount() const { return dropped_; }
+
+private:
+  struct Slot {
+    uint8_t length;
+    uint8_t data[MeshProtocol::MAX_MESSAGE_SIZE];
+  };
+
+  void enqueue(const uint8_t* data, size_t length);
+
+  uint16_t udpPort_;
+  uint32_t nodeId_;
+  uint32_t bootCount_;
+  Slot queue_[QUEUE_SIZE];
+  volatile uint8_t head_;
+  volatile uint8_t count_;
+  volatile uint32_t dropped_;
+
+#ifdef ARDUINO
+  portMUX_TYPE lock_;
+  static MeshTransport* instance_;  // ESP-NOW の受信コールバックは引数を持たないため
+  static void onReceive(const uint8_t* mac, const uint8_t* data, int length);
+#else
+  int socket_;
+  void pollSocket();
+#endif
+};
+
+#endif // MESH_TRANSPORT_H
@@ -0,0 +1,197 @@
+/**
+ * MqttClient.h
+ *
+ * MQTT によるテレメトリ送信・コマンド受信クラス
+ *
+ * 送信（<baseTopic>/...）:
+ *   sensor  温湿度（QoS 0、未送信の値は最新値で上書き）
+ *   mode    エアコンモードの変更（QoS 1、retain）
+ *   health  稼働状況（QoS 0、未送信の値は最新値で上書き）
+ *   status  "online" / "offline"（retain、切断時はブローカーが Last Will で "offline" を送信）
+ *
+ * 受信（<baseTopic>/cmd/...）:
+ *   mode      モード名（"off", "cooling_25" など、StatusFormat::modeName と同じ）
+ *   setpoint  目標室温の下限・上限（"24.2,26.5"）
+ *
+ * loop() 側は publish〜() でキューに積み、pollCommand() で受信したコマンドを取り出すだけで、
+ * ソケットの送受信はすべて専用タスク（ホストでは service() の呼び出し側）が行います。
+ * 送信キューは固定長で、一定間隔（BATCH_INTERVAL_MS）ごとに複数メッセージを
+ * まとめて1回の send で送ります。オフライン中もキューに保持し、満杯時は
+ * QoS 0 のメッセージから破棄します。QoS 1 は PUBACK を受け取るまで保持し、再接続時に再送します。
+ */
+
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ControlPolicy.h"
+#include "MqttCodec.h"
+#include "SensorData.h"
+#include "StatusSnapshot.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#else
+#include <mutex>
+#endif
+
+// 送信するトピック（<baseTopic>/ の後ろ）
+enum class MqttTopic : uint8_t {
+  SENSOR,
+  MODE,
+  HEALTH,
+  STATUS
+};
+
+// 受信したコマンドの種別
+enum class MqttCommandType : uint8_t {
+  MODE,      // モードを直接指定
+  SETPOINT   // 目標室温の範囲を変更
+};
+
+// 受信したコマンド
+struct MqttCommand {
+  MqttCommandType type;
+  ACMode mode;        // MODE
+  float tempLower;    // SETPOINT
+  float tempUpper;    // SETPOINT
+};
+
+class MqttClient {
+public:
+  static constexpr size_t QUEUE_SIZE = 16;                 // 送信キューの件数
+  static constexpr size_t MAX_PAYLOAD = 128;               // 1メッセージのペイロード上限
+  static constexpr size_t COMMAND_QUEUE_SIZE = 4;          // 受信コマンドの保持件数
+  static constexpr size_t TX_BUFFER_SIZE = 1024;           // まとめて送信するバッファ
+  static constexpr uint32_t BATCH_INTERVAL_MS = 10000;     // まとめて送信する間隔
+  static constexpr uint16_t KEEP_ALIVE_SEC = 60;
+  static constexpr uint32_t SOCKET_TIMEOUT_MS = 5000;      // 接続・送信・CONNACK待ちのタイムアウト
+  static constexpr uint32_t RECONNECT_MIN_MS = 2000;       // 再接続間隔（失敗ごとに倍増）
+  static constexpr uint32_t RECONNECT_MAX_MS = 60000;
+
+  /**
+   * コンストラクタ
+   * @param host ブローカーのホスト名またはIPアドレス
+   * @param port ブローカーのポート
+   * @param clientId クライアントID
+   * @param baseTopic トピックの接頭辞（例: "aircon/living"）
+   * @param username ユーザー名（nullptr: 認証なし）
+   * @param password パスワード
+   */
+  MqttClient(const char* host, uint16_t port, const char* clientId, const char* baseTopic,
+             const char* username = nullptr, const char* password = nullptr);
+  ~MqttClient();
+
+  // 通信タスクを開始（ESP32のみ。ホストでは service() を呼び出し側が回す）
+  void begin();
+
+  // 温湿度を送信キューに追加
+  void publishSample(const SensorData& data);
+
+  // エアコンモードの変更を送信キューに追加（次の service() ですぐに送信）
+  void publishMode(ACMode mode);
+
+  // 稼働状況を送信キューに追加
+  void publishHealth(const StatusSnapshot& status);
+
+  /**
+   * 受信したコマンドを1件取り出す（loop() から呼び出す）
+   * @return false: コマンドなし
+   */
+  bool pollCommand(MqttCommand& out);
+
+  /**
+   * 通信処理（接続・受信・まとめて送信・キープアライブ）
+   * @param timeoutMs 受信を待つ最大時間（ミリ秒）
+   */
+  void service(uint32_t timeoutMs);
+
+  bool isConnected() const { return connected_; }
+
+  // 送信キューの件数
+  size_t getQueuedCount();
+
+  // キュー溢れで破棄したメッセージ数
+  uint32_t getDroppedCount() const { return droppedCount_; }
+
+private:
+  struct Message {
+    MqttTopic topic;
+    uint8_t qos;
+    bool retain;
+    bool coalesce;   // 未送信の同じトピックを上書きする
+    bool sent;       // 送信済み（QoS 1 は PUBACK 待ち）
+    bool dup;        // 再送
+    uint16_t packetId;
+    uint8_t length;
+    char payload[MAX_PAYLOAD];
+  };
+
+  static constexpr size_t TOPIC_SIZE = 64;  // トピック名のバッファ
+  // PUBLISH 1件の最大サイズ（固定ヘッダー・残りの長さ・トピック長・トピック・パケットID・ペイロード）
+  static constexpr size_t MAX_PUBLISH_SIZE = 1 + 4 + 2 + TOPIC_SIZE + 2 + MAX_PAYLOAD;
+
+  void enqueue(MqttTopic topic, uint8_t qos, bool retain, bool coalesce, const char* payload, int length);
+  Message& at(size_t index) { return queue_[(head_ + index) % QUEUE_SIZE]; }
+  void removeAt(size_t index);
+
+  bool connect();
+  void disconnect(const char* reason);
+  bool waitForConnack();
+  bool flushQueue();
+  bool takeUnsent(Message& out);
+  bool sendRaw(const uint8_t* data, size_t length);
+  void handlePacket(const MqttPacket& packet);
+  void handleCommand(const MqttPublish& publish);
+  void pushCommand(const MqttCommand& command);
+  void topicName(const char* suffix, char* out, size_t size) const;
+  static const char* topicSuffix(MqttTopic topic);
+  static void onPacket(const MqttPacket& packet, void* context);
+
+  void lock();
+  void unlock();
+
+  const char* host_;
+  uint16_t port_;
+  const char* clientId_;
+  const char* baseTopic_;
+  const char* username_;
+  const char* password_;
+
+  // 送信キュー（リングバッファ、loop() と通信タスクで共有）
+  Message queue_[QUEUE_SIZE];
+  size_t head_;
+  size_t count_;
+  volatile bool flushRequested_;
+  volatile uint32_t droppedCount_;
+
+  // 受信コマンド（通信タスク → loop()）
+  MqttCommand commands_[COMMAND_QUEUE_SIZE];
+  size_t commandHead_;
+  size_t commandCount_;
+
+  // 通信タスクのみが使用
+  MqttPacketParser parser_;
+  uint8_t txBuffer_[TX_BUFFER_SIZE];
+  int socket_;
+  volatile bool connected_;
+  bool connackReceived_;
+  uint8_t connackCode_;
+  bool pingPending_;
+  uint16_t nextPacketId_;
+  uint32_t lastFlush_;
+  uint32_t lastSend_;
+  uint32_t pingSentAt_;
+  uint32_t lastAttempt_;
+  uint32_t reconnectDelay_;
+
+#ifdef ARDUINO
+  portMUX_TYPE lock_;
+  static void clientTask(void* param);
+#else
+  std::mutex lock_;
+#endif
+};
+
+#endif // MQTT_CLIENT_H
@@ -0,0 +1,123 @@
+/**
+ * MqttCodec.h
+ *
+ * MQTT 3.1.1 パケットの符号化・復号（Arduino非依存）
+ *
+ * このシステムで使うパケット（CONNECT / PUBLISH / PUBACK / SUBSCRIBE / PINGREQ / DISCONNECT の送信、
+ * CONNACK / PUBLISH / PUBACK / SUBACK / PINGRESP の受信）だけを扱います。
+ * 符号化は呼び出し側のバッファに直接書き込み、動的確保は行いません。
+ */
+
+#ifndef MQTT_CODEC_H
+#define MQTT_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// パケット種別（固定ヘッダーの上位4ビット）
+enum class MqttPacketType : uint8_t {
+  CONNECT = 1,
+  CONNACK = 2,
+  PUBLISH = 3,
+  PUBACK = 4,
+  SUBSCRIBE = 8,
+  SUBACK = 9,
+  PINGREQ = 12,
+  PINGRESP = 13,
+  DISCONNECT = 14
+};
+
+// CONNECT の設定
+struct MqttConnectOptions {
+  const char* clientId;
+  uint16_t keepAliveSec;
+  const char* willTopic;    // 切断時にブローカーが送るメッセージ（nullptr: なし）
+  const char* willMessage;
+  bool willRetain;
+  const char* username;     // nullptr または空文字: なし
+  const char* password;
+};
+
+// 受信したパケット（body は受信バッファを指す）
+struct MqttPacket {
+  MqttPacketType type;
+  uint8_t flags;        // 固定ヘッダーの下位4ビット
+  const uint8_t* body;  // 可変ヘッダー＋ペイロード
+  size_t length;
+};
+
+// 受信した PUBLISH の内容（文字列は終端なし）
+struct MqttPublish {
+  const char* topic;
+  size_t topicLength;
+  const uint8_t* payload;
+  size_t payloadLength;
+  uint8_t qos;
+  bool retain;
+  uint16_t packetId;    // QoS 1 のみ
+};
+
+namespace MqttCodec {
+  constexpr uint8_t CONNACK_ACCEPTED = 0;
+
+  /**
+   * 各パケットの符号化
+   * @param out 書き込み先
+   * @param size バッファサイズ
+   * @return 書き込んだバイト数（収まらない場合は0）
+   */
+  size_t encodeConnect(const MqttConnectOptions& options, uint8_t* out, size_t size);
+  size_t encodePublish(const char* topic, const uint8_t* payload, size_t payloadLength,
+                       uint8_t qos, bool retain, bool dup, uint16_t packetId,
+                       uint8_t* out, size_t size);
+  size_t encodeSubscribe(uint16_t packetId, const char* topicFilter, uint8_t qos, uint8_t* out, size_t size);
+  size_t encodePuback(uint16_t packetId, uint8_t* out, size_t size);
+  size_t encodePingreq(uint8_t* out, size_t size);
+  size_t encodeDisconnect(uint8_t* out, size_t size);
+
+  // CONNACK の戻りコードを取得（不正なパケットは false）
+  bool parseConnack(const MqttPacket& packet, uint8_t& returnCode);
+
+  // PUBACK・SUBACK のパケットIDを取得
+  bool parsePacketId(const MqttPacket& packet, uint16_t& packetId);
+
+  // PUBLISH を解析
+  bool parsePublish(const MqttPacket& packet, MqttPublish& out);
+}
+
+/**
+ * 受信バイト列からパケットを取り出すパーサー
+ * MAX_PACKET_SIZE を超えるパケットは読み捨てます（コマンド用途では不要なため）。
+ */
+class MqttPacketParser {
+public:
+  static constexpr size_t MAX_PACKET_SIZE = 256;
+
+  typedef void (*PacketHandler)(const MqttPacket& packet, void* context);
+
+  MqttPacketParser(PacketHandler onPacket, void* context);
+
+  void feed(const uint8_t* data, size_t length);
+
+  // 状態を初期化（再接続時）
+  void reset();
+
+  // 不正・過大で破棄したパケット数
+  uint32_t getErrorCount() const { return errorCount_; }
+
+private:
+  enum class State : uint8_t { HEADER, LENGTH, BODY };
+
+  PacketHandler onPacket_;
+  void* context_;
+  State state_;
+  uint8_t header_;
+  uint32_t remaining_;     // 残りの本体バイト数
+  uint32_t bodyLength_;
+  uint8_t lengthShift_;
+  size_t received_;
+  uint8_t buffer_[MAX_PACKET_SIZE];
+  uint32_t errorCount_;
+};
+
+#endif // MQTT_CODEC_H
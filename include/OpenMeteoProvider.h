@@ -0,0 +1,34 @@
+/**
+ * OpenMeteoProvider.h
+ *
+ * Open-Meteo API からの天気予報の取得（HTTPS）
+ */
+
+#ifndef OPEN_METEO_PROVIDER_H
+#define OPEN_METEO_PROVIDER_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include "ForecastProvider.h"
+
+class OpenMeteoProvider : public ForecastProvider {
+public:
+  OpenMeteoProvider(float latitude, float longitude);
+
+  const char* name() const override { return "open-meteo"; }
+
+  // 地点の変更時に URL を作成（取得のたびに文字列を組み立てない）
+  void setLocation(float latitude, float longitude) override;
+
+  bool fetch(ForecastScratch& scratch, ForecastValues& out) override;
+
+private:
+  static constexpr size_t API_URL_SIZE = 192;
+  static constexpr unsigned long BODY_TIMEOUT_MS = 5000;
+
+  int readBody(HTTPClient& http, char* body, size_t size);
+
+  char apiUrl_[API_URL_SIZE];
+};
+
+#endif // OPEN_METEO_PROVIDER_H
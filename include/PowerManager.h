@@ -0,0 +1,84 @@
+/**
+ * PowerManager.h
+ *
+ * loop() の待機と省電力（ライトスリープ）の管理クラス
+ *
+ * 実際の処理はセンサー読み取り（2秒ごと）と制御（5分ごと）だけなので、loop() は
+ * 次の処理期限まで idleUntil() でタスクを止めます。その間 CPU は FreeRTOS の
+ * アイドルタスクに移り、電源管理が有効なビルド（esp32dev_lightsleep 環境）では自動ライトスリープに入ります。
+ * 既定の esp32dev 環境（Arduino のビルド済み SDK）は電源管理が無効のため、待機のみです。
+ *
+ * 起床要因:
+ * - タイマー（次の期限、または MAX_IDLE_MS）
+ * - IR起床ピンの Low（IR受信モジュールの出力を受信ピンと並列に接続した別の GPIO）
+ * - WiFi の DTIM ビーコン（モデムスリープで接続を維持）
+ *
+ * ライトスリープの起床設定（Low レベル）は同じピンのエッジ割り込みを置き換えるため、IRrecv が使う受信ピンには
+ * 設定せず、別の起床ピンを使います（未接続の場合はライトスリープしません）。
+ * IR受信中（受信ピンの Low から 50ms）はライトスリープを止め、loop() の実行中は CPU を最高周波数に固定します
+ * （LoopProfiler のサイクル数→時間の換算と IR受信のタイミングが周波数の切り替えでずれないように）。
+ *
+ * loop() タスクが動いていた時間の割合（稼働率）を計測し、定期的に出力します。
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+
+class PowerManager {
+public:
+  // 1回の待機の上限（MQTTコマンド・IR受信データの処理遅延の上限）
+  static constexpr uint32_t MAX_IDLE_MS = 250;
+  static constexpr uint8_t NO_PIN = 0xFF;  // IR起床ピンなし
+
+  /**
+   * コンストラクタ
+   * @param irRecvPin 赤外線受信ピン（IRrecv が使用。受信中の判定に使う）
+   * @param irWakePin IR起床ピン（受信モジュールの出力に並列に接続。NO_PIN: ライトスリープしない）
+   * @param lightSleep true: 自動ライトスリープを有効化, false: 待機のみ
+   */
+  PowerManager(uint8_t irRecvPin, uint8_t irWakePin, bool lightSleep);
+
+  // ライトスリープに入る前の準備（アイドルフックから呼ばれるため、短時間で終わる処理に限る）
+  typedef void (*SleepPrepare)(void* context);
+  static constexpr uint8_t MAX_SLEEP_PREPARES = 2;
+
+  /**
+   * ライトスリープの準備処理を登録（起床設定を眠る直前だけ行う入力など）
+   * ライトスリープが無効なビルド・設定では呼ばれません。
+   * @return false: 登録数の上限
+   */
+  bool addSleepPrepare(SleepPrepare prepare, void* context);
+
+  /**
+   * 電源管理を設定（WiFi接続後に呼び出す）
+   * @return true: 自動ライトスリープが有効
+   */
+  bool begin();
+
+  /**
+   * 次の処理期限まで待機（最大 MAX_IDLE_MS）
+   * @param deadlineMs 次に処理が必要な時刻（millis()）
+   */
+  void idleUntil(unsigned long deadlineMs);
+
+  // 前回のリセットからの稼働率（0.0〜1.0）
+  float getActiveDuty() const;
+
+  // 稼働率を出力して計測をリセット
+  void printSummary();
+
+private:
+  uint8_t irRecvPin_;
+  uint8_t irWakePin_;
+  bool lightSleep_;
+  bool lightSleepActive_;
+
+  // 稼働率の計測（µs）
+  int64_t windowStartUs_;  // esp_timer_get_time()（micros() は約71分で桁あふれするため）
+  uint64_t idleUs_;
+  uint32_t idleCount_;
+};
+
+#endif // POWER_MANAGER_H
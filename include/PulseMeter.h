@@ -0,0 +1,64 @@
+/**
+ * PulseMeter.h
+ *
+ * パルス出力付き電力量計（S0 出力など）の読み取りクラス
+ *
+ * パルスの立ち下がりを GPIO 割り込みで数え、loop() から takeWh() で前回からの電力量を取り出します。
+ * 割り込みでは回数を数えるだけで、チャタリングは前回のパルスからの間隔で除外します。
+ *
+ * ライトスリープ中はエッジ割り込みが届かないため、眠る直前（PowerManager の準備処理）だけ起床設定（Low レベル）を
+ * 行います。起床設定は同じピンの割り込みを Low レベルに置き換えるため、最初の割り込みで立ち下がりに戻し、
+ * その割り込みを1パルスとして数えます（Low の間に割り込みが繰り返されて多重に数えないように）。
+ */
+
+#ifndef PULSE_METER_H
+#define PULSE_METER_H
+
+#include <Arduino.h>
+
+class PulseMeter {
+public:
+  static constexpr uint8_t NO_PIN = 0xFF;              // 計測器なし
+  static constexpr uint32_t MIN_PULSE_INTERVAL_US = 20000;  // これより短い間隔のパルスはチャタリングとして除外
+
+  /**
+   * コンストラクタ
+   * @param pin パルス入力ピン（NO_PIN: 計測器なし）
+   * @param pulsesPerKWh 1kWh あたりのパルス数（計測器の銘板の imp/kWh）
+   */
+  PulseMeter(uint8_t pin, uint32_t pulsesPerKWh);
+
+  // 割り込み（立ち下がり）を設定
+  void begin();
+
+  /**
+   * ライトスリープ中もパルスで起床するよう設定（PowerManager::addSleepPrepare() に登録）
+   * パルスの出力中（Low）は設定しません（立ち下がりの割り込みで数え済み）。
+   */
+  static void prepareSleep(void* context);
+
+  // 計測器が接続されているか
+  bool isEnabled() const { return pin_ != NO_PIN; }
+
+  /**
+   * 前回の呼び出しからの電力量を取り出す
+   * @return Wh（計測器なしは -1）
+   */
+  float takeWh();
+
+  // 起動からのパルス数
+  uint32_t getTotalPulses() const { return totalPulses_; }
+
+private:
+  static void IRAM_ATTR onPulse(void* arg);
+
+  uint8_t pin_;
+  uint32_t pulsesPerKWh_;
+  volatile uint32_t pending_;      // takeWh() で取り出していないパルス数
+  volatile uint32_t totalPulses_;
+  volatile uint32_t lastPulseUs_;
+  volatile bool wakeArmed_;        // 起床設定中（割り込みが Low レベル）
+  portMUX_TYPE lock_;
+};
+
+#endif // PULSE_METER_H
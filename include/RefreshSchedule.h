@@ -0,0 +1,61 @@
+/**
+ * RefreshSchedule.h
+ *
+ * 定期取得の期限管理（Arduino非依存）
+ *
+ * 次の取得時刻を絶対時刻（UNIX時刻）で持ち、現在時刻が期限を過ぎていれば取得します。
+ * loop() が期限の瞬間に止まっていても、次に確認した時点で取得されます（取りこぼしなし）。
+ * - 成功: 次の周期の境界（毎時0分など）+ ランダムな遅れ（複数台が同じ秒に API を呼ばないように）
+ * - 失敗: 指数バックオフ（retryBaseSec から倍々、retryMaxSec まで）+ ランダムな遅れで再試行
+ * 時刻はすべて呼び出し側から渡します（ホストでそのまま動作確認できます）。
+ */
+
+#ifndef REFRESH_SCHEDULE_H
+#define REFRESH_SCHEDULE_H
+
+#include <stdint.h>
+
+class RefreshSchedule {
+public:
+  /**
+   * コンストラクタ
+   * @param intervalSec 取得の周期（秒、境界は UNIX時刻の intervalSec の倍数）
+   * @param jitterSec 周期の境界に加えるランダムな遅れの上限（秒）
+   * @param retryBaseSec 失敗後の最初の再試行までの時間（秒）
+   * @param retryMaxSec 再試行の間隔の上限（秒）
+   * @param seed 遅れの乱数の種（ノードごとに異なる値）
+   */
+  RefreshSchedule(uint32_t intervalSec, uint32_t jitterSec, uint32_t retryBaseSec, uint32_t retryMaxSec,
+                  uint32_t seed);
+
+  // 取得の期限を過ぎたか（期限が未設定の場合はすぐに取得）
+  bool isDue(uint32_t nowEpoch) const { return nextEpoch_ == 0 || nowEpoch >= nextEpoch_; }
+
+  // 取得に成功した（次の周期の境界 + 遅れを期限にする）
+  void onSuccess(uint32_t nowEpoch);
+
+  // 取得に失敗した（バックオフ後を期限にする）
+  void onFailure(uint32_t nowEpoch);
+
+  // 期限を取り消し、次の確認ですぐに取得する（地点の変更時など）
+  void expedite() { nextEpoch_ = 0; }
+
+  // 次の取得時刻（UNIX時刻、0: すぐ）
+  uint32_t getNextEpoch() const { return nextEpoch_; }
+
+  // 連続した失敗の回数
+  uint32_t getFailures() const { return failures_; }
+
+private:
+  uint32_t random(uint32_t bound);
+
+  uint32_t intervalSec_;
+  uint32_t jitterSec_;
+  uint32_t retryBaseSec_;
+  uint32_t retryMaxSec_;
+  uint32_t state_;       // xorshift32 の状態
+  uint32_t nextEpoch_;
+  uint32_t failures_;
+};
+
+#endif // REFRESH_SCHEDULE_H
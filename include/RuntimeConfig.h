@@ -0,0 +1,74 @@
+/**
+ * RuntimeConfig.h
+ *
+ * 実行時に変更できる設定値と、その保存形式（Arduino非依存）
+ *
+ * 設定はメンバーを直接読むだけの固定レイアウトの構造体で、loop() ではキー検索を行いません。
+ * NVS にはこの構造体をそのままバイト列として、ヘッダー（マジック・バージョン・サイズ・CRC32）付きで保存します。
+ *
+ * スキーマの変更ルール:
+ * - フィールドは末尾にのみ追加し、VERSION を1つ上げる
+ * - 古いバージョンのデータは保存されているサイズ分だけ読み込み、追加分は初期値のままにする
+ * - フィールドの削除・型変更・並べ替えは行わない（必要な場合は MAGIC を変えて初期化する）
+ */
+
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ControlPolicy.h"
+
+class ResponseWriter;
+
+// 実行時設定（バージョン1）
+struct RuntimeConfig {
+  // 制御閾値
+  PolicyThresholds thresholds;
+
+  // センサー補正
+  float tempOffset;   // 温度補正（℃）
+  float humOffset;    // 湿度補正（%）
+
+  // タイミング（ミリ秒）
+  uint32_t sensorReadIntervalMs;
+  uint32_t controlIntervalMs;
+  uint32_t profileReportIntervalMs;
+
+  // 天気予報の地点
+  float latitude;
+  float longitude;
+};
+
+namespace RuntimeConfigSchema {
+  constexpr uint16_t MAGIC = 0xAC5C;
+  constexpr uint16_t VERSION = 1;
+  constexpr size_t HEADER_SIZE = 12;  // [マジック:2][バージョン:2][サイズ:2][予約:2][CRC32:4]
+  constexpr size_t BLOB_SIZE = HEADER_SIZE + sizeof(RuntimeConfig);
+
+  // 保存用のバイト列を生成（out は BLOB_SIZE バイト以上）
+  size_t encode(const RuntimeConfig& config, uint8_t* out);
+
+  /**
+   * 保存されたバイト列を読み込む
+   * @param defaults 古いバージョンで不足するフィールドに使う値
+   * @return false: マジック・CRC不一致、または新しすぎるバージョン（out は defaults のまま）
+   */
+  bool decode(const uint8_t* data, size_t length, const RuntimeConfig& defaults, RuntimeConfig& out);
+
+  // 値の組み合わせが妥当か（下限 < 上限 など）
+  bool validate(const RuntimeConfig& config, const char** error);
+
+  /**
+   * 名前を指定して1項目を変更（"tempLower" = "24.0" など）
+   * @return false: 不明な名前、数値でない、範囲外
+   */
+  bool setField(RuntimeConfig& config, const char* name, const char* value, const char** error);
+
+  // 全項目をJSONで書き出す
+  void writeJson(const RuntimeConfig& config, ResponseWriter& out);
+
+  uint32_t crc32(const uint8_t* data, size_t length);
+}
+
+#endif // RUNTIME_CONFIG_H
@@ -0,0 +1,54 @@
+/**
+ * SensorData.h
+ *
+ * センサーデータ構造体と不快指数の計算（Arduino非依存）
+ */
+
+#ifndef SENSOR_DATA_H
+#define SENSOR_DATA_H
+
+// センサーデータ構造体
+struct SensorData {
+  float temperature;
+  float humidity;
+  float discomfortIndex;  // 不快指数（DI）
+  bool isValid;
+
+  SensorData() : temperature(0.0f), humidity(0.0f), discomfortIndex(0.0f), isValid(false) {}
+  SensorData(float temp, float hum, bool valid)
+    : temperature(temp), humidity(hum), discomfortIndex(0.0f), isValid(valid) {}
+  SensorData(float temp, float hum, float di, bool valid)
+    : temperature(temp), humidity(hum), discomfortIndex(di), isValid(valid) {}
+
+  // 同じ読み取り結果か（無効な値同士は同じとみなす。DataBus の変更検出用）
+  bool operator==(const SensorData& other) const {
+    if (isValid != other.isValid) {
+      return false;
+    }
+    return !isValid || (temperature == other.temperature && humidity == other.humidity &&
+                        discomfortIndex == other.discomfortIndex);
+  }
+};
+
+/**
+ * 不快指数（Discomfort Index: DI）を計算
+ * @param temperature 温度（摂氏）
+ * @param humidity    湿度（%）
+ * @return 不快指数（DI値）
+ *
+ * 計算式: DI = 0.81T + 0.01H(0.99T - 14.3) + 46.3
+ * DI値の目安:
+ *   〜55: 寒い
+ *   55〜60: 肌寒い
+ *   60〜65: 何も感じない
+ *   65〜70: 快い
+ *   70〜75: 暑くない
+ *   75〜80: やや暑い
+ *   80〜85: 暑くて汗が出る
+ *   85〜  : 暑くてたまらない
+ */
+inline float discomfortIndex(float temperature, float humidity) {
+  return 0.81f * temperature + 0.01f * humidity * (0.99f * temperature - 14.3f) + 46.3f;
+}
+
+#endif // SENSOR_DATA_H
@@ -0,0 +1,90 @@
+/**
+ * SerialConsole.h
+ *
+ * シリアルからのコマンド入力（診断・実行中の調整用）
+ *
+ * loop() ごとに poll() を呼ぶと、受信済みのバイトだけを読み（待たない）、改行で区切った1行を
+ * コマンド表から探して処理を呼び出します。
+ * - 1回の poll() で読むバイト数は MAX_BYTES_PER_POLL まで、実行するコマンドは1件まで。
+ *   読み取りが BUDGET_US を超えたら残りは次の loop() で読む
+ * - コマンドの処理は送信・取得を開始するだけで完了を待たない前提で、BUDGET_US を超えた場合は警告する
+ * - コマンド表は const の配列（フラッシュに配置）で、処理は main.cpp で定義する。help は組み込み
+ * - 応答はログ（LOG）で出力する（シリアルはバイナリログと共用のため直接書かない）
+ * - 行の区切り・コマンドの検索は Arduino非依存（feed() で1バイトずつ渡せばホストでも動作）
+ */
+
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// コマンド表の1行
+struct ConsoleCommand {
+  const char* name;   // コマンド名
+  const char* usage;  // 引数の説明（help・引数が不正な場合に表示）
+
+  /**
+   * 処理
+   * @param args コマンド名の後ろの文字列（前後の空白は除去済み、書き換えてよい）
+   * @return false: 引数が不正
+   */
+  bool (*handler)(char* args, void* context);
+};
+
+class SerialConsole {
+public:
+  static constexpr size_t LINE_SIZE = 96;             // 1行の上限（終端を含む）
+  static constexpr size_t MAX_BYTES_PER_POLL = 64;    // 1回の poll() で読むバイト数の上限
+  static constexpr uint32_t BUDGET_US = 2000;         // 1回の poll() の時間の目安（µs）
+
+  /**
+   * コンストラクタ
+   * @param commands コマンド表（const の配列）
+   * @param count コマンドの数
+   * @param context 処理に渡す値
+   */
+  SerialConsole(const ConsoleCommand* commands, size_t count, void* context = nullptr);
+
+#ifdef ARDUINO
+  /**
+   * 受信済みのバイトを読み、1行そろったらコマンドを実行（loop() ごとに呼び出す）
+   * @return true: コマンドを実行した
+   */
+  bool poll(Stream& stream);
+#endif
+
+  /**
+   * 1バイト渡す（CR・LF で1行を確定。長すぎる行は確定時に破棄）
+   * @return true: 1行そろった（execute() で実行する）
+   */
+  bool feed(char c);
+
+  // そろった1行を実行（不明なコマンド・不正な引数はログ出力）
+  void execute();
+
+  // コマンド一覧をログ出力
+  void printHelp() const;
+
+  // 実行したコマンドの数
+  uint32_t getExecuted() const { return executed_; }
+
+private:
+  const ConsoleCommand* find(const char* name) const;
+
+  const ConsoleCommand* commands_;
+  size_t count_;
+  void* context_;
+
+  char line_[LINE_SIZE];
+  size_t length_;
+  bool overflow_;  // 入力中の行が LINE_SIZE を超えた
+  bool ready_;     // 1行そろっている
+  uint32_t executed_;
+};
+
+#endif // SERIAL_CONSOLE_H
@@ -0,0 +1,128 @@
+/**
+ * SetpointModulator.h
+ *
+ * 設定温度の調整による連続運転の制御（Arduino非依存）
+ *
+ * オン・オフ制御（ControlPolicy）は暖房23.5度・冷房25度のプリセットを発停するため、
+ * ヒステリシスの幅ごとに圧縮機の起動・停止を繰り返します。このクラスは一度運転を始めたら停止せず、
+ * 平滑化した室温と目標室温（暖房: 停止温度, 冷房: 停止温度）の差から PI 制御で設定温度を決め、
+ * 0.5℃単位で1回の判定あたり MAX_STEP まで変更します（インバーター機の能力を連続的に絞る）。
+ *
+ * - 運転の開始・運転モードの選択はオン・オフ制御の判定に従う（開始時はプリセットの設定温度から）
+ * - オン・オフ制御が快適範囲として停止する場合も運転を続け、目標から releaseBand 以上離れたら停止
+ * - 夜間停止・極寒日の暖房18度・除湿はオン・オフ制御のプリセットをそのまま使う
+ *
+ * 比較のため、オン・オフ制御の判定も内部の状態（getBaselineMode()）で続け、
+ * それぞれの圧縮機の起動回数（停止から運転への切り替え）を数えます。
+ * 時刻はすべて呼び出し側から渡します（ホストのシミュレーターでもそのまま動作します）。
+ */
+
+#ifndef SETPOINT_MODULATOR_H
+#define SETPOINT_MODULATOR_H
+
+#include <stdint.h>
+#include "ControlPolicy.h"
+#include "ACCommand.h"
+
+// 調整のパラメーター（シミュレーター等で差し替え可能）
+struct ModulatorParams {
+  float kp;            // 比例ゲイン（設定温度の変化℃ / 室温の誤差℃）
+  float kiPerHour;     // 積分ゲイン（設定温度の変化℃ / 誤差℃·h）
+  float offsetMin;     // 目標室温からの設定温度の幅（能力を絞る側、℃）
+  float offsetMax;     // 目標室温からの設定温度の幅（能力を上げる側、℃）
+  float releaseBand;   // 目標室温からこれ以上離れたら停止（暖房で暑すぎる・冷房で寒すぎる、℃）
+  float filterTauSec;  // 室温の平滑化の時定数（秒）
+};
+
+constexpr ModulatorParams DEFAULT_MODULATOR_PARAMS = {
+  0.5f, 0.5f, -1.0f, 4.0f, 1.0f, 120.0f
+};
+
+// 判定の結果（ログ出力・解析用）
+enum class ModulatorAction : uint8_t {
+  PASS,       // 調整しない（オン・オフ制御のプリセットをそのまま使用）
+  START,      // 運転開始（プリセットの設定温度から調整を開始）
+  RAISE,      // 設定温度を上げた
+  LOWER,      // 設定温度を下げた
+  KEEP,       // 設定温度を維持
+  RELEASE     // 目標から離れたため停止
+};
+
+class SetpointModulator {
+public:
+  static constexpr float MAX_STEP = 0.5f;           // 1回の判定で変更する設定温度の上限（℃）
+  static constexpr float STEP_DEADBAND = 0.15f;     // 0.5℃単位の丸めの境界での往復を防ぐ幅（℃）
+  static constexpr uint32_t MAX_DT_MS = 1800000;    // 積分に使う経過時間の上限（手動指定の後など）
+
+  explicit SetpointModulator(const ModulatorParams& params = DEFAULT_MODULATOR_PARAMS);
+
+  // パラメーターの設定（積分は次の運転開始から反映）
+  void setParams(const ModulatorParams& params) { params_ = params; }
+  const ModulatorParams& getParams() const { return params_; }
+
+  /**
+   * センサーの読み取り値を渡す（読み取りのたびに呼び出す。読み取り間隔は一定でなくてよい）
+   * @param nowMs 読み取った時刻（millis）
+   */
+  void onReading(uint32_t nowMs, float temperature);
+
+  /**
+   * 制御周期ごとの判定
+   * @param baseline オン・オフ制御の判定（現在のモードに getBaselineMode() を渡して判定したもの）
+   * @param temperature 室温（平滑化の値がない場合に使用）
+   * @param thresholds 目標範囲（ピーク時間帯に広げた値を含む）
+   * @param current 現在の指令（手動指定などで運転モードが変わっていれば調整をやり直す）
+   * @param nowMs 現在時刻（millis）
+   * @return 送信する指令
+   */
+  ACCommand update(const PolicyDecision& baseline, float temperature, const PolicyThresholds& thresholds,
+                   const ACCommand& current, uint32_t nowMs);
+
+  // オン・オフ制御を続けた場合の現在のモード（ControlPolicy::decide() のヒステリシス用）
+  ACMode getBaselineMode() const { return baselineMode_; }
+
+  // 直近の判定の結果と目標室温
+  ModulatorAction getLastAction() const { return lastAction_; }
+  float getTarget() const { return target_; }
+
+  // 平滑化した室温（読み取り前は 0）
+  float getFilteredTemperature() const { return filtered_; }
+
+  // 圧縮機の起動回数（この制御 / オン・オフ制御を続けた場合）
+  uint32_t getStarts() const { return starts_; }
+  uint32_t getBaselineStarts() const { return baselineStarts_; }
+
+  // 設定温度を変更した回数
+  uint32_t getSetpointChanges() const { return setpointChanges_; }
+
+private:
+  ACCommand pass(ACMode mode);
+  ACCommand start(ACOperation operation, float error);
+  ACCommand step(const ACCommand& current, float sign, float error, uint32_t nowMs);
+  void countStart(const ACCommand& command);
+
+  ModulatorParams params_;
+
+  // 平滑化した室温
+  bool hasFiltered_;
+  float filtered_;
+  uint32_t lastReadingMs_;
+
+  // 調整の状態
+  ACOperation active_;    // 調整中の運転モード（OFF: 調整していない）
+  float target_;          // 目標室温
+  float integral_;        // 積分項（設定温度の目標室温からの幅、℃）
+  uint32_t lastUpdateMs_;
+  ACCommand lastOutput_;  // 前回返した指令
+  ModulatorAction lastAction_;
+
+  // 比較用のオン・オフ制御の状態
+  ACMode baselineMode_;
+
+  // 統計
+  uint32_t starts_;
+  uint32_t baselineStarts_;
+  uint32_t setpointChanges_;
+};
+
+#endif // SETPOINT_MODULATOR_H
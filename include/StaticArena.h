@@ -0,0 +1,65 @@
+/**
+ * StaticArena.h
+ *
+ * 起動時に確保する固定領域（Arduino非依存）
+ *
+ * setup() で一度だけヒープから確保した領域を、長く使うバッファ（HTTP受信・JSON解析など）に
+ * 先頭から順に割り当てます。個別の解放はなく、mark() / rewind() でまとめて戻します。
+ * 起動直後の断片化していないヒープから確保するため、長時間稼働しても確保に失敗しません。
+ */
+
+#ifndef STATIC_ARENA_H
+#define STATIC_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class StaticArena {
+public:
+  static constexpr size_t DEFAULT_ALIGN = 8;
+
+  StaticArena();
+
+  /**
+   * 既存のバッファを領域として使う（begin() の代わり）
+   * @param buffer バッファ（DEFAULT_ALIGN の境界に揃っていること）
+   * @param size バイト数
+   */
+  StaticArena(void* buffer, size_t size);
+
+  /**
+   * 領域をヒープから確保（setup() で一度だけ呼び出す）
+   * @param size バイト数
+   * @return false: 確保に失敗、または確保済み
+   */
+  bool begin(size_t size);
+
+  /**
+   * 領域から割り当て
+   * @param size バイト数
+   * @param align 境界（2のべき乗）
+   * @return 割り当てた領域、不足時は nullptr（失敗回数を記録）
+   */
+  void* allocate(size_t size, size_t align = DEFAULT_ALIGN);
+
+  // 現在の使用位置（rewind() で戻す位置）
+  size_t mark() const { return used_; }
+
+  // mark() の位置まで戻す（それ以降の割り当ては無効になる）
+  void rewind(size_t position);
+
+  bool isReady() const { return base_ != nullptr; }
+  size_t getCapacity() const { return capacity_; }
+  size_t getUsed() const { return used_; }
+  size_t getPeak() const { return peak_; }          // 使用量の最大値（容量の見直し用）
+  uint32_t getFailures() const { return failures_; }
+
+private:
+  uint8_t* base_;
+  size_t capacity_;
+  size_t used_;
+  size_t peak_;
+  uint32_t failures_;
+};
+
+#endif // STATIC_ARENA_H
@@ -0,0 +1,72 @@
+/**
+ * StatusFormat.h
+ *
+ * ステータスのJSON・Prometheusテキスト形式への書き出し（Arduino非依存）
+ *
+ * String などの中間文字列を作らず、呼び出し側の固定バッファに直接書式化し、
+ * バッファが埋まるたびに送信関数（ソケットの send など）へ渡します。
+ */
+
+#ifndef STATUS_FORMAT_H
+#define STATUS_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "StatusSnapshot.h"
+
+// バッファの内容を送り出す関数（false を返すと以降の書き込みを中止）
+typedef bool (*ResponseSink)(const char* data, size_t length, void* context);
+
+/**
+ * 固定バッファへの書き込みクラス
+ * 動的確保は行わず、満杯になったら sink に渡して先頭から再利用します。
+ */
+class ResponseWriter {
+public:
+  /**
+   * コンストラクタ
+   * @param buffer 書き込み先のバッファ
+   * @param size バッファサイズ
+   * @param sink バッファの送信関数
+   * @param context sink に渡す値
+   */
+  ResponseWriter(char* buffer, size_t size, ResponseSink sink, void* context);
+
+  // 文字列をそのまま書き込む
+  void write(const char* text);
+  void write(const char* data, size_t length);
+
+  // printf 形式で書き込む
+  void printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  // バッファに残った内容を送信
+  bool flush();
+
+  // 送信に失敗したか（以降の書き込みは無視されます）
+  bool failed() const { return failed_; }
+
+  // これまでに書き込んだバイト数
+  size_t getTotal() const { return total_; }
+
+private:
+  char* buffer_;
+  size_t size_;
+  size_t used_;
+  size_t total_;
+  ResponseSink sink_;
+  void* context_;
+  bool failed_;
+};
+
+namespace StatusFormat {
+  // JSON形式で書き出す
+  void writeJson(const StatusSnapshot& status, ResponseWriter& out);
+
+  // Prometheus テキスト形式（exposition format 0.0.4）で書き出す
+  void writePrometheus(const StatusSnapshot& status, ResponseWriter& out);
+
+  // エアコンモードの識別名（"off", "cooling_25" など）
+  const char* modeName(ACMode mode);
+}
+
+#endif // STATUS_FORMAT_H
@@ -0,0 +1,113 @@
+/**
+ * StatusServer.h
+ *
+ * ステータス・メトリクスを返す軽量HTTPサーバー
+ *
+ *   GET /status   現在の状態をJSONで返す
+ *   GET /metrics  Prometheus テキスト形式で返す
+ *   GET /config   実行時設定をJSONで返す（attachConfig() した場合）
+ *   POST /config  "名前=値&..." 形式の本文で実行時設定を変更
+ *                 （"Authorization: Bearer <トークン>" が必要。トークンが空の場合は 403 で無効）
+ *   GET /trace    制御の入力トレース（バイナリ、attachTrace() した場合。tools/replay で再生）
+ *
+ * ESP32 では lwIP の BSD ソケットを専用の低優先度タスクで処理するため、loop() を止めません。
+ * loop() 側は publish() で状態のスナップショットを渡すだけで、応答の書式化は
+ * サーバータスクが固定バッファに直接行います（String・動的確保なし）。
+ * ホストでは同じコードが POSIX ソケットで動作し、poll() を呼び出し側が回します。
+ */
+
+#ifndef STATUS_SERVER_H
+#define STATUS_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "StatusSnapshot.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#else
+#include <mutex>
+#endif
+
+class ConfigManager;
+class ResponseWriter;
+
+// /trace の本文を書き出す関数（サーバータスクから呼び出す）
+typedef void (*TraceSource)(ResponseWriter& out, void* context);
+
+class StatusServer {
+public:
+  static constexpr uint16_t DEFAULT_PORT = 80;
+  static constexpr size_t REQUEST_BUFFER_SIZE = 512;    // リクエストヘッダーの読み取り上限
+  static constexpr size_t RESPONSE_BUFFER_SIZE = 1024;  // 送信用バッファ（満杯ごとに send）
+  static constexpr uint32_t SOCKET_TIMEOUT_MS = 2000;   // 送受信のタイムアウト
+
+  /**
+   * コンストラクタ
+   * @param port 待ち受けポート（0: OSが割り当て、ホストのテスト用）
+   */
+  explicit StatusServer(uint16_t port = DEFAULT_PORT);
+  ~StatusServer();
+
+  /**
+   * 待ち受けを開始（ESP32ではサーバータスクも起動）
+   * @return true: 成功, false: ソケットの作成・バインド失敗
+   */
+  bool begin();
+
+  /**
+   * /config で参照・変更する設定（begin() の前に呼び出す）
+   * @param writeToken POST /config に必要なトークン（nullptr・空文字: 変更を受け付けない）
+   */
+  void attachConfig(ConfigManager* config, const char* writeToken) {
+    config_ = config;
+    writeToken_ = writeToken;
+  }
+
+  // /trace で出力する関数（begin() の前に呼び出す）
+  void attachTrace(TraceSource source, void* context) {
+    traceSource_ = source;
+    traceContext_ = context;
+  }
+
+  // 公開する状態を更新（loop() から呼び出す）
+  void publish(const StatusSnapshot& snapshot);
+
+  /**
+   * 接続を待ち、1件のリクエストを処理
+   * @param timeoutMs 待ち時間（ミリ秒）
+   * @return true: リクエストを処理した
+   */
+  bool poll(uint32_t timeoutMs);
+
+  // 待ち受け中のポート番号
+  uint16_t getPort() const { return port_; }
+
+  // 処理したリクエスト数
+  uint32_t getRequestCount() const { return requestCount_; }
+
+private:
+  void handleClient(int client);
+  bool readBody(int client, char* request, size_t& received, char*& body);
+  void copySnapshot(StatusSnapshot& out);
+  static bool sendAll(const char* data, size_t length, void* context);
+
+  uint16_t port_;
+  int listenSocket_;
+  volatile uint32_t requestCount_;
+  StatusSnapshot snapshot_;
+  ConfigManager* config_;
+  const char* writeToken_;
+  TraceSource traceSource_;
+  void* traceContext_;
+  char responseBuffer_[RESPONSE_BUFFER_SIZE];
+
+#ifdef ARDUINO
+  portMUX_TYPE lock_;
+  static void serverTask(void* param);
+#else
+  std::mutex lock_;
+#endif
+};
+
+#endif // STATUS_SERVER_H
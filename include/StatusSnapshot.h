@@ -0,0 +1,77 @@
+/**
+ * StatusSnapshot.h
+ *
+ * HTTPステータス出力用の状態スナップショット（Arduino非依存）
+ *
+ * loop() で定期的に値を詰めて StatusServer に渡します。
+ * 文字列を含まない固定サイズの構造体のため、タスク間でそのままコピーできます。
+ */
+
+#ifndef STATUS_SNAPSHOT_H
+#define STATUS_SNAPSHOT_H
+
+#include <stdint.h>
+#include "ControlPolicy.h"
+#include "LoopProfiler.h"
+
+struct StatusSnapshot {
+  static constexpr size_t PHASE_COUNT = static_cast<size_t>(LoopPhase::COUNT);
+
+  uint32_t uptimeMs;
+
+  // 室内センサー
+  bool sensorValid;
+  float temperature;      // ℃
+  float humidity;         // %
+  float discomfortIndex;
+  uint32_t sensorIntervalMs;   // 現在の読み取り間隔（変化に応じて調整）
+  float sensorReadsPerHour;    // 平均の読み取り頻度（回/時）
+  uint32_t sensorReads;        // 読み取り回数
+  uint32_t sensorReadsSaved;   // 最短間隔で読み続けた場合と比べて省略した回数
+
+  // 天気予報
+  bool weatherValid;
+  float tempMax;          // ℃
+  float tempMin;          // ℃
+  int16_t weatherCode;
+  uint32_t weatherAgeMs;  // 最終取得からの経過時間（再起動前に取得した予報を含む）
+  const char* weatherSource;  // 取得元（"open-meteo", "file", "cache", "mesh"。nullptr: 不明）
+  uint32_t weatherRefreshFailures;  // 連続した取得の失敗回数（再試行中）
+
+  // エアコン
+  ACMode acMode;            // 設定温度の調整中は設定温度が近いプリセット
+  float acSetpoint;         // 現在の設定温度（℃、0: 停止・不明）
+  bool acModulated;         // 設定温度を調整する制御
+  uint32_t compressorStarts;  // 圧縮機の起動回数（設定温度を調整する制御の判定から数えた値）
+  uint32_t baselineStarts;    // オン・オフ制御を続けた場合の起動回数（比較用）
+
+  // 消費電力量・電気代（メインのゾーン）
+  float powerW;              // 推定消費電力（補正後）
+  float energyTodayKWh;
+  float costToday;           // 円
+  float energyMonthKWh;
+  float costMonth;           // 円
+  float pricePerKWh;         // 現在の時間帯の料金
+  bool tariffPeak;           // ピーク時間帯
+
+  // loop() の処理時間（サイクル数、cpuMHz で割るとµs）
+  uint32_t cpuMHz;
+  PhaseStats phases[PHASE_COUNT];
+  float activeDuty;          // loop() タスクの稼働率（0.0〜1.0、待機を除く）
+
+  // ヒープ
+  uint32_t freeHeap;
+  uint32_t minFreeHeap;      // 起動後の最小値
+  uint32_t maxAllocHeap;     // 確保可能な最大ブロック
+  uint32_t minMaxAllocHeap;  // 確保可能な最大ブロックの起動後の最小値
+  float maxAllocTrendPerDay; // 確保可能な最大ブロックの傾き（バイト/日、負: 断片化が進んでいる）
+
+  // 起動（起動からのミリ秒、0: 未到達）
+  uint32_t bootFirstControlMs;  // 最初のエアコンへの送信
+  uint32_t bootNetworkMs;       // WiFi接続・NTP同期・天気予報の取得の終了
+
+  // ログ
+  uint32_t logDropped;       // 破棄したログの累計
+};
+
+#endif // STATUS_SNAPSHOT_H
@@ -30,11 +30,28 @@ public:
   TimeManager(const char* ntpServer, long gmtOffsetSec, int daylightOffsetSec);
 
   /**
-   * NTPサーバーから時刻を同期
+   * NTPサーバーから時刻を同期（同期の完了まで最大10秒待つ）
    * @return true: 同期成功, false: 同期失敗
    */
   bool syncTime();
 
+  /**
+   * NTP同期を開始（完了は待たない。同期はバックグラウンドで行われ、getEpochTime() で確認する）
+   */
+  void startSync();
+
+  /**
+   * タイムゾーンのみ設定（NTP同期なし）
+   * ディープスリープからの復帰時など、RTCの時刻は有効だが TZ 設定が失われている場合に使用します。
+   */
+  void restoreTimeZone();
+
+  /**
+   * UNIX時刻を直接設定（NTP同期なし。タイムゾーンも設定）
+   * 複数台の連携で、取得担当ノードから受信した時刻を使う場合に使用します。
+   */
+  void setEpochTime(uint32_t epoch);
+
   /**
    * 現在の時刻情報を取得
    * @param timeinfo 時刻情報を格納する構造体（出力）
@@ -42,6 +59,13 @@ public:
    */
   bool getCurrentTime(struct tm& timeinfo);
 
+  /**
+   * 現在のUNIX時刻を取得
+   * @param epoch UNIX時刻（秒、出力）
+   * @return true: 取得成功, false: 時刻未同期
+   */
+  bool getEpochTime(uint32_t& epoch);
+
   /**
    * 現在の時（0-23）を取得
    * @return 時（0-23）、取得失敗時は -1
@@ -61,17 +85,10 @@ public:
   bool isSummerSeason();
 
   /**
-   * 現在の日時をシリアル出力
+   * 現在の日時をログ出力
    */
   void printCurrentTime();
 
-  /**
-   * フォーマットされた日時文字列を取得
-   * @param format フォーマット文字列（strftime形式、例: "%Y-%m-%d %H:%M"）
-   * @return フォーマットされた日時文字列、取得失敗時は空文字列
-   */
-  String getFormattedTime(const char* format);
-
   /**
    * フォーマットされた日時を指定バッファに書き込む（組み込み環境推奨）
    * @param format フォーマット文字列（strftime形式、例: "%Y-%m-%d %H:%M"）
@@ -88,7 +105,11 @@ public:
   static constexpr const char* FORMAT_DATE_ONLY = "%Y-%m-%d";
   static constexpr const char* FORMAT_TIME_ONLY = "%H:%M:%S";
 
+  // これより前の時刻は未同期とみなす
+  static constexpr time_t MIN_VALID_EPOCH = 1577836800;  // 2020-01-01 00:00:00 UTC
+
 private:
+
   const char* ntpServer_;         // NTPサーバーアドレス
   long gmtOffsetSec_;             // GMTオフセット（秒）
   int daylightOffsetSec_;         // サマータイムオフセット（秒）
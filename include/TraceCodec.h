@@ -0,0 +1,184 @@
+/**
+ * TraceCodec.h
+ *
+ * 制御の入力トレース（記録・再生用）の圧縮形式（Arduino非依存）
+ *
+ * 制御の判定に渡したすべての入力（センサー値・時刻・天気予報・閾値・手動のモード指定・受信した赤外線信号）と
+ * 判定の結果を記録し、ホストの再生ツール（tools/replay）で同じ判定を実行して結果を比べます。
+ * 再生で同じ判定になるよう、浮動小数点数は丸めずにビット列のまま記録します。
+ *
+ * ブロック: [ヘッダー 10バイト][レコード...]
+ * レコード: [varint: (経過ミリ秒 << 3) | 種別][種別ごとの値]
+ *   経過ミリ秒: SAMPLE は zigzag（前回の SAMPLE からの経過 − 前回の読み取り間隔）、その他は直前のレコードから
+ *   SAMPLE:     1バイト（下位4ビット: 温度, 上位4ビット: 湿度。0〜14: 最近の値の表の位置, 15: 表にない値）,
+ *               表にない値ごとに zigzag varint（表の先頭の値との float のビット列の差分）
+ *   CONTROL:    1バイト（フラグ）, varint（tm_year）, 6バイト（tm_mon, tm_mday, tm_hour, tm_min, tm_sec, tm_wday）,
+ *               1バイト（判定に渡した現在のモード）, varint（判定の結果: ACMode、調整時は ACCommand::packed()）
+ *   WEATHER:    1バイト（有効）, float × 2（最高・最低気温）, zigzag varint（天気コード）
+ *   THRESHOLDS: float × 4（PolicyThresholds の順）
+ *   MODE:       1バイト（手動で指定した ACMode）
+ *   IR:         zigzag varint（プロトコル）, varint（ビット数）, varint（値、64ビット）
+ *   BOOT:       なし（記録の開始。再生側は状態を初期化する）
+ *
+ * 読み取り値は数種類の値を行き来することが多いため、最近の値を新しい順に並べた表の位置で記録します。
+ * 表・差分はブロックごとに空から始めます（ブロック単位で独立して復号できます）。
+ * 一定間隔の読み取りで値が表にある場合は1件2バイトです。
+ */
+
+#ifndef TRACE_CODEC_H
+#define TRACE_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "ControlPolicy.h"
+
+// レコードの種別
+enum class TraceKind : uint8_t {
+  SAMPLE = 0,      // センサーの読み取り値（有効な値のみ）
+  CONTROL = 1,     // 制御の判定（入力の時刻と結果）
+  WEATHER = 2,     // 判定に使う天気予報の変更
+  THRESHOLDS = 3,  // 判定に使う閾値の変更（設定の変更・ピーク時間帯）
+  MODE = 4,        // 手動のモード指定（MQTT・シリアルコンソール）
+  IR = 5,          // 受信した赤外線信号
+  BOOT = 6         // 記録の開始（起動）
+};
+
+// CONTROL のフラグ
+namespace TraceFlag {
+  constexpr uint8_t TIME_VALID = 0x01;  // 時刻を取得できた（無効の場合は停止と判定）
+  constexpr uint8_t MODULATED = 0x02;   // 設定温度を調整する制御（結果は ACCommand）
+}
+
+// 1件分のトレース（復号後）
+struct TraceEvent {
+  uint32_t timeMs;             // 時刻（millis）
+  TraceKind kind;
+  float temperature;           // SAMPLE
+  float humidity;              // SAMPLE
+  struct tm timeinfo;          // CONTROL（記録した項目以外は0）
+  uint8_t flags;               // CONTROL（TraceFlag）
+  uint8_t mode;                // CONTROL: 判定に渡した現在のモード / MODE: 指定したモード
+  uint32_t result;             // CONTROL: 判定の結果
+  bool weatherValid;           // WEATHER
+  float tempMax;               // WEATHER
+  float tempMin;               // WEATHER
+  int32_t weatherCode;         // WEATHER
+  PolicyThresholds thresholds; // THRESHOLDS
+  int16_t irProtocol;          // IR（decode_type_t）
+  uint16_t irBits;             // IR
+  uint64_t irValue;            // IR
+};
+
+/**
+ * 最近の値の表（SAMPLE の値を新しい順に保持、符号化・復号で同じ操作を行う）
+ */
+struct TraceValueTable {
+  static constexpr uint8_t SIZE = 15;
+  static constexpr uint8_t LITERAL = 15;  // 表にない値
+
+  uint32_t values[SIZE];  // float のビット列
+  uint8_t count;
+
+  void clear() { count = 0; }
+
+  // 値の位置（ない場合は LITERAL）
+  uint8_t find(uint32_t value) const;
+
+  // 表の先頭の値（空の場合は0）
+  uint32_t front() const { return count > 0 ? values[0] : 0; }
+
+  // 位置の値を取り出して先頭へ移動
+  uint32_t use(uint8_t index);
+
+  // 新しい値を先頭に追加（満杯の場合は最も古い値を捨てる）
+  void push(uint32_t value);
+};
+
+// ブロックヘッダー（ファイル上はリトルエンディアンでこの順に格納）
+struct TraceBlockHeader {
+  static constexpr uint8_t MAGIC = 0xC7;
+  static constexpr uint8_t VERSION = 1;
+  static constexpr size_t SIZE = 10;
+
+  uint16_t payloadLength;  // レコード部のバイト数
+  uint16_t recordCount;
+  uint32_t startMs;        // 先頭レコードの時刻（millis）
+
+  void serialize(uint8_t* out) const;
+  bool deserialize(const uint8_t* in);
+};
+
+/**
+ * ブロックの符号化
+ * 固定サイズのバッファに追記し、満杯になったら呼び出し側がフラッシュします。
+ */
+class TraceEncoder {
+public:
+  static constexpr size_t CAPACITY = 512;  // レコード部の最大バイト数
+  static constexpr size_t MAX_RECORD_SIZE = 32;
+
+  TraceEncoder();
+
+  /**
+   * レコードを追加
+   * @return false: 空き不足（フラッシュ後に再度追加してください）
+   */
+  bool append(const TraceEvent& event);
+
+  // 現在のブロックを消去
+  void reset();
+
+  bool isEmpty() const { return header_.recordCount == 0; }
+  const TraceBlockHeader& getHeader() const { return header_; }
+  const uint8_t* getPayload() const { return payload_; }
+
+private:
+  void putByte(uint8_t value) { payload_[header_.payloadLength++] = value; }
+  void putVarint(uint64_t value);
+  void putSigned(int32_t value);
+  void putFloat(float value);
+  uint8_t encodeValue(TraceValueTable& table, uint32_t value, int32_t& literal);
+
+  TraceBlockHeader header_;
+  uint8_t payload_[CAPACITY];
+  uint32_t lastTime_;
+  uint32_t lastSampleTime_;
+  uint32_t lastSampleInterval_;
+  TraceValueTable temperatures_;
+  TraceValueTable humidities_;
+};
+
+/**
+ * ブロックの復号
+ */
+class TraceDecoder {
+public:
+  TraceDecoder(const TraceBlockHeader& header, const uint8_t* payload);
+
+  /**
+   * 次のレコードを取得
+   * @return false: 末尾、または破損
+   */
+  bool next(TraceEvent& event);
+
+private:
+  bool getByte(uint8_t& value);
+  bool getVarint(uint64_t& value);
+  bool getVarint32(uint32_t& value);
+  bool getSigned(int32_t& value);
+  bool getFloat(float& value);
+  bool decodeValue(TraceValueTable& table, uint8_t code, float& value);
+
+  const uint8_t* payload_;
+  size_t length_;
+  size_t pos_;
+  uint16_t remaining_;
+  uint32_t lastTime_;
+  uint32_t lastSampleTime_;
+  uint32_t lastSampleInterval_;
+  TraceValueTable temperatures_;
+  TraceValueTable humidities_;
+};
+
+#endif // TRACE_CODEC_H
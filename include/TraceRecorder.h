@@ -0,0 +1,110 @@
+/**
+ * TraceRecorder.h
+ *
+ * 制御の入力トレースの記録クラス（LittleFS上の追記専用ログ）
+ *
+ * メインのゾーンの制御の判定に渡した入力と判定の結果を TraceCodec の形式で記録します。
+ * ホストの再生ツール（tools/replay）で同じ判定を実行し、ファームウェアの変更や閾値の変更で
+ * 判定がどう変わるかを実機なしで確認できます。
+ *
+ * - センサー: 有効な読み取りごと（SetpointModulator に渡す値と同じ）
+ * - 判定: 制御周期ごとに時刻（struct tm）・判定に渡した現在のモード・結果。
+ *   天気予報・閾値は変わった場合のみ判定の直前に記録する
+ * - 手動のモード指定（MQTT・シリアルコンソール）・受信した赤外線信号
+ *
+ * ファイル構成: /trace/00000001.bin, 00000002.bin, ...
+ * - RAM上のブロックが満杯になるか FLUSH_INTERVAL_MS ごとに追記（書き出し前の分は再起動で失われる）
+ * - ファイルが FILE_SIZE を超えたら次のファイルへ切り替え、MAX_FILES を超えたら最も古いファイルを削除
+ * - 追加ゾーンの判定・ディープスリープの起床ごとの判定は記録しない
+ *
+ * LittleFS のマウントは HistoryStore::begin() で行います（その後に begin() を呼び出す）。
+ *
+ * 書き出し（loop()）と writeTo()（HTTPサーバーのタスク）は同時に動くため、ファイルの番号の範囲と
+ * 書き込み中のファイルのサイズは lock_ で保護します。writeTo() は読み取り中のファイルを readingSequence_ に
+ * 登録し、書き出し側はそのファイルを削除しません（読み終わった後の書き出しで削除）。書き込み中のファイルは
+ * 開いた時点で書き出し済みのサイズまでを読みます（ファイル操作中は lock_ を保持しません）。
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <Arduino.h>
+#include "TraceCodec.h"
+#include "ControlPolicy.h"
+#include "ACCommand.h"
+#include "WeatherData.h"
+
+class ResponseWriter;
+
+class TraceRecorder {
+public:
+  static constexpr size_t FILE_SIZE = 64 * 1024;             // 1ファイルの上限（バイト）
+  static constexpr size_t MAX_FILES = 8;                     // 保持するファイル数（約512KB、読み取り間隔が最短のままでも1週間分）
+  static constexpr uint32_t FLUSH_INTERVAL_MS = 10 * 60000;  // ブロックを書き出す間隔
+
+  TraceRecorder();
+
+  /**
+   * 既存のファイルを確認し、記録の開始（BOOT）を記録
+   * @return false: LittleFS が使えない（以降の記録は無視されます）
+   */
+  bool begin(uint32_t nowMs);
+
+  // センサーの読み取り値を記録（有効な値のみ渡す）
+  void recordSample(uint32_t nowMs, float temperature, float humidity);
+
+  /**
+   * オン・オフ制御の判定を記録
+   * @param timeinfo 判定に使った時刻（nullptr: 時刻を取得できず停止と判定）
+   * @param current 判定に渡した現在のモード
+   * @param decided 判定の結果
+   */
+  void recordControl(uint32_t nowMs, const struct tm* timeinfo, const WeatherData& weather,
+                     const PolicyThresholds& thresholds, ACMode current, ACMode decided);
+
+  /**
+   * 設定温度を調整する制御の判定を記録
+   * @param baseline 判定に渡した比較用のモード（SetpointModulator::getBaselineMode()）
+   * @param decided 判定の結果
+   */
+  void recordCommand(uint32_t nowMs, const struct tm& timeinfo, const WeatherData& weather,
+                     const PolicyThresholds& thresholds, ACMode baseline, const ACCommand& decided);
+
+  // 手動のモード指定を記録
+  void recordMode(uint32_t nowMs, ACMode mode);
+
+  // 受信した赤外線信号を記録
+  void recordIR(uint32_t nowMs, int16_t protocol, uint16_t bits, uint64_t value);
+
+  // RAM上のブロックをフラッシュに書き出す
+  void flush();
+
+  /**
+   * 書き出し済みのトレースを古い順に出力（HTTPサーバーのタスクから呼び出す。同時に呼び出せるのは1タスクのみ）
+   * 書き込み中のファイルは書き出し済みのブロックまでを出力します。
+   */
+  void writeTo(ResponseWriter& out) const;
+
+private:
+  void append(const TraceEvent& event);
+  void recordInputs(uint32_t nowMs, const WeatherData& weather, const PolicyThresholds& thresholds);
+  void recordDecision(uint32_t nowMs, const struct tm* timeinfo, uint8_t flags, ACMode current, uint32_t result);
+  bool writeBlock();
+  void removeOldFiles();
+  static void filePath(uint32_t sequence, char* path, size_t size);
+
+  TraceEncoder encoder_;
+  bool ready_;
+  uint32_t firstSequence_;  // 最も古いファイル（以下3つは lock_ で保護）
+  uint32_t lastSequence_;   // 書き込み中のファイル（0: なし）
+  size_t lastSize_;         // 書き込み中のファイルのサイズ（書き出し済みのブロックまで）
+  mutable uint32_t readingSequence_;  // writeTo() が読み取り中のファイル（0: なし。削除しない）
+  mutable portMUX_TYPE lock_;
+
+  // 前回記録した入力（起動後の最初の判定では必ず記録する）
+  bool inputsRecorded_;
+  WeatherData lastWeather_;
+  PolicyThresholds lastThresholds_;
+};
+
+#endif // TRACE_RECORDER_H
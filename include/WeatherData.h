@@ -0,0 +1,52 @@
+/**
+ * WeatherData.h
+ *
+ * 天気予報データ構造体と天気の分類（Arduino非依存）
+ *
+ * 文字列を持たない固定サイズの構造体のため、コピーしても動的確保は発生しません。
+ * 表示用の文字列は weatherCategoryName() がフラッシュ上の定数表から返します。
+ */
+
+#ifndef WEATHER_DATA_H
+#define WEATHER_DATA_H
+
+#include <stdint.h>
+#include <type_traits>
+
+// 天気の分類（WMO 天気コードを表示用にまとめたもの）
+enum class WeatherCategory : uint8_t {
+  UNKNOWN,  // 不明・未取得
+  CLEAR,    // 快晴
+  CLOUDY,   // 晴れ〜曇り
+  FOG,      // 霧
+  RAIN,     // 雨
+  SNOW,     // 雪
+  STORM     // 雷雨・シャワー
+};
+
+// 天気予報データ構造体
+struct WeatherData {
+  bool isValid;              // データの有効性
+  float tempMax;             // 最高気温 (°C)
+  float tempMin;             // 最低気温 (°C)
+  int weatherCode;           // 天気コード
+  WeatherCategory category;  // 天気の分類
+  unsigned long lastUpdate;  // 最終更新時刻 (millis)
+  uint32_t fetchedEpoch;     // 取得時刻（UNIX時刻、0: 不明。再起動をまたいだ古さの判定用）
+
+  // 同じ予報か（lastUpdate は比べない。取得し直した場合は fetchedEpoch で区別。DataBus の変更検出用）
+  bool operator==(const WeatherData& other) const {
+    return isValid == other.isValid && tempMax == other.tempMax && tempMin == other.tempMin &&
+           weatherCode == other.weatherCode && category == other.category && fetchedEpoch == other.fetchedEpoch;
+  }
+};
+
+static_assert(std::is_trivially_copyable<WeatherData>::value, "WeatherData は動的確保なしでコピーできる必要があります");
+
+// WMO 天気コードを分類に変換
+WeatherCategory weatherCategoryFromCode(int code);
+
+// 分類の表示名（表示領域に合わせた省略形。例: "Cloudy"）
+const char* weatherCategoryName(WeatherCategory category);
+
+#endif // WEATHER_DATA_H
@@ -2,50 +2,155 @@
 #define WEATHER_FORECAST_H
 
 #include <Arduino.h>
-#include <HTTPClient.h>
-#include <ArduinoJson.h>
+#include "WeatherData.h"
+#include "WeatherParser.h"
+#include "StaticArena.h"
+#include "ForecastProvider.h"
+#include "OpenMeteoProvider.h"
+#include "RefreshSchedule.h"
+#include "Coroutine.h"
+#include "BackgroundWorker.h"
 
 // 前方宣言
 class TimeManager;
 
-// 天気予報データ構造体
-struct WeatherData {
-  bool isValid;              // データの有効性
-  float tempMax;             // 最高気温 (°C)
-  float tempMin;             // 最低気温 (°C)
-  int weatherCode;           // 天気コード
-  String weatherString;      // 天気の文字列表現
-  unsigned long lastUpdate;  // 最終更新時刻 (millis)
-};
-
 // 天気予報管理クラス
 class WeatherForecast {
 public:
+  static constexpr size_t MAX_PROVIDERS = 4;           // 取得元の上限（Open-Meteo を含む）
+  static constexpr uint32_t STALE_SEC = 3 * 3600;      // これより古い予報は古い値として警告
+  static constexpr uint32_t EXPIRE_SEC = 24 * 3600;    // これより古い予報は破棄（無効）
+  static constexpr uint32_t REFRESH_INTERVAL_SEC = 3600;  // 定期取得の周期（毎時0分が境界）
+  static constexpr uint32_t REFRESH_JITTER_SEC = 300;     // 境界からのランダムな遅れの上限
+  static constexpr uint32_t RETRY_BASE_SEC = 60;          // 失敗後の最初の再試行まで（以降倍々）
+  static constexpr uint32_t RETRY_MAX_SEC = 1800;         // 再試行の間隔の上限
+  static constexpr uint32_t FETCH_POLL_MS = 100;          // 別タスクでの取得の完了の確認間隔
+
   // コンストラクタ
   WeatherForecast(float latitude, float longitude);
 
-  // 初期化（起動時の天気予報取得）
+  // 初期化（起動時の天気予報取得。取得の完了まで待つ）
   bool begin();
 
-  // 定期更新チェック（毎時0分に更新）
+  /**
+   * 定期取得を別タスクで行う（setup() で呼び出す）
+   * 取得中も loop() は止まらず、取得した値は完了を確認した loop() で反映します。
+   * 登録しない場合、update() は取得の完了まで待ちます。
+   */
+  bool attach(BackgroundWorker& worker, CoroutineScheduler& scheduler);
+
+  /**
+   * HTTP受信・JSON解析のバッファを固定領域から割り当てる（setup() で begin() の前に呼び出す）
+   * 割り当てがない場合は取得のたびにヒープを使います。
+   * @return false: 領域が不足（ヒープを使う）
+   */
+  bool reserveBuffers(StaticArena& arena);
+
+  /**
+   * 予備の取得元を追加（Open-Meteo API の後に、追加した順に試す）
+   * @return false: 上限を超えた
+   */
+  bool addProvider(ForecastProvider* provider);
+
+  /**
+   * 保存しておいた予報を読み込む（setup() で begin() の前に呼び出す）
+   * 取得に成功するまでこの値を使います。古さは fetchedEpoch から判定します。
+   */
+  void restore(const WeatherData& cached);
+
+  // 予報地点を変更（次の update() ですぐに取得。取得中の場合は完了後に変更）
+  void setLocation(float latitude, float longitude);
+
+  // 次の update() ですぐに取得
+  void expedite() { schedule_.expedite(); }
+
+  // 別タスクで取得中か
+  bool isFetching() const { return fetchTask_.isRunning(); }
+
+  // 現在の予報地点と同じか
+  bool isLocation(float latitude, float longitude) const {
+    return latitude == latitude_ && longitude == longitude_;
+  }
+
+  /**
+   * 定期更新チェック（期限を過ぎていれば取得。古くなりすぎた予報は破棄）
+   * 期限は毎時0分 + ランダムな遅れで、失敗した場合はバックオフして再試行します。
+   */
   void update(TimeManager& timeMgr);
 
-  // 最新の天気予報データを取得
-  WeatherData getData() const;
+  /**
+   * 他のノードから受信した天気予報を設定（複数台の連携で取得担当以外のノード）
+   * 天気の分類は天気コードから決め、lastUpdate は現在時刻にします。
+   */
+  void setExternalData(float tempMax, float tempMin, int weatherCode, bool isValid);
+
+  // 最新の天気予報データを取得（コピーせずに参照する）
+  const WeatherData& getData() const { return weatherData_; }
+
+  // 現在の予報の取得元（"open-meteo", "file", "cache", "mesh"。未取得は "none"）
+  const char* getSource() const { return source_; }
+
+  /**
+   * 予報を取得してからの経過秒数
+   * @param nowEpoch 現在のUNIX時刻
+   * @return 経過秒数（取得時刻が不明な場合は 0）
+   */
+  uint32_t getAgeSec(uint32_t nowEpoch) const;
+
+  // 次の取得時刻（UNIX時刻、0: 時刻の同期後すぐ）
+  uint32_t getNextRefreshEpoch() const { return schedule_.getNextEpoch(); }
+
+  // 連続して取得に失敗した回数
+  uint32_t getRefreshFailures() const { return schedule_.getFailures(); }
 
 private:
-  // API設定
-  String apiUrl_;
+  float latitude_;
+  float longitude_;
+
+  // 取得元（先頭は Open-Meteo API）
+  OpenMeteoProvider openMeteo_;
+  ForecastProvider* providers_[MAX_PROVIDERS];
+  size_t providerCount_;
+  const char* source_;
 
   // 更新管理
-  int lastUpdateHour_;  // 最後に更新した時（0-23）
+  RefreshSchedule schedule_;
+  bool staleLogged_;    // 古い予報の警告を出力済み
+
+  // 別タスクでの取得（取得元の呼び出しは worker_ のタスク、結果の反映は loop()）
+  class FetchTask : public Coroutine {
+  public:
+    explicit FetchTask(WeatherForecast& owner) : owner_(owner) {}
+  protected:
+    bool run(uint32_t nowMs) override;
+  private:
+    WeatherForecast& owner_;
+  };
+
+  BackgroundWorker* worker_;  // nullptr: update() で取得の完了まで待つ
+  FetchTask fetchTask_;
+  bool locationPending_;      // 取得中に変更された地点（完了後に取得元へ設定）
+  ForecastValues fetched_;    // 取得した値（取得中は worker_ のタスクのみ書き込む）
+  const char* fetchedSource_; // 取得に成功した取得元（nullptr: すべて失敗）
 
   // 天気データ
   WeatherData weatherData_;
 
+  // 固定領域のバッファ（reserveBuffers() で割り当て）
+  static constexpr size_t BODY_SIZE = 1536;        // レスポンス本文（1日分でおよそ600バイト）
+  static constexpr size_t JSON_POOL_SIZE = 3072;   // JsonDocument の確保先
+  char* body_;
+  StaticArena jsonArena_;
+  ArenaJsonAllocator jsonAllocator_;
+
   // 内部処理関数
-  bool fetchWeatherData();
-  String weatherCodeToString(int code) const;
+  static void fetchJob(void* context);
+  const char* fetchValues(ForecastValues& values);
+  bool applyFetched(const char* source, const ForecastValues& values);
+  bool fetchAndReschedule();
+  bool reschedule(bool fetched);
+  void applyLocation();
+  void checkAge(uint32_t nowEpoch);
 };
 
 #endif // WEATHER_FORECAST_H
@@ -0,0 +1,66 @@
+/**
+ * WeatherParser.h
+ *
+ * Open-Meteo APIレスポンス（JSON）の解析（Arduino非依存）
+ */
+
+#ifndef WEATHER_PARSER_H
+#define WEATHER_PARSER_H
+
+#include <stddef.h>
+#include <ArduinoJson.h>
+#include "StaticArena.h"
+
+// 予報値（1日分）
+struct ForecastValues {
+  float tempMax;    // 最高気温 (°C)
+  float tempMin;    // 最低気温 (°C)
+  int weatherCode;  // 天気コード（WMO）
+};
+
+// 解析結果
+enum class ParseResult {
+  OK,           // 成功
+  JSON_ERROR,   // JSONとして不正
+  INCOMPLETE    // 必要な項目が不足
+};
+
+/**
+ * 固定領域から確保する JsonDocument 用アロケーター
+ * 解析の前に reset() で領域を戻して使い回します（ヒープを使わない）。
+ * 最後に確保したブロックの解放・拡張はその場で行い、それ以外の解放は reset() まで保留します。
+ */
+class ArenaJsonAllocator : public ArduinoJson::Allocator {
+public:
+  explicit ArenaJsonAllocator(StaticArena& arena);
+
+  void* allocate(size_t size) override;
+  void deallocate(void* pointer) override;
+  void* reallocate(void* pointer, size_t newSize) override;
+
+  // 領域を空に戻す（前回の JsonDocument を破棄してから呼び出す）
+  void reset();
+
+private:
+  StaticArena& arena_;
+  size_t start_;      // 生成時の使用位置
+  void* lastBlock_;   // 最後に確保したブロック
+  size_t lastMark_;   // 最後に確保したブロックの直前の使用位置
+};
+
+class WeatherParser {
+public:
+  /**
+   * daily=weather_code,temperature_2m_max,temperature_2m_min のレスポンスを解析
+   * @param json レスポンス本文
+   * @param length 本文の長さ（バイト）
+   * @param out 解析結果（出力、OK の場合のみ更新）
+   * @param allocator JsonDocument のアロケーター（nullptr なら既定のヒープ）
+   * @param errorMessage JSON_ERROR 時のエラー内容（出力、nullptr可）
+   */
+  static ParseResult parseDaily(const char* json, size_t length, ForecastValues& out,
+                                ArduinoJson::Allocator* allocator = nullptr,
+                                const char** errorMessage = nullptr);
+};
+
+#endif // WEATHER_PARSER_H
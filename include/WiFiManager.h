@@ -3,6 +3,7 @@
  *
  * WiFi接続管理クラス
  * WiFiの接続・切断監視・再接続を担当します。
+ * 再接続は loop() を止めないようコルーチンで接続の完了を待ちます。
  */
 
 #ifndef WIFI_MANAGER_H
@@ -10,6 +11,7 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
+#include "Coroutine.h"
 
 /**
  * WiFi接続管理クラス
@@ -17,7 +19,7 @@
  * 主な機能:
  * - WiFiアクセスポイントへの接続
  * - 接続状態の監視
- * - 切断時の自動再接続
+ * - 切断時の自動再接続（attach() 後はコルーチンで待機）
  */
 class WiFiManager {
 public:
@@ -29,19 +31,30 @@ public:
    */
   WiFiManager(const char* ssid, const char* password, unsigned long timeoutMs = 10000);
 
+  static constexpr uint32_t POLL_MS = 500;  // 接続待ちの確認間隔
+
   /**
-   * WiFiに接続
+   * WiFiに接続（接続の完了まで待つ。起動用タスク・ディープスリープの起床時に使用）
    * @return true: 接続成功, false: 接続失敗
    */
   bool connect();
 
+  /**
+   * 再接続のコルーチンを登録（setup() で呼び出す）
+   * 登録しない場合、checkConnection() は接続の完了まで待ちます。
+   */
+  bool attach(CoroutineScheduler& scheduler);
+
   /**
    * WiFi接続状態を確認し、切断時は再接続を試みる
-   * loop関数内で定期的に呼び出してください。
-   * @return true: 接続中, false: 切断中
+   * loop関数内で定期的に呼び出してください。attach() 後は再接続を開始してすぐに戻ります。
+   * @return true: 接続中, false: 切断中（再接続中を含む）
    */
   bool checkConnection();
 
+  // 再接続中か
+  bool isReconnecting() const { return reconnect_.isRunning(); }
+
   /**
    * WiFiが接続中かどうかを確認
    * @return true: 接続中, false: 切断中
@@ -54,9 +67,25 @@ public:
   void printConnectionInfo();
 
 private:
+  // 再接続（接続を開始し、完了・タイムアウトまで POLL_MS ごとに確認）
+  class ReconnectTask : public Coroutine {
+  public:
+    explicit ReconnectTask(WiFiManager& owner) : owner_(owner), startMs_(0) {}
+  protected:
+    bool run(uint32_t nowMs) override;
+  private:
+    WiFiManager& owner_;
+    uint32_t startMs_;
+  };
+
+  void beginConnect();
+  void onConnected();
+
   const char* ssid_;              // WiFi SSID
   const char* password_;          // WiFiパスワード
   unsigned long timeoutMs_;       // 接続タイムアウト時間
+  ReconnectTask reconnect_;
+  bool attached_;                 // 再接続のコルーチンを登録済み
 };
 
 #endif // WIFI_MANAGER_H
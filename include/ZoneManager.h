@@ -0,0 +1,133 @@
+/**
+ * ZoneManager.h
+ *
+ * 複数の部屋（ゾーン）のエアコンを1台の ESP32 で制御するクラス
+ *
+ * ゾーンごとに IR 送信ピン（AirConditionerController）・センサー・現在モード（ヒステリシス状態）を持ちます。
+ * - 判定: 制御周期ごとに evaluate() で全ゾーンをまとめて判定（時刻・天気予報の取得は1回）
+ * - 送信: モード変更はゾーンごとの送信待ちに積み、service() が1回に1フレームずつ、
+ *         前のフレームから IR_FRAME_GAP_MS 以上空けて送信（複数の送信機の信号が重ならない）
+ *
+ * ゾーン0（メイン）は loop() 側で判定し（MQTT の手動モード等があるため）、requestMode() で送信のみ依頼します。
+ */
+
+#ifndef ZONE_MANAGER_H
+#define ZONE_MANAGER_H
+
+#include <Arduino.h>
+#include "AirConditionerController.h"
+#include "EnvironmentSensor.h"
+
+// ゾーンの定義（main.cpp の ZoneConfig で使用）
+struct ZoneDefinition {
+  static constexpr uint8_t SHARED_SENSOR = 0xFF;  // センサーなし（メインのセンサー値を使用）
+
+  const char* name;
+  uint8_t irSendPin;
+  uint8_t dhtPin;
+};
+
+/**
+ * 送信完了時に呼ばれる関数（モードが変わった場合のみ。設定温度だけの変更では呼ばれない）
+ * @param zone ゾーン番号
+ * @param mode 送信したモード（設定温度を調整した指令は ACCommand::nearestMode()）
+ */
+typedef void (*ZoneSentHandler)(uint8_t zone, ACMode mode, void* context);
+
+/**
+ * 停止中のゾーンを運転させる（コンプレッサーが起動する）前に呼ばれる関数
+ * @return true: 今送信してよい, false: 送信待ちのまま後で再度確認
+ */
+typedef bool (*ZoneStartGate)(uint8_t zone, ACMode mode, void* context);
+
+class ZoneManager {
+public:
+  static constexpr uint8_t MAX_ZONES = 4;
+  static constexpr uint32_t IR_FRAME_GAP_MS = 500;  // 送信フレーム間の最小間隔
+
+  /**
+   * コンストラクタ
+   * @param handler 送信完了時に呼ぶ関数（nullptr 可）
+   */
+  ZoneManager(ZoneSentHandler handler = nullptr, void* context = nullptr);
+
+  /**
+   * ゾーンを追加
+   * @param ac 送信に使うコントローラー（begin() 済みであること）
+   * @param sensor ゾーンのセンサー（nullptr: evaluate() に渡すメインの値を使用）
+   * @param autoControl true: evaluate() で判定する, false: requestMode() のみ
+   * @return ゾーン番号（追加できない場合は -1）
+   */
+  int addZone(const char* name, AirConditionerController* ac, EnvironmentSensor* sensor, bool autoControl);
+
+  /**
+   * 起動の許可を問い合わせる関数を設定（複数台の連携で起動を分散する場合）
+   * @param gate nullptr: 常に許可
+   */
+  void setStartGate(ZoneStartGate gate, void* context) {
+    startGate_ = gate;
+    startGateContext_ = context;
+  }
+
+  // 登録済みのゾーン数
+  uint8_t getCount() const { return count_; }
+
+  // 全ゾーンの制御閾値を設定
+  void setThresholds(const PolicyThresholds& thresholds);
+
+  /**
+   * 自動制御のゾーンをまとめて判定し、変更があれば送信待ちに積む
+   * @param timeinfo 現在時刻
+   * @param weather 天気予報
+   * @param mainReading メインのセンサー値（センサーを持たないゾーンで使用）
+   */
+  void evaluate(const struct tm& timeinfo, const WeatherData& weather, const SensorData& mainReading);
+
+  /**
+   * モード変更を依頼（同じゾーンの未送信分は置き換え）
+   * @return true: 送信待ちに積んだ, false: 現在と同じモードのため不要
+   */
+  bool requestMode(uint8_t zone, ACMode mode);
+
+  /**
+   * 指令の送信を依頼（設定温度を調整する場合。同じゾーンの未送信分は置き換え）
+   * @return true: 送信待ちに積んだ, false: 現在と同じ指令のため不要
+   */
+  bool requestCommand(uint8_t zone, const ACCommand& command);
+
+  /**
+   * 送信待ちがあれば1フレーム送信（loop() から毎回呼び出す）
+   * @return true: 送信した
+   */
+  bool service();
+
+  // 送信待ちがあるか
+  bool hasPending() const;
+
+  // 次に送信できる時刻（millis()）
+  unsigned long getNextTransmitTime() const { return lastTransmitEnd_ + IR_FRAME_GAP_MS; }
+
+  // ゾーン情報
+  const char* getName(uint8_t zone) const { return zones_[zone].name; }
+  ACMode getMode(uint8_t zone) const { return zones_[zone].ac->getCurrentMode(); }
+
+private:
+  struct Zone {
+    const char* name;
+    AirConditionerController* ac;
+    EnvironmentSensor* sensor;
+    bool autoControl;
+    ACCommand pending;   // 不明: 送信待ちなし
+  };
+
+  Zone zones_[MAX_ZONES];
+  uint8_t count_;
+  uint8_t nextZone_;              // 送信待ちを探す開始位置（ゾーン間で順番に送信）
+  unsigned long lastTransmitEnd_;
+  ZoneSentHandler handler_;
+  void* context_;
+  ZoneStartGate startGate_;
+  void* startGateContext_;
+};
+
+#endif // ZONE_MANAGER_H
@@ -0,0 +1,137 @@
+/**
+ * ACCommand.cpp
+ *
+ * エアコンへの指令の実装
+ */
+
+#include "ACCommand.h"
+
+#include <math.h>
+
+namespace {
+  // 設定温度を 0.5℃ 単位の段数に変換（範囲外は上限・下限）
+  uint32_t setpointToSteps(float setpoint) {
+    if (!(setpoint >= ACCommand::MIN_SETPOINT)) {
+      setpoint = ACCommand::MIN_SETPOINT;
+    } else if (setpoint > ACCommand::MAX_SETPOINT) {
+      setpoint = ACCommand::MAX_SETPOINT;
+    }
+    return static_cast<uint32_t>(lroundf((setpoint - ACCommand::MIN_SETPOINT) * 2.0f));
+  }
+
+  // ACMode ごとの指令（ControlPolicy の判定結果をそのまま送信できるように）
+  struct ModePreset {
+    ACMode mode;
+    ACOperation operation;
+    float setpoint;
+  };
+
+  const ModePreset MODE_PRESETS[] = {
+    {ACMode::HEATING_23_5, ACOperation::HEAT, 23.5f},
+    {ACMode::HEATING_18, ACOperation::HEAT, 18.0f},
+    {ACMode::COOLING_25, ACOperation::COOL, 25.0f},
+    {ACMode::DEHUMID_MINUS_1_5, ACOperation::DRY, 24.5f},  // 26度 - 1.5度 = 24.5度
+  };
+}
+
+ACCommand ACCommand::run(ACOperation operation, float setpoint, ACFan fan) {
+  if (operation == ACOperation::OFF) {
+    return off();
+  }
+  return ACCommand(static_cast<uint32_t>(operation) | (setpointToSteps(setpoint) << 3) |
+                   (static_cast<uint32_t>(fan) << 9));
+}
+
+ACCommand ACCommand::fromMode(ACMode mode) {
+  if (mode == ACMode::OFF) {
+    return off();
+  }
+  for (const ModePreset& preset : MODE_PRESETS) {
+    if (preset.mode == mode) {
+      return run(preset.operation, preset.setpoint);
+    }
+  }
+  return ACCommand();
+}
+
+ACMode ACCommand::toMode() const {
+  if (isOff()) {
+    return ACMode::OFF;
+  }
+  for (const ModePreset& preset : MODE_PRESETS) {
+    if (fromMode(preset.mode) == *this) {
+      return preset.mode;
+    }
+  }
+  return ACMode::NONE;
+}
+
+ACMode ACCommand::nearestMode() const {
+  if (!isKnown() || isOff()) {
+    return toMode();
+  }
+  ACMode nearest = ACMode::NONE;
+  float nearestDiff = 0.0f;
+  for (const ModePreset& preset : MODE_PRESETS) {
+    if (preset.operation != getOperation()) {
+      continue;
+    }
+    float diff = fabsf(preset.setpoint - getSetpoint());
+    if (nearest == ACMode::NONE || diff < nearestDiff) {
+      nearest = preset.mode;
+      nearestDiff = diff;
+    }
+  }
+  return nearest;
+}
+
+// 停止・不明の指令は項目を変更しても停止・不明のまま
+
+ACCommand ACCommand::withSetpoint(float setpoint) const {
+  if (isOff() || !isKnown()) {
+    return *this;
+  }
+  return ACCommand((bits_ & ~FIELD_SETPOINT) | (setpointToSteps(setpoint) << 3));
+}
+
+ACCommand ACCommand::withFan(ACFan fan) const {
+  if (isOff() || !isKnown()) {
+    return *this;
+  }
+  return ACCommand((bits_ & ~FIELD_FAN) | (static_cast<uint32_t>(fan) << 9));
+}
+
+ACCommand ACCommand::withSwing(bool vertical, bool horizontal) const {
+  if (isOff() || !isKnown()) {
+    return *this;
+  }
+  uint32_t bits = bits_ & ~(FIELD_SWING_VERTICAL | FIELD_SWING_HORIZONTAL);
+  return ACCommand(bits | (vertical ? FIELD_SWING_VERTICAL : 0) | (horizontal ? FIELD_SWING_HORIZONTAL : 0));
+}
+
+ACCommand ACCommand::withPowerful(bool on) const {
+  if (isOff() || !isKnown()) {
+    return *this;
+  }
+  uint32_t bits = bits_ & ~FIELD_POWERFUL;
+  return ACCommand(on ? (bits & ~FIELD_ECONO) | FIELD_POWERFUL : bits);
+}
+
+ACCommand ACCommand::withEcono(bool on) const {
+  if (isOff() || !isKnown()) {
+    return *this;
+  }
+  uint32_t bits = bits_ & ~FIELD_ECONO;
+  return ACCommand(on ? (bits & ~FIELD_POWERFUL) | FIELD_ECONO : bits);
+}
+
+const char* ACCommand::operationToString(ACOperation operation) {
+  switch (operation) {
+    case ACOperation::HEAT: return "暖房";
+    case ACOperation::COOL: return "冷房";
+    case ACOperation::DRY:  return "除湿";
+    case ACOperation::FAN:  return "送風";
+    case ACOperation::AUTO: return "自動";
+    default:                return "停止";
+  }
+}
@@ -0,0 +1,97 @@
+/**
+ * AdaptiveSampler.cpp
+ *
+ * センサー読み取り間隔の調整の実装
+ */
+
+#include "AdaptiveSampler.h"
+
+#include <math.h>
+
+AdaptiveSampler::AdaptiveSampler(uint32_t minIntervalMs, uint32_t maxIntervalMs)
+  : minIntervalMs_(minIntervalMs),
+    maxIntervalMs_(maxIntervalMs),
+    intervalMs_(minIntervalMs),
+    thresholds_(DEFAULT_THRESHOLDS),
+    filtered_(false),
+    temperature_(0.0f),
+    humidity_(0.0f),
+    baseTemperature_(0.0f),
+    baseHumidity_(0.0f),
+    firstMs_(0),
+    lastReadMs_(0),
+    reads_(0),
+    saved_(0) {
+}
+
+void AdaptiveSampler::setMinInterval(uint32_t minIntervalMs) {
+  minIntervalMs_ = minIntervalMs;
+  if (intervalMs_ < minIntervalMs_) {
+    intervalMs_ = minIntervalMs_;
+  }
+}
+
+uint32_t AdaptiveSampler::onReading(uint32_t nowMs, bool valid, float temperature, float humidity) {
+  // 最短間隔で読み取った場合の回数との差（前回からの間隔で読めたはずの回数 - 1）
+  if (reads_ == 0) {
+    firstMs_ = nowMs;
+  } else if (minIntervalMs_ > 0) {
+    uint32_t possible = (nowMs - lastReadMs_) / minIntervalMs_;
+    saved_ += possible > 1 ? possible - 1 : 0;
+  }
+  reads_++;
+  lastReadMs_ = nowMs;
+
+  if (!valid) {
+    intervalMs_ = minIntervalMs_;
+    return intervalMs_;
+  }
+
+  bool moving;
+  if (!filtered_) {
+    filtered_ = true;
+    temperature_ = temperature;
+    humidity_ = humidity;
+    moving = true;  // 変化の基準がないため、最初は最短間隔
+  } else {
+    temperature_ += FILTER_ALPHA * (temperature - temperature_);
+    humidity_ += FILTER_ALPHA * (humidity - humidity_);
+    moving = fabsf(temperature_ - baseTemperature_) >= TEMP_STEP ||
+             fabsf(humidity_ - baseHumidity_) >= HUMIDITY_STEP;
+  }
+  if (moving) {
+    baseTemperature_ = temperature_;
+    baseHumidity_ = humidity_;
+  }
+
+  if (moving || nearEdge(temperature_, humidity_)) {
+    intervalMs_ = minIntervalMs_;
+  } else {
+    intervalMs_ = intervalMs_ >= maxIntervalMs_ / 2 ? maxIntervalMs_ : intervalMs_ * 2;
+  }
+  return intervalMs_;
+}
+
+float AdaptiveSampler::getReadsPerHour(uint32_t nowMs) const {
+  uint32_t elapsed = nowMs - firstMs_;
+  if (reads_ == 0 || elapsed == 0) {
+    return minIntervalMs_ > 0 ? 3600000.0f / minIntervalMs_ : 0.0f;
+  }
+  return reads_ * 3600000.0f / elapsed;
+}
+
+/**
+ * 制御の判定が変わりうる境界の近くか
+ * 暖房の開始（下限）・停止、冷房の停止・開始（上限）、除湿の開始（湿度上限）を見ます。
+ */
+bool AdaptiveSampler::nearEdge(float temperature, float humidity) const {
+  const float edges[] = {
+    thresholds_.tempLower, thresholds_.tempLowerOff(), thresholds_.tempUpperOff(), thresholds_.tempUpper,
+  };
+  for (float edge : edges) {
+    if (fabsf(temperature - edge) < TEMP_EDGE_MARGIN) {
+      return true;
+    }
+  }
+  return fabsf(humidity - thresholds_.humidityUpper) < HUMIDITY_EDGE_MARGIN;
+}
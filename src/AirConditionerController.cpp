@@ -8,34 +8,31 @@
  * - 夜間停止機能（春・秋・冬季の23:00〜7:00）
  * - 極寒日の特別対応（最低気温0度以下の場合は夜間も暖房18度で運転）
  * - 快適温度帯（24.5〜26.5度）と湿度帯（40〜60%）の維持
+ *
+ * モード決定ロジック本体は ControlPolicy に分離しています。
  */
 
 #include "AirConditionerController.h"
 #include <IRutils.h>
-
-// 温度・湿度の閾値設定
-namespace Threshold {
-  // 温度範囲
-  constexpr float TEMP_LOWER = 24.2f;   // 目標室温下限
-  constexpr float TEMP_UPPER = 26.5f;   // 目標室温上限
-
-  // ヒステリシス（不感帯）設定
-  constexpr float TEMP_HYSTERESIS = 0.3f;   // 温度ヒステリシス幅（℃）
-  constexpr float TEMP_LOWER_OFF = TEMP_LOWER + TEMP_HYSTERESIS;  // 暖房停止温度: 24.5℃
-  constexpr float TEMP_UPPER_OFF = TEMP_UPPER - TEMP_HYSTERESIS;  // 冷房停止温度: 26.2℃
-
-  // 湿度範囲
-  constexpr float HUMIDITY_LOWER = 40.0f;   // 目標湿度下限
-  constexpr float HUMIDITY_UPPER = 62.0f;   // 目標湿度上限
-  constexpr float HUMIDITY_HIGH = 65.0f;    // 高湿度の閾値
-  constexpr float HUMIDITY_VERY_HIGH = 70.0f; // 非常に高湿度の閾値
-}
+#include "Logger.h"
 
 /**
  * コンストラクタ
  */
 AirConditionerController::AirConditionerController(uint8_t sendPin, uint8_t recvPin)
-  : daikinAC_(sendPin), irRecv_(recvPin), currentMode_(ACMode::NONE) {
+  : daikinAC_(sendPin),
+    irRecv_(recvPin == NO_RECEIVER ? nullptr : new IRrecv(recvPin)),
+    receiveResume_(irRecv_),
+    attached_(false),
+    receiveHandler_(nullptr),
+    receiveContext_(nullptr),
+    currentMode_(ACMode::NONE),
+    currentCommand_(),
+    policy_(),
+    frameCache_(),
+    frameCacheNext_(0),
+    frameCacheHits_(0),
+    frameCacheMisses_(0) {
 }
 
 /**
@@ -43,84 +40,45 @@ AirConditionerController::AirConditionerController(uint8_t sendPin, uint8_t recv
  */
 void AirConditionerController::begin() {
   daikinAC_.begin();
-  irRecv_.enableIRIn();
-  Serial.println("[AC] エアコンコントローラー初期化完了");
+  if (irRecv_) {
+    irRecv_->enableIRIn();
+  }
+  LOG(AC_READY);
 }
 
 /**
  * エアコンの動作モードを設定
  */
 void AirConditionerController::setMode(ACMode mode) {
-  // 既に同じモードの場合はスキップ
-  if (mode == currentMode_) {
-    Serial.println("[AC] モード変更なし（すでに同じモード）");
-    return;
-  }
-
-  // 停止命令の場合、既に停止状態ならスキップ（受信音防止）
-  if (mode == ACMode::OFF && currentMode_ == ACMode::OFF) {
-    Serial.println("[AC] すでに停止状態のため、停止信号を送信しません");
-    return;
-  }
-
-  switch (mode) {
-    case ACMode::OFF:
-      sendOff();
-      break;
-    case ACMode::HEATING_23_5:
-      sendHeating23_5();
-      break;
-    case ACMode::HEATING_18:
-      sendHeating18();
-      break;
-    case ACMode::COOLING_25:
-      sendCooling25();
-      break;
-    case ACMode::DEHUMID_MINUS_1_5:
-      sendDehumidMinus1_5();
-      break;
-    default:
-      Serial.println("[AC] 無効なモード");
-      return;
-  }
-
-  currentMode_ = mode;
-}
-
-/**
- * 現在の季節を判定
- */
-Season AirConditionerController::getCurrentSeason(int month) const {
-  if (month >= 3 && month <= 5) {
-    return Season::SPRING;
-  } else if (month >= 6 && month <= 9) {
-    return Season::SUMMER;
-  } else if (month >= 10 && month <= 11) {
-    return Season::AUTUMN;
-  } else {
-    return Season::WINTER;
-  }
+  setCommand(ACCommand::fromMode(mode));
 }
 
 /**
- * 現在の時間帯を判定
+ * 指令を送信
+ * 詰めた値が現在と同じなら送信しません（停止中の停止も含め、受信音を防止）。
  */
-TimeOfDay AirConditionerController::getTimeOfDay(int hour) const {
-  if (hour >= 7 && hour < 23) {
-    return TimeOfDay::DAYTIME;
-  } else {
-    return TimeOfDay::NIGHT;
+bool AirConditionerController::setCommand(const ACCommand& command) {
+  if (!command.isKnown()) {
+    LOG(AC_INVALID_MODE);
+    return false;
   }
-}
 
-/**
- * 極寒日かどうかを判定（最低気温0度以下）
- */
-bool AirConditionerController::isExtremeColdDay(const WeatherData& weather) const {
-  if (!weather.isValid) {
+  uint32_t changed = command.diff(currentCommand_);
+  if (changed == 0) {
+    if (command.isOff()) {
+      LOG(AC_ALREADY_OFF);
+    } else {
+      LOG(AC_MODE_UNCHANGED);
+    }
     return false;
   }
-  return weather.tempMin <= 0.0f;
+  LOG(AC_COMMAND_DIFF, currentCommand_.packed(), command.packed(), changed);
+
+  sendFrame(command);
+
+  currentCommand_ = command;
+  currentMode_ = command.toMode();
+  return true;
 }
 
 /**
@@ -131,195 +89,118 @@ ACMode AirConditionerController::determineOptimalMode(float temperature, float h
   // 現在の時刻を取得
   struct tm timeinfo;
   if (!timeMgr.getCurrentTime(timeinfo)) {
-    Serial.println("[AC] 時刻取得失敗、デフォルトモード");
+    LOG(AC_TIME_FAIL);
     return ACMode::OFF;
   }
-
-  int month = timeinfo.tm_mon + 1;  // tm_monは0-11なので+1
-  int hour = timeinfo.tm_hour;
-
-  Season season = getCurrentSeason(month);
-  TimeOfDay timeOfDay = getTimeOfDay(hour);
-  bool isExtremeCold = isExtremeColdDay(weather);
-
-  Serial.printf("[AC] 温度:%.1f℃, 湿度:%.1f%%, 月:%d, 時:%d\n", temperature, humidity, month, hour);
-
-  // 季節別に制御ロジックを実行
-  ACMode mode;
-  switch (season) {
-    case Season::SPRING:
-      Serial.println("[AC] 季節: 春季");
-      mode = determineSpringMode(temperature, humidity, timeOfDay);
-      break;
-    case Season::SUMMER:
-      Serial.println("[AC] 季節: 夏季");
-      mode = determineSummerMode(temperature, humidity);
-      break;
-    case Season::AUTUMN:
-      Serial.println("[AC] 季節: 秋季");
-      mode = determineAutumnMode(temperature, humidity, timeOfDay);
-      break;
-    case Season::WINTER:
-      Serial.println("[AC] 季節: 冬季");
-      mode = determineWinterMode(temperature, humidity, timeOfDay, isExtremeCold);
-      break;
-    default:
-      mode = ACMode::OFF;
-  }
-
-  return mode;
+  return determineOptimalMode(temperature, humidity, timeinfo, weather);
 }
 
 /**
- * 春季（3〜5月）の制御ロジック
+ * 取得済みの時刻で最適なモードを決定
  */
-ACMode AirConditionerController::determineSpringMode(float temperature, float humidity, TimeOfDay timeOfDay) {
-  // 夜間は停止
-  if (timeOfDay == TimeOfDay::NIGHT) {
-    Serial.println("[AC] 春季・夜間 → 停止");
-    return ACMode::OFF;
-  }
+ACMode AirConditionerController::determineOptimalMode(float temperature, float humidity,
+                                                      const struct tm& timeinfo, const WeatherData& weather) {
+  PolicyInput input = makeInput(temperature, humidity, timeinfo, weather);
 
-  // 日中の制御（ヒステリシス付き）
-  if (temperature < Threshold::TEMP_LOWER) {
-    // 24.2度未満 → 暖房23.5度
-    Serial.printf("[AC] 春季・日中: 室温%.1f℃ < %.1f℃ → 暖房23.5度\n", temperature, Threshold::TEMP_LOWER);
-    return ACMode::HEATING_23_5;
-  } else if (currentMode_ == ACMode::HEATING_23_5 && temperature < Threshold::TEMP_LOWER_OFF) {
-    // 暖房中で24.5度未満 → 暖房継続（ヒステリシス）
-    Serial.printf("[AC] 春季・日中: 暖房中（室温%.1f℃ < %.1f℃）→ 暖房継続\n", temperature, Threshold::TEMP_LOWER_OFF);
-    return ACMode::HEATING_23_5;
-  } else if (temperature > Threshold::TEMP_UPPER) {
-    // 26.5度超 → 冷房25度
-    Serial.printf("[AC] 春季・日中: 室温%.1f℃ > %.1f℃ → 冷房25度\n", temperature, Threshold::TEMP_UPPER);
-    return ACMode::COOLING_25;
-  } else if (currentMode_ == ACMode::COOLING_25 && temperature > Threshold::TEMP_UPPER_OFF) {
-    // 冷房中で26.2度超 → 冷房継続（ヒステリシス）
-    Serial.printf("[AC] 春季・日中: 冷房中（室温%.1f℃ > %.1f℃）→ 冷房継続\n", temperature, Threshold::TEMP_UPPER_OFF);
-    return ACMode::COOLING_25;
-  } else {
-    // 快適範囲内 → 停止（春季は除湿を行わない）
-    Serial.printf("[AC] 春季・日中: 快適範囲内（温度%.1f℃, 湿度%.1f%%）→ 停止\n", temperature, humidity);
-    return ACMode::OFF;
-  }
+  // 季節別の制御ロジックを実行
+  PolicyDecision decision = policy_.decide(input, currentMode_);
+  printDecision(decision, temperature, humidity);
+
+  return decision.mode;
 }
 
 /**
- * 夏季（6〜9月）の制御ロジック（24時間運転）
+ * 設定温度を調整する制御で指令を決定
+ * オン・オフ制御の判定（ログ出力を含む）を先に行い、その結果をもとに調整します。
  */
-ACMode AirConditionerController::determineSummerMode(float temperature, float humidity) {
-  // 過冷房防止（24.2度未満で停止）
-  if (temperature < Threshold::TEMP_LOWER) {
-    Serial.printf("[AC] 夏季: 室温%.1f℃ < %.1f℃ → 過冷房防止のため停止\n", temperature, Threshold::TEMP_LOWER);
-    return ACMode::OFF;
-  }
-
-  // 冷房運転中のヒステリシス判定
-  if (currentMode_ == ACMode::COOLING_25 && temperature > Threshold::TEMP_UPPER_OFF) {
-    // 冷房中で26.2度超 → 冷房継続（ヒステリシス）
-    Serial.printf("[AC] 夏季: 冷房中（室温%.1f℃ > %.1f℃）→ 冷房継続\n", temperature, Threshold::TEMP_UPPER_OFF);
-    return ACMode::COOLING_25;
-  }
-
-  // 除湿運転中のヒステリシス判定
-  if (currentMode_ == ACMode::DEHUMID_MINUS_1_5) {
-    if (temperature > Threshold::TEMP_UPPER_OFF && humidity > Threshold::HUMIDITY_UPPER) {
-      // 除湿中で条件継続 → 除湿継続（ヒステリシス）
-      Serial.printf("[AC] 夏季: 除湿中（室温%.1f℃ > %.1f℃, 湿度%.1f%% > %.1f%%）→ 除湿継続\n",
-                    temperature, Threshold::TEMP_UPPER_OFF, humidity, Threshold::HUMIDITY_UPPER);
-      return ACMode::DEHUMID_MINUS_1_5;
-    }
-  }
-
-  // 新規起動判定
-  if (temperature > Threshold::TEMP_UPPER) {
-    // 26.5度超 → 冷房25度
-    Serial.printf("[AC] 夏季: 室温%.1f℃ > %.1f℃ → 冷房25度\n", temperature, Threshold::TEMP_UPPER);
-    return ACMode::COOLING_25;
-  } else if (temperature >= Threshold::TEMP_LOWER && temperature <= Threshold::TEMP_UPPER) {
-    // 快適温度範囲内
-    if (humidity > Threshold::HUMIDITY_UPPER) {
-      // 湿度62%超 → 除湿
-      Serial.printf("[AC] 夏季: 湿度%.1f%% > %.1f%% → 除湿-1.5度\n", humidity, Threshold::HUMIDITY_UPPER);
-      return ACMode::DEHUMID_MINUS_1_5;
-    } else {
-      // 湿度も快適範囲内 → 停止
-      Serial.printf("[AC] 夏季: 快適範囲内（温度%.1f℃, 湿度%.1f%%）→ 停止\n", temperature, humidity);
-      return ACMode::OFF;
-    }
+ACCommand AirConditionerController::determineCommand(float temperature, float humidity, const struct tm& timeinfo,
+                                                     const WeatherData& weather, SetpointModulator& modulator,
+                                                     uint32_t nowMs) {
+  PolicyInput input = makeInput(temperature, humidity, timeinfo, weather);
+  PolicyDecision decision = policy_.decide(input, modulator.getBaselineMode());
+  printDecision(decision, temperature, humidity);
+
+  ACCommand command = modulator.update(decision, temperature, policy_.getThresholds(), currentCommand_, nowMs);
+  switch (modulator.getLastAction()) {
+    case ModulatorAction::START:
+      LOG(MOD_START, ACCommand::operationToString(command.getOperation()), command.getSetpoint(),
+          modulator.getTarget());
+      break;
+    case ModulatorAction::RAISE:
+    case ModulatorAction::LOWER:
+      LOG(MOD_STEP, currentCommand_.getSetpoint(), command.getSetpoint(), modulator.getFilteredTemperature(),
+          modulator.getTarget());
+      break;
+    case ModulatorAction::KEEP:
+      LOG(MOD_KEEP, command.getSetpoint(), modulator.getFilteredTemperature(), modulator.getTarget());
+      break;
+    case ModulatorAction::RELEASE:
+      LOG(MOD_RELEASE, modulator.getFilteredTemperature(), modulator.getTarget());
+      break;
+    default:
+      break;
   }
-
-  return ACMode::OFF;
+  return command;
 }
 
 /**
- * 秋季（10〜11月）の制御ロジック
+ * 制御ポリシーへの入力を作成（変換は ControlPolicy::makeInput() と共通）
  */
-ACMode AirConditionerController::determineAutumnMode(float temperature, float humidity, TimeOfDay timeOfDay) {
-  // 夜間は停止
-  if (timeOfDay == TimeOfDay::NIGHT) {
-    Serial.println("[AC] 秋季・夜間 → 停止");
-    return ACMode::OFF;
-  }
-
-  // 日中の制御（春季と同じロジック、ヒステリシス付き）
-  if (temperature < Threshold::TEMP_LOWER) {
-    // 24.2度未満 → 暖房23.5度
-    Serial.printf("[AC] 秋季・日中: 室温%.1f℃ < %.1f℃ → 暖房23.5度\n", temperature, Threshold::TEMP_LOWER);
-    return ACMode::HEATING_23_5;
-  } else if (currentMode_ == ACMode::HEATING_23_5 && temperature < Threshold::TEMP_LOWER_OFF) {
-    // 暖房中で24.5度未満 → 暖房継続（ヒステリシス）
-    Serial.printf("[AC] 秋季・日中: 暖房中（室温%.1f℃ < %.1f℃）→ 暖房継続\n", temperature, Threshold::TEMP_LOWER_OFF);
-    return ACMode::HEATING_23_5;
-  } else if (temperature > Threshold::TEMP_UPPER) {
-    // 26.5度超 → 冷房25度
-    Serial.printf("[AC] 秋季・日中: 室温%.1f℃ > %.1f℃ → 冷房25度\n", temperature, Threshold::TEMP_UPPER);
-    return ACMode::COOLING_25;
-  } else if (currentMode_ == ACMode::COOLING_25 && temperature > Threshold::TEMP_UPPER_OFF) {
-    // 冷房中で26.2度超 → 冷房継続（ヒステリシス）
-    Serial.printf("[AC] 秋季・日中: 冷房中（室温%.1f℃ > %.1f℃）→ 冷房継続\n", temperature, Threshold::TEMP_UPPER_OFF);
-    return ACMode::COOLING_25;
-  } else {
-    // 快適範囲内 → 停止（秋季は除湿を行わない）
-    Serial.printf("[AC] 秋季・日中: 快適範囲内（温度%.1f℃, 湿度%.1f%%）→ 停止\n", temperature, humidity);
-    return ACMode::OFF;
-  }
+PolicyInput AirConditionerController::makeInput(float temperature, float humidity, const struct tm& timeinfo,
+                                                const WeatherData& weather) const {
+  PolicyInput input = ControlPolicy::makeInput(temperature, humidity, timeinfo, weather);
+  LOG(AC_INPUT, temperature, humidity, input.month, input.hour);
+  return input;
 }
 
 /**
- * 冬季（12〜2月）の制御ロジック
+ * 判定結果をログ出力
  */
-ACMode AirConditionerController::determineWinterMode(float temperature, float humidity,
-                                                     TimeOfDay timeOfDay, bool isExtremeCold) {
-  // 極寒日の夜間は暖房18度で継続運転
-  if (timeOfDay == TimeOfDay::NIGHT && isExtremeCold) {
-    Serial.println("[AC] 冬季・夜間・極寒日（最低気温0度以下）→ 暖房18度");
-    return ACMode::HEATING_18;
-  }
-
-  // 通常の夜間は停止
-  if (timeOfDay == TimeOfDay::NIGHT) {
-    Serial.println("[AC] 冬季・夜間 → 停止（コスト削減優先）");
-    return ACMode::OFF;
-  }
-
-  // 日中の制御（ヒステリシス付き）
-  if (temperature < Threshold::TEMP_LOWER) {
-    // 24.2度未満 → 暖房23.5度
-    Serial.printf("[AC] 冬季・日中: 室温%.1f℃ < %.1f℃ → 暖房23.5度\n", temperature, Threshold::TEMP_LOWER);
-    return ACMode::HEATING_23_5;
-  } else if (currentMode_ == ACMode::HEATING_23_5 && temperature < Threshold::TEMP_LOWER_OFF) {
-    // 暖房中で24.5度未満 → 暖房継続（ヒステリシス）
-    Serial.printf("[AC] 冬季・日中: 暖房中（室温%.1f℃ < %.1f℃）→ 暖房継続\n", temperature, Threshold::TEMP_LOWER_OFF);
-    return ACMode::HEATING_23_5;
-  } else if (temperature >= Threshold::TEMP_LOWER_OFF && temperature <= Threshold::TEMP_UPPER) {
-    // 快適範囲内 → 停止
-    Serial.printf("[AC] 冬季・日中: 快適範囲内（温度%.1f℃）→ 停止\n", temperature);
-    return ACMode::OFF;
-  } else {
-    // 26.5度超 → 自然冷却待ち（冷房・除湿は使用しない）
-    Serial.printf("[AC] 冬季・日中: 室温%.1f℃ > %.1f℃ → 自然冷却待ち（停止）\n", temperature, Threshold::TEMP_UPPER);
-    return ACMode::OFF;
+void AirConditionerController::printDecision(const PolicyDecision& decision,
+                                             float temperature, float humidity) const {
+  const PolicyThresholds& th = policy_.getThresholds();
+  const char* season = ControlPolicy::seasonToString(decision.season);
+  const char* period = (decision.season == Season::SUMMER) ? ""
+                     : (decision.timeOfDay == TimeOfDay::DAYTIME) ? "・日中" : "・夜間";
+
+  LOG(AC_SEASON, season);
+
+  switch (decision.reason) {
+    case PolicyReason::NIGHT_OFF:
+      LOG(AC_NIGHT_OFF, season, period);
+      break;
+    case PolicyReason::EXTREME_COLD_NIGHT:
+      LOG(AC_EXTREME_COLD_NIGHT, season, period);
+      break;
+    case PolicyReason::HEAT_START:
+      LOG(AC_HEAT_START, season, period, temperature, th.tempLower);
+      break;
+    case PolicyReason::HEAT_HOLD:
+      LOG(AC_HEAT_HOLD, season, period, temperature, th.tempLowerOff());
+      break;
+    case PolicyReason::COOL_START:
+      LOG(AC_COOL_START, season, period, temperature, th.tempUpper);
+      break;
+    case PolicyReason::COOL_HOLD:
+      LOG(AC_COOL_HOLD, season, period, temperature, th.tempUpperOff());
+      break;
+    case PolicyReason::DEHUMID_START:
+      LOG(AC_DEHUMID_START, season, period, humidity, th.humidityUpper);
+      break;
+    case PolicyReason::DEHUMID_HOLD:
+      LOG(AC_DEHUMID_HOLD, season, period, temperature, th.tempUpperOff(), humidity, th.humidityUpper);
+      break;
+    case PolicyReason::COMFORT_OFF:
+      LOG(AC_COMFORT_OFF, season, period, temperature, humidity);
+      break;
+    case PolicyReason::OVERCOOL_OFF:
+      LOG(AC_OVERCOOL_OFF, season, period, temperature, th.tempLower);
+      break;
+    case PolicyReason::WARM_WAIT_OFF:
+      LOG(AC_WARM_WAIT_OFF, season, period, temperature, th.tempUpper);
+      break;
+    default:
+      break;
   }
 }
 
@@ -329,136 +210,141 @@ ACMode AirConditionerController::determineWinterMode(float temperature, float hu
 void AirConditionerController::handleIRReceive() {
   decode_results results;
 
-  if (irRecv_.decode(&results)) {
-    Serial.println("====================================");
-    Serial.print("[IR] 受信コード: ");
-    serialPrintUint64(results.value, HEX);
-    Serial.println();
-    Serial.print("[IR] プロトコル: ");
-    Serial.println(typeToString(results.decode_type));
-    Serial.print("[IR] ビット数: ");
-    Serial.println(results.bits);
-
-    Serial.print("uint16_t rawData[");
-    Serial.print(results.rawlen - 1);
-    Serial.println("] = {");
-    Serial.print("  ");
+  // 送信後の受信の停止中は読まない
+  if (irRecv_ && !receiveResume_.isRunning() && irRecv_->decode(&results)) {
+    LOG(IR_SEPARATOR);
+    char code[17];  // 64ビットの16進数 + null終端（uint64ToString は String を確保するため使わない）
+    snprintf(code, sizeof(code), "%llx", static_cast<unsigned long long>(results.value));
+    LOG(IR_CODE, code);
+    LOG(IR_PROTOCOL, static_cast<int>(results.decode_type));
+    LOG(IR_BITS, results.bits);
+
+    // 生データは10個ずつ1レコードにまとめる（μs、65535で頭打ち）
+    LOG(IR_RAW_BEGIN, results.rawlen - 1);
+    uint16_t line[IR_RAW_VALUES_PER_LINE];
+    uint8_t count = 0;
     for (uint16_t i = 1; i < results.rawlen; i++) {
-      Serial.print(results.rawbuf[i] * kRawTick);
-      if (i < results.rawlen - 1) Serial.print(", ");
-      if (i % 10 == 0) Serial.print("\n  ");
+      uint32_t us = static_cast<uint32_t>(results.rawbuf[i]) * kRawTick;
+      line[count++] = us > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(us);
+      bool last = (i == results.rawlen - 1);
+      if (count == IR_RAW_VALUES_PER_LINE || last) {
+        LogU16Array values = {line, count};
+        if (last) {
+          LOG(IR_RAW_LAST_LINE, values);
+        } else {
+          LOG(IR_RAW_LINE, values);
+        }
+        count = 0;
+      }
+    }
+    LOG(IR_RAW_END);
+    LOG(IR_SEPARATOR);
+
+    if (receiveHandler_) {
+      receiveHandler_(static_cast<int16_t>(results.decode_type), results.bits, results.value, receiveContext_);
     }
-    Serial.println("\n};");
-    Serial.println("====================================");
 
-    irRecv_.resume();
+    irRecv_->resume();
   }
 }
 
 /**
- * エアコンを停止（電源オフ）
+ * 指令のIRフレーム（Daikinステート）を取得
+ * 同じ指令のフレームは毎回同じため、生成済みのものはキャッシュから返します。
+ * キャッシュにない場合はダイキンのステートに設定して生成し、最も古いものと入れ替えます。
  */
-void AirConditionerController::sendOff() {
-  Serial.println("[AC] エアコン停止 送信開始");
-
-  irRecv_.disableIRIn();
-  daikinAC_.off();
-  daikinAC_.send();
-
-  Serial.println("[AC] エアコン停止 送信完了");
+const uint8_t* AirConditionerController::encodeFrame(const ACCommand& command) {
+  if (!command.isKnown()) {
+    return nullptr;
+  }
+  for (const CachedFrame& cached : frameCache_) {
+    if (cached.command == command) {
+      frameCacheHits_++;
+      return cached.state;
+    }
+  }
 
-  delay(200);
-  irRecv_.enableIRIn();
+  frameCacheMisses_++;
+  applyCommand(command);
+  CachedFrame& slot = frameCache_[frameCacheNext_];
+  frameCacheNext_ = (frameCacheNext_ + 1) % FRAME_CACHE_SIZE;
+  slot.command = command;
+  memcpy(slot.state, daikinAC_.getRaw(), kDaikinStateLength);
+  return slot.state;
 }
 
 /**
- * 暖房23.5度の信号を送信
+ * ダイキンのステートに指令を設定
  */
-void AirConditionerController::sendHeating23_5() {
-  Serial.println("[AC] 暖房23.5度 送信開始");
-
-  irRecv_.disableIRIn();
-
-  daikinAC_.on();
-  daikinAC_.setMode(kDaikinHeat);
-  daikinAC_.setTemp(23.5);
-  daikinAC_.setFan(kDaikinFanAuto);
-  daikinAC_.setSwingVertical(false);
-  daikinAC_.setSwingHorizontal(false);
-
-  daikinAC_.send();
-
-  Serial.println("[AC] 暖房23.5度 送信完了");
-
-  delay(200);
-  irRecv_.enableIRIn();
-}
+void AirConditionerController::applyCommand(const ACCommand& command) {
+  if (command.isOff()) {
+    daikinAC_.off();
+    return;
+  }
 
-/**
- * 暖房18度の信号を送信（極寒日の夜間用）
- */
-void AirConditionerController::sendHeating18() {
-  Serial.println("[AC] 暖房18度 送信開始");
+  uint8_t daikinMode;
+  switch (command.getOperation()) {
+    case ACOperation::HEAT: daikinMode = kDaikinHeat; break;
+    case ACOperation::COOL: daikinMode = kDaikinCool; break;
+    case ACOperation::DRY:  daikinMode = kDaikinDry; break;
+    case ACOperation::FAN:  daikinMode = kDaikinFan; break;
+    default:                daikinMode = kDaikinAuto; break;
+  }
 
-  irRecv_.disableIRIn();
+  uint8_t daikinFan;
+  switch (command.getFan()) {
+    case ACFan::AUTO:  daikinFan = kDaikinFanAuto; break;
+    case ACFan::QUIET: daikinFan = kDaikinFanQuiet; break;
+    default:
+      // LEVEL_1〜LEVEL_5 → 1〜5
+      daikinFan = static_cast<uint8_t>(command.getFan()) - static_cast<uint8_t>(ACFan::LEVEL_1) + kDaikinFanMin;
+      break;
+  }
 
   daikinAC_.on();
-  daikinAC_.setMode(kDaikinHeat);
-  daikinAC_.setTemp(18);
-  daikinAC_.setFan(kDaikinFanAuto);
-  daikinAC_.setSwingVertical(false);
-  daikinAC_.setSwingHorizontal(false);
-
-  daikinAC_.send();
-
-  Serial.println("[AC] 暖房18度 送信完了");
-
-  delay(200);
-  irRecv_.enableIRIn();
+  daikinAC_.setMode(daikinMode);
+  daikinAC_.setTemp(command.getSetpoint());
+  daikinAC_.setFan(daikinFan);
+  daikinAC_.setSwingVertical(command.getSwingVertical());
+  daikinAC_.setSwingHorizontal(command.getSwingHorizontal());
+  daikinAC_.setPowerful(command.getPowerful());
+  daikinAC_.setEcono(command.getEcono());
 }
 
 /**
- * 冷房25度の信号を送信
+ * 指令の信号を送信
  */
-void AirConditionerController::sendCooling25() {
-  Serial.println("[AC] 冷房25度 送信開始");
-
-  irRecv_.disableIRIn();
-
-  daikinAC_.on();
-  daikinAC_.setMode(kDaikinCool);
-  daikinAC_.setTemp(25);
-  daikinAC_.setFan(kDaikinFanAuto);
-  daikinAC_.setSwingVertical(false);
-  daikinAC_.setSwingHorizontal(false);
+void AirConditionerController::sendFrame(const ACCommand& command) {
+  ACMode mode = command.toMode();
+  const char* name = mode != ACMode::NONE ? ControlPolicy::modeToString(mode)
+                                          : ACCommand::operationToString(command.getOperation());
+  LOG(AC_SEND_START, name);
+
+  if (irRecv_) {
+    irRecv_->disableIRIn();
+  }
 
+  daikinAC_.setRaw(encodeFrame(command));
   daikinAC_.send();
 
-  Serial.println("[AC] 冷房25度 送信完了");
+  LOG(AC_SEND_DONE, name);
 
-  delay(200);
-  irRecv_.enableIRIn();
+  if (irRecv_ && attached_) {
+    receiveResume_.start(millis());
+  } else if (irRecv_) {
+    delay(RECEIVE_RESUME_MS);
+    irRecv_->enableIRIn();
+  }
 }
 
-/**
- * 除湿-1.5度の信号を送信
- */
-void AirConditionerController::sendDehumidMinus1_5() {
-  Serial.println("[AC] 除湿-1.5度 送信開始");
-
-  irRecv_.disableIRIn();
-
-  daikinAC_.on();
-  daikinAC_.setMode(kDaikinDry);
-  daikinAC_.setTemp(24.5);  // 26度 - 1.5度 = 24.5度
-  daikinAC_.setFan(kDaikinFanAuto);
-  daikinAC_.setSwingVertical(false);
-  daikinAC_.setSwingHorizontal(false);
-
-  daikinAC_.send();
-
-  Serial.println("[AC] 除湿-1.5度 送信完了");
+bool AirConditionerController::attach(CoroutineScheduler& scheduler) {
+  attached_ = irRecv_ != nullptr && scheduler.add(&receiveResume_);
+  return attached_;
+}
 
-  delay(200);
-  irRecv_.enableIRIn();
+bool AirConditionerController::ReceiveResumeTask::run(uint32_t nowMs) {
+  CO_BEGIN();
+  CO_SLEEP(RECEIVE_RESUME_MS);
+  irRecv_->enableIRIn();
+  CO_END();
 }
@@ -0,0 +1,156 @@
+/**
+ * AllocCounter.cpp
+ *
+ * ヒープ確保の回数計測の実装
+ */
+
+#include "AllocCounter.h"
+#include "Logger.h"
+
+#if ALLOC_COUNTER_ENABLED
+
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_debug_helpers.h>
+
+namespace {
+  TaskHandle_t watchedTask = nullptr;
+  volatile uint32_t taskCount = 0;  // 監視対象のタスクだけが更新する
+  uint32_t exemptionDepth = 0;      // 監視対象のタスクの AllocExemption の入れ子の深さ（同上）
+  uint32_t totalCount = 0;          // 全タスク（アトミックに更新）
+
+  // 初期化後の呼び出し元（seal() 以降に記録）
+  volatile bool sealed = false;
+  AllocSite sites[AllocCounter::MAX_SITES];
+  size_t siteCount = 0;
+  uint32_t untrackedCount = 0;
+  portMUX_TYPE sitesLock = portMUX_INITIALIZER_UNLOCKED;
+
+  // 先頭から除くフレーム（recordSite・__wrap_*）
+  constexpr size_t SKIP_FRAMES = 2;
+
+  /**
+   * スタックをたどって呼び出し元を記録
+   * フレームの数が変わらないよう、インライン展開しない
+   */
+  __attribute__((noinline)) void recordSite(size_t size) {
+    uint32_t pc[AllocSite::DEPTH] = {};
+    esp_backtrace_frame_t frame;
+    esp_backtrace_get_start(&frame.pc, &frame.sp, &frame.next_pc);
+    for (size_t i = 0; i < SKIP_FRAMES + AllocSite::DEPTH; i++) {
+      if (i >= SKIP_FRAMES) {
+        pc[i - SKIP_FRAMES] = esp_cpu_process_stack_pc(frame.pc);
+      }
+      if (frame.next_pc == 0 || !esp_backtrace_get_next_frame(&frame)) {
+        break;
+      }
+    }
+
+    portENTER_CRITICAL(&sitesLock);
+    size_t i = 0;
+    while (i < siteCount && memcmp(sites[i].pc, pc, sizeof(pc)) != 0) {
+      i++;
+    }
+    if (i < siteCount) {
+      sites[i].count++;
+      sites[i].bytes += size;
+    } else if (siteCount < AllocCounter::MAX_SITES) {
+      memcpy(sites[siteCount].pc, pc, sizeof(pc));
+      sites[siteCount].count = 1;
+      sites[siteCount].bytes = size;
+      siteCount++;
+    } else {
+      untrackedCount++;
+    }
+    portEXIT_CRITICAL(&sitesLock);
+  }
+
+  inline void countAllocation(size_t size) {
+    __atomic_fetch_add(&totalCount, 1, __ATOMIC_RELAXED);
+    if (watchedTask != nullptr && xTaskGetCurrentTaskHandle() == watchedTask && exemptionDepth == 0) {
+      taskCount = taskCount + 1;
+    }
+    if (sealed) {
+      recordSite(size);
+    }
+  }
+}
+
+// リンカーの --wrap による置き換え（__real_* が元の関数）
+extern "C" {
+  void* __real_malloc(size_t size);
+  void* __real_calloc(size_t count, size_t size);
+  void* __real_realloc(void* ptr, size_t size);
+
+  void* __wrap_malloc(size_t size) {
+    countAllocation(size);
+    return __real_malloc(size);
+  }
+
+  void* __wrap_calloc(size_t count, size_t size) {
+    countAllocation(count * size);
+    return __real_calloc(count, size);
+  }
+
+  void* __wrap_realloc(void* ptr, size_t size) {
+    countAllocation(size);
+    return __real_realloc(ptr, size);
+  }
+}
+
+void AllocCounter::watchCurrentTask() {
+  taskCount = 0;
+  watchedTask = xTaskGetCurrentTaskHandle();
+}
+
+uint32_t AllocCounter::takeTaskCount() {
+  // 監視対象のタスク自身から呼び出すため、読み取りとリセットの間に増えることはない
+  uint32_t count = taskCount;
+  taskCount = 0;
+  return count;
+}
+
+void AllocCounter::beginExemption() {
+  if (xTaskGetCurrentTaskHandle() == watchedTask) {
+    exemptionDepth++;
+  }
+}
+
+void AllocCounter::endExemption() {
+  if (xTaskGetCurrentTaskHandle() == watchedTask && exemptionDepth > 0) {
+    exemptionDepth--;
+  }
+}
+
+uint32_t AllocCounter::getTotal() {
+  return __atomic_load_n(&totalCount, __ATOMIC_RELAXED);
+}
+
+void AllocCounter::seal() {
+  sealed = true;
+}
+
+size_t AllocCounter::getSites(AllocSite* out, size_t max) {
+  portENTER_CRITICAL(&sitesLock);
+  size_t count = siteCount < max ? siteCount : max;
+  memcpy(out, sites, count * sizeof(AllocSite));
+  portEXIT_CRITICAL(&sitesLock);
+  return count;
+}
+
+uint32_t AllocCounter::getUntrackedCount() {
+  return untrackedCount;
+}
+
+void AllocCounter::printSites() {
+  // ログ出力中の確保で表が変わらないよう、先に写してから出力
+  AllocSite copy[MAX_SITES];
+  size_t count = getSites(copy, MAX_SITES);
+  LOG(ALLOC_SITES_HEADER, static_cast<uint32_t>(count), getUntrackedCount());
+  for (size_t i = 0; i < count; i++) {
+    LOG(ALLOC_SITE, copy[i].pc[0], copy[i].pc[1], copy[i].pc[2], copy[i].count, copy[i].bytes);
+  }
+}
+
+#endif // ALLOC_COUNTER_ENABLED
@@ -5,6 +5,7 @@
  */
 
 #include "AutoStopController.h"
+#include "Logger.h"
 
 /**
  * コンストラクタ
@@ -40,7 +41,7 @@ bool AutoStopController::check() {
 
   // デバッグ用：1時間に1回、現在時刻を表示
   if (currentHour != lastPrintedHour_) {
-    Serial.printf("[AutoStop] 現在時刻: %02d時, 月: %d月\n", currentHour, currentMonth);
+    LOG(AUTOSTOP_NOW, currentHour, currentMonth);
     lastPrintedHour_ = currentHour;
   }
 
@@ -52,10 +53,9 @@ bool AutoStopController::check() {
 
   // 指定時刻で、まだ今日停止していない場合
   if (currentHour == stopHour_ && !stoppedToday_) {
-    Serial.println("[AutoStop] ========================================");
-    Serial.printf("[AutoStop] %d時になりました。エアコンを自動停止します（%d月は対象期間）\n",
-                  stopHour_, currentMonth);
-    Serial.println("[AutoStop] ========================================");
+    LOG(AUTOSTOP_SEPARATOR);
+    LOG(AUTOSTOP_TRIGGER, stopHour_, currentMonth);
+    LOG(AUTOSTOP_SEPARATOR);
 
     // エアコンを停止
     ac_.setMode(ACMode::OFF);
@@ -79,5 +79,5 @@ bool AutoStopController::check() {
  */
 void AutoStopController::setEnabled(bool enabled) {
   enabled_ = enabled;
-  Serial.printf("[AutoStop] 自動停止機能: %s\n", enabled ? "有効" : "無効");
+  LOG(AUTOSTOP_ENABLED, enabled ? "有効" : "無効");
 }
@@ -0,0 +1,97 @@
+/**
+ * BackgroundWorker.cpp
+ *
+ * 別タスクで処理を実行するクラスの実装
+ */
+
+#include "BackgroundWorker.h"
+
+#include "Logger.h"
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+namespace {
+#ifdef ARDUINO
+  constexpr UBaseType_t TASK_PRIORITY = 1;
+  constexpr BaseType_t TASK_CORE = 0;  // WiFi と同じコア（loop() は 1）
+#endif
+}
+
+BackgroundWorker::BackgroundWorker(const char* name, uint32_t stackSize)
+  : name_(name),
+    stackSize_(stackSize),
+    task_(nullptr),
+    job_(nullptr),
+    context_(nullptr),
+    submitted_(0),
+    completed_(0) {
+}
+
+bool BackgroundWorker::begin() {
+#ifdef ARDUINO
+  TaskHandle_t handle = nullptr;
+  if (xTaskCreatePinnedToCore(taskMain, name_, stackSize_, this, TASK_PRIORITY, &handle, TASK_CORE) != pdPASS) {
+    LOG(WORKER_TASK_FAIL, name_);
+    return false;
+  }
+  task_ = handle;
+#else
+  task_ = this;  // 依頼ごとにスレッドを起動
+#endif
+  return true;
+}
+
+bool BackgroundWorker::submit(Job job, void* context) {
+  if (!isIdle()) {
+    return false;
+  }
+  job_ = job;
+  context_ = context;
+  submitted_++;
+
+  if (task_ == nullptr) {
+    runJob();
+    return true;
+  }
+#ifdef ARDUINO
+  xTaskNotifyGive(static_cast<TaskHandle_t>(task_));
+#else
+  std::thread(taskMain, this).detach();
+#endif
+  return true;
+}
+
+bool BackgroundWorker::isIdle() const {
+  return __atomic_load_n(&completed_, __ATOMIC_ACQUIRE) == submitted_;
+}
+
+uint32_t BackgroundWorker::getCompleted() const {
+  return __atomic_load_n(&completed_, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * 処理を実行し、書き込みの完了を release で公開
+ */
+void BackgroundWorker::runJob() {
+  job_(context_);
+  __atomic_store_n(&completed_, completed_ + 1, __ATOMIC_RELEASE);
+}
+
+#ifdef ARDUINO
+void BackgroundWorker::taskMain(void* param) {
+  BackgroundWorker* worker = static_cast<BackgroundWorker*>(param);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    worker->runJob();
+  }
+}
+#else
+void BackgroundWorker::taskMain(void* param) {
+  static_cast<BackgroundWorker*>(param)->runJob();
+}
+#endif
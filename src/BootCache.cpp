@@ -0,0 +1,98 @@
+/**
+ * BootCache.cpp
+ *
+ * 停電からの復帰時に使う前回の状態の実装
+ */
+
+#include "BootCache.h"
+
+#include <Preferences.h>
+#include "AllocCounter.h"
+#include "Logger.h"
+
+namespace {
+  const char* NVS_NAMESPACE = "aircon";
+  const char* NVS_KEY = "boot";
+}
+
+BootCache::BootCache()
+  : savedEpoch_(0),
+    savedForecast_(0),
+    forecast_() {
+  forecast_.isValid = false;
+  forecast_.category = WeatherCategory::UNKNOWN;
+}
+
+bool BootCache::begin() {
+  Record record;
+  Preferences prefs;
+  size_t length = 0;
+  if (prefs.begin(NVS_NAMESPACE, true)) {
+    length = prefs.getBytes(NVS_KEY, &record, sizeof(record));
+    prefs.end();
+  }
+  if (length != sizeof(record) || record.version != RECORD_VERSION || record.epoch == 0) {
+    LOG(BOOT_CACHE_EMPTY);
+    return false;
+  }
+
+  savedEpoch_ = record.epoch;
+  forecast_.isValid = record.forecastValid != 0;
+  forecast_.tempMax = record.tempMax;
+  forecast_.tempMin = record.tempMin;
+  forecast_.weatherCode = record.weatherCode;
+  forecast_.category = weatherCategoryFromCode(record.weatherCode);
+  forecast_.lastUpdate = 0;
+  forecast_.fetchedEpoch = record.fetchedEpoch;
+  savedForecast_ = record.fetchedEpoch;
+  LOG(BOOT_CACHE_LOADED, savedEpoch_, forecast_.isValid ? "あり" : "なし");
+  return true;
+}
+
+bool BootCache::provisionalTime(uint32_t nowMs, struct tm& out) const {
+  if (savedEpoch_ == 0) {
+    return false;
+  }
+  time_t provisional = static_cast<time_t>(savedEpoch_ + nowMs / 1000);
+  localtime_r(&provisional, &out);
+  return true;
+}
+
+void BootCache::update(uint32_t epoch, const WeatherData& weather) {
+  bool forecastChanged = weather.isValid && weather.fetchedEpoch != savedForecast_;
+  if (!forecastChanged && savedEpoch_ != 0 && epoch - savedEpoch_ < SAVE_INTERVAL_SEC) {
+    return;
+  }
+  if (save(epoch, weather)) {
+    savedEpoch_ = epoch;
+    if (weather.isValid) {
+      savedForecast_ = weather.fetchedEpoch;
+      forecast_ = weather;
+    }
+  }
+}
+
+bool BootCache::save(uint32_t epoch, const WeatherData& weather) {
+  // 天気予報がまだない場合は前回の予報を残す
+  const WeatherData& forecast = weather.isValid ? weather : forecast_;
+  Record record;
+  record.epoch = epoch;
+  record.tempMax = forecast.tempMax;
+  record.tempMin = forecast.tempMin;
+  record.fetchedEpoch = forecast.fetchedEpoch;
+  record.weatherCode = static_cast<int16_t>(forecast.weatherCode);
+  record.forecastValid = forecast.isValid ? 1 : 0;
+  record.version = RECORD_VERSION;
+
+  AllocExemption exemption;  // NVS への書き込みは内部で確保する
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false)) {
+    return false;
+  }
+  bool ok = prefs.putBytes(NVS_KEY, &record, sizeof(record)) == sizeof(record);
+  prefs.end();
+  if (!ok) {
+    LOG(BOOT_CACHE_SAVE_FAIL);
+  }
+  return ok;
+}
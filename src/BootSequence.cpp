@@ -0,0 +1,78 @@
+/**
+ * BootSequence.cpp
+ *
+ * 起動処理の並列化と所要時間の記録の実装
+ */
+
+#include "BootSequence.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "Logger.h"
+
+BootSequence::BootSequence()
+  : times_(),
+    step_(nullptr),
+    context_(nullptr) {
+}
+
+/**
+ * 到達時刻は 0ms と未到達を区別するため +1 して保持
+ * 各段階を記録するタスクは1つだけのため、読み取りと書き込みの間の競合はありません。
+ */
+void BootSequence::mark(BootMilestone milestone) {
+  size_t index = static_cast<size_t>(milestone);
+  if (index >= MILESTONE_COUNT || times_[index] != 0) {
+    return;
+  }
+  uint32_t now = millis();
+  __atomic_store_n(&times_[index], now + 1, __ATOMIC_RELEASE);
+  LOG(BOOT_MILESTONE, milestoneName(milestone), now);
+}
+
+bool BootSequence::reached(BootMilestone milestone) const {
+  return __atomic_load_n(&times_[static_cast<size_t>(milestone)], __ATOMIC_ACQUIRE) != 0;
+}
+
+uint32_t BootSequence::getMs(BootMilestone milestone) const {
+  uint32_t value = __atomic_load_n(&times_[static_cast<size_t>(milestone)], __ATOMIC_ACQUIRE);
+  return value != 0 ? value - 1 : 0;
+}
+
+bool BootSequence::startNetwork(NetworkStep step, void* context) {
+  step_ = step;
+  context_ = context;
+  BaseType_t created = xTaskCreatePinnedToCore(networkTask, "boot_net", TASK_STACK_SIZE, this,
+                                               TASK_PRIORITY, nullptr, TASK_CORE);
+  if (created != pdPASS) {
+    LOG(BOOT_TASK_FAIL);
+    step(context);
+    mark(BootMilestone::NETWORK_DONE);
+    return false;
+  }
+  return true;
+}
+
+void BootSequence::networkTask(void* param) {
+  BootSequence* boot = static_cast<BootSequence*>(param);
+  boot->step_(boot->context_);
+  // step の書き込みは NETWORK_DONE の記録（release）より前に完了している
+  boot->mark(BootMilestone::NETWORK_DONE);
+  vTaskDelete(nullptr);
+}
+
+const char* BootSequence::milestoneName(BootMilestone milestone) {
+  switch (milestone) {
+    case BootMilestone::SENSOR_READY:   return "sensor";
+    case BootMilestone::IR_READY:       return "ir";
+    case BootMilestone::DISPLAY_READY:  return "display";
+    case BootMilestone::SETUP_DONE:     return "setup";
+    case BootMilestone::FIRST_READING:  return "first_reading";
+    case BootMilestone::WIFI_CONNECTED: return "wifi";
+    case BootMilestone::TIME_SYNCED:    return "ntp";
+    case BootMilestone::WEATHER_READY:  return "weather";
+    case BootMilestone::NETWORK_DONE:   return "network";
+    case BootMilestone::FIRST_CONTROL:  return "first_control";
+    default:                            return "?";
+  }
+}
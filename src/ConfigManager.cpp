@@ -0,0 +1,160 @@
+/**
+ * ConfigManager.cpp
+ *
+ * 実行時設定の読み込み・保存・差し替えクラスの実装
+ */
+
+#include "ConfigManager.h"
+
+#include <string.h>
+#include "AllocCounter.h"
+#include "Logger.h"
+
+#ifdef ARDUINO
+#include <Preferences.h>
+#endif
+
+namespace {
+#ifdef ARDUINO
+  const char* NVS_NAMESPACE = "aircon";
+  const char* NVS_KEY = "config";
+#endif
+
+  // applyText() の本文を現在の設定に反映（modify() の編集関数）
+  bool applyPairs(RuntimeConfig& config, void* context, const char** error) {
+    char* text = static_cast<char*>(context);
+    char* savePtr = nullptr;
+    for (char* pair = strtok_r(text, "&\r\n", &savePtr); pair; pair = strtok_r(nullptr, "&\r\n", &savePtr)) {
+      char* separator = strchr(pair, '=');
+      if (!separator) {
+        *error = "名前=値 の形式ではありません";
+        return false;
+      }
+      *separator = '\0';
+      if (!RuntimeConfigSchema::setField(config, pair, separator + 1, error)) {
+        LOG(CONFIG_BAD_FIELD, pair, *error);
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+/**
+ * コンストラクタ
+ */
+ConfigManager::ConfigManager(const RuntimeConfig& defaults)
+  : defaults_(defaults),
+    current_(&buffers_[0]),
+    generation_(0) {
+  buffers_[0] = defaults;
+  buffers_[1] = defaults;
+}
+
+bool ConfigManager::begin() {
+  bool loaded = false;
+#ifdef ARDUINO
+  uint8_t blob[RuntimeConfigSchema::BLOB_SIZE];
+  Preferences prefs;
+  size_t length = 0;
+  if (prefs.begin(NVS_NAMESPACE, true)) {
+    length = prefs.getBytes(NVS_KEY, blob, sizeof(blob));
+    prefs.end();
+  }
+  if (length > 0) {
+    loaded = RuntimeConfigSchema::decode(blob, length, defaults_, buffers_[0]);
+    if (!loaded) {
+      LOG(CONFIG_INVALID);
+    }
+  }
+#endif
+
+  const char* error;
+  if (!loaded && !RuntimeConfigSchema::validate(defaults_, &error)) {
+    LOG(CONFIG_REJECTED, error);  // 初期値自体の誤り（ビルド設定の見直しが必要）
+  }
+  current_.store(&buffers_[0], std::memory_order_release);
+  if (loaded) {
+    LOG(CONFIG_LOADED, RuntimeConfigSchema::VERSION);
+  } else {
+    LOG(CONFIG_DEFAULTS, RuntimeConfigSchema::VERSION);
+  }
+  return loaded;
+}
+
+/**
+ * 現在の設定をコピー
+ * 書き込み側は使用中でない側のバッファに書いてから世代を進めるため、コピーの前後で世代が
+ * 同じならコピー中にバッファは書き換えられていません（変わっていればコピーし直す）。
+ */
+RuntimeConfig ConfigManager::get() const {
+  for (;;) {
+    uint32_t generation = generation_.load(std::memory_order_acquire);
+    RuntimeConfig copy = *current_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (generation_.load(std::memory_order_relaxed) == generation) {
+      return copy;
+    }
+  }
+}
+
+bool ConfigManager::update(const RuntimeConfig& next, const char** error) {
+  std::lock_guard<std::mutex> guard(writeLock_);
+  return commit(next, error);
+}
+
+bool ConfigManager::modify(ConfigEditor edit, void* context, const char** error) {
+  std::lock_guard<std::mutex> guard(writeLock_);
+  RuntimeConfig next = *current_.load(std::memory_order_relaxed);  // 書き込み側はロック中のみ
+  if (!edit(next, context, error)) {
+    return false;
+  }
+  return commit(next, error);
+}
+
+bool ConfigManager::commit(const RuntimeConfig& next, const char** error) {
+  if (!RuntimeConfigSchema::validate(next, error)) {
+    LOG(CONFIG_REJECTED, *error);
+    return false;
+  }
+
+  const RuntimeConfig* active = current_.load(std::memory_order_relaxed);
+  RuntimeConfig* spare = (active == &buffers_[0]) ? &buffers_[1] : &buffers_[0];
+  *spare = next;
+  current_.store(spare, std::memory_order_release);
+  uint32_t generation = generation_.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+  if (!save(next)) {
+    LOG(CONFIG_SAVE_FAIL);  // 差し替えは有効（再起動後は以前の設定に戻る）
+  }
+  LOG(CONFIG_UPDATED, generation);
+  return true;
+}
+
+
+bool ConfigManager::applyText(char* text, const char** error) {
+  return modify(applyPairs, text, error);
+}
+
+bool ConfigManager::reset() {
+  const char* error;
+  return update(defaults_, &error);
+}
+
+bool ConfigManager::save(const RuntimeConfig& config) {
+#ifdef ARDUINO
+  uint8_t blob[RuntimeConfigSchema::BLOB_SIZE];
+  size_t length = RuntimeConfigSchema::encode(config, blob);
+  AllocExemption exemption;  // NVS への書き込みは内部で確保する（loop() のMQTTコマンド・コンソールからも呼ばれる）
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false)) {
+    return false;
+  }
+  bool ok = prefs.putBytes(NVS_KEY, blob, length) == length;
+  prefs.end();
+  return ok;
+#else
+  (void)config;
+  return true;
+#endif
+}
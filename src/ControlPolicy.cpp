@@ -0,0 +1,244 @@
+/**
+ * ControlPolicy.cpp
+ *
+ * エアコン制御ポリシーの実装ファイル
+ *
+ * 主な機能:
+ * - 季節・時間帯・温湿度に基づいた最適なモード決定
+ * - 夜間停止（春・秋・冬季の23:00〜7:00）
+ * - 極寒日の特別対応（最低気温0度以下の場合は夜間も暖房18度で運転）
+ * - ヒステリシス付きの快適温度帯・湿度帯の維持
+ *
+ * シリアル出力は行わず、判定理由（PolicyReason）を返します。
+ */
+
+#include "ControlPolicy.h"
+#include "WeatherData.h"
+
+/**
+ * コンストラクタ
+ */
+ControlPolicy::ControlPolicy(const PolicyThresholds& thresholds)
+  : thresholds_(thresholds) {
+}
+
+/**
+ * 現在の季節を判定
+ */
+Season ControlPolicy::getSeason(int month) {
+  if (month >= 3 && month <= 5) {
+    return Season::SPRING;
+  } else if (month >= 6 && month <= 9) {
+    return Season::SUMMER;
+  } else if (month >= 10 && month <= 11) {
+    return Season::AUTUMN;
+  } else {
+    return Season::WINTER;
+  }
+}
+
+/**
+ * 現在の時間帯を判定
+ */
+TimeOfDay ControlPolicy::getTimeOfDay(int hour) {
+  if (hour >= 7 && hour < 23) {
+    return TimeOfDay::DAYTIME;
+  } else {
+    return TimeOfDay::NIGHT;
+  }
+}
+
+/**
+ * 極寒日かどうかを判定（最低気温0度以下）
+ */
+bool ControlPolicy::isExtremeCold(bool forecastValid, float forecastTempMin) {
+  if (!forecastValid) {
+    return false;
+  }
+  return forecastTempMin <= Threshold::EXTREME_COLD_TEMP;
+}
+
+/**
+ * 制御ポリシーへの入力を作成
+ */
+PolicyInput ControlPolicy::makeInput(float temperature, float humidity, const struct tm& timeinfo,
+                                     const WeatherData& weather) {
+  PolicyInput input;
+  input.temperature = temperature;
+  input.humidity = humidity;
+  input.month = timeinfo.tm_mon + 1;  // tm_monは0-11なので+1
+  input.hour = timeinfo.tm_hour;
+  input.extremeCold = isExtremeCold(weather.isValid, weather.tempMin);
+  return input;
+}
+
+/**
+ * 季節名を取得
+ */
+const char* ControlPolicy::seasonToString(Season season) {
+  switch (season) {
+    case Season::SPRING: return "春季";
+    case Season::SUMMER: return "夏季";
+    case Season::AUTUMN: return "秋季";
+    case Season::WINTER: return "冬季";
+    default:             return "不明";
+  }
+}
+
+/**
+ * モード名を取得
+ */
+const char* ControlPolicy::modeToString(ACMode mode) {
+  switch (mode) {
+    case ACMode::OFF:               return "エアコン停止";
+    case ACMode::HEATING_23_5:      return "暖房23.5度";
+    case ACMode::HEATING_18:        return "暖房18度";
+    case ACMode::COOLING_25:        return "冷房25度";
+    case ACMode::DEHUMID_MINUS_1_5: return "除湿-1.5度";
+    default:                        return "なし";
+  }
+}
+
+/**
+ * 入力と現在のモードに基づいて最適なモードを決定
+ */
+PolicyDecision ControlPolicy::decide(const PolicyInput& input, ACMode currentMode) const {
+  PolicyDecision decision;
+  decision.season = getSeason(input.month);
+  decision.timeOfDay = getTimeOfDay(input.hour);
+  decision.mode = ACMode::OFF;
+
+  // 季節別に制御ロジックを実行
+  switch (decision.season) {
+    case Season::SPRING:
+    case Season::AUTUMN:
+      // 春季・秋季は同じロジック（除湿は行わない）
+      decision.reason = decideIntermediate(input.temperature, decision.timeOfDay, currentMode, decision.mode);
+      break;
+    case Season::SUMMER:
+      decision.reason = decideSummer(input.temperature, input.humidity, currentMode, decision.mode);
+      break;
+    case Season::WINTER:
+    default:
+      decision.reason = decideWinter(input.temperature, decision.timeOfDay, input.extremeCold,
+                                     currentMode, decision.mode);
+      break;
+  }
+
+  return decision;
+}
+
+/**
+ * 春季（3〜5月）・秋季（10〜11月）の制御ロジック
+ */
+PolicyReason ControlPolicy::decideIntermediate(float temperature, TimeOfDay timeOfDay,
+                                               ACMode currentMode, ACMode& mode) const {
+  // 夜間は停止
+  if (timeOfDay == TimeOfDay::NIGHT) {
+    mode = ACMode::OFF;
+    return PolicyReason::NIGHT_OFF;
+  }
+
+  // 日中の制御（ヒステリシス付き）
+  if (temperature < thresholds_.tempLower) {
+    // 24.2度未満 → 暖房23.5度
+    mode = ACMode::HEATING_23_5;
+    return PolicyReason::HEAT_START;
+  } else if (currentMode == ACMode::HEATING_23_5 && temperature < thresholds_.tempLowerOff()) {
+    // 暖房中で24.5度未満 → 暖房継続（ヒステリシス）
+    mode = ACMode::HEATING_23_5;
+    return PolicyReason::HEAT_HOLD;
+  } else if (temperature > thresholds_.tempUpper) {
+    // 26.5度超 → 冷房25度
+    mode = ACMode::COOLING_25;
+    return PolicyReason::COOL_START;
+  } else if (currentMode == ACMode::COOLING_25 && temperature > thresholds_.tempUpperOff()) {
+    // 冷房中で26.2度超 → 冷房継続（ヒステリシス）
+    mode = ACMode::COOLING_25;
+    return PolicyReason::COOL_HOLD;
+  } else {
+    // 快適範囲内 → 停止
+    mode = ACMode::OFF;
+    return PolicyReason::COMFORT_OFF;
+  }
+}
+
+/**
+ * 夏季（6〜9月）の制御ロジック（24時間運転）
+ */
+PolicyReason ControlPolicy::decideSummer(float temperature, float humidity,
+                                         ACMode currentMode, ACMode& mode) const {
+  // 過冷房防止（24.2度未満で停止）
+  if (temperature < thresholds_.tempLower) {
+    mode = ACMode::OFF;
+    return PolicyReason::OVERCOOL_OFF;
+  }
+
+  // 冷房運転中のヒステリシス判定
+  if (currentMode == ACMode::COOLING_25 && temperature > thresholds_.tempUpperOff()) {
+    // 冷房中で26.2度超 → 冷房継続（ヒステリシス）
+    mode = ACMode::COOLING_25;
+    return PolicyReason::COOL_HOLD;
+  }
+
+  // 除湿運転中のヒステリシス判定
+  if (currentMode == ACMode::DEHUMID_MINUS_1_5) {
+    if (temperature > thresholds_.tempUpperOff() && humidity > thresholds_.humidityUpper) {
+      // 除湿中で条件継続 → 除湿継続（ヒステリシス）
+      mode = ACMode::DEHUMID_MINUS_1_5;
+      return PolicyReason::DEHUMID_HOLD;
+    }
+  }
+
+  // 新規起動判定
+  if (temperature > thresholds_.tempUpper) {
+    // 26.5度超 → 冷房25度
+    mode = ACMode::COOLING_25;
+    return PolicyReason::COOL_START;
+  } else if (humidity > thresholds_.humidityUpper) {
+    // 快適温度範囲内で湿度62%超 → 除湿
+    mode = ACMode::DEHUMID_MINUS_1_5;
+    return PolicyReason::DEHUMID_START;
+  }
+
+  // 湿度も快適範囲内 → 停止
+  mode = ACMode::OFF;
+  return PolicyReason::COMFORT_OFF;
+}
+
+/**
+ * 冬季（12〜2月）の制御ロジック
+ */
+PolicyReason ControlPolicy::decideWinter(float temperature, TimeOfDay timeOfDay, bool extremeCold,
+                                         ACMode currentMode, ACMode& mode) const {
+  // 極寒日の夜間は暖房18度で継続運転
+  if (timeOfDay == TimeOfDay::NIGHT && extremeCold) {
+    mode = ACMode::HEATING_18;
+    return PolicyReason::EXTREME_COLD_NIGHT;
+  }
+
+  // 通常の夜間は停止
+  if (timeOfDay == TimeOfDay::NIGHT) {
+    mode = ACMode::OFF;
+    return PolicyReason::NIGHT_OFF;
+  }
+
+  // 日中の制御（ヒステリシス付き）
+  if (temperature < thresholds_.tempLower) {
+    // 24.2度未満 → 暖房23.5度
+    mode = ACMode::HEATING_23_5;
+    return PolicyReason::HEAT_START;
+  } else if (currentMode == ACMode::HEATING_23_5 && temperature < thresholds_.tempLowerOff()) {
+    // 暖房中で24.5度未満 → 暖房継続（ヒステリシス）
+    mode = ACMode::HEATING_23_5;
+    return PolicyReason::HEAT_HOLD;
+  } else if (temperature <= thresholds_.tempUpper) {
+    // 快適範囲内 → 停止
+    mode = ACMode::OFF;
+    return PolicyReason::COMFORT_OFF;
+  } else {
+    // 26.5度超 → 自然冷却待ち（冷房・除湿は使用しない）
+    mode = ACMode::OFF;
+    return PolicyReason::WARM_WAIT_OFF;
+  }
+}
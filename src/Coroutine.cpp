@@ -0,0 +1,68 @@
+/**
+ * Coroutine.cpp
+ *
+ * コルーチンの実行管理の実装
+ */
+
+#include "Coroutine.h"
+
+CoroutineScheduler::CoroutineScheduler()
+  : coroutines_(),
+    count_(0),
+    resumes_(0) {
+}
+
+bool CoroutineScheduler::add(Coroutine* coroutine) {
+  if (count_ >= MAX_COROUTINES) {
+    return false;
+  }
+  coroutines_[count_++] = coroutine;
+  return true;
+}
+
+size_t CoroutineScheduler::run(uint32_t nowMs) {
+  size_t resumed = 0;
+  for (size_t i = 0; i < count_; i++) {
+    if (coroutines_[i]->isReady(nowMs)) {
+      coroutines_[i]->resume(nowMs);
+      resumed++;
+    }
+  }
+  resumes_ += resumed;
+  return resumed;
+}
+
+/**
+ * 再開時刻を過ぎているコルーチンは nowMs を返します（期限の比較は符号付きの差で行う）。
+ */
+bool CoroutineScheduler::getNextWakeMs(uint32_t nowMs, uint32_t& wakeMs) const {
+  bool found = false;
+  int32_t earliest = 0;
+  for (size_t i = 0; i < count_; i++) {
+    if (!coroutines_[i]->isRunning()) {
+      continue;
+    }
+    int32_t until = static_cast<int32_t>(coroutines_[i]->getWakeMs() - nowMs);
+    if (until < 0) {
+      until = 0;
+    }
+    if (!found || until < earliest) {
+      earliest = until;
+      found = true;
+    }
+  }
+  if (found) {
+    wakeMs = nowMs + static_cast<uint32_t>(earliest);
+  }
+  return found;
+}
+
+size_t CoroutineScheduler::getRunning() const {
+  size_t running = 0;
+  for (size_t i = 0; i < count_; i++) {
+    if (coroutines_[i]->isRunning()) {
+      running++;
+    }
+  }
+  return running;
+}
@@ -0,0 +1,111 @@
+/**
+ * DeepSleepManager.cpp
+ *
+ * 電池駆動ノード向けのディープスリープ管理クラスの実装
+ */
+
+#include "DeepSleepManager.h"
+
+#include <string.h>
+#include <time.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include "Logger.h"
+
+namespace {
+  // ディープスリープ中も保持（電源投入時は0で初期化）
+  RTC_DATA_ATTR DeepSleepState rtcState;
+}
+
+/**
+ * コンストラクタ
+ */
+DeepSleepManager::DeepSleepManager(uint32_t wakeIntervalSec, uint32_t forecastMaxAgeSec)
+  : wakeIntervalSec_(wakeIntervalSec),
+    forecastMaxAgeSec_(forecastMaxAgeSec) {
+}
+
+bool DeepSleepManager::begin() {
+  bool resumed = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && rtcState.magic == STATE_MAGIC;
+  if (!resumed) {
+    memset(&rtcState, 0, sizeof(rtcState));
+    rtcState.magic = STATE_MAGIC;
+    rtcState.mode = ACMode::NONE;
+    LOG(DEEPSLEEP_COLD_BOOT, wakeIntervalSec_);
+  }
+  rtcState.wakeCount++;
+  LOG(DEEPSLEEP_WAKE, rtcState.wakeCount, ControlPolicy::modeToString(rtcState.mode),
+      rtcState.lastAwakeUs / 1000);
+  return resumed;
+}
+
+ACMode DeepSleepManager::getMode() const {
+  return rtcState.mode;
+}
+
+void DeepSleepManager::setMode(ACMode mode) {
+  rtcState.mode = mode;
+}
+
+/**
+ * 天気予報は当日分のみのため、日付が変わった場合も再取得します。
+ */
+bool DeepSleepManager::needsNetwork(uint32_t epoch, bool timeValid) const {
+  if (!timeValid || !rtcState.forecastValid || epoch - rtcState.forecastEpoch >= forecastMaxAgeSec_) {
+    return true;
+  }
+  time_t now = epoch;
+  time_t fetched = rtcState.forecastEpoch;
+  struct tm nowTm;
+  struct tm fetchedTm;
+  localtime_r(&now, &nowTm);
+  localtime_r(&fetched, &fetchedTm);
+  return nowTm.tm_yday != fetchedTm.tm_yday || nowTm.tm_year != fetchedTm.tm_year;
+}
+
+WeatherData DeepSleepManager::getForecast() const {
+  WeatherData weather;
+  weather.isValid = rtcState.forecastValid;
+  weather.tempMax = rtcState.forecastTempMax;
+  weather.tempMin = rtcState.forecastTempMin;
+  weather.weatherCode = rtcState.forecastWeatherCode;
+  weather.category = weatherCategoryFromCode(weather.weatherCode);
+  weather.lastUpdate = 0;
+  weather.fetchedEpoch = rtcState.forecastEpoch;
+  return weather;
+}
+
+void DeepSleepManager::setForecast(const WeatherData& weather, uint32_t epoch) {
+  rtcState.forecastValid = weather.isValid;
+  rtcState.forecastTempMax = weather.tempMax;
+  rtcState.forecastTempMin = weather.tempMin;
+  rtcState.forecastWeatherCode = static_cast<int16_t>(weather.weatherCode);
+  rtcState.forecastEpoch = epoch;
+}
+
+void DeepSleepManager::markWifiWake() {
+  rtcState.wifiWakeCount++;
+}
+
+/**
+ * 起床時間にはこの後のログ出力（Serial の送信完了待ち）は含みません。
+ */
+void DeepSleepManager::sleep() {
+  uint32_t awakeUs = static_cast<uint32_t>(esp_timer_get_time());
+  rtcState.lastAwakeUs = awakeUs;
+  if (awakeUs > rtcState.maxAwakeUs) {
+    rtcState.maxAwakeUs = awakeUs;
+  }
+  rtcState.totalAwakeUs += awakeUs;
+
+  uint64_t intervalUs = static_cast<uint64_t>(wakeIntervalSec_) * 1000000ULL;
+  uint64_t sleepUs = awakeUs < intervalUs ? intervalUs - awakeUs : intervalUs;
+  LOG(DEEPSLEEP_SLEEP, awakeUs / 1000.0f,
+      static_cast<float>(rtcState.totalAwakeUs / rtcState.wakeCount) / 1000.0f,
+      rtcState.maxAwakeUs / 1000.0f, rtcState.wifiWakeCount, rtcState.wakeCount,
+      static_cast<uint32_t>(sleepUs / 1000000ULL));
+  Logger::flush();
+
+  esp_sleep_enable_timer_wakeup(sleepUs);
+  esp_deep_sleep_start();
+}
@@ -1,4 +1,5 @@
 #include "DisplayController.h"
+#include "Logger.h"
 
 DisplayController::DisplayController(uint8_t width, uint8_t height, TwoWire* wire, int8_t resetPin, uint8_t address)
   : display_(width, height, wire, resetPin), width_(width), height_(height) {
@@ -6,10 +7,10 @@ DisplayController::DisplayController(uint8_t width, uint8_t height, TwoWire* wir
 
 bool DisplayController::begin() {
   if (!display_.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
-    Serial.println("[Display] 初期化失敗");
+    LOG(DISPLAY_INIT_FAIL);
     return false;
   }
-  Serial.println("[Display] ディスプレイ初期化完了");
+  LOG(DISPLAY_READY);
   return true;
 }
 
@@ -161,7 +162,7 @@ void DisplayController::showSensorDataWithWeather(const SensorData& data, const
   if (weather.isValid) {
     // 天気文字列（左側）
     display_.setCursor(0, 56);
-    display_.print(weather.weatherString);
+    display_.print(weatherCategoryName(weather.category));
 
     // 最高・最低気温（右側）
     display_.setCursor(60, 56);
@@ -179,8 +180,15 @@ void DisplayController::showSensorDataWithWeather(const SensorData& data, const
 }
 
 void DisplayController::showSensorDataWithWeatherAndAC(const SensorData& data, const char* datetime, const WeatherData& weather, ACMode acMode) {
+  renderSensorDataWithWeatherAndAC(data, datetime, weather, acMode);
+
+  // 表示実行
+  display_.display();
+}
+
+void DisplayController::renderSensorDataWithWeatherAndAC(const SensorData& data, const char* datetime, const WeatherData& weather, ACMode acMode) {
   if (!data.isValid) {
-    showError("Sensor Error");
+    renderError("Sensor Error");
     return;
   }
 
@@ -265,7 +273,7 @@ void DisplayController::showSensorDataWithWeatherAndAC(const SensorData& data, c
   if (weather.isValid) {
     // 天気文字列（左側）
     display_.setCursor(0, 56);
-    display_.print(weather.weatherString);
+    display_.print(weatherCategoryName(weather.category));
 
     // 最高・最低気温（右側）
     display_.setCursor(60, 56);
@@ -277,15 +285,16 @@ void DisplayController::showSensorDataWithWeatherAndAC(const SensorData& data, c
     display_.setCursor(0, 56);
     display_.print("Weather: N/A");
   }
+}
 
-  // 表示実行
+void DisplayController::showError(const char* message) {
+  renderError(message);
   display_.display();
 }
 
-void DisplayController::showError(const char* message) {
+void DisplayController::renderError(const char* message) {
   display_.clearDisplay();
   display_.setTextSize(2);
   display_.setCursor(20, 25);
   display_.println(message);
-  display_.display();
 }
@@ -0,0 +1,168 @@
+/**
+ * EnergyModel.cpp
+ *
+ * 消費電力量・電気代の推定の実装
+ */
+
+#include "EnergyModel.h"
+
+#include "Logger.h"
+
+/**
+ * コンストラクタ
+ */
+EnergyModel::EnergyModel(const float* modeWatts)
+  : bands_(),
+    bandCount_(0),
+    lastEpoch_(0),
+    mode_(ACMode::NONE),
+    lastPrice_(0.0f),
+    calibrationSec_(0),
+    calibrationWh_(0.0f),
+    days_(),
+    months_(),
+    dayIndex_(0),
+    monthIndex_(0) {
+  for (size_t i = 0; i < MODE_COUNT; i++) {
+    modeWatts_[i] = modeWatts[i];
+    scale_[i] = 1.0f;
+  }
+}
+
+bool EnergyModel::setTariff(const TariffBand* bands, size_t count) {
+  bool valid = count > 0 && count <= MAX_BANDS && bands[0].startHour == 0;
+  for (size_t i = 1; valid && i < count; i++) {
+    valid = bands[i].startHour > bands[i - 1].startHour && bands[i].startHour < 24;
+  }
+  if (!valid) {
+    LOG(ENERGY_BAD_TARIFF, static_cast<uint32_t>(count));
+    bandCount_ = 0;
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    bands_[i] = bands[i];
+  }
+  bandCount_ = count;
+  return true;
+}
+
+float EnergyModel::getPrice(int hour) const {
+  float price = 0.0f;
+  for (size_t i = 0; i < bandCount_ && bands_[i].startHour <= hour; i++) {
+    price = bands_[i].pricePerKWh;
+  }
+  return price;
+}
+
+bool EnergyModel::isPeak(int hour) const {
+  bool peak = false;
+  for (size_t i = 0; i < bandCount_ && bands_[i].startHour <= hour; i++) {
+    peak = bands_[i].peak;
+  }
+  return peak;
+}
+
+/**
+ * 前回の呼び出しからの消費電力量を積算
+ * 区間（前回〜今回）は前回のモード・前回の時間帯の料金で計算し、今回の日付に加えます。
+ */
+void EnergyModel::accumulate(uint32_t epoch, const struct tm& local, ACMode mode, float measuredWh) {
+  uint32_t dayKey = static_cast<uint32_t>((local.tm_year + 1900) * 10000 + (local.tm_mon + 1) * 100 + local.tm_mday);
+  bool metered = measuredWh >= 0.0f;
+
+  if (lastEpoch_ != 0 && epoch > lastEpoch_ && epoch - lastEpoch_ <= MAX_GAP_SEC) {
+    uint32_t seconds = epoch - lastEpoch_;
+    float wh = metered ? measuredWh : estimateW(mode_) * seconds / 3600.0f;
+    add(dayKey, wh, lastPrice_);
+    if (metered) {
+      calibrate(mode_, seconds, measuredWh);
+    }
+  } else {
+    // 初回・時刻の巻き戻り・長い中断: 推定はせず、計測値（実際に使った分）だけ加える
+    add(dayKey, metered ? measuredWh : 0.0f, getPrice(local.tm_hour));
+    calibrationSec_ = 0;
+    calibrationWh_ = 0.0f;
+  }
+
+  if (mode != mode_) {
+    calibrationSec_ = 0;
+    calibrationWh_ = 0.0f;
+  }
+  lastEpoch_ = epoch;
+  mode_ = mode;
+  lastPrice_ = getPrice(local.tm_hour);
+}
+
+/**
+ * 今日・今月の集計に加える（日付・月が変わった場合は次の枠へ進める）
+ */
+void EnergyModel::add(uint32_t dayKey, float wh, float price) {
+  EnergyTotals* day = &days_[dayIndex_];
+  if (day->key != dayKey) {
+    if (day->key != 0) {
+      LOG(ENERGY_DAY, day->key, day->kWh, day->cost);
+      dayIndex_ = (dayIndex_ + 1) % DAY_SLOTS;
+      day = &days_[dayIndex_];
+    }
+    day->key = dayKey;
+    day->kWh = 0.0f;
+    day->cost = 0.0f;
+  }
+
+  uint32_t monthKey = dayKey / 100;
+  EnergyTotals* month = &months_[monthIndex_];
+  if (month->key != monthKey) {
+    if (month->key != 0) {
+      LOG(ENERGY_MONTH, month->key, month->kWh, month->cost);
+      monthIndex_ = (monthIndex_ + 1) % MONTH_SLOTS;
+      month = &months_[monthIndex_];
+    }
+    month->key = monthKey;
+    month->kWh = 0.0f;
+    month->cost = 0.0f;
+  }
+
+  float kWh = wh / 1000.0f;
+  day->kWh += kWh;
+  day->cost += kWh * price;
+  month->kWh += kWh;
+  month->cost += kWh * price;
+}
+
+/**
+ * 同じモードが CALIBRATION_SEC 以上続き、推定値が MIN_CALIBRATION_WH に達したら、
+ * 計測値と補正前の推定値の比で補正係数を更新
+ * （待機電力のように小さい値は、パルスの分解能に見合う量がたまるまで区間を延ばします）
+ */
+void EnergyModel::calibrate(ACMode mode, uint32_t seconds, float measuredWh) {
+  calibrationSec_ += seconds;
+  calibrationWh_ += measuredWh;
+  size_t i = index(mode);
+  float rawWh = modeWatts_[i] * calibrationSec_ / 3600.0f;
+  if (calibrationSec_ < CALIBRATION_SEC || rawWh < MIN_CALIBRATION_WH) {
+    return;
+  }
+
+  float ratio = calibrationWh_ / rawWh;
+  ratio = ratio < MIN_SCALE ? MIN_SCALE : (ratio > MAX_SCALE ? MAX_SCALE : ratio);
+  scale_[i] += CALIBRATION_WEIGHT * (ratio - scale_[i]);
+  LOG(ENERGY_CALIBRATED, ControlPolicy::modeToString(mode), calibrationWh_, rawWh, scale_[i]);
+  calibrationSec_ = 0;
+  calibrationWh_ = 0.0f;
+}
+
+bool EnergyModel::getDay(size_t ago, EnergyTotals& out) const {
+  if (ago >= DAY_SLOTS) {
+    return false;
+  }
+  out = days_[(dayIndex_ + DAY_SLOTS - ago) % DAY_SLOTS];
+  return out.key != 0;
+}
+
+bool EnergyModel::getMonthTotals(size_t ago, EnergyTotals& out) const {
+  if (ago >= MONTH_SLOTS) {
+    return false;
+  }
+  out = months_[(monthIndex_ + MONTH_SLOTS - ago) % MONTH_SLOTS];
+  return out.key != 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * FileForecastProvider.cpp
+ *
+ * LittleFS のファイルからの天気予報の取得の実装
+ */
+
+#include "FileForecastProvider.h"
+
+#include <LittleFS.h>
+#include "Logger.h"
+
+FileForecastProvider::FileForecastProvider(const char* path)
+  : path_(path) {
+}
+
+bool FileForecastProvider::fetch(ForecastScratch& scratch, ForecastValues& out) {
+  if (!LittleFS.exists(path_)) {
+    return false;  // 予備の取得元のため、ファイルがないのは通常の状態（ログ出力なし）
+  }
+  File file = LittleFS.open(path_, FILE_READ);
+  if (!file) {
+    LOG(WEATHER_FILE_ERROR, path_);
+    return false;
+  }
+
+  // 読み込み（固定領域がなければヒープの String）
+  String payload;
+  const char* json = scratch.body;
+  size_t length;
+  if (scratch.body != nullptr) {
+    if (file.size() >= scratch.bodySize) {
+      file.close();
+      LOG(WEATHER_FILE_ERROR, path_);
+      return false;
+    }
+    length = file.read(reinterpret_cast<uint8_t*>(scratch.body), scratch.bodySize - 1);
+    scratch.body[length] = '\0';
+  } else {
+    payload = file.readString();
+    json = payload.c_str();
+    length = payload.length();
+  }
+  file.close();
+
+  return parseBody(json, length, scratch, out);
+}
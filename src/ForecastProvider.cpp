@@ -0,0 +1,22 @@
+/**
+ * ForecastProvider.cpp
+ *
+ * 天気予報の取得元に共通の処理
+ */
+
+#include "ForecastProvider.h"
+#include "Logger.h"
+
+bool ForecastProvider::parseBody(const char* json, size_t length, ForecastScratch& scratch, ForecastValues& out) {
+  const char* errorMessage = "";
+  ParseResult result = WeatherParser::parseDaily(json, length, out, scratch.allocator, &errorMessage);
+  if (result == ParseResult::JSON_ERROR) {
+    LOG(WEATHER_JSON_ERROR, errorMessage);
+    return false;
+  }
+  if (result == ParseResult::INCOMPLETE) {
+    LOG(WEATHER_JSON_INCOMPLETE);
+    return false;
+  }
+  return true;
+}
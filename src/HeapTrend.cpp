@@ -0,0 +1,75 @@
+/**
+ * HeapTrend.cpp
+ *
+ * ヒープの断片化の傾向の実装
+ */
+
+#include "HeapTrend.h"
+
+#include "Logger.h"
+
+HeapTrend::HeapTrend(uint32_t intervalSec)
+  : intervalSec_(intervalSec),
+    samples_(),
+    next_(0),
+    count_(0),
+    first_(),
+    minLargest_(UINT32_MAX) {
+}
+
+bool HeapTrend::sample(uint32_t uptimeSec, uint32_t largestBlock, uint32_t freeBytes) {
+  if (largestBlock < minLargest_) {
+    minLargest_ = largestBlock;
+  }
+  if (count_ > 0 && uptimeSec - getLatest().uptimeSec < intervalSec_) {
+    return false;
+  }
+
+  HeapSample& slot = samples_[next_];
+  slot.uptimeSec = uptimeSec;
+  slot.largestBlock = largestBlock;
+  slot.freeBytes = freeBytes;
+  if (count_ == 0) {
+    first_ = slot;
+  }
+  next_ = (next_ + 1) % SLOT_COUNT;
+  if (count_ < SLOT_COUNT) {
+    count_++;
+  }
+
+  LOG(HEAP_TREND, largestBlock, freeBytes, minLargest_, first_.largestBlock, getSlopePerDay());
+  return true;
+}
+
+/**
+ * 最大ブロックの傾き（最小二乗法）
+ * 時刻・最大ブロックは最古の記録との差（時間単位・バイト）にして桁落ちを避けます。
+ */
+float HeapTrend::getSlopePerDay() const {
+  if (count_ < 2) {
+    return 0.0f;
+  }
+  size_t oldest = (next_ + SLOT_COUNT - count_) % SLOT_COUNT;
+  uint32_t origin = samples_[oldest].uptimeSec;
+  float base = static_cast<float>(samples_[oldest].largestBlock);
+
+  float sumX = 0.0f;
+  float sumY = 0.0f;
+  float sumXX = 0.0f;
+  float sumXY = 0.0f;
+  for (size_t i = 0; i < count_; i++) {
+    const HeapSample& s = samples_[(oldest + i) % SLOT_COUNT];
+    float x = (s.uptimeSec - origin) / 3600.0f;
+    float y = static_cast<float>(s.largestBlock) - base;
+    sumX += x;
+    sumY += y;
+    sumXX += x * x;
+    sumXY += x * y;
+  }
+  float n = static_cast<float>(count_);
+  float denominator = n * sumXX - sumX * sumX;
+  if (denominator <= 0.0f) {
+    return 0.0f;
+  }
+  return (n * sumXY - sumX * sumY) / denominator * 24.0f;
+}
@@ -0,0 +1,203 @@
+/**
+ * HistoryCodec.cpp
+ *
+ * 履歴データの圧縮形式の実装
+ */
+
+#include "HistoryCodec.h"
+
+#include <string.h>
+
+namespace {
+  inline uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+  }
+
+  inline int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+  }
+
+  // 種別ごとの基準間隔（SAMPLE は1分ごとなので差分がほぼ0になる）
+  inline int32_t expectedInterval(HistoryKind kind) {
+    return kind == HistoryKind::SAMPLE ? static_cast<int32_t>(HistoryEncoder::SAMPLE_INTERVAL_SEC) : 0;
+  }
+}
+
+// ========================================
+// HistoryBlockHeader
+// ========================================
+
+void HistoryBlockHeader::serialize(uint8_t* out) const {
+  out[0] = MAGIC;
+  memcpy(out + 1, &payloadLength, 2);
+  out[3] = recordCount;
+  memcpy(out + 4, &startTime, 4);
+  memcpy(out + 8, &endTime, 4);
+}
+
+bool HistoryBlockHeader::deserialize(const uint8_t* in) {
+  if (in[0] != MAGIC) {
+    return false;
+  }
+  memcpy(&payloadLength, in + 1, 2);
+  recordCount = in[3];
+  memcpy(&startTime, in + 4, 4);
+  memcpy(&endTime, in + 8, 4);
+  return payloadLength <= HistoryEncoder::CAPACITY && endTime >= startTime;
+}
+
+// ========================================
+// HistoryEncoder
+// ========================================
+
+HistoryEncoder::HistoryEncoder() {
+  reset();
+}
+
+void HistoryEncoder::reset() {
+  header_.payloadLength = 0;
+  header_.recordCount = 0;
+  header_.startTime = 0;
+  header_.endTime = 0;
+  lastTime_ = 0;
+  lastTemperature_ = 0;
+  lastHumidity_ = 0;
+}
+
+void HistoryEncoder::putVarint(uint32_t value) {
+  while (value >= 0x80) {
+    payload_[header_.payloadLength++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  payload_[header_.payloadLength++] = static_cast<uint8_t>(value);
+}
+
+void HistoryEncoder::putSigned(int32_t value) {
+  putVarint(zigzag(value));
+}
+
+bool HistoryEncoder::append(const HistoryEvent& event) {
+  if (header_.payloadLength + MAX_RECORD_SIZE > CAPACITY || header_.recordCount == UINT8_MAX) {
+    return false;
+  }
+
+  if (header_.recordCount == 0) {
+    header_.startTime = event.time;
+    lastTime_ = event.time - expectedInterval(event.kind);  // 先頭の経過秒を0にする
+  } else {
+    // 時刻が戻った・大きく飛んだ場合はブロックを閉じる（ヘッダーの endTime >= startTime を保つ）
+    int32_t step = static_cast<int32_t>(event.time - lastTime_);
+    if (step < 0 || static_cast<uint32_t>(step) > MAX_STEP_SEC) {
+      return false;
+    }
+  }
+
+  int32_t elapsed = static_cast<int32_t>(event.time - lastTime_) - expectedInterval(event.kind);
+  putVarint((zigzag(elapsed) << 2) | static_cast<uint32_t>(event.kind));
+
+  switch (event.kind) {
+    case HistoryKind::SAMPLE:
+      putSigned(event.temperature - lastTemperature_);
+      putSigned(event.humidity - lastHumidity_);
+      lastTemperature_ = event.temperature;
+      lastHumidity_ = event.humidity;
+      break;
+    case HistoryKind::MODE:
+      payload_[header_.payloadLength++] = event.mode;
+      break;
+    case HistoryKind::FORECAST:
+      putSigned(event.tempMax);
+      putSigned(event.tempMin);
+      putVarint(event.weatherCode);
+      break;
+  }
+
+  lastTime_ = event.time;
+  header_.endTime = event.time;
+  header_.recordCount++;
+  return true;
+}
+
+// ========================================
+// HistoryDecoder
+// ========================================
+
+HistoryDecoder::HistoryDecoder(const HistoryBlockHeader& header, const uint8_t* payload)
+  : payload_(payload),
+    length_(header.payloadLength),
+    pos_(0),
+    remaining_(header.recordCount),
+    lastTime_(header.startTime),
+    lastTemperature_(0),
+    lastHumidity_(0) {
+}
+
+bool HistoryDecoder::getVarint(uint32_t& value) {
+  value = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (pos_ >= length_) {
+      return false;
+    }
+    uint8_t byte = payload_[pos_++];
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HistoryDecoder::getSigned(int32_t& value) {
+  uint32_t raw;
+  if (!getVarint(raw)) {
+    return false;
+  }
+  value = unzigzag(raw);
+  return true;
+}
+
+bool HistoryDecoder::next(HistoryEvent& event) {
+  if (remaining_ == 0) {
+    return false;
+  }
+
+  bool first = (pos_ == 0);
+  uint32_t head;
+  if (!getVarint(head)) {
+    return false;
+  }
+  memset(&event, 0, sizeof(event));
+  event.kind = static_cast<HistoryKind>(head & 0x3);
+
+  // 先頭レコードの時刻はヘッダーの開始時刻（経過秒は0で符号化される）
+  int32_t elapsed = unzigzag(head >> 2);
+  event.time = first ? lastTime_ + elapsed : lastTime_ + elapsed + expectedInterval(event.kind);
+
+  int32_t a, b;
+  uint32_t c;
+  switch (event.kind) {
+    case HistoryKind::SAMPLE:
+      if (!getSigned(a) || !getSigned(b)) return false;
+      lastTemperature_ = static_cast<int16_t>(lastTemperature_ + a);
+      lastHumidity_ = static_cast<int16_t>(lastHumidity_ + b);
+      event.temperature = lastTemperature_;
+      event.humidity = lastHumidity_;
+      break;
+    case HistoryKind::MODE:
+      if (pos_ >= length_) return false;
+      event.mode = payload_[pos_++];
+      break;
+    case HistoryKind::FORECAST:
+      if (!getSigned(a) || !getSigned(b) || !getVarint(c)) return false;
+      event.tempMax = static_cast<int16_t>(a);
+      event.tempMin = static_cast<int16_t>(b);
+      event.weatherCode = static_cast<uint8_t>(c);
+      break;
+    default:
+      return false;
+  }
+
+  lastTime_ = event.time;
+  remaining_--;
+  return true;
+}
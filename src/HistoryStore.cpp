@@ -0,0 +1,353 @@
+/**
+ * HistoryStore.cpp
+ *
+ * 履歴データの保存クラスの実装
+ */
+
+#include "HistoryStore.h"
+
+#include <LittleFS.h>
+#include <math.h>
+#include "AllocCounter.h"
+#include "Logger.h"
+#include "WeatherForecast.h"
+
+namespace {
+  const char* HISTORY_DIR = "/history";
+}
+
+/**
+ * コンストラクタ
+ */
+HistoryStore::HistoryStore()
+  : segmentCount_(0),
+    ready_(false),
+    sampleMinute_(0),
+    lastSampleTime_(0),
+    temperatureSum_(0.0f),
+    humiditySum_(0.0f),
+    sampleCount_(0) {
+}
+
+void HistoryStore::segmentPath(uint32_t sequence, char* path, size_t size) {
+  snprintf(path, size, "%s/%08lu.bin", HISTORY_DIR, static_cast<unsigned long>(sequence));
+}
+
+/**
+ * LittleFS をマウントし、既存のセグメントから時刻インデックスを構築
+ */
+bool HistoryStore::begin() {
+  // 初回起動時（未フォーマット）はフォーマットする
+  if (!LittleFS.begin(true)) {
+    LOG(HISTORY_MOUNT_FAIL);
+    return false;
+  }
+  if (!LittleFS.exists(HISTORY_DIR)) {
+    LittleFS.mkdir(HISTORY_DIR);
+  }
+
+  // セグメント番号を収集（番号順に挿入）
+  segmentCount_ = 0;
+  File dir = LittleFS.open(HISTORY_DIR);
+  for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    uint32_t sequence = strtoul(file.name(), nullptr, 10);
+    if (sequence == 0) {
+      continue;
+    }
+    Segment segment = {sequence, 0, 0, 0, file.size()};
+    // 時刻が戻った後のブロックもあるため、全ブロックのヘッダーから時刻の範囲を求める（本体は読み飛ばす）
+    uint8_t raw[HistoryBlockHeader::SIZE];
+    HistoryBlockHeader header;
+    bool first = true;
+    while (file.read(raw, sizeof(raw)) == sizeof(raw) && header.deserialize(raw)) {
+      if (first) {
+        segment.startTime = header.startTime;
+        segment.minTime = header.startTime;
+        segment.maxTime = header.endTime;
+        first = false;
+      }
+      includeBlock(segment, header);
+      file.seek(file.position() + header.payloadLength);
+    }
+    file.close();
+
+    if (segmentCount_ == MAX_SEGMENTS) {
+      // 上限を超えた分は古い方から削除
+      char path[32];
+      bool newest = sequence > segments_[0].sequence;
+      segmentPath(newest ? segments_[0].sequence : sequence, path, sizeof(path));
+      LittleFS.remove(path);
+      if (!newest) {
+        continue;
+      }
+      memmove(segments_, segments_ + 1, sizeof(Segment) * (segmentCount_ - 1));
+      segmentCount_--;
+    }
+    size_t i = segmentCount_;
+    while (i > 0 && segments_[i - 1].sequence > sequence) {
+      segments_[i] = segments_[i - 1];
+      i--;
+    }
+    segments_[i] = segment;
+    segmentCount_++;
+  }
+  dir.close();
+
+  ready_ = true;
+  LOG(HISTORY_READY, segmentCount_, getStoredBytes() / 1024);
+  return true;
+}
+
+/**
+ * 温湿度を記録（1分ごとの平均値として保存）
+ */
+void HistoryStore::addSample(uint32_t epoch, float temperature, float humidity) {
+  uint32_t minute = epoch / 60;
+  if (sampleCount_ > 0 && minute != sampleMinute_) {
+    emitSampleAverage();
+  }
+  sampleMinute_ = minute;
+  temperatureSum_ += temperature;
+  humiditySum_ += humidity;
+  sampleCount_++;
+  lastSampleTime_ = epoch;
+}
+
+/**
+ * 集計中の温湿度を平均して記録（時刻は集計中の最後の読み取り時刻）
+ */
+void HistoryStore::emitSampleAverage() {
+  if (sampleCount_ == 0) {
+    return;
+  }
+  HistoryEvent event = {};
+  event.time = lastSampleTime_;
+  event.kind = HistoryKind::SAMPLE;
+  event.temperature = static_cast<int16_t>(lroundf(temperatureSum_ / sampleCount_ * 10.0f));
+  event.humidity = static_cast<int16_t>(lroundf(humiditySum_ / sampleCount_ * 10.0f));
+  temperatureSum_ = 0.0f;
+  humiditySum_ = 0.0f;
+  sampleCount_ = 0;
+  append(event);
+}
+
+void HistoryStore::recordMode(uint32_t epoch, ACMode mode) {
+  // 時刻順を保つため、集計中の温湿度を先に記録
+  emitSampleAverage();
+  HistoryEvent event = {};
+  event.time = epoch;
+  event.kind = HistoryKind::MODE;
+  event.mode = static_cast<uint8_t>(mode);
+  append(event);
+}
+
+void HistoryStore::recordForecast(uint32_t epoch, const WeatherData& weather) {
+  emitSampleAverage();
+  HistoryEvent event = {};
+  event.time = epoch;
+  event.kind = HistoryKind::FORECAST;
+  event.tempMax = static_cast<int16_t>(lroundf(weather.tempMax * 10.0f));
+  event.tempMin = static_cast<int16_t>(lroundf(weather.tempMin * 10.0f));
+  event.weatherCode = static_cast<uint8_t>(weather.weatherCode);
+  append(event);
+}
+
+void HistoryStore::append(const HistoryEvent& event) {
+  if (!ready_) {
+    return;
+  }
+  // 満杯・時刻が戻った場合は書き出して新しいブロックへ
+  if (!encoder_.append(event)) {
+    writeBlock();
+    encoder_.append(event);
+  }
+  // 一定時間ごとにまとめて書き出す
+  if (static_cast<int32_t>(event.time - encoder_.getHeader().startTime) >= static_cast<int32_t>(FLUSH_INTERVAL_SEC)) {
+    writeBlock();
+  }
+}
+
+void HistoryStore::flush() {
+  emitSampleAverage();
+  writeBlock();
+}
+
+/**
+ * RAM上のブロックを現在のセグメントに追記
+ */
+bool HistoryStore::writeBlock() {
+  if (!ready_ || encoder_.isEmpty()) {
+    return true;
+  }
+
+  const HistoryBlockHeader& header = encoder_.getHeader();
+  size_t blockSize = HistoryBlockHeader::SIZE + header.payloadLength;
+  if (segmentCount_ == 0 || segments_[segmentCount_ - 1].size + blockSize > SEGMENT_SIZE) {
+    openNewSegment(header.startTime);
+  }
+
+  Segment& segment = segments_[segmentCount_ - 1];
+  char path[32];
+  segmentPath(segment.sequence, path, sizeof(path));
+
+  uint8_t raw[HistoryBlockHeader::SIZE];
+  header.serialize(raw);
+
+  bool ok;
+  {
+    AllocExemption exemption;  // LittleFS のファイル操作は内部で確保する
+    File file = LittleFS.open(path, FILE_APPEND);
+    ok = file &&
+         file.write(raw, sizeof(raw)) == sizeof(raw) &&
+         file.write(encoder_.getPayload(), header.payloadLength) == header.payloadLength;
+    if (file) {
+      file.close();
+    }
+  }
+
+  if (ok) {
+    if (segment.size == 0) {
+      segment.startTime = header.startTime;
+      segment.minTime = header.startTime;
+      segment.maxTime = header.endTime;
+    }
+    includeBlock(segment, header);
+    segment.size += blockSize;
+  } else {
+    LOG(HISTORY_WRITE_FAIL, path);
+  }
+
+  // 失敗した場合もブロックは破棄（同じブロックで書き込みを繰り返さない）
+  encoder_.reset();
+  return ok;
+}
+
+/**
+ * 新しいセグメントを作成（上限を超える場合は最も古いセグメントを削除）
+ */
+bool HistoryStore::openNewSegment(uint32_t startTime) {
+  uint32_t sequence = segmentCount_ > 0 ? segments_[segmentCount_ - 1].sequence + 1 : 1;
+
+  if (segmentCount_ == MAX_SEGMENTS) {
+    char path[32];
+    segmentPath(segments_[0].sequence, path, sizeof(path));
+    {
+      AllocExemption exemption;
+      LittleFS.remove(path);
+    }
+    LOG(HISTORY_SEGMENT_REMOVED, path);
+    memmove(segments_, segments_ + 1, sizeof(Segment) * (segmentCount_ - 1));
+    segmentCount_--;
+  }
+
+  Segment& segment = segments_[segmentCount_++];
+  segment.sequence = sequence;
+  segment.startTime = startTime;
+  segment.minTime = startTime;
+  segment.maxTime = startTime;
+  segment.size = 0;
+  return true;
+}
+
+/**
+ * セグメントの時刻の範囲をブロックに合わせて広げる
+ */
+void HistoryStore::includeBlock(Segment& segment, const HistoryBlockHeader& header) {
+  if (header.startTime < segment.minTime) {
+    segment.minTime = header.startTime;
+  }
+  if (header.endTime > segment.maxTime) {
+    segment.maxTime = header.endTime;
+  }
+}
+
+/**
+ * 指定期間の履歴を古い順に取得
+ */
+size_t HistoryStore::query(uint32_t from, uint32_t to, HistoryVisitor visitor, void* context) {
+  size_t count = 0;
+  bool stop = false;
+
+  for (size_t i = 0; i < segmentCount_ && !stop; i++) {
+    const Segment& segment = segments_[i];
+    // 時刻が戻るとセグメントの開始時刻は順に並ばないため、各セグメントの時刻の範囲で判定（打ち切らない）
+    if (segment.size == 0 || segment.maxTime < from || segment.minTime > to) {
+      continue;
+    }
+    count += querySegment(segment, from, to, visitor, context, stop);
+  }
+
+  // 未書き出しのブロック
+  if (!stop && !encoder_.isEmpty()) {
+    HistoryDecoder decoder(encoder_.getHeader(), encoder_.getPayload());
+    HistoryEvent event;
+    while (decoder.next(event)) {
+      if (event.time < from) continue;
+      if (event.time > to) break;
+      count++;
+      if (!visitor(event, context)) break;
+    }
+  }
+  return count;
+}
+
+size_t HistoryStore::querySegment(const Segment& segment, uint32_t from, uint32_t to,
+                                  HistoryVisitor visitor, void* context, bool& stop) {
+  char path[32];
+  segmentPath(segment.sequence, path, sizeof(path));
+  File file;
+  {
+    AllocExemption exemption;  // 開くときに確保する（読み取り・visitor の確保は検出する）
+    file = LittleFS.open(path, FILE_READ);
+  }
+  if (!file) {
+    return 0;
+  }
+
+  size_t count = 0;
+  uint8_t raw[HistoryBlockHeader::SIZE];
+  uint8_t payload[HistoryEncoder::CAPACITY];
+  HistoryBlockHeader header;
+
+  // 時刻が戻った後のブロックは前のブロックより前の時刻になるため、範囲外のブロックは読み飛ばして続ける
+  while (!stop && file.read(raw, sizeof(raw)) == sizeof(raw) && header.deserialize(raw)) {
+    // 範囲外のブロックは復号せずに読み飛ばす
+    if (header.endTime < from || header.startTime > to) {
+      file.seek(file.position() + header.payloadLength);
+      continue;
+    }
+    if (file.read(payload, header.payloadLength) != header.payloadLength) {
+      break;
+    }
+
+    HistoryDecoder decoder(header, payload);
+    HistoryEvent event;
+    while (decoder.next(event)) {
+      if (event.time < from) continue;
+      if (event.time > to) break;  // ブロック内は昇順
+      count++;
+      if (!visitor(event, context)) {
+        stop = true;
+        break;
+      }
+    }
+  }
+
+  file.close();
+  return count;
+}
+
+uint32_t HistoryStore::getOldestTime() const {
+  if (segmentCount_ > 0) {
+    return segments_[0].startTime;
+  }
+  return encoder_.isEmpty() ? 0 : encoder_.getHeader().startTime;
+}
+
+size_t HistoryStore::getStoredBytes() const {
+  size_t total = 0;
+  for (size_t i = 0; i < segmentCount_; i++) {
+    total += segments_[i].size;
+  }
+  return total;
+}
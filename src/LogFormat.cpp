@@ -0,0 +1,406 @@
+/**
+ * LogFormat.cpp
+ *
+ * バイナリログレコードの復元処理・フレーム処理の実装
+ */
+
+#include "LogFormat.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// ========================================
+// メッセージ表
+// ========================================
+
+const char* const LogTable::FORMATS[LogTable::MESSAGE_COUNT] = {
+#define LOG_FORMAT_ENTRY(id, level, rate, format) format,
+  LOG_MESSAGE_TABLE(LOG_FORMAT_ENTRY)
+#undef LOG_FORMAT_ENTRY
+};
+
+const char* const LogTable::NAMES[LogTable::MESSAGE_COUNT] = {
+#define LOG_NAME_ENTRY(id, level, rate, format) #id,
+  LOG_MESSAGE_TABLE(LOG_NAME_ENTRY)
+#undef LOG_NAME_ENTRY
+};
+
+namespace {
+  uint32_t fnv1a(uint32_t h, const char* text) {
+    for (const char* p = text; *p; p++) {
+      h = (h ^ static_cast<uint8_t>(*p)) * 16777619u;
+    }
+    return (h ^ 0xFFu) * 16777619u;  // 区切り
+  }
+}
+
+/**
+ * 表全体のハッシュ値（FNV-1a、ID名と書式から計算）
+ */
+uint32_t LogTable::hash() {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < MESSAGE_COUNT; i++) {
+    h = fnv1a(h, NAMES[i]);
+    h = fnv1a(h, FORMATS[i]);
+  }
+  return h;
+}
+
+// ========================================
+// テキストへの復元
+// ========================================
+
+namespace {
+  // 引数列の読み出し
+  class ArgReader {
+  public:
+    ArgReader(const uint8_t* data, size_t length) : data_(data), length_(length), pos_(0) {}
+
+    // 次の引数の型（残りがなければ0）
+    uint8_t peekType() const { return pos_ < length_ ? data_[pos_] : 0; }
+
+    bool readInt(int32_t& out) {
+      uint8_t type = data_[pos_++];
+      uint32_t raw;
+      if (!take(&raw, sizeof(raw))) return false;
+      if (type == LogArgType::FLOAT) {
+        float f;
+        memcpy(&f, &raw, sizeof(f));
+        out = static_cast<int32_t>(f);
+      } else {
+        out = static_cast<int32_t>(raw);
+      }
+      return true;
+    }
+
+    bool readDouble(double& out) {
+      uint8_t type = data_[pos_++];
+      uint32_t raw;
+      if (!take(&raw, sizeof(raw))) return false;
+      if (type == LogArgType::FLOAT) {
+        float f;
+        memcpy(&f, &raw, sizeof(f));
+        out = f;
+      } else if (type == LogArgType::INT) {
+        out = static_cast<int32_t>(raw);
+      } else {
+        out = raw;
+      }
+      return true;
+    }
+
+    // 文字列を終端付きで取り出す
+    bool readString(char* out, size_t outSize) {
+      pos_++;  // 型
+      uint8_t len;
+      if (!take(&len, 1) || pos_ + len > length_) return false;
+      size_t n = len < outSize - 1 ? len : outSize - 1;
+      memcpy(out, data_ + pos_, n);
+      out[n] = '\0';
+      pos_ += len;
+      return true;
+    }
+
+    bool readArray(const uint8_t*& values, uint8_t& count) {
+      pos_++;  // 型
+      if (!take(&count, 1) || pos_ + count * 2u > length_) return false;
+      values = data_ + pos_;
+      pos_ += count * 2u;
+      return true;
+    }
+
+    // 型が一致しない引数を読み飛ばす
+    void skip() {
+      if (pos_ >= length_) return;
+      uint8_t type = data_[pos_++];
+      if (type == LogArgType::STRING) {
+        pos_ += 1 + (pos_ < length_ ? data_[pos_] : 0);
+      } else if (type == LogArgType::U16_ARRAY) {
+        pos_ += 1 + (pos_ < length_ ? data_[pos_] * 2u : 0);
+      } else {
+        pos_ += 4;
+      }
+    }
+
+  private:
+    bool take(void* out, size_t n) {
+      if (pos_ + n > length_) {
+        pos_ = length_;
+        return false;
+      }
+      memcpy(out, data_ + pos_, n);
+      pos_ += n;
+      return true;
+    }
+
+    const uint8_t* data_;
+    size_t length_;
+    size_t pos_;
+  };
+
+  // 出力バッファへの追記（溢れた分は切り捨て）
+  class TextWriter {
+  public:
+    TextWriter(char* out, size_t size) : out_(out), size_(size), pos_(0) {
+      if (size_) out_[0] = '\0';
+    }
+
+    void append(const char* text, size_t n) {
+      if (pos_ + 1 >= size_) return;
+      size_t room = size_ - 1 - pos_;
+      if (n > room) n = room;
+      memcpy(out_ + pos_, text, n);
+      pos_ += n;
+      out_[pos_] = '\0';
+    }
+
+    void append(const char* text) { append(text, strlen(text)); }
+
+    template <typename T>
+    void appendFormatted(const char* spec, T value) {
+      char buf[64];
+      int n = snprintf(buf, sizeof(buf), spec, value);
+      if (n > 0) append(buf, static_cast<size_t>(n) < sizeof(buf) ? n : sizeof(buf) - 1);
+    }
+
+    size_t length() const { return pos_; }
+
+  private:
+    char* out_;
+    size_t size_;
+    size_t pos_;
+  };
+}
+
+size_t LogFormat::formatMessage(const LogRecord& record, char* out, size_t outSize) {
+  TextWriter writer(out, outSize);
+  if (record.id >= LogTable::MESSAGE_COUNT) {
+    writer.appendFormatted("[Log] 不明なメッセージID %u", static_cast<unsigned>(record.id));
+    return writer.length();
+  }
+
+  ArgReader args(record.payload, record.length);
+  const char* p = LogTable::FORMATS[record.id];
+
+  while (*p) {
+    // 変換指定までの文字はそのまま出力
+    const char* literal = p;
+    while (*p && *p != '%') p++;
+    writer.append(literal, p - literal);
+    if (!*p) break;
+
+    if (p[1] == '%') {
+      writer.append("%", 1);
+      p += 2;
+      continue;
+    }
+
+    // 変換指定（フラグ・幅・精度）を取り出し、長さ修飾子は除く
+    char spec[16];
+    size_t specLen = 0;
+    spec[specLen++] = *p++;
+    while (*p && strchr("-+ #0123456789.", *p) && specLen < sizeof(spec) - 3) {
+      spec[specLen++] = *p++;
+    }
+    while (*p && strchr("hlLzjt", *p)) p++;
+    char conversion = *p ? *p++ : '\0';
+    spec[specLen++] = conversion;
+    spec[specLen] = '\0';
+
+    // 引数が足りない・型が合わない場合は "<?>" を出力
+    uint8_t type = args.peekType();
+    bool numeric = type == LogArgType::INT || type == LogArgType::UINT || type == LogArgType::FLOAT;
+    if (type == 0) {
+      writer.append("<?>");
+      continue;
+    }
+
+    switch (conversion) {
+      case 'd': case 'i': case 'c': {
+        int32_t v;
+        if (!numeric) {
+          args.skip();
+          writer.append("<?>");
+        } else if (args.readInt(v)) {
+          writer.appendFormatted(spec, static_cast<int>(v));
+        }
+        break;
+      }
+      case 'u': case 'x': case 'X': case 'o': {
+        int32_t v;
+        if (!numeric) {
+          args.skip();
+          writer.append("<?>");
+        } else if (args.readInt(v)) {
+          writer.appendFormatted(spec, static_cast<unsigned>(v));
+        }
+        break;
+      }
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+        double v;
+        if (!numeric) {
+          args.skip();
+          writer.append("<?>");
+        } else if (args.readDouble(v)) {
+          writer.appendFormatted(spec, v);
+        }
+        break;
+      }
+      case 's': {
+        char text[LogRecord::PAYLOAD_SIZE + 1];
+        if (type != LogArgType::STRING) {
+          args.skip();
+          writer.append("<?>");
+        } else if (args.readString(text, sizeof(text))) {
+          writer.appendFormatted(spec, text);
+        }
+        break;
+      }
+      case 'v': {
+        const uint8_t* values;
+        uint8_t count;
+        if (type != LogArgType::U16_ARRAY) {
+          args.skip();
+          writer.append("<?>");
+          break;
+        }
+        if (!args.readArray(values, count)) {
+          break;
+        }
+        for (uint8_t i = 0; i < count; i++) {
+          uint16_t v;
+          memcpy(&v, values + i * 2, sizeof(v));
+          if (i > 0) writer.append(", ", 2);
+          writer.appendFormatted("%u", static_cast<unsigned>(v));
+        }
+        break;
+      }
+      default:
+        args.skip();
+        writer.append("<?>");
+        break;
+    }
+  }
+
+  return writer.length();
+}
+
+size_t LogFormat::formatLine(const LogRecord& record, char* out, size_t outSize) {
+  int prefix = snprintf(out, outSize, "%6lu.%03lu ",
+                        static_cast<unsigned long>(record.timestampMs / 1000),
+                        static_cast<unsigned long>(record.timestampMs % 1000));
+  if (prefix < 0 || static_cast<size_t>(prefix) + 2 >= outSize) {
+    return 0;
+  }
+  size_t n = prefix + formatMessage(record, out + prefix, outSize - prefix - 1);
+  out[n++] = '\n';
+  out[n] = '\0';
+  return n;
+}
+
+// ========================================
+// フレーム
+// ========================================
+
+uint8_t LogFormat::crc8(const uint8_t* data, size_t length, uint8_t crc) {
+  // CRC-8（多項式 0x07）
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t LogFormat::encodeFrame(const LogRecord& record, uint8_t* out) {
+  size_t recordLength = RECORD_HEADER_SIZE + record.length;
+  out[0] = SYNC_0;
+  out[1] = SYNC_1;
+  out[2] = static_cast<uint8_t>(recordLength);
+  memcpy(out + 3, &record.timestampMs, 4);
+  memcpy(out + 7, &record.id, 2);
+  out[9] = record.length;
+  memcpy(out + 10, record.payload, record.length);
+  out[3 + recordLength] = crc8(out + 2, recordLength + 1);
+  return recordLength + 4;
+}
+
+LogFrameParser::LogFrameParser(RecordHandler onRecord, TextHandler onText, void* context)
+  : onRecord_(onRecord),
+    onText_(onText),
+    context_(context),
+    state_(State::IDLE),
+    received_(0),
+    expected_(0),
+    errorCount_(0) {
+}
+
+void LogFrameParser::flushAsText() {
+  if (received_ > 0) {
+    onText_(buffer_, received_, context_);
+  }
+  received_ = 0;
+  state_ = State::IDLE;
+}
+
+void LogFrameParser::feed(uint8_t byte) {
+  switch (state_) {
+    case State::IDLE:
+      if (byte == LogFormat::SYNC_0) {
+        buffer_[0] = byte;
+        received_ = 1;
+        state_ = State::SYNC;
+      } else {
+        onText_(&byte, 1, context_);
+      }
+      return;
+
+    case State::SYNC:
+      buffer_[received_++] = byte;
+      if (byte == LogFormat::SYNC_1) {
+        state_ = State::LENGTH;
+      } else {
+        flushAsText();
+      }
+      return;
+
+    case State::LENGTH:
+      buffer_[received_++] = byte;
+      if (byte < LogFormat::RECORD_HEADER_SIZE ||
+          byte > LogFormat::RECORD_HEADER_SIZE + LogRecord::PAYLOAD_SIZE) {
+        flushAsText();
+        return;
+      }
+      expected_ = 3 + byte + 1;  // 同期2 + 長さ1 + レコード + CRC
+      state_ = State::BODY;
+      return;
+
+    case State::BODY:
+      buffer_[received_++] = byte;
+      if (received_ < expected_) {
+        return;
+      }
+      break;
+  }
+
+  // フレーム受信完了
+  size_t recordLength = buffer_[2];
+  LogRecord record;
+  memcpy(&record.timestampMs, buffer_ + 3, 4);
+  memcpy(&record.id, buffer_ + 7, 2);
+  record.length = buffer_[9];
+
+  bool valid = LogFormat::crc8(buffer_ + 2, recordLength + 1) == buffer_[3 + recordLength] &&
+               record.length == recordLength - LogFormat::RECORD_HEADER_SIZE;
+  if (!valid) {
+    errorCount_++;
+    flushAsText();
+    return;
+  }
+
+  memcpy(record.payload, buffer_ + 10, record.length);
+  received_ = 0;
+  state_ = State::IDLE;
+  onRecord_(record, context_);
+}
@@ -0,0 +1,211 @@
+/**
+ * Logger.cpp
+ *
+ * 非同期バイナリログの実装
+ *
+ * リングバッファは複数の書き込み側・単一の読み出し側のロックフリーキュー
+ * （各スロットのシーケンス番号で書き込み完了を判定する方式）です。
+ * スロットは静的領域に置き、ゼロ初期化のまま使えるようにしているため、
+ * グローバルオブジェクトのコンストラクタからも記録できます。
+ */
+
+#include "Logger.h"
+
+#include <atomic>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <stdio.h>
+#include <chrono>
+#endif
+
+namespace {
+  static_assert((Logger::RING_SIZE & (Logger::RING_SIZE - 1)) == 0, "RING_SIZE は2のべき乗にしてください");
+
+  constexpr uint32_t RING_MASK = Logger::RING_SIZE - 1;
+
+  // sequence はスロット番号を引いた値で保持する（ゼロ初期化で「空き」状態になる）
+  struct Slot {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+  };
+
+  Slot slots[Logger::RING_SIZE];
+  std::atomic<uint32_t> head(0);     // 次の書き込み位置
+  std::atomic<uint32_t> tail(0);     // 次の読み出し位置
+  std::atomic<bool> draining(false); // 読み出し中（読み出し側を1つに限る）
+  std::atomic<uint32_t> dropped(0);  // 未報告の破棄件数
+  std::atomic<uint32_t> droppedTotal(0);
+
+  // メッセージごとの頻度制限（同時書き込みでの多少の誤差は許容）
+  struct RateState {
+    std::atomic<uint32_t> windowStart;
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> suppressed;
+  };
+  RateState rateStates[LogTable::MESSAGE_COUNT];
+
+#ifdef ARDUINO
+  constexpr uint32_t TASK_STACK_SIZE = 3072;
+  constexpr UBaseType_t TASK_PRIORITY = 1;
+  constexpr BaseType_t TASK_CORE = 0;
+
+  void drainTask(void*) {
+    for (;;) {
+      Logger::drain();
+      vTaskDelay(pdMS_TO_TICKS(Logger::DRAIN_INTERVAL_MS));
+    }
+  }
+#endif
+}
+
+void Logger::begin() {
+#ifdef ARDUINO
+  xTaskCreatePinnedToCore(drainTask, "log", TASK_STACK_SIZE, nullptr, TASK_PRIORITY, nullptr, TASK_CORE);
+#endif
+  LOG(LOG_STARTED, LogTable::hash());
+}
+
+uint32_t Logger::now() {
+#ifdef ARDUINO
+  return millis();
+#else
+  static const auto start = std::chrono::steady_clock::now();
+  return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now() - start).count());
+#endif
+}
+
+/**
+ * 頻度制限の判定
+ * 単位時間が切り替わったときに、前の単位時間で抑制した件数を記録します。
+ */
+bool Logger::allow(LogId id) {
+  size_t index = static_cast<size_t>(id);
+  uint8_t limit = LogTable::RATE_LIMITS[index];
+  if (limit == 0) {
+    return true;
+  }
+
+  RateState& state = rateStates[index];
+  uint32_t current = now();
+  if (current - state.windowStart.load(std::memory_order_relaxed) >= RATE_WINDOW_MS) {
+    state.windowStart.store(current, std::memory_order_relaxed);
+    state.count.store(0, std::memory_order_relaxed);
+    uint32_t suppressed = state.suppressed.exchange(0, std::memory_order_relaxed);
+    if (suppressed > 0) {
+      LOG(LOG_SUPPRESSED, LogTable::NAMES[index], suppressed);
+    }
+  }
+
+  if (state.count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+    state.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * 書き込み用のスロットを確保（満杯なら nullptr）
+ */
+LogRecord* Logger::reserve(uint32_t& position) {
+  uint32_t pos = head.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot& slot = slots[pos & RING_MASK];
+    uint32_t sequence = slot.sequence.load(std::memory_order_acquire) + (pos & RING_MASK);
+    int32_t diff = static_cast<int32_t>(sequence - pos);
+    if (diff == 0) {
+      if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        position = pos;
+        return &slot.record;
+      }
+    } else if (diff < 0) {
+      // 読み出しが追いついていない
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      droppedTotal.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    } else {
+      pos = head.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+/**
+ * 書き込み完了を通知（読み出し側から見えるようになる）
+ */
+void Logger::commit(uint32_t position) {
+  slots[position & RING_MASK].sequence.store(position + 1 - (position & RING_MASK),
+                                             std::memory_order_release);
+}
+
+size_t Logger::drain(size_t maxRecords) {
+  if (draining.exchange(true, std::memory_order_acquire)) {
+    return 0;  // 他のタスクが出力中
+  }
+  size_t count = 0;
+
+  uint32_t pos = tail.load(std::memory_order_relaxed);
+  while (count < maxRecords) {
+    Slot& slot = slots[pos & RING_MASK];
+    uint32_t sequence = slot.sequence.load(std::memory_order_acquire) + (pos & RING_MASK);
+    if (sequence != pos + 1) {
+      break;  // 空、または書き込み中
+    }
+    output(slot.record);
+    slot.sequence.store(pos + Logger::RING_SIZE - (pos & RING_MASK), std::memory_order_release);
+    pos++;
+    count++;
+  }
+  tail.store(pos, std::memory_order_relaxed);
+
+  // 破棄件数の報告（バッファを経由せず直接出力）
+  uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+  if (lost > 0) {
+    LogRecord record;
+    record.timestampMs = now();
+    record.id = static_cast<uint16_t>(LogId::LOG_DROPPED);
+    LogEncoder encoder(record);
+    encoder.putUint(lost);
+    output(record);
+  }
+
+  draining.store(false, std::memory_order_release);
+  return count;
+}
+
+void Logger::flush() {
+  while (tail.load(std::memory_order_relaxed) != head.load(std::memory_order_relaxed)) {
+    if (drain() == 0) {
+#ifdef ARDUINO
+      delay(1);  // 送信タスクの出力中、または書き込み途中のレコード待ち
+#endif
+    }
+  }
+#ifdef ARDUINO
+  Serial.flush();
+#else
+  fflush(stdout);
+#endif
+}
+
+uint32_t Logger::getDroppedCount() {
+  return droppedTotal.load(std::memory_order_relaxed);
+}
+
+void Logger::output(const LogRecord& record) {
+#if defined(ARDUINO) && !defined(LOG_TEXT_OUTPUT)
+  uint8_t frame[LogFormat::MAX_FRAME_SIZE];
+  size_t length = LogFormat::encodeFrame(record, frame);
+  Serial.write(frame, length);
+#else
+  char line[256];
+  size_t length = LogFormat::formatLine(record, line, sizeof(line));
+#ifdef ARDUINO
+  Serial.write(reinterpret_cast<const uint8_t*>(line), length);
+#else
+  fwrite(line, 1, length, stdout);
+#endif
+#endif
+}
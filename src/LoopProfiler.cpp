@@ -0,0 +1,290 @@
+/**
+ * LoopProfiler.cpp
+ *
+ * loop() の処理時間計測クラスの実装
+ */
+
+#include "LoopProfiler.h"
+#include "AllocCounter.h"
+#include "Logger.h"
+
+#include <stdlib.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+namespace {
+  // サイクルカウンターの読み取り（ホストではナノ秒で代用）
+  inline uint32_t readCycles() {
+#ifdef ARDUINO
+    return ESP.getCycleCount();
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+  }
+
+  inline uint32_t cpuFrequencyMHz() {
+#ifdef ARDUINO
+    return ESP.getCpuFreqMHz();
+#else
+    return 1000;  // ナノ秒を1GHzのサイクルとみなす
+#endif
+  }
+}
+
+// ========================================
+// CycleHistogram
+// ========================================
+
+/**
+ * 値からバケット番号を計算
+ * 0〜3 はそのまま、それ以上は2のべき乗区間を4分割
+ */
+uint8_t CycleHistogram::bucketOf(uint32_t value) {
+  if (value < 4) {
+    return static_cast<uint8_t>(value);
+  }
+  uint8_t octave = 31 - __builtin_clz(value);       // 2 〜 31
+  uint8_t sub = (value >> (octave - 2)) & 0x3;      // 区間内の4分割
+  return static_cast<uint8_t>(4 * (octave - 1) + sub);
+}
+
+/**
+ * バケットの代表値（区間の中央）
+ */
+uint32_t CycleHistogram::bucketValue(uint8_t index) {
+  if (index < 4) {
+    return index;
+  }
+  uint8_t octave = index / 4 + 1;
+  uint8_t sub = index % 4;
+  uint32_t lower = static_cast<uint32_t>(4 + sub) << (octave - 2);
+  uint32_t width = 1u << (octave - 2);
+  return lower + width / 2;
+}
+
+void CycleHistogram::record(uint32_t cycles, uint32_t weight) {
+  counts_[bucketOf(cycles)] += weight;
+  observe(cycles);
+}
+
+void CycleHistogram::observe(uint32_t cycles) {
+  if (cycles < windowMin_) windowMin_ = cycles;
+  if (cycles > windowMax_) windowMax_ = cycles;
+  totalCycles_ += cycles;
+}
+
+void CycleHistogram::decay() {
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+    counts_[i] >>= 1;
+  }
+  prevMin_ = windowMin_;
+  prevMax_ = windowMax_;
+  windowMin_ = UINT32_MAX;
+  windowMax_ = 0;
+}
+
+uint32_t CycleHistogram::percentile(uint32_t total, float ratio) const {
+  uint32_t target = static_cast<uint32_t>(total * ratio);
+  uint32_t cumulative = 0;
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+    cumulative += counts_[i];
+    if (cumulative > target) {
+      return bucketValue(i);
+    }
+  }
+  return 0;
+}
+
+void CycleHistogram::stats(PhaseStats& out) const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+    total += counts_[i];
+  }
+
+  // 最小・最大は現在と前回のウィンドウを合わせた値
+  uint32_t lo = windowMin_ < prevMin_ ? windowMin_ : prevMin_;
+  uint32_t hi = windowMax_ > prevMax_ ? windowMax_ : prevMax_;
+
+  out.count = total;
+  out.min = (lo == UINT32_MAX) ? 0 : lo;
+  out.max = hi;
+  out.p50 = total ? percentile(total, 0.50f) : 0;
+  out.p99 = total ? percentile(total, 0.99f) : 0;
+  out.totalCycles = totalCycles_;
+
+  // 代表値が実測の範囲外にならないよう補正
+  if (total) {
+    if (out.p50 < out.min) out.p50 = out.min;
+    if (out.p99 > out.max) out.p99 = out.max;
+    if (out.p50 > out.p99) out.p50 = out.p99;
+  }
+}
+
+// ========================================
+// LoopProfiler
+// ========================================
+
+LoopProfiler::LoopProfiler(uint32_t decayIntervalMs)
+  : loopStart_(0),
+    lastMark_(0),
+    cycleAccumulator_(0),
+    decayIntervalCycles_(decayIntervalMs),
+    overheadCycles_(0),
+    sampledLoopCycles_(0),
+    tailThresholdCycles_(0),
+    loopCounter_(0),
+    phaseCounters_(),
+    allocations_(),
+    cpuMHz_(0),
+    allocationCheck_(false),
+    sampled_(false),
+    inLoop_(false) {
+}
+
+void LoopProfiler::beginLoop() {
+  // CPU周波数はグローバル初期化後に確定するため、初回に換算する
+  if (cpuMHz_ == 0) {
+    cpuMHz_ = cpuFrequencyMHz();
+    decayIntervalCycles_ *= static_cast<uint64_t>(cpuMHz_) * 1000;
+    tailThresholdCycles_ = TAIL_THRESHOLD_US * cpuMHz_;
+  }
+  sampled_ = (++loopCounter_ % SAMPLE_EVERY) == 0;
+  countAllocations(LoopPhase::LOOP_TOTAL);  // 前回の endLoop() 以降（待機中）の分
+  loopStart_ = readCycles();
+  lastMark_ = loopStart_;
+  inLoop_ = true;
+}
+
+void LoopProfiler::record(LoopPhase phase, uint32_t cycles) {
+  size_t index = static_cast<size_t>(phase);
+  CycleHistogram& histogram = histograms_[index];
+  if (++phaseCounters_[index] % SAMPLE_EVERY == 0) {
+    histogram.record(cycles, SAMPLE_EVERY);
+  } else if (cycles >= tailThresholdCycles_) {
+    histogram.record(cycles, 1);
+  } else {
+    histogram.observe(cycles);
+  }
+}
+
+void LoopProfiler::mark(LoopPhase phase) {
+  uint32_t now = readCycles();
+  record(phase, now - lastMark_);
+  countAllocations(phase);
+  lastMark_ = now;
+
+  // サンプリングしたloopでは記録処理自体の時間を計測（次の区間には含まれる）
+  if (sampled_) {
+    overheadCycles_ += readCycles() - now;
+  }
+}
+
+void LoopProfiler::endLoop() {
+  if (!inLoop_) {
+    return;
+  }
+  inLoop_ = false;
+
+  uint32_t now = readCycles();
+  uint32_t elapsed = now - loopStart_;
+  record(LoopPhase::LOOP_TOTAL, elapsed);
+  countAllocations(LoopPhase::LOOP_TOTAL);  // 最後のマーク以降の分
+
+  // 一定時間ごとにヒストグラムを半減（直近のデータを重視）
+  cycleAccumulator_ += elapsed;
+  if (cycleAccumulator_ >= decayIntervalCycles_) {
+    cycleAccumulator_ = 0;
+    for (size_t i = 0; i < PHASE_COUNT; i++) {
+      histograms_[i].decay();
+    }
+  }
+
+  if (sampled_) {
+    uint32_t end = readCycles();
+    overheadCycles_ += end - now;
+    sampledLoopCycles_ += end - loopStart_;
+  }
+}
+
+/**
+ * 直前の呼び出しからのヒープ確保を指定フェーズの分として数える
+ * （計測が無効なビルドでは takeTaskCount() が常に 0 のため何もしない）
+ */
+void LoopProfiler::countAllocations(LoopPhase phase) {
+  uint32_t count = AllocCounter::takeTaskCount();
+  if (count == 0) {
+    return;
+  }
+  allocations_[static_cast<size_t>(phase)] += count;
+  if (allocationCheck_) {
+    LOG(ALLOC_IN_LOOP, phaseName(phase), count);
+#ifdef ALLOC_ASSERT
+    Logger::flush();
+    abort();
+#endif
+  }
+}
+
+void LoopProfiler::getStats(LoopPhase phase, PhaseStats& out) const {
+  histograms_[static_cast<size_t>(phase)].stats(out);
+}
+
+/**
+ * 計測のオーバーヘッド
+ * 記録処理の重いサンプリング対象のloopで計測するため、実際より大きめ（上限）の値になります。
+ */
+float LoopProfiler::getOverheadPercent() const {
+  if (sampledLoopCycles_ == 0) {
+    return 0.0f;
+  }
+  return 100.0f * static_cast<float>(overheadCycles_) / static_cast<float>(sampledLoopCycles_);
+}
+
+const char* LoopProfiler::phaseName(LoopPhase phase) {
+  switch (phase) {
+    case LoopPhase::WIFI_CHECK:     return "wifi";
+    case LoopPhase::IR_RECEIVE:     return "ir_recv";
+    case LoopPhase::MQTT_COMMAND:   return "mqtt";
+    case LoopPhase::CONSOLE:        return "console";
+    case LoopPhase::MESH:           return "mesh";
+    case LoopPhase::WEATHER_UPDATE: return "weather";
+    case LoopPhase::REPORT:         return "report";
+    case LoopPhase::SENSOR_READ:    return "sensor";
+    case LoopPhase::DISPLAY:        return "display";
+    case LoopPhase::CONTROL:        return "control";
+    case LoopPhase::HISTORY:        return "history";
+    case LoopPhase::LOOP_TOTAL:     return "loop";
+    default:                        return "?";
+  }
+}
+
+void LoopProfiler::printSummary() const {
+  uint32_t mhz = cpuMHz_ ? cpuMHz_ : 1;
+  PhaseStats total;
+  getStats(LoopPhase::LOOP_TOTAL, total);
+
+  LOG(PROFILE_HEADER);
+  for (size_t i = 0; i < PHASE_COUNT; i++) {
+    PhaseStats s;
+    histograms_[i].stats(s);
+    float share = total.totalCycles ? 100.0f * s.totalCycles / total.totalCycles : 0.0f;
+    LOG(PROFILE_ROW, phaseName(static_cast<LoopPhase>(i)), s.count,
+        static_cast<float>(s.min) / mhz, static_cast<float>(s.p50) / mhz,
+        static_cast<float>(s.p99) / mhz, static_cast<float>(s.max) / mhz, share);
+  }
+  LOG(PROFILE_OVERHEAD, getOverheadPercent());
+
+  if (AllocCounter::isEnabled()) {
+    for (size_t i = 0; i < PHASE_COUNT; i++) {
+      if (allocations_[i] != 0) {
+        LOG(PROFILE_ALLOC_ROW, phaseName(static_cast<LoopPhase>(i)), allocations_[i]);
+      }
+    }
+    LOG(PROFILE_ALLOC_TOTAL, AllocCounter::getTotal());
+  }
+}
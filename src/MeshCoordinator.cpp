@@ -0,0 +1,293 @@
+/**
+ * MeshCoordinator.cpp
+ *
+ * 複数台の連携の実装
+ */
+
+#include "MeshCoordinator.h"
+
+#include "Logger.h"
+
+namespace {
+  // a が b より前か（millis() の桁あふれを考慮）
+  inline bool before(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+  }
+
+  inline uint32_t distance(uint32_t a, uint32_t b) {
+    return before(a, b) ? b - a : a - b;
+  }
+}
+
+/**
+ * コンストラクタ
+ */
+MeshCoordinator::MeshCoordinator(MeshTransport& transport, bool forecastSource, const uint8_t* key)
+  : transport_(transport),
+    forecastSource_(forecastSource),
+    key_(key),
+    sequence_(0),
+    replayed_(0),
+    forecast_(),
+    hasForecast_(false),
+    forecastAtMs_(0),
+    lastPublishMs_(0),
+    forecastGeneration_(0),
+    state_(ClaimState::IDLE),
+    claimSlotMs_(0),
+    decideAtMs_(0),
+    records_(),
+    peers_() {
+}
+
+void MeshCoordinator::service(uint32_t nowMs) {
+  uint8_t buffer[MeshProtocol::MAX_MESSAGE_SIZE];
+  size_t length;
+  while ((length = transport_.receive(buffer)) > 0) {
+    if (!MeshProtocol::verify(key_, buffer, length)) {
+      LOG(MESH_BAD_MAC, static_cast<uint32_t>(length));
+      continue;
+    }
+    MeshMessage message;
+    if (!MeshProtocol::decode(buffer, length, message)) {
+      LOG(MESH_BAD_MESSAGE, static_cast<uint32_t>(length));
+      continue;
+    }
+    if (message.origin.nodeId == transport_.getNodeId()) {
+      continue;  // 自分の送信（UDP ではループバックで届く）
+    }
+    if (!acceptPeer(message.origin, nowMs)) {
+      replayed_++;
+      LOG(MESH_REPLAYED, message.origin.nodeId, message.origin.boot, message.origin.sequence);
+      continue;
+    }
+    handleMessage(message, nowMs);
+  }
+
+  // 後から起動したノードのために定期的に再送（時刻は送信時点に進める）
+  if (forecastSource_ && hasForecast_ && nowMs - lastPublishMs_ >= FORECAST_INTERVAL_MS) {
+    MeshForecast current = forecast_;
+    current.epoch += (nowMs - forecastAtMs_) / 1000;
+    uint8_t message[MeshProtocol::MAX_MESSAGE_SIZE];
+    send(message, MeshProtocol::encodeForecast(key_, nextOrigin(), current, message));
+    lastPublishMs_ = nowMs;
+  }
+}
+
+void MeshCoordinator::handleMessage(const MeshMessage& message, uint32_t nowMs) {
+  switch (message.type) {
+    case MeshMessageType::FORECAST:
+      if (forecastSource_) {
+        LOG(MESH_SECOND_SOURCE, message.origin.nodeId);
+        return;
+      }
+      forecast_ = message.forecast;
+      forecastAtMs_ = nowMs;
+      hasForecast_ = true;
+      forecastGeneration_++;
+      LOG(MESH_FORECAST_RECEIVED, message.origin.nodeId, forecast_.tempMax, forecast_.tempMin);
+      break;
+
+    case MeshMessageType::CLAIM: {
+      uint32_t slot = nowMs + message.delayMs;
+      record(message.origin.nodeId, slot, true);
+      // 同じ時間帯を予約している場合は、ノードIDの小さい方を優先
+      if (state_ == ClaimState::CLAIMING && distance(slot, claimSlotMs_) < STAGGER_WINDOW_MS &&
+          message.origin.nodeId < transport_.getNodeId()) {
+        state_ = ClaimState::IDLE;
+        removePlanned(transport_.getNodeId());
+        LOG(MESH_CLAIM_YIELD, message.origin.nodeId);
+      }
+      break;
+    }
+
+    case MeshMessageType::START:
+      removePlanned(message.origin.nodeId);
+      record(message.origin.nodeId, nowMs, false);
+      break;
+
+    case MeshMessageType::RELEASE:
+      removePlanned(message.origin.nodeId);
+      break;
+  }
+}
+
+void MeshCoordinator::publishForecast(const MeshForecast& forecast, uint32_t nowMs) {
+  forecast_ = forecast;
+  forecastAtMs_ = nowMs;
+  hasForecast_ = true;
+  forecastGeneration_++;
+  uint8_t message[MeshProtocol::MAX_MESSAGE_SIZE];
+  send(message, MeshProtocol::encodeForecast(key_, nextOrigin(), forecast, message));
+  lastPublishMs_ = nowMs;
+  LOG(MESH_FORECAST_SENT, forecast.tempMax, forecast.tempMin);
+}
+
+bool MeshCoordinator::getForecast(MeshForecast& out, uint32_t& ageMs, uint32_t nowMs) const {
+  if (!hasForecast_) {
+    return false;
+  }
+  ageMs = nowMs - forecastAtMs_;
+  out = forecast_;
+  out.epoch += ageMs / 1000;
+  return true;
+}
+
+bool MeshCoordinator::requestStart(uint32_t nowMs) {
+  prune(nowMs);
+
+  if (state_ == ClaimState::IDLE) {
+    claimSlotMs_ = findSlot(nowMs);
+    decideAtMs_ = before(claimSlotMs_, nowMs + CLAIM_WAIT_MS) ? nowMs + CLAIM_WAIT_MS : claimSlotMs_;
+    state_ = ClaimState::CLAIMING;
+    record(transport_.getNodeId(), claimSlotMs_, true);
+
+    uint8_t message[MeshProtocol::MAX_MESSAGE_SIZE];
+    send(message, MeshProtocol::encodeClaim(key_, nextOrigin(), claimSlotMs_ - nowMs, message));
+    LOG(MESH_CLAIM, claimSlotMs_ - nowMs);
+    return false;
+  }
+
+  if (before(nowMs, decideAtMs_)) {
+    return false;
+  }
+
+  // 競合なく予約時刻になった
+  state_ = ClaimState::IDLE;
+  removePlanned(transport_.getNodeId());
+  record(transport_.getNodeId(), nowMs, false);
+  uint8_t message[MeshProtocol::MAX_MESSAGE_SIZE];
+  send(message, MeshProtocol::encodeStart(key_, nextOrigin(), message));
+  LOG(MESH_START);
+  return true;
+}
+
+void MeshCoordinator::cancelStart() {
+  if (state_ != ClaimState::CLAIMING) {
+    return;
+  }
+  state_ = ClaimState::IDLE;
+  removePlanned(transport_.getNodeId());
+  uint8_t message[MeshProtocol::MAX_MESSAGE_SIZE];
+  send(message, MeshProtocol::encodeRelease(key_, nextOrigin(), message));
+  LOG(MESH_RELEASE);
+}
+
+/**
+ * 他の起動（予定）と STAGGER_WINDOW_MS 以内に重なる数が上限未満になる最も早い時刻
+ */
+uint32_t MeshCoordinator::findSlot(uint32_t nowMs) const {
+  uint32_t candidate = nowMs;
+  for (size_t attempt = 0; attempt <= MAX_RECORDS; attempt++) {
+    uint8_t overlapping = 0;
+    uint32_t latestEnd = candidate;
+    for (const StartRecord& r : records_) {
+      if (!r.used || (r.nodeId == transport_.getNodeId() && r.planned)) {
+        continue;
+      }
+      if (distance(r.atMs, candidate) < STAGGER_WINDOW_MS) {
+        overlapping++;
+        if (before(latestEnd, r.atMs + STAGGER_WINDOW_MS)) {
+          latestEnd = r.atMs + STAGGER_WINDOW_MS;
+        }
+      }
+    }
+    if (overlapping < MAX_STARTS_PER_WINDOW) {
+      return candidate;
+    }
+    candidate = latestEnd;
+  }
+  return candidate;
+}
+
+void MeshCoordinator::record(uint32_t nodeId, uint32_t atMs, bool planned) {
+  if (planned) {
+    removePlanned(nodeId);  // 予約はノードごとに1件
+  }
+  StartRecord* slot = nullptr;
+  for (StartRecord& r : records_) {
+    if (!r.used) {
+      slot = &r;
+      break;
+    }
+    // 空きがなければ最も古い記録を上書き
+    if (!slot || before(r.atMs, slot->atMs)) {
+      slot = &r;
+    }
+  }
+  slot->nodeId = nodeId;
+  slot->atMs = atMs;
+  slot->planned = planned;
+  slot->used = true;
+}
+
+void MeshCoordinator::removePlanned(uint32_t nodeId) {
+  for (StartRecord& r : records_) {
+    if (r.used && r.planned && r.nodeId == nodeId) {
+      r.used = false;
+    }
+  }
+}
+
+// 判定に関係しなくなった記録（起動から STAGGER_WINDOW_MS 以上経過）を削除
+void MeshCoordinator::prune(uint32_t nowMs) {
+  for (StartRecord& r : records_) {
+    if (r.used && before(r.atMs + STAGGER_WINDOW_MS, nowMs)) {
+      r.used = false;
+    }
+  }
+}
+
+/**
+ * 送信元の起動回数・送信番号が前回より新しいかを確認して記録
+ * 起動回数が前回より小さい、または同じ起動で送信番号が前回以下のものは再送として拒否します。
+ */
+bool MeshCoordinator::acceptPeer(const MeshOrigin& origin, uint32_t nowMs) {
+  Peer* slot = nullptr;
+  for (Peer& p : peers_) {
+    if (p.nodeId == origin.nodeId) {
+      if (origin.boot < p.boot || (origin.boot == p.boot && origin.sequence <= p.sequence)) {
+        return false;
+      }
+      p.boot = origin.boot;
+      p.sequence = origin.sequence;
+      p.lastSeenMs = nowMs;
+      return true;
+    }
+    // 空きを優先し、なければ最も長く受信していないノードを置き換える
+    if (!slot || (slot->nodeId != 0 && (p.nodeId == 0 || before(p.lastSeenMs, slot->lastSeenMs)))) {
+      slot = &p;
+    }
+  }
+  slot->nodeId = origin.nodeId;
+  slot->lastSeenMs = nowMs;
+  slot->boot = origin.boot;
+  slot->sequence = origin.sequence;
+  LOG(MESH_PEER, origin.nodeId);
+  return true;
+}
+
+// 次に送信するメッセージの送信元（送信番号を進める）
+MeshOrigin MeshCoordinator::nextOrigin() {
+  MeshOrigin origin;
+  origin.nodeId = transport_.getNodeId();
+  origin.boot = transport_.getBootCount();
+  origin.sequence = ++sequence_;
+  return origin;
+}
+
+size_t MeshCoordinator::getPeerCount(uint32_t nowMs) const {
+  size_t count = 0;
+  for (const Peer& p : peers_) {
+    if (p.nodeId != 0 && nowMs - p.lastSeenMs < PEER_TIMEOUT_MS) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void MeshCoordinator::send(const uint8_t* data, size_t length) {
+  if (!transport_.broadcast(data, length)) {
+    LOG(MESH_SEND_FAIL);
+  }
+}
@@ -0,0 +1,185 @@
+/**
+ * MeshProtocol.cpp
+ *
+ * 複数台の連携用メッセージの符号化・復号の実装
+ */
+
+#include "MeshProtocol.h"
+
+#include <math.h>
+
+namespace {
+  constexpr size_t FORECAST_SIZE = 10;
+  constexpr size_t CLAIM_SIZE = 4;
+
+  inline void putU16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+  }
+
+  inline void putU32(uint8_t* out, uint32_t value) {
+    putU16(out, static_cast<uint16_t>(value));
+    putU16(out + 2, static_cast<uint16_t>(value >> 16));
+  }
+
+  inline uint16_t getU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+  }
+
+  inline uint32_t getU32(const uint8_t* in) {
+    return getU16(in) | (static_cast<uint32_t>(getU16(in + 2)) << 16);
+  }
+
+  // 0.1℃単位の符号付き整数に変換
+  inline int16_t toDeci(float value) {
+    return static_cast<int16_t>(lroundf(value * 10.0f));
+  }
+
+  inline uint64_t getU64(const uint8_t* in) {
+    return getU32(in) | (static_cast<uint64_t>(getU32(in + 4)) << 32);
+  }
+
+  inline uint64_t rotl(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+  }
+
+  inline void sipRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+  }
+
+  /**
+   * SipHash-2-4（短いメッセージ向けの鍵付きハッシュ、64ビット）
+   */
+  uint64_t sipHash(const uint8_t* key, const uint8_t* data, size_t length) {
+    uint64_t k0 = getU64(key);
+    uint64_t k1 = getU64(key + 8);
+    uint64_t v0 = k0 ^ 0x736f6d6570736575ULL;
+    uint64_t v1 = k1 ^ 0x646f72616e646f6dULL;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261ULL;
+    uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+
+    size_t whole = length & ~static_cast<size_t>(7);
+    for (size_t i = 0; i < whole; i += 8) {
+      uint64_t m = getU64(data + i);
+      v3 ^= m;
+      sipRound(v0, v1, v2, v3);
+      sipRound(v0, v1, v2, v3);
+      v0 ^= m;
+    }
+    uint64_t last = static_cast<uint64_t>(length) << 56;
+    for (size_t i = whole; i < length; i++) {
+      last |= static_cast<uint64_t>(data[i]) << (8 * (i - whole));
+    }
+    v3 ^= last;
+    sipRound(v0, v1, v2, v3);
+    sipRound(v0, v1, v2, v3);
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; i++) {
+      sipRound(v0, v1, v2, v3);
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+  }
+
+  // ヘッダーと本文の後ろに MAC を付ける
+  size_t seal(const uint8_t* key, uint8_t* out, size_t length) {
+    uint64_t mac = sipHash(key, out, length);
+    putU32(out + length, static_cast<uint32_t>(mac));
+    putU32(out + length + 4, static_cast<uint32_t>(mac >> 32));
+    return length + MeshProtocol::MAC_SIZE;
+  }
+
+  size_t putHeader(MeshMessageType type, const MeshOrigin& origin, uint8_t* out) {
+    out[0] = MeshProtocol::MAGIC;
+    out[1] = MeshProtocol::VERSION;
+    out[2] = static_cast<uint8_t>(type);
+    out[3] = 0;
+    putU32(out + 4, origin.nodeId);
+    putU32(out + 8, origin.boot);
+    putU32(out + 12, origin.sequence);
+    return MeshProtocol::HEADER_SIZE;
+  }
+}
+
+bool MeshProtocol::isKeySet(const uint8_t* key) {
+  uint8_t any = 0;
+  for (size_t i = 0; i < KEY_SIZE; i++) {
+    any |= key[i];
+  }
+  return any != 0;
+}
+
+size_t MeshProtocol::encodeForecast(const uint8_t* key, const MeshOrigin& origin, const MeshForecast& forecast, uint8_t* out) {
+  size_t length = putHeader(MeshMessageType::FORECAST, origin, out);
+  uint8_t* body = out + length;
+  putU32(body, forecast.epoch);
+  putU16(body + 4, static_cast<uint16_t>(toDeci(forecast.tempMax)));
+  putU16(body + 6, static_cast<uint16_t>(toDeci(forecast.tempMin)));
+  body[8] = forecast.weatherCode;
+  body[9] = forecast.valid ? 1 : 0;
+  return seal(key, out, length + FORECAST_SIZE);
+}
+
+size_t MeshProtocol::encodeClaim(const uint8_t* key, const MeshOrigin& origin, uint32_t delayMs, uint8_t* out) {
+  size_t length = putHeader(MeshMessageType::CLAIM, origin, out);
+  putU32(out + length, delayMs);
+  return seal(key, out, length + CLAIM_SIZE);
+}
+
+size_t MeshProtocol::encodeStart(const uint8_t* key, const MeshOrigin& origin, uint8_t* out) {
+  return seal(key, out, putHeader(MeshMessageType::START, origin, out));
+}
+
+size_t MeshProtocol::encodeRelease(const uint8_t* key, const MeshOrigin& origin, uint8_t* out) {
+  return seal(key, out, putHeader(MeshMessageType::RELEASE, origin, out));
+}
+
+bool MeshProtocol::verify(const uint8_t* key, const uint8_t* data, size_t length) {
+  if (length < HEADER_SIZE + MAC_SIZE) {
+    return false;
+  }
+  size_t signedLength = length - MAC_SIZE;
+  uint64_t mac = sipHash(key, data, signedLength);
+  uint64_t received = getU64(data + signedLength);
+  return (mac ^ received) == 0;
+}
+
+bool MeshProtocol::decode(const uint8_t* data, size_t length, MeshMessage& out) {
+  if (length < HEADER_SIZE + MAC_SIZE || data[0] != MAGIC || data[1] != VERSION) {
+    return false;
+  }
+  out.type = static_cast<MeshMessageType>(data[2]);
+  out.origin.nodeId = getU32(data + 4);
+  out.origin.boot = getU32(data + 8);
+  out.origin.sequence = getU32(data + 12);
+  const uint8_t* body = data + HEADER_SIZE;
+  size_t bodyLength = length - HEADER_SIZE - MAC_SIZE;
+
+  switch (out.type) {
+    case MeshMessageType::FORECAST:
+      if (bodyLength < FORECAST_SIZE) {
+        return false;
+      }
+      out.forecast.epoch = getU32(body);
+      out.forecast.tempMax = static_cast<int16_t>(getU16(body + 4)) / 10.0f;
+      out.forecast.tempMin = static_cast<int16_t>(getU16(body + 6)) / 10.0f;
+      out.forecast.weatherCode = body[8];
+      out.forecast.valid = body[9] != 0;
+      return true;
+    case MeshMessageType::CLAIM:
+      if (bodyLength < CLAIM_SIZE) {
+        return false;
+      }
+      out.delayMs = getU32(body);
+      return true;
+    case MeshMessageType::START:
+    case MeshMessageType::RELEASE:
+      return true;
+    default:
+      return false;  // 新しいバージョンの種別は無視
+  }
+}
@@ -0,0 +1,245 @@
+/**
+ * MeshTransport.cpp
+ *
+ * 複数台の連携用のブロードキャスト通信の実装
+ */
+
+#include "MeshTransport.h"
+
+#include <errno.h>
+#include <string.h>
+#include "AllocCounter.h"
+#include "Logger.h"
+
+#ifdef ARDUINO
+#include <Preferences.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef ARDUINO
+  const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  const char* NVS_NAMESPACE = "aircon";
+  const char* NVS_KEY = "meshBoot";
+#else
+  const char* const UDP_BROADCAST_ADDRESS = "127.255.255.255";  // ループバック内のブロードキャスト
+#endif
+}
+
+#ifdef ARDUINO
+MeshTransport* MeshTransport::instance_ = nullptr;
+#endif
+
+/**
+ * コンストラクタ
+ */
+MeshTransport::MeshTransport(uint16_t udpPort)
+  : udpPort_(udpPort),
+    nodeId_(0),
+    bootCount_(0),
+    queue_(),
+    head_(0),
+    count_(0),
+    dropped_(0) {
+#ifdef ARDUINO
+  portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+  lock_ = unlocked;
+#else
+  socket_ = -1;
+#endif
+}
+
+MeshTransport::~MeshTransport() {
+#ifndef ARDUINO
+  if (socket_ >= 0) {
+    close(socket_);
+  }
+#endif
+}
+
+#ifdef ARDUINO
+
+bool MeshTransport::begin() {
+  uint8_t mac[6];
+  esp_wifi_get_mac(WIFI_IF_STA, mac);
+  nodeId_ = (static_cast<uint32_t>(mac[2]) << 24) | (static_cast<uint32_t>(mac[3]) << 16) |
+            (static_cast<uint32_t>(mac[4]) << 8) | mac[5];
+
+  // 起動回数（受信側が前回の起動のメッセージの再送を見分けるため、保存できない場合は連携しない）
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false)) {
+    LOG(MESH_INIT_FAIL, "nvs", 0);
+    return false;
+  }
+  bootCount_ = prefs.getUInt(NVS_KEY, 0) + 1;
+  bool saved = prefs.putUInt(NVS_KEY, bootCount_) == sizeof(uint32_t);
+  prefs.end();
+  if (!saved) {
+    LOG(MESH_INIT_FAIL, "nvs", 0);
+    return false;
+  }
+
+  esp_err_t err = esp_now_init();
+  if (err != ESP_OK) {
+    LOG(MESH_INIT_FAIL, "esp_now_init", static_cast<int>(err));
+    return false;
+  }
+  instance_ = this;
+  esp_now_register_recv_cb(onReceive);
+
+  esp_now_peer_info_t peer;
+  memset(&peer, 0, sizeof(peer));
+  memcpy(peer.peer_addr, BROADCAST_MAC, sizeof(BROADCAST_MAC));
+  peer.channel = 0;  // 現在のチャンネル（接続中のアクセスポイントと同じ）
+  peer.ifidx = WIFI_IF_STA;
+  peer.encrypt = false;
+  err = esp_now_add_peer(&peer);
+  if (err != ESP_OK) {
+    LOG(MESH_INIT_FAIL, "esp_now_add_peer", static_cast<int>(err));
+    return false;
+  }
+  LOG(MESH_STARTED, "ESP-NOW", nodeId_);
+  return true;
+}
+
+bool MeshTransport::broadcast(const uint8_t* data, size_t length) {
+  AllocExemption exemption;  // ESP-NOW の送信は送信バッファを確保する
+  return esp_now_send(BROADCAST_MAC, data, length) == ESP_OK;
+}
+
+/**
+ * ESP-NOW の受信コールバック（WiFi タスクで実行されるため、キューに積むだけ）
+ */
+void MeshTransport::onReceive(const uint8_t* mac, const uint8_t* data, int length) {
+  if (instance_ && length > 0) {
+    instance_->enqueue(data, static_cast<size_t>(length));
+  }
+}
+
+size_t MeshTransport::receive(uint8_t* out) {
+  size_t length = 0;
+  portENTER_CRITICAL(&lock_);
+  if (count_ > 0) {
+    const Slot& slot = queue_[head_];
+    length = slot.length;
+    memcpy(out, slot.data, length);
+    head_ = (head_ + 1) % QUEUE_SIZE;
+    count_ = count_ - 1;
+  }
+  portEXIT_CRITICAL(&lock_);
+  return length;
+}
+
+void MeshTransport::enqueue(const uint8_t* data, size_t length) {
+  if (length > MeshProtocol::MAX_MESSAGE_SIZE) {
+    return;
+  }
+  portENTER_CRITICAL(&lock_);
+  if (count_ < QUEUE_SIZE) {
+    Slot& slot = queue_[(head_ + count_) % QUEUE_SIZE];
+    slot.length = static_cast<uint8_t>(length);
+    memcpy(slot.data, data, length);
+    count_ = count_ + 1;
+  } else {
+    dropped_ = dropped_ + 1;
+  }
+  portEXIT_CRITICAL(&lock_);
+}
+
+#else
+
+bool MeshTransport::begin() {
+  socket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (socket_ < 0) {
+    LOG(MESH_INIT_FAIL, "socket", errno);
+    return false;
+  }
+  // 同じポートで複数ノードを動かすため、ポートを共有してブロードキャストを許可
+  int on = 1;
+  setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#ifdef SO_REUSEPORT
+  setsockopt(socket_, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+#endif
+  setsockopt(socket_, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+  fcntl(socket_, F_SETFL, fcntl(socket_, F_GETFL, 0) | O_NONBLOCK);
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(udpPort_);
+  if (bind(socket_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+    LOG(MESH_INIT_FAIL, "bind", errno);
+    close(socket_);
+    socket_ = -1;
+    return false;
+  }
+  if (nodeId_ == 0) {
+    nodeId_ = static_cast<uint32_t>(getpid());
+  }
+  bootCount_ = static_cast<uint32_t>(time(nullptr));  // プロセスの起動ごとに増える
+  LOG(MESH_STARTED, "UDP", nodeId_);
+  return true;
+}
+
+bool MeshTransport::broadcast(const uint8_t* data, size_t length) {
+  if (socket_ < 0) {
+    return false;
+  }
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(udpPort_);
+  inet_pton(AF_INET, UDP_BROADCAST_ADDRESS, &addr.sin_addr);
+  return sendto(socket_, data, length, 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) ==
+         static_cast<ssize_t>(length);
+}
+
+size_t MeshTransport::receive(uint8_t* out) {
+  pollSocket();
+  if (count_ == 0) {
+    return 0;
+  }
+  const Slot& slot = queue_[head_];
+  size_t length = slot.length;
+  memcpy(out, slot.data, length);
+  head_ = (head_ + 1) % QUEUE_SIZE;
+  count_ = count_ - 1;
+  return length;
+}
+
+// ソケットに届いている分をキューへ移す
+void MeshTransport::pollSocket() {
+  if (socket_ < 0) {
+    return;
+  }
+  uint8_t buffer[MeshProtocol::MAX_MESSAGE_SIZE + 1];
+  ssize_t n;
+  while ((n = recv(socket_, buffer, sizeof(buffer), 0)) > 0) {
+    enqueue(buffer, static_cast<size_t>(n));
+  }
+}
+
+void MeshTransport::enqueue(const uint8_t* data, size_t length) {
+  if (length > MeshProtocol::MAX_MESSAGE_SIZE) {
+    return;
+  }
+  if (count_ < QUEUE_SIZE) {
+    Slot& slot = queue_[(head_ + count_) % QUEUE_SIZE];
+    slot.length = static_cast<uint8_t>(length);
+    memcpy(slot.data, data, length);
+    count_ = count_ + 1;
+  } else {
+    dropped_ = dropped_ + 1;
+  }
+}
+
+#endif
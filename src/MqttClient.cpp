@@ -0,0 +1,670 @@
+/**
+ * MqttClient.cpp
+ *
+ * MQTT によるテレメトリ送信・コマンド受信クラスの実装
+ */
+
+#include "MqttClient.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Logger.h"
+#include "StatusFormat.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <WiFi.h>
+#include <freertos/task.h>
+#include <lwip/netdb.h>
+#include <lwip/sockets.h>
+#else
+#include <chrono>
+#include <thread>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+#ifdef ARDUINO
+  constexpr uint32_t TASK_STACK_SIZE = 4096;
+  constexpr UBaseType_t TASK_PRIORITY = 1;
+  constexpr BaseType_t TASK_CORE = 0;
+#endif
+  constexpr uint32_t TASK_SERVICE_MS = 200;
+  constexpr float SETPOINT_MIN = 16.0f;   // 受け付ける目標室温の範囲
+  constexpr float SETPOINT_MAX = 30.0f;
+
+  const ACMode COMMAND_MODES[] = {
+    ACMode::OFF, ACMode::HEATING_23_5, ACMode::HEATING_18, ACMode::COOLING_25, ACMode::DEHUMID_MINUS_1_5
+  };
+
+  inline uint32_t nowMs() {
+#ifdef ARDUINO
+    return millis();
+#else
+    static const auto start = std::chrono::steady_clock::now();
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start).count());
+#endif
+  }
+
+  inline void sleepMs(uint32_t ms) {
+#ifdef ARDUINO
+    vTaskDelay(pdMS_TO_TICKS(ms));
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+  }
+
+  inline bool networkAvailable() {
+#ifdef ARDUINO
+    return WiFi.status() == WL_CONNECTED;
+#else
+    return true;
+#endif
+  }
+
+  void setTimeout(int sock, int option, uint32_t ms) {
+    struct timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    setsockopt(sock, SOL_SOCKET, option, &tv, sizeof(tv));
+  }
+
+  // 受信したトピックが <base>/<suffix> と一致するか
+  bool topicEquals(const MqttPublish& publish, const char* expected) {
+    size_t length = strlen(expected);
+    return publish.topicLength == length && memcmp(publish.topic, expected, length) == 0;
+  }
+}
+
+/**
+ * コンストラクタ
+ */
+MqttClient::MqttClient(const char* host, uint16_t port, const char* clientId, const char* baseTopic,
+                       const char* username, const char* password)
+  : host_(host),
+    port_(port),
+    clientId_(clientId),
+    baseTopic_(baseTopic),
+    username_(username),
+    password_(password),
+    head_(0),
+    count_(0),
+    flushRequested_(false),
+    droppedCount_(0),
+    commandHead_(0),
+    commandCount_(0),
+    parser_(onPacket, this),
+    socket_(-1),
+    connected_(false),
+    connackReceived_(false),
+    connackCode_(0),
+    pingPending_(false),
+    nextPacketId_(1),
+    lastFlush_(0),
+    lastSend_(0),
+    pingSentAt_(0),
+    lastAttempt_(0),
+    reconnectDelay_(0) {
+#ifdef ARDUINO
+  portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+  lock_ = unlocked;
+#endif
+}
+
+MqttClient::~MqttClient() {
+  if (socket_ >= 0) {
+    close(socket_);
+  }
+}
+
+void MqttClient::lock() {
+#ifdef ARDUINO
+  portENTER_CRITICAL(&lock_);
+#else
+  lock_.lock();
+#endif
+}
+
+void MqttClient::unlock() {
+#ifdef ARDUINO
+  portEXIT_CRITICAL(&lock_);
+#else
+  lock_.unlock();
+#endif
+}
+
+void MqttClient::begin() {
+#ifdef ARDUINO
+  xTaskCreatePinnedToCore(clientTask, "mqtt", TASK_STACK_SIZE, this, TASK_PRIORITY, nullptr, TASK_CORE);
+#endif
+}
+
+#ifdef ARDUINO
+void MqttClient::clientTask(void* param) {
+  MqttClient* client = static_cast<MqttClient*>(param);
+  for (;;) {
+    client->service(TASK_SERVICE_MS);
+  }
+}
+#endif
+
+// ========================================
+// 送信キュー（loop() 側）
+// ========================================
+
+void MqttClient::publishSample(const SensorData& data) {
+  char payload[MAX_PAYLOAD];
+  int length = snprintf(payload, sizeof(payload),
+                        "{\"temperature\":%.1f,\"humidity\":%.1f,\"discomfort_index\":%.1f}",
+                        data.temperature, data.humidity, data.discomfortIndex);
+  enqueue(MqttTopic::SENSOR, 0, false, true, payload, length);
+}
+
+void MqttClient::publishMode(ACMode mode) {
+  const char* name = StatusFormat::modeName(mode);
+  enqueue(MqttTopic::MODE, 1, true, false, name, strlen(name));
+  flushRequested_ = true;
+}
+
+void MqttClient::publishHealth(const StatusSnapshot& status) {
+  const PhaseStats& loopStats = status.phases[static_cast<size_t>(LoopPhase::LOOP_TOTAL)];
+  char payload[MAX_PAYLOAD];
+  int length = snprintf(payload, sizeof(payload),
+                        "{\"uptime_ms\":%lu,\"free_heap\":%lu,\"min_free_heap\":%lu,"
+                        "\"loop_p99_us\":%lu,\"log_dropped\":%lu,\"mqtt_dropped\":%lu}",
+                        static_cast<unsigned long>(status.uptimeMs),
+                        static_cast<unsigned long>(status.freeHeap),
+                        static_cast<unsigned long>(status.minFreeHeap),
+                        static_cast<unsigned long>(loopStats.p99 / (status.cpuMHz ? status.cpuMHz : 1)),
+                        static_cast<unsigned long>(status.logDropped),
+                        static_cast<unsigned long>(droppedCount_));
+  enqueue(MqttTopic::HEALTH, 0, false, true, payload, length);
+}
+
+/**
+ * 送信キューに追加
+ * 同じトピックの未送信メッセージがあれば上書きし（coalesce）、
+ * 満杯なら QoS 0 → 未送信の QoS 1 → 最も古いもの の順に1件破棄します。
+ */
+void MqttClient::enqueue(MqttTopic topic, uint8_t qos, bool retain, bool coalesce, const char* payload, int length) {
+  if (length < 0) {
+    return;
+  }
+  if (static_cast<size_t>(length) >= MAX_PAYLOAD) {
+    length = MAX_PAYLOAD - 1;
+  }
+
+  bool dropped = false;
+  lock();
+  Message* slot = nullptr;
+  if (coalesce) {
+    for (size_t i = 0; i < count_; i++) {
+      Message& message = at(i);
+      if (message.topic == topic && message.coalesce && !message.sent) {
+        slot = &message;
+        break;
+      }
+    }
+  }
+
+  if (!slot) {
+    if (count_ == QUEUE_SIZE) {
+      size_t victim = 0;
+      bool found = false;
+      for (size_t i = 0; i < count_ && !found; i++) {
+        found = at(i).qos == 0;
+        victim = i;
+      }
+      for (size_t i = 0; i < count_ && !found; i++) {
+        found = !at(i).sent;
+        victim = i;
+      }
+      removeAt(found ? victim : 0);
+      dropped = true;
+    }
+    slot = &at(count_);
+    count_++;
+    slot->topic = topic;
+    slot->qos = qos;
+    slot->retain = retain;
+    slot->coalesce = coalesce;
+    slot->sent = false;
+    slot->dup = false;
+    slot->packetId = 0;
+  }
+  memcpy(slot->payload, payload, length);
+  slot->length = static_cast<uint8_t>(length);
+  unlock();
+
+  if (dropped) {
+    droppedCount_ = droppedCount_ + 1;
+    LOG(MQTT_QUEUE_DROP, droppedCount_);
+  }
+}
+
+// キューの要素を削除（先頭以外は後ろの要素を詰める）
+void MqttClient::removeAt(size_t index) {
+  if (index == 0) {
+    head_ = (head_ + 1) % QUEUE_SIZE;
+  } else {
+    for (size_t i = index; i + 1 < count_; i++) {
+      at(i) = at(i + 1);
+    }
+  }
+  count_--;
+}
+
+size_t MqttClient::getQueuedCount() {
+  lock();
+  size_t count = count_;
+  unlock();
+  return count;
+}
+
+bool MqttClient::pollCommand(MqttCommand& out) {
+  bool available = false;
+  lock();
+  if (commandCount_ > 0) {
+    out = commands_[commandHead_];
+    commandHead_ = (commandHead_ + 1) % COMMAND_QUEUE_SIZE;
+    commandCount_--;
+    available = true;
+  }
+  unlock();
+  return available;
+}
+
+// ========================================
+// 通信処理（通信タスク側）
+// ========================================
+
+void MqttClient::service(uint32_t timeoutMs) {
+  uint32_t now = nowMs();
+
+  if (!connected_) {
+    if (!networkAvailable() || (reconnectDelay_ > 0 && now - lastAttempt_ < reconnectDelay_)) {
+      sleepMs(timeoutMs);
+      return;
+    }
+    lastAttempt_ = now;
+    if (connect()) {
+      reconnectDelay_ = 0;
+    } else {
+      reconnectDelay_ = reconnectDelay_ == 0 ? RECONNECT_MIN_MS : reconnectDelay_ * 2;
+      if (reconnectDelay_ > RECONNECT_MAX_MS) {
+        reconnectDelay_ = RECONNECT_MAX_MS;
+      }
+    }
+    return;
+  }
+
+  // 次の送信時刻まで受信を待つ
+  uint32_t untilFlush = now - lastFlush_ >= BATCH_INTERVAL_MS ? 0 : BATCH_INTERVAL_MS - (now - lastFlush_);
+  uint32_t wait = flushRequested_ ? 0 : (untilFlush < timeoutMs ? untilFlush : timeoutMs);
+
+  fd_set readSet;
+  FD_ZERO(&readSet);
+  FD_SET(socket_, &readSet);
+  struct timeval tv;
+  tv.tv_sec = wait / 1000;
+  tv.tv_usec = (wait % 1000) * 1000;
+  if (select(socket_ + 1, &readSet, nullptr, nullptr, &tv) > 0) {
+    uint8_t buffer[128];
+    ssize_t n = recv(socket_, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+      disconnect("受信エラー");
+      return;
+    }
+    parser_.feed(buffer, n);
+  }
+
+  now = nowMs();
+  if (connected_ && (flushRequested_ || now - lastFlush_ >= BATCH_INTERVAL_MS)) {
+    flushRequested_ = false;
+    lastFlush_ = now;
+    if (!flushQueue()) {
+      disconnect("送信エラー");
+      return;
+    }
+  }
+
+  // キープアライブ（送信が途絶えたら PINGREQ、応答がなければ切断）
+  if (connected_ && pingPending_ && now - pingSentAt_ >= SOCKET_TIMEOUT_MS) {
+    disconnect("PINGRESP なし");
+  } else if (connected_ && !pingPending_ && now - lastSend_ >= KEEP_ALIVE_SEC * 1000UL / 2) {
+    size_t length = MqttCodec::encodePingreq(txBuffer_, sizeof(txBuffer_));
+    if (!sendRaw(txBuffer_, length)) {
+      disconnect("送信エラー");
+      return;
+    }
+    pingPending_ = true;
+    pingSentAt_ = now;
+  }
+}
+
+/**
+ * ブローカーに接続し、CONNECT → CONNACK → SUBSCRIBE まで行う
+ */
+bool MqttClient::connect() {
+  LOG(MQTT_CONNECTING, host_, port_);
+
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  char portText[6];
+  snprintf(portText, sizeof(portText), "%u", port_);
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(host_, portText, &hints, &result) != 0 || !result) {
+    LOG(MQTT_CONNECT_FAIL, "名前解決", 0);
+    return false;
+  }
+
+  socket_ = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+  if (socket_ < 0) {
+    freeaddrinfo(result);
+    LOG(MQTT_CONNECT_FAIL, "socket", errno);
+    return false;
+  }
+
+  // 接続はノンブロッキングで開始し、タイムアウト付きで待つ
+  int flags = fcntl(socket_, F_GETFL, 0);
+  fcntl(socket_, F_SETFL, flags | O_NONBLOCK);
+  int rc = ::connect(socket_, result->ai_addr, result->ai_addrlen);
+  freeaddrinfo(result);
+  if (rc < 0 && errno != EINPROGRESS) {
+    LOG(MQTT_CONNECT_FAIL, "connect", errno);
+    close(socket_);
+    socket_ = -1;
+    return false;
+  }
+  if (rc < 0) {
+    fd_set writeSet;
+    FD_ZERO(&writeSet);
+    FD_SET(socket_, &writeSet);
+    struct timeval tv;
+    tv.tv_sec = SOCKET_TIMEOUT_MS / 1000;
+    tv.tv_usec = (SOCKET_TIMEOUT_MS % 1000) * 1000;
+    int error = 0;
+    socklen_t errorLength = sizeof(error);
+    if (select(socket_ + 1, nullptr, &writeSet, nullptr, &tv) <= 0 ||
+        getsockopt(socket_, SOL_SOCKET, SO_ERROR, &error, &errorLength) < 0 || error != 0) {
+      LOG(MQTT_CONNECT_FAIL, "connect", error ? error : ETIMEDOUT);
+      close(socket_);
+      socket_ = -1;
+      return false;
+    }
+  }
+  fcntl(socket_, F_SETFL, flags & ~O_NONBLOCK);
+  setTimeout(socket_, SO_RCVTIMEO, SOCKET_TIMEOUT_MS);
+  setTimeout(socket_, SO_SNDTIMEO, SOCKET_TIMEOUT_MS);
+
+  // CONNECT（切断時はブローカーが status に "offline" を送る）
+  char willTopic[64];
+  topicName(topicSuffix(MqttTopic::STATUS), willTopic, sizeof(willTopic));
+  MqttConnectOptions options = {clientId_, KEEP_ALIVE_SEC, willTopic, "offline", true, username_, password_};
+  size_t length = MqttCodec::encodeConnect(options, txBuffer_, sizeof(txBuffer_));
+  parser_.reset();
+  connackReceived_ = false;
+  if (length == 0 || !sendRaw(txBuffer_, length) || !waitForConnack()) {
+    LOG(MQTT_CONNECT_FAIL, "CONNACK", connackReceived_ ? connackCode_ : 0);
+    close(socket_);
+    socket_ = -1;
+    return false;
+  }
+
+  connected_ = true;
+  pingPending_ = false;
+
+  // コマンドの購読と online の通知
+  char topic[TOPIC_SIZE];
+  topicName("cmd/+", topic, sizeof(topic));
+  length = MqttCodec::encodeSubscribe(nextPacketId_++, topic, 1, txBuffer_, sizeof(txBuffer_));
+  if (nextPacketId_ == 0) nextPacketId_ = 1;
+  const char* online = "online";
+  length += MqttCodec::encodePublish(willTopic, reinterpret_cast<const uint8_t*>(online), strlen(online),
+                                     0, true, false, 0, txBuffer_ + length, sizeof(txBuffer_) - length);
+  if (!sendRaw(txBuffer_, length)) {
+    disconnect("送信エラー");
+    return false;
+  }
+
+  // PUBACK 待ちだった QoS 1 は再送する
+  lock();
+  for (size_t i = 0; i < count_; i++) {
+    Message& message = at(i);
+    if (message.sent && message.qos > 0) {
+      message.sent = false;
+      message.dup = true;
+    }
+  }
+  unlock();
+  flushRequested_ = true;
+
+  LOG(MQTT_CONNECTED, baseTopic_);
+  return true;
+}
+
+bool MqttClient::waitForConnack() {
+  uint32_t start = nowMs();
+  while (!connackReceived_ && nowMs() - start < SOCKET_TIMEOUT_MS) {
+    uint8_t buffer[16];
+    ssize_t n = recv(socket_, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+      return false;
+    }
+    parser_.feed(buffer, n);
+  }
+  return connackReceived_ && connackCode_ == MqttCodec::CONNACK_ACCEPTED;
+}
+
+void MqttClient::disconnect(const char* reason) {
+  if (socket_ >= 0) {
+    close(socket_);
+    socket_ = -1;
+  }
+  if (connected_) {
+    connected_ = false;
+    LOG(MQTT_DISCONNECTED, reason);
+  }
+  lastAttempt_ = nowMs();
+  reconnectDelay_ = RECONNECT_MIN_MS;
+}
+
+/**
+ * 未送信のメッセージを送信バッファにまとめて送る
+ * ロック中（ESP32 では割り込み禁止）はメッセージのコピーだけを行い、
+ * トピック名の書式化・符号化・send はロックの外で行います。
+ */
+bool MqttClient::flushQueue() {
+  for (;;) {
+    size_t length = 0;
+    Message message;
+    // 最大サイズの1件が入る空きがある間だけ取り出す（取り出した分は必ず符号化できる）
+    while (sizeof(txBuffer_) - length >= MAX_PUBLISH_SIZE && takeUnsent(message)) {
+      char topic[TOPIC_SIZE];
+      topicName(topicSuffix(message.topic), topic, sizeof(topic));
+      length += MqttCodec::encodePublish(topic, reinterpret_cast<const uint8_t*>(message.payload),
+                                         message.length, message.qos, message.retain, message.dup,
+                                         message.packetId, txBuffer_ + length, sizeof(txBuffer_) - length);
+    }
+
+    if (length == 0) {
+      return true;
+    }
+    if (!sendRaw(txBuffer_, length)) {
+      return false;
+    }
+  }
+}
+
+/**
+ * 未送信のメッセージを1件コピーして送信済みにする
+ * QoS 0 は取り出した時点でキューから削除し、QoS 1 はパケットIDを割り当てて PUBACK を待ちます。
+ * @return false: 未送信のメッセージなし
+ */
+bool MqttClient::takeUnsent(Message& out) {
+  bool found = false;
+  lock();
+  for (size_t i = 0; i < count_; i++) {
+    Message& message = at(i);
+    if (message.sent) {
+      continue;
+    }
+    if (message.qos > 0 && message.packetId == 0) {
+      message.packetId = nextPacketId_++;
+      if (nextPacketId_ == 0) nextPacketId_ = 1;
+    }
+    out = message;
+    if (message.qos == 0) {
+      removeAt(i);
+    } else {
+      message.sent = true;
+    }
+    found = true;
+    break;
+  }
+  unlock();
+  return found;
+}
+
+bool MqttClient::sendRaw(const uint8_t* data, size_t length) {
+  while (length > 0) {
+    ssize_t n = send(socket_, data, length, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    length -= n;
+  }
+  lastSend_ = nowMs();
+  return true;
+}
+
+void MqttClient::onPacket(const MqttPacket& packet, void* context) {
+  static_cast<MqttClient*>(context)->handlePacket(packet);
+}
+
+void MqttClient::handlePacket(const MqttPacket& packet) {
+  switch (packet.type) {
+    case MqttPacketType::CONNACK:
+      connackReceived_ = MqttCodec::parseConnack(packet, connackCode_);
+      break;
+
+    case MqttPacketType::PUBACK: {
+      uint16_t packetId;
+      if (MqttCodec::parsePacketId(packet, packetId)) {
+        lock();
+        for (size_t i = 0; i < count_; i++) {
+          if (at(i).sent && at(i).packetId == packetId) {
+            removeAt(i);
+            break;
+          }
+        }
+        unlock();
+      }
+      break;
+    }
+
+    case MqttPacketType::PUBLISH: {
+      MqttPublish publish;
+      if (MqttCodec::parsePublish(packet, publish)) {
+        handleCommand(publish);
+        if (publish.qos == 1) {
+          size_t length = MqttCodec::encodePuback(publish.packetId, txBuffer_, sizeof(txBuffer_));
+          sendRaw(txBuffer_, length);
+        }
+      }
+      break;
+    }
+
+    case MqttPacketType::PINGRESP:
+      pingPending_ = false;
+      break;
+
+    default:
+      break;  // SUBACK など
+  }
+}
+
+/**
+ * コマンドを解析して loop() 向けのキューに積む
+ */
+void MqttClient::handleCommand(const MqttPublish& publish) {
+  char text[32];
+  size_t length = publish.payloadLength < sizeof(text) - 1 ? publish.payloadLength : sizeof(text) - 1;
+  memcpy(text, publish.payload, length);
+  text[length] = '\0';
+
+  char topic[TOPIC_SIZE];
+  MqttCommand command = {};
+
+  topicName("cmd/mode", topic, sizeof(topic));
+  if (topicEquals(publish, topic)) {
+    for (ACMode mode : COMMAND_MODES) {
+      if (strcmp(text, StatusFormat::modeName(mode)) == 0) {
+        command.type = MqttCommandType::MODE;
+        command.mode = mode;
+        pushCommand(command);
+        LOG(MQTT_COMMAND_MODE, text);
+        return;
+      }
+    }
+    LOG(MQTT_BAD_COMMAND, "mode", text);
+    return;
+  }
+
+  topicName("cmd/setpoint", topic, sizeof(topic));
+  if (topicEquals(publish, topic)) {
+    char* end = nullptr;
+    float lower = strtof(text, &end);
+    float upper = (end && *end == ',') ? strtof(end + 1, &end) : 0.0f;
+    if (end && *end == '\0' && lower >= SETPOINT_MIN && upper <= SETPOINT_MAX && lower < upper) {
+      command.type = MqttCommandType::SETPOINT;
+      command.tempLower = lower;
+      command.tempUpper = upper;
+      pushCommand(command);
+      LOG(MQTT_COMMAND_SETPOINT, lower, upper);
+      return;
+    }
+    LOG(MQTT_BAD_COMMAND, "setpoint", text);
+  }
+}
+
+void MqttClient::pushCommand(const MqttCommand& command) {
+  lock();
+  if (commandCount_ == COMMAND_QUEUE_SIZE) {
+    // 取り出されていない古いコマンドを捨てる（新しい指示を優先）
+    commandHead_ = (commandHead_ + 1) % COMMAND_QUEUE_SIZE;
+    commandCount_--;
+  }
+  commands_[(commandHead_ + commandCount_) % COMMAND_QUEUE_SIZE] = command;
+  commandCount_++;
+  unlock();
+}
+
+void MqttClient::topicName(const char* suffix, char* out, size_t size) const {
+  snprintf(out, size, "%s/%s", baseTopic_, suffix);
+}
+
+const char* MqttClient::topicSuffix(MqttTopic topic) {
+  switch (topic) {
+    case MqttTopic::SENSOR: return "sensor";
+    case MqttTopic::MODE:   return "mode";
+    case MqttTopic::HEALTH: return "health";
+    case MqttTopic::STATUS: return "status";
+    default:                return "unknown";
+  }
+}
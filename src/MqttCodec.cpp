@@ -0,0 +1,319 @@
+/**
+ * MqttCodec.cpp
+ *
+ * MQTT 3.1.1 パケットの符号化・復号の実装
+ */
+
+#include "MqttCodec.h"
+
+#include <string.h>
+
+namespace {
+  constexpr uint8_t CONNECT_CLEAN_SESSION = 0x02;
+  constexpr uint8_t CONNECT_WILL = 0x04;
+  constexpr uint8_t CONNECT_WILL_RETAIN = 0x20;
+  constexpr uint8_t CONNECT_PASSWORD = 0x40;
+  constexpr uint8_t CONNECT_USERNAME = 0x80;
+  constexpr uint8_t PUBLISH_DUP = 0x08;
+  constexpr uint8_t PUBLISH_RETAIN = 0x01;
+  constexpr uint32_t MAX_REMAINING_LENGTH = 268435455;  // 可変長4バイトの上限
+
+  inline bool hasText(const char* text) {
+    return text && text[0] != '\0';
+  }
+
+  inline size_t stringSize(const char* text) {
+    return 2 + strlen(text);
+  }
+
+  // 固定バッファへの書き込み（はみ出したら以降は無視し、failed を立てる）
+  class PacketWriter {
+  public:
+    PacketWriter(uint8_t* out, size_t size) : out_(out), size_(size), pos_(0), failed_(false) {}
+
+    void byte(uint8_t value) {
+      if (pos_ >= size_) {
+        failed_ = true;
+        return;
+      }
+      out_[pos_++] = value;
+    }
+
+    void u16(uint16_t value) {
+      byte(static_cast<uint8_t>(value >> 8));
+      byte(static_cast<uint8_t>(value));
+    }
+
+    void bytes(const void* data, size_t length) {
+      if (pos_ + length > size_) {
+        failed_ = true;
+        return;
+      }
+      memcpy(out_ + pos_, data, length);
+      pos_ += length;
+    }
+
+    void string(const char* text) {
+      size_t length = strlen(text);
+      u16(static_cast<uint16_t>(length));
+      bytes(text, length);
+    }
+
+    // 固定ヘッダー（種別・フラグ・残りバイト数）
+    void header(MqttPacketType type, uint8_t flags, size_t remaining) {
+      if (remaining > MAX_REMAINING_LENGTH) {
+        failed_ = true;
+        return;
+      }
+      byte(static_cast<uint8_t>((static_cast<uint8_t>(type) << 4) | flags));
+      do {
+        uint8_t digit = remaining % 128;
+        remaining /= 128;
+        byte(remaining > 0 ? (digit | 0x80) : digit);
+      } while (remaining > 0);
+    }
+
+    size_t result() const { return failed_ ? 0 : pos_; }
+
+  private:
+    uint8_t* out_;
+    size_t size_;
+    size_t pos_;
+    bool failed_;
+  };
+}
+
+// ========================================
+// 符号化
+// ========================================
+
+size_t MqttCodec::encodeConnect(const MqttConnectOptions& options, uint8_t* out, size_t size) {
+  bool will = hasText(options.willTopic);
+  bool username = hasText(options.username);
+  bool password = username && hasText(options.password);
+
+  uint8_t flags = CONNECT_CLEAN_SESSION;
+  size_t remaining = 10 + stringSize(options.clientId);
+  if (will) {
+    flags |= CONNECT_WILL;
+    if (options.willRetain) {
+      flags |= CONNECT_WILL_RETAIN;
+    }
+    remaining += stringSize(options.willTopic) + stringSize(options.willMessage);
+  }
+  if (username) {
+    flags |= CONNECT_USERNAME;
+    remaining += stringSize(options.username);
+  }
+  if (password) {
+    flags |= CONNECT_PASSWORD;
+    remaining += stringSize(options.password);
+  }
+
+  PacketWriter writer(out, size);
+  writer.header(MqttPacketType::CONNECT, 0, remaining);
+  writer.string("MQTT");
+  writer.byte(4);  // プロトコルレベル（3.1.1）
+  writer.byte(flags);
+  writer.u16(options.keepAliveSec);
+  writer.string(options.clientId);
+  if (will) {
+    writer.string(options.willTopic);
+    writer.string(options.willMessage);
+  }
+  if (username) {
+    writer.string(options.username);
+  }
+  if (password) {
+    writer.string(options.password);
+  }
+  return writer.result();
+}
+
+size_t MqttCodec::encodePublish(const char* topic, const uint8_t* payload, size_t payloadLength,
+                                uint8_t qos, bool retain, bool dup, uint16_t packetId,
+                                uint8_t* out, size_t size) {
+  uint8_t flags = static_cast<uint8_t>(qos << 1);
+  if (retain) {
+    flags |= PUBLISH_RETAIN;
+  }
+  if (dup && qos > 0) {
+    flags |= PUBLISH_DUP;
+  }
+  size_t remaining = stringSize(topic) + (qos > 0 ? 2 : 0) + payloadLength;
+
+  PacketWriter writer(out, size);
+  writer.header(MqttPacketType::PUBLISH, flags, remaining);
+  writer.string(topic);
+  if (qos > 0) {
+    writer.u16(packetId);
+  }
+  writer.bytes(payload, payloadLength);
+  return writer.result();
+}
+
+size_t MqttCodec::encodeSubscribe(uint16_t packetId, const char* topicFilter, uint8_t qos,
+                                  uint8_t* out, size_t size) {
+  PacketWriter writer(out, size);
+  writer.header(MqttPacketType::SUBSCRIBE, 0x02, 2 + stringSize(topicFilter) + 1);
+  writer.u16(packetId);
+  writer.string(topicFilter);
+  writer.byte(qos);
+  return writer.result();
+}
+
+size_t MqttCodec::encodePuback(uint16_t packetId, uint8_t* out, size_t size) {
+  PacketWriter writer(out, size);
+  writer.header(MqttPacketType::PUBACK, 0, 2);
+  writer.u16(packetId);
+  return writer.result();
+}
+
+size_t MqttCodec::encodePingreq(uint8_t* out, size_t size) {
+  PacketWriter writer(out, size);
+  writer.header(MqttPacketType::PINGREQ, 0, 0);
+  return writer.result();
+}
+
+size_t MqttCodec::encodeDisconnect(uint8_t* out, size_t size) {
+  PacketWriter writer(out, size);
+  writer.header(MqttPacketType::DISCONNECT, 0, 0);
+  return writer.result();
+}
+
+// ========================================
+// 復号
+// ========================================
+
+bool MqttCodec::parseConnack(const MqttPacket& packet, uint8_t& returnCode) {
+  if (packet.type != MqttPacketType::CONNACK || packet.length != 2) {
+    return false;
+  }
+  returnCode = packet.body[1];
+  return true;
+}
+
+bool MqttCodec::parsePacketId(const MqttPacket& packet, uint16_t& packetId) {
+  if (packet.length < 2) {
+    return false;
+  }
+  packetId = static_cast<uint16_t>((packet.body[0] << 8) | packet.body[1]);
+  return true;
+}
+
+bool MqttCodec::parsePublish(const MqttPacket& packet, MqttPublish& out) {
+  if (packet.type != MqttPacketType::PUBLISH || packet.length < 2) {
+    return false;
+  }
+  out.qos = (packet.flags >> 1) & 0x03;
+  out.retain = (packet.flags & PUBLISH_RETAIN) != 0;
+  if (out.qos > 1) {
+    return false;  // QoS 2 は購読時に要求しないため未対応
+  }
+
+  size_t pos = 0;
+  out.topicLength = (packet.body[0] << 8) | packet.body[1];
+  pos += 2;
+  if (pos + out.topicLength > packet.length) {
+    return false;
+  }
+  out.topic = reinterpret_cast<const char*>(packet.body + pos);
+  pos += out.topicLength;
+
+  out.packetId = 0;
+  if (out.qos > 0) {
+    if (pos + 2 > packet.length) {
+      return false;
+    }
+    out.packetId = static_cast<uint16_t>((packet.body[pos] << 8) | packet.body[pos + 1]);
+    pos += 2;
+  }
+  out.payload = packet.body + pos;
+  out.payloadLength = packet.length - pos;
+  return true;
+}
+
+// ========================================
+// MqttPacketParser
+// ========================================
+
+MqttPacketParser::MqttPacketParser(PacketHandler onPacket, void* context)
+  : onPacket_(onPacket),
+    context_(context),
+    errorCount_(0) {
+  reset();
+}
+
+void MqttPacketParser::reset() {
+  state_ = State::HEADER;
+  header_ = 0;
+  remaining_ = 0;
+  bodyLength_ = 0;
+  lengthShift_ = 0;
+  received_ = 0;
+}
+
+void MqttPacketParser::feed(const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    uint8_t byte = data[i];
+    switch (state_) {
+      case State::HEADER:
+        header_ = byte;
+        bodyLength_ = 0;
+        lengthShift_ = 0;
+        state_ = State::LENGTH;
+        break;
+
+      case State::LENGTH:
+        bodyLength_ |= static_cast<uint32_t>(byte & 0x7F) << lengthShift_;
+        lengthShift_ += 7;
+        if (byte & 0x80) {
+          if (lengthShift_ >= 28) {
+            // 残りバイト数の表現が不正（以降の同期は取れないが、再接続でリセットされる）
+            errorCount_++;
+            reset();
+          }
+          break;
+        }
+        remaining_ = bodyLength_;
+        received_ = 0;
+        if (bodyLength_ > MAX_PACKET_SIZE) {
+          errorCount_++;
+        }
+        if (remaining_ == 0) {
+          MqttPacket packet = {static_cast<MqttPacketType>(header_ >> 4), static_cast<uint8_t>(header_ & 0x0F),
+                               buffer_, 0};
+          onPacket_(packet, context_);
+          state_ = State::HEADER;
+        } else {
+          state_ = State::BODY;
+        }
+        break;
+
+      case State::BODY: {
+        // 過大なパケットは読み捨てる
+        if (bodyLength_ <= MAX_PACKET_SIZE) {
+          size_t chunk = length - i;
+          if (chunk > remaining_) {
+            chunk = remaining_;
+          }
+          memcpy(buffer_ + received_, data + i, chunk);
+          received_ += chunk;
+          remaining_ -= chunk;
+          i += chunk - 1;
+        } else {
+          remaining_--;
+        }
+        if (remaining_ == 0) {
+          if (bodyLength_ <= MAX_PACKET_SIZE) {
+            MqttPacket packet = {static_cast<MqttPacketType>(header_ >> 4), static_cast<uint8_t>(header_ & 0x0F),
+                                 buffer_, received_};
+            onPacket_(packet, context_);
+          }
+          state_ = State::HEADER;
+        }
+        break;
+      }
+    }
+  }
+}
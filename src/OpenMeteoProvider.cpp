@@ -0,0 +1,96 @@
+/**
+ * OpenMeteoProvider.cpp
+ *
+ * Open-Meteo API からの天気予報の取得の実装
+ */
+
+#include "OpenMeteoProvider.h"
+#include "Logger.h"
+
+OpenMeteoProvider::OpenMeteoProvider(float latitude, float longitude) {
+  setLocation(latitude, longitude);
+}
+
+void OpenMeteoProvider::setLocation(float latitude, float longitude) {
+  snprintf(apiUrl_, sizeof(apiUrl_),
+           "https://api.open-meteo.com/v1/forecast?latitude=%.6f&longitude=%.6f"
+           "&daily=weather_code,temperature_2m_max,temperature_2m_min"
+           "&timezone=Asia/Tokyo&forecast_days=1",
+           latitude, longitude);
+}
+
+bool OpenMeteoProvider::fetch(ForecastScratch& scratch, ForecastValues& out) {
+  HTTPClient http;
+
+  LOG(WEATHER_REQUEST);
+
+  http.useHTTP10(true);  // チャンク形式にさせず、本文をそのまま固定バッファに読めるように
+  http.begin(apiUrl_);
+  int httpResponseCode = http.GET();
+  if (httpResponseCode != 200) {
+    LOG(WEATHER_HTTP_ERROR, httpResponseCode);
+    http.end();
+    return false;
+  }
+
+  // 本文の受信（固定領域がなければヒープの String）
+  String payload;
+  const char* json = scratch.body;
+  int length;
+  if (scratch.body != nullptr) {
+    length = readBody(http, scratch.body, scratch.bodySize);
+  } else {
+    payload = http.getString();
+    json = payload.c_str();
+    length = static_cast<int>(payload.length());
+  }
+  http.end();
+  if (length < 0) {
+    LOG(WEATHER_BODY_ERROR, static_cast<uint32_t>(scratch.bodySize));
+    return false;
+  }
+  LOG(WEATHER_RESPONSE_OK);
+
+  return parseBody(json, static_cast<size_t>(length), scratch, out);
+}
+
+/**
+ * レスポンス本文を固定バッファに読み込む
+ * HTTP/1.0 で要求するため、本文は Content-Length 分（なければ切断まで）そのまま届きます。
+ * @return 本文の長さ、バッファに収まらない・タイムアウトは -1
+ */
+int OpenMeteoProvider::readBody(HTTPClient& http, char* body, size_t size) {
+  WiFiClient* stream = http.getStreamPtr();
+  int expected = http.getSize();  // -1: Content-Length なし
+  if (stream == nullptr || expected >= static_cast<int>(size)) {
+    return -1;
+  }
+
+  size_t length = 0;
+  unsigned long start = millis();
+  while (expected < 0 || length < static_cast<size_t>(expected)) {
+    int available = stream->available();
+    if (available > 0) {
+      size_t room = size - 1 - length;
+      if (room == 0) {
+        return -1;
+      }
+      size_t chunk = static_cast<size_t>(available) < room ? static_cast<size_t>(available) : room;
+      int received = stream->read(reinterpret_cast<uint8_t*>(body) + length, chunk);
+      if (received > 0) {
+        length += static_cast<size_t>(received);
+      }
+    } else if (!stream->connected()) {
+      break;
+    } else if (millis() - start >= BODY_TIMEOUT_MS) {
+      return -1;
+    } else {
+      delay(1);
+    }
+  }
+  if (expected >= 0 && length < static_cast<size_t>(expected)) {
+    return -1;  // 途中で切断
+  }
+  body[length] = '\0';
+  return static_cast<int>(length);
+}
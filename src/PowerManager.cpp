@@ -0,0 +1,203 @@
+/**
+ * PowerManager.cpp
+ *
+ * loop() の待機と省電力（ライトスリープ）の管理クラスの実装
+ */
+
+#include "PowerManager.h"
+
+#include <WiFi.h>
+#include <driver/gpio.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include "Logger.h"
+
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+#include <esp_freertos_hooks.h>
+
+namespace {
+  // 最後のマーク（Low）からこの時間が過ぎたら受信の終了とみなす（IRrecv のタイムアウト 15ms＋余裕）
+  constexpr uint32_t CAPTURE_HOLD_US = 50000;
+
+  /**
+   * IR受信中のライトスリープの禁止
+   * アイドルフック（引数なし）から参照するため、ファイル内で保持します。
+   */
+  gpio_num_t capturePin;
+  esp_pm_lock_handle_t captureLock;
+  portMUX_TYPE captureMux = portMUX_INITIALIZER_UNLOCKED;
+  bool capturing = false;
+  int64_t lastMarkUs = 0;
+
+  // loop() の実行中は CPU を最高周波数に固定（idleUntil() の待機中のみ解放）
+  esp_pm_lock_handle_t activeLock;
+
+  // ライトスリープの準備処理（addSleepPrepare()。件数は登録後に増やす）
+  PowerManager::SleepPrepare sleepPrepares[PowerManager::MAX_SLEEP_PREPARES];
+  void* sleepPrepareContexts[PowerManager::MAX_SLEEP_PREPARES];
+  volatile uint8_t sleepPrepareCount = 0;
+
+  /**
+   * 受信ピンを確認し、受信中はライトスリープを止める（両コアのアイドルフック）
+   * アイドルフックはライトスリープに入るかを判定する直前に呼ばれるため、受信の途中で眠ることはありません。
+   * 受信ピンのレベルを読むだけで、IRrecv の割り込みの設定は変えません。
+   */
+  bool watchCapture() {
+    bool mark = gpio_get_level(capturePin) == 0;  // 受信モジュールの出力は負論理
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&captureMux);
+    if (mark) {
+      lastMarkUs = now;
+      if (!capturing) {
+        capturing = true;
+        esp_pm_lock_acquire(captureLock);
+      }
+    } else if (capturing && now - lastMarkUs >= CAPTURE_HOLD_US) {
+      capturing = false;
+      esp_pm_lock_release(captureLock);
+    }
+    portEXIT_CRITICAL(&captureMux);
+
+    uint8_t count = sleepPrepareCount;
+    for (uint8_t i = 0; i < count; i++) {
+      sleepPrepares[i](sleepPrepareContexts[i]);
+    }
+    return true;
+  }
+}
+#endif
+
+/**
+ * コンストラクタ
+ */
+PowerManager::PowerManager(uint8_t irRecvPin, uint8_t irWakePin, bool lightSleep)
+  : irRecvPin_(irRecvPin),
+    irWakePin_(irWakePin),
+    lightSleep_(lightSleep),
+    lightSleepActive_(false),
+    windowStartUs_(0),
+    idleUs_(0),
+    idleCount_(0) {
+}
+
+bool PowerManager::addSleepPrepare(SleepPrepare prepare, void* context) {
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  uint8_t count = sleepPrepareCount;
+  if (count >= MAX_SLEEP_PREPARES) {
+    return false;
+  }
+  sleepPrepares[count] = prepare;
+  sleepPrepareContexts[count] = context;
+  sleepPrepareCount = count + 1;
+  return true;
+#else
+  (void)prepare;
+  (void)context;
+  return true;  // ライトスリープしないビルドでは準備は不要
+#endif
+}
+
+bool PowerManager::begin() {
+  windowStartUs_ = esp_timer_get_time();
+
+  // WiFi はモデムスリープ（DTIM ごとにビーコンを受信して接続を維持）
+  WiFi.setSleep(true);
+
+  if (!lightSleep_) {
+    LOG(POWER_IDLE_ONLY);
+    return false;
+  }
+
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  // 受信ピンに起床設定（Low レベル）をすると IRrecv のエッジ割り込みが置き換わるため、起床は別のピンで行う
+  if (irWakePin_ == NO_PIN) {
+    LOG(POWER_NO_IR_WAKE);
+    return false;
+  }
+
+  // IR受信の途中で眠るとパルス幅の計測とタイムアウト判定が狂うため、受信中だけライトスリープを止める
+  // （常に止めるとライトスリープに入らないため、ロックはアイドルフックが受信中のみ保持）
+  esp_err_t err = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "ir", &captureLock);
+  if (err == ESP_OK) {
+    err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "loop", &activeLock);
+  }
+  if (err != ESP_OK) {
+    LOG(POWER_PM_FAIL, err);
+    return false;
+  }
+  esp_pm_lock_acquire(activeLock);  // begin() は loop() の外から呼ばれるため、最初の待機までは保持
+  capturePin = static_cast<gpio_num_t>(irRecvPin_);
+  esp_register_freertos_idle_hook_for_cpu(watchCapture, 0);
+  esp_register_freertos_idle_hook_for_cpu(watchCapture, 1);
+
+  // IR起床ピンの Low（受信モジュールの出力は負論理）で起床（このピンには割り込みを設定しない）
+  pinMode(irWakePin_, INPUT);
+  gpio_wakeup_enable(static_cast<gpio_num_t>(irWakePin_), GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+
+  // 最低周波数を 80MHz にして APB クロックを 80MHz に保つ（IRrecv のタイマーの刻みが変わらない）
+  esp_pm_config_esp32_t pm;
+  pm.max_freq_mhz = getCpuFrequencyMhz();
+  pm.min_freq_mhz = 80;
+  pm.light_sleep_enable = true;
+  err = esp_pm_configure(&pm);
+  if (err != ESP_OK) {
+    LOG(POWER_PM_FAIL, err);
+    return false;
+  }
+
+  lightSleepActive_ = true;
+  LOG(POWER_LIGHT_SLEEP, irWakePin_);
+  return true;
+#else
+  LOG(POWER_NO_PM);
+  return false;
+#endif
+}
+
+/**
+ * 次の処理期限まで待機
+ * delay() は vTaskDelay() のため、待機中はアイドルタスク（およびライトスリープ）に移ります。
+ * ライトスリープが有効な場合は、待機中だけ最高周波数のロックを解放します。
+ */
+void PowerManager::idleUntil(unsigned long deadlineMs) {
+  long remaining = static_cast<long>(deadlineMs - millis());
+  if (remaining <= 0) {
+    return;
+  }
+  uint32_t waitMs = remaining < static_cast<long>(MAX_IDLE_MS) ? static_cast<uint32_t>(remaining) : MAX_IDLE_MS;
+
+  int64_t start = esp_timer_get_time();
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  if (lightSleepActive_) {
+    esp_pm_lock_release(activeLock);
+    delay(waitMs);
+    esp_pm_lock_acquire(activeLock);
+  } else {
+    delay(waitMs);
+  }
+#else
+  delay(waitMs);
+#endif
+  idleUs_ += static_cast<uint64_t>(esp_timer_get_time() - start);
+  idleCount_++;
+}
+
+float PowerManager::getActiveDuty() const {
+  uint64_t elapsedUs = static_cast<uint64_t>(esp_timer_get_time() - windowStartUs_);
+  if (elapsedUs == 0 || idleUs_ >= elapsedUs) {
+    return 0.0f;
+  }
+  return 1.0f - static_cast<float>(idleUs_) / static_cast<float>(elapsedUs);
+}
+
+void PowerManager::printSummary() {
+  uint32_t averageIdleMs = idleCount_ ? static_cast<uint32_t>(idleUs_ / idleCount_ / 1000) : 0;
+  LOG(POWER_DUTY, getActiveDuty() * 100.0f, idleCount_, averageIdleMs,
+      lightSleepActive_ ? "ライトスリープ" : "待機のみ");
+
+  windowStartUs_ = esp_timer_get_time();
+  idleUs_ = 0;
+  idleCount_ = 0;
+}
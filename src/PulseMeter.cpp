@@ -0,0 +1,91 @@
+/**
+ * PulseMeter.cpp
+ *
+ * パルス出力付き電力量計の読み取りクラスの実装
+ */
+
+#include "PulseMeter.h"
+
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+#include <soc/gpio_struct.h>
+#include "Logger.h"
+
+/**
+ * コンストラクタ
+ */
+PulseMeter::PulseMeter(uint8_t pin, uint32_t pulsesPerKWh)
+  : pin_(pin),
+    pulsesPerKWh_(pulsesPerKWh),
+    pending_(0),
+    totalPulses_(0),
+    lastPulseUs_(0),
+    wakeArmed_(false) {
+  portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+  lock_ = unlocked;
+}
+
+void PulseMeter::begin() {
+  if (!isEnabled()) {
+    return;
+  }
+  // S0 出力はオープンコレクタのため内部プルアップを使用
+  pinMode(pin_, INPUT_PULLUP);
+  // 起床設定（Low レベル）はここでは行わない（常に設定するとパルスの Low の間、割り込みが繰り返される）
+  attachInterruptArg(digitalPinToInterrupt(pin_), onPulse, this, FALLING);
+
+  LOG(ENERGY_METER_READY, pin_, pulsesPerKWh_);
+}
+
+/**
+ * ライトスリープの準備（アイドルフック）
+ * ピンが High の間だけ起床設定を行い、次の立ち下がり（Low レベルの割り込み）で onPulse() が解除します。
+ * 確認と設定の間に立ち下がった場合も、設定直後に Low レベルの割り込みが入るため取りこぼしません。
+ */
+void PulseMeter::prepareSleep(void* context) {
+  PulseMeter* meter = static_cast<PulseMeter*>(context);
+  if (!meter->isEnabled()) {
+    return;
+  }
+  gpio_num_t pin = static_cast<gpio_num_t>(meter->pin_);
+  portENTER_CRITICAL(&meter->lock_);
+  if (!meter->wakeArmed_ && gpio_get_level(pin) == 1) {
+    meter->wakeArmed_ = true;
+    gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL);
+  }
+  portEXIT_CRITICAL(&meter->lock_);
+}
+
+/**
+ * パルスの立ち下がり（割り込み）
+ * 起床設定中は Low レベルの割り込みのため、立ち下がりに戻してから1パルスとして数えます
+ * （割り込みから呼べる gpio_ll で直接設定）。
+ */
+void IRAM_ATTR PulseMeter::onPulse(void* arg) {
+  PulseMeter* meter = static_cast<PulseMeter*>(arg);
+  uint32_t now = micros();
+  portENTER_CRITICAL_ISR(&meter->lock_);
+  if (meter->wakeArmed_) {
+    meter->wakeArmed_ = false;
+    gpio_num_t pin = static_cast<gpio_num_t>(meter->pin_);
+    gpio_ll_wakeup_disable(&GPIO, pin);
+    gpio_ll_set_intr_type(&GPIO, pin, GPIO_INTR_NEGEDGE);
+  }
+  if (now - meter->lastPulseUs_ >= MIN_PULSE_INTERVAL_US) {
+    meter->lastPulseUs_ = now;
+    meter->pending_ = meter->pending_ + 1;
+    meter->totalPulses_ = meter->totalPulses_ + 1;
+  }
+  portEXIT_CRITICAL_ISR(&meter->lock_);
+}
+
+float PulseMeter::takeWh() {
+  if (!isEnabled()) {
+    return -1.0f;
+  }
+  portENTER_CRITICAL(&lock_);
+  uint32_t pulses = pending_;
+  pending_ = 0;
+  portEXIT_CRITICAL(&lock_);
+  return pulses * 1000.0f / pulsesPerKWh_;
+}
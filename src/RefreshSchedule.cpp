@@ -0,0 +1,47 @@
+/**
+ * RefreshSchedule.cpp
+ *
+ * 定期取得の期限管理の実装
+ */
+
+#include "RefreshSchedule.h"
+
+RefreshSchedule::RefreshSchedule(uint32_t intervalSec, uint32_t jitterSec, uint32_t retryBaseSec,
+                                 uint32_t retryMaxSec, uint32_t seed)
+  : intervalSec_(intervalSec),
+    jitterSec_(jitterSec),
+    retryBaseSec_(retryBaseSec),
+    retryMaxSec_(retryMaxSec),
+    state_(seed != 0 ? seed : 0x9E3779B9),  // xorshift は 0 から進まないため
+    nextEpoch_(0),
+    failures_(0) {
+}
+
+void RefreshSchedule::onSuccess(uint32_t nowEpoch) {
+  failures_ = 0;
+  nextEpoch_ = (nowEpoch / intervalSec_ + 1) * intervalSec_ + random(jitterSec_ + 1);
+}
+
+/**
+ * 再試行の間隔は retryBaseSec × 2^(失敗回数-1)（retryMaxSec まで）で、
+ * 間隔の 1/4 までのランダムな遅れを加えます（同時に失敗した複数台の再試行をずらす）。
+ */
+void RefreshSchedule::onFailure(uint32_t nowEpoch) {
+  uint32_t delay = retryBaseSec_;
+  for (uint32_t i = 0; i < failures_ && delay < retryMaxSec_; i++) {
+    delay *= 2;
+  }
+  if (delay > retryMaxSec_) {
+    delay = retryMaxSec_;
+  }
+  failures_++;
+  nextEpoch_ = nowEpoch + delay + random(delay / 4 + 1);
+}
+
+// [0, bound) の乱数（xorshift32）
+uint32_t RefreshSchedule::random(uint32_t bound) {
+  state_ ^= state_ << 13;
+  state_ ^= state_ >> 17;
+  state_ ^= state_ << 5;
+  return bound != 0 ? state_ % bound : 0;
+}
@@ -0,0 +1,181 @@
+/**
+ * RuntimeConfig.cpp
+ *
+ * 実行時設定の保存形式・項目表の実装
+ */
+
+#include "RuntimeConfig.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+#include "StatusFormat.h"
+
+static_assert(std::is_trivially_copyable<RuntimeConfig>::value, "RuntimeConfig はバイト列として保存するため POD にしてください");
+
+namespace {
+  enum class FieldType : uint8_t { FLOAT, UINT32 };
+
+  // 変更可能な項目（名前・型・位置・範囲）
+  struct Field {
+    const char* name;
+    FieldType type;
+    size_t offset;
+    double min;
+    double max;
+  };
+
+#define CONFIG_FIELD(name, member, type, min, max) \
+  {name, FieldType::type, offsetof(RuntimeConfig, member), min, max}
+
+  const Field FIELDS[] = {
+    CONFIG_FIELD("tempLower",               thresholds.tempLower,      FLOAT,  10.0,   35.0),
+    CONFIG_FIELD("tempUpper",               thresholds.tempUpper,      FLOAT,  10.0,   35.0),
+    CONFIG_FIELD("tempHysteresis",          thresholds.tempHysteresis, FLOAT,  0.0,    3.0),
+    CONFIG_FIELD("humidityUpper",           thresholds.humidityUpper,  FLOAT,  30.0,   90.0),
+    CONFIG_FIELD("tempOffset",              tempOffset,                FLOAT,  -10.0,  10.0),
+    CONFIG_FIELD("humOffset",               humOffset,                 FLOAT,  -20.0,  20.0),
+    CONFIG_FIELD("sensorReadIntervalMs",    sensorReadIntervalMs,      UINT32, 500,    60000),
+    CONFIG_FIELD("controlIntervalMs",       controlIntervalMs,         UINT32, 10000,  3600000),
+    CONFIG_FIELD("profileReportIntervalMs", profileReportIntervalMs,   UINT32, 10000,  86400000),
+    CONFIG_FIELD("latitude",                latitude,                  FLOAT,  -90.0,  90.0),
+    CONFIG_FIELD("longitude",               longitude,                 FLOAT,  -180.0, 180.0),
+  };
+
+#undef CONFIG_FIELD
+
+  inline void putU16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+  }
+
+  inline uint16_t getU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+  }
+}
+
+uint32_t RuntimeConfigSchema::crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+  }
+  return ~crc;
+}
+
+size_t RuntimeConfigSchema::encode(const RuntimeConfig& config, uint8_t* out) {
+  uint8_t* payload = out + HEADER_SIZE;
+  memcpy(payload, &config, sizeof(config));
+  uint32_t crc = crc32(payload, sizeof(config));
+
+  putU16(out, MAGIC);
+  putU16(out + 2, VERSION);
+  putU16(out + 4, static_cast<uint16_t>(sizeof(config)));
+  putU16(out + 6, 0);
+  memcpy(out + 8, &crc, 4);
+  return BLOB_SIZE;
+}
+
+bool RuntimeConfigSchema::decode(const uint8_t* data, size_t length, const RuntimeConfig& defaults,
+                                 RuntimeConfig& out) {
+  out = defaults;
+  if (length < HEADER_SIZE || getU16(data) != MAGIC) {
+    return false;
+  }
+  uint16_t version = getU16(data + 2);
+  uint16_t size = getU16(data + 4);
+  uint32_t crc;
+  memcpy(&crc, data + 8, 4);
+
+  if (version > VERSION || size > sizeof(RuntimeConfig) || HEADER_SIZE + size > length ||
+      crc32(data + HEADER_SIZE, size) != crc) {
+    return false;
+  }
+
+  // 古いバージョンは保存されている先頭部分のみ上書き（追加されたフィールドは初期値）
+  RuntimeConfig loaded = defaults;
+  memcpy(&loaded, data + HEADER_SIZE, size);
+  if (!validate(loaded, nullptr)) {
+    return false;
+  }
+  out = loaded;
+  return true;
+}
+
+bool RuntimeConfigSchema::validate(const RuntimeConfig& config, const char** error) {
+  const char* message = nullptr;
+  for (const Field& field : FIELDS) {
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&config) + field.offset;
+    double value;
+    if (field.type == FieldType::FLOAT) {
+      float f;
+      memcpy(&f, base, sizeof(f));
+      value = f;
+    } else {
+      uint32_t u;
+      memcpy(&u, base, sizeof(u));
+      value = u;
+    }
+    // NaN もここで弾かれる
+    if (!(value >= field.min && value <= field.max)) {
+      message = field.name;
+      break;
+    }
+  }
+  if (!message && config.thresholds.tempLowerOff() >= config.thresholds.tempUpperOff()) {
+    message = "tempLower + tempHysteresis < tempUpper - tempHysteresis を満たしていません";
+  }
+  if (error) {
+    *error = message;
+  }
+  return message == nullptr;
+}
+
+bool RuntimeConfigSchema::setField(RuntimeConfig& config, const char* name, const char* value,
+                                   const char** error) {
+  for (const Field& field : FIELDS) {
+    if (strcmp(field.name, name) != 0) {
+      continue;
+    }
+    char* end = nullptr;
+    double parsed = strtod(value, &end);
+    if (end == value || *end != '\0') {
+      *error = "数値ではありません";
+      return false;
+    }
+    if (!(parsed >= field.min && parsed <= field.max)) {
+      *error = "範囲外です";
+      return false;
+    }
+    uint8_t* base = reinterpret_cast<uint8_t*>(&config) + field.offset;
+    if (field.type == FieldType::FLOAT) {
+      float f = static_cast<float>(parsed);
+      memcpy(base, &f, sizeof(f));
+    } else {
+      uint32_t u = static_cast<uint32_t>(parsed);
+      memcpy(base, &u, sizeof(u));
+    }
+    return true;
+  }
+  *error = "不明な項目です";
+  return false;
+}
+
+void RuntimeConfigSchema::writeJson(const RuntimeConfig& config, ResponseWriter& out) {
+  out.printf("{\"version\":%u", VERSION);
+  for (const Field& field : FIELDS) {
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&config) + field.offset;
+    if (field.type == FieldType::FLOAT) {
+      float f;
+      memcpy(&f, base, sizeof(f));
+      out.printf(",\"%s\":%.6g", field.name, f);
+    } else {
+      uint32_t u;
+      memcpy(&u, base, sizeof(u));
+      out.printf(",\"%s\":%lu", field.name, static_cast<unsigned long>(u));
+    }
+  }
+  out.write("}\n");
+}
@@ -0,0 +1,151 @@
+/**
+ * SerialConsole.cpp
+ *
+ * シリアルからのコマンド入力の実装
+ */
+
+#include "SerialConsole.h"
+
+#include <string.h>
+#include "Logger.h"
+
+namespace {
+  bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+  }
+
+  // 前後の空白を除いた先頭（末尾は '\0' で切る）
+  char* trim(char* text) {
+    while (isSpace(*text)) {
+      text++;
+    }
+    size_t length = strlen(text);
+    while (length > 0 && isSpace(text[length - 1])) {
+      text[--length] = '\0';
+    }
+    return text;
+  }
+}
+
+SerialConsole::SerialConsole(const ConsoleCommand* commands, size_t count, void* context)
+  : commands_(commands),
+    count_(count),
+    context_(context),
+    line_(),
+    length_(0),
+    overflow_(false),
+    ready_(false),
+    executed_(0) {
+}
+
+#ifdef ARDUINO
+/**
+ * 受信バッファに届いている分だけ読む（Stream::read() は待たない）
+ */
+bool SerialConsole::poll(Stream& stream) {
+  uint32_t start = micros();
+  size_t bytes = 0;
+  while (bytes < MAX_BYTES_PER_POLL && stream.available() > 0) {
+    bytes++;
+    if (feed(static_cast<char>(stream.read()))) {
+      execute();
+      uint32_t elapsed = micros() - start;
+      if (elapsed > BUDGET_US) {
+        LOG(CONSOLE_SLOW, elapsed, BUDGET_US);
+      }
+      return true;  // 1回に1コマンド（続きは次の loop()）
+    }
+    if (micros() - start > BUDGET_US) {
+      break;
+    }
+  }
+  return false;
+}
+#endif
+
+bool SerialConsole::feed(char c) {
+  if (ready_) {
+    // 前の行が未実行の間は読み捨てる（poll() は確定したらすぐに実行する）
+    return true;
+  }
+  if (c == '\r' || c == '\n') {
+    if (overflow_) {
+      LOG(CONSOLE_TOO_LONG, static_cast<uint32_t>(LINE_SIZE - 1));
+      overflow_ = false;
+      length_ = 0;
+      return false;
+    }
+    if (length_ == 0) {
+      return false;  // 空行・CRLF の LF
+    }
+    line_[length_] = '\0';
+    ready_ = true;
+    return true;
+  }
+  if (c == '\b' || c == 0x7F) {
+    if (length_ > 0) {
+      length_--;
+    }
+    return false;
+  }
+  if (length_ + 1 >= LINE_SIZE) {
+    overflow_ = true;
+    return false;
+  }
+  line_[length_++] = c;
+  return false;
+}
+
+void SerialConsole::execute() {
+  if (!ready_) {
+    return;
+  }
+  ready_ = false;
+  length_ = 0;
+
+  char* text = trim(line_);
+  if (*text == '\0') {
+    return;
+  }
+  LOG(CONSOLE_INPUT, text);
+
+  // コマンド名と引数に分ける
+  char* args = text;
+  while (*args != '\0' && !isSpace(*args)) {
+    args++;
+  }
+  if (*args != '\0') {
+    *args++ = '\0';
+  }
+  args = trim(args);
+
+  executed_++;
+  if (strcmp(text, "help") == 0) {
+    printHelp();
+    return;
+  }
+  const ConsoleCommand* command = find(text);
+  if (command == nullptr) {
+    LOG(CONSOLE_UNKNOWN, text);
+    return;
+  }
+  if (!command->handler(args, context_)) {
+    LOG(CONSOLE_USAGE, command->name, command->usage);
+  }
+}
+
+void SerialConsole::printHelp() const {
+  LOG(CONSOLE_HELP_HEADER);
+  for (size_t i = 0; i < count_; i++) {
+    LOG(CONSOLE_HELP, commands_[i].name, commands_[i].usage);
+  }
+}
+
+const ConsoleCommand* SerialConsole::find(const char* name) const {
+  for (size_t i = 0; i < count_; i++) {
+    if (strcmp(commands_[i].name, name) == 0) {
+      return &commands_[i];
+    }
+  }
+  return nullptr;
+}
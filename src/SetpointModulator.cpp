@@ -0,0 +1,170 @@
+/**
+ * SetpointModulator.cpp
+ *
+ * 設定温度の調整による連続運転の制御の実装
+ */
+
+#include "SetpointModulator.h"
+
+namespace {
+  constexpr float HALF_QUANTUM = 0.25f;  // 設定温度の単位（0.5℃）の半分
+
+  // 圧縮機が運転するモードか
+  bool isRunning(ACMode mode) {
+    return mode != ACMode::OFF && mode != ACMode::NONE;
+  }
+
+  // オン・オフ制御が快適範囲として停止する理由（調整中は運転を続ける）
+  bool isComfortOff(PolicyReason reason) {
+    return reason == PolicyReason::COMFORT_OFF || reason == PolicyReason::OVERCOOL_OFF ||
+           reason == PolicyReason::WARM_WAIT_OFF;
+  }
+
+  float clampf(float value, float low, float high) {
+    return value < low ? low : (value > high ? high : value);
+  }
+}
+
+SetpointModulator::SetpointModulator(const ModulatorParams& params)
+  : params_(params),
+    hasFiltered_(false),
+    filtered_(0.0f),
+    lastReadingMs_(0),
+    active_(ACOperation::OFF),
+    target_(0.0f),
+    integral_(0.0f),
+    lastUpdateMs_(0),
+    lastOutput_(),
+    lastAction_(ModulatorAction::PASS),
+    baselineMode_(ACMode::NONE),
+    starts_(0),
+    baselineStarts_(0),
+    setpointChanges_(0) {
+}
+
+/**
+ * 室温を平滑化（経過時間に応じた重みの指数移動平均。読み取り間隔が変わっても時定数は同じ）
+ */
+void SetpointModulator::onReading(uint32_t nowMs, float temperature) {
+  if (!hasFiltered_) {
+    hasFiltered_ = true;
+    filtered_ = temperature;
+  } else {
+    float dtSec = (nowMs - lastReadingMs_) / 1000.0f;
+    float alpha = dtSec / (params_.filterTauSec + dtSec);
+    filtered_ += alpha * (temperature - filtered_);
+  }
+  lastReadingMs_ = nowMs;
+}
+
+ACCommand SetpointModulator::update(const PolicyDecision& baseline, float temperature,
+                                    const PolicyThresholds& thresholds, const ACCommand& current,
+                                    uint32_t nowMs) {
+  // 比較用: オン・オフ制御を続けた場合の起動
+  if (isRunning(baseline.mode) && !isRunning(baselineMode_)) {
+    baselineStarts_++;
+  }
+  baselineMode_ = baseline.mode;
+
+  if (!hasFiltered_) {
+    onReading(nowMs, temperature);
+  }
+
+  // 調整する運転モード（快適範囲での停止は、調整中なら運転を続ける）
+  ACOperation operation = ACOperation::OFF;
+  if (baseline.mode == ACMode::HEATING_23_5) {
+    operation = ACOperation::HEAT;
+  } else if (baseline.mode == ACMode::COOLING_25) {
+    operation = ACOperation::COOL;
+  } else if (baseline.mode == ACMode::OFF && active_ != ACOperation::OFF && isComfortOff(baseline.reason)) {
+    operation = active_;
+  }
+
+  ACCommand command;
+  if (operation == ACOperation::OFF) {
+    command = pass(baseline.mode);
+  } else {
+    // 誤差は能力を上げる向きを正にする（暖房: 目標より寒い, 冷房: 目標より暑い）
+    float sign = operation == ACOperation::HEAT ? 1.0f : -1.0f;
+    target_ = operation == ACOperation::HEAT ? thresholds.tempLowerOff() : thresholds.tempUpperOff();
+    float error = sign * (target_ - filtered_);
+    bool continuing = active_ == operation && current.isKnown() && current.getOperation() == operation;
+
+    if (continuing && -error >= params_.releaseBand) {
+      active_ = ACOperation::OFF;
+      lastAction_ = ModulatorAction::RELEASE;
+      command = ACCommand::off();
+    } else if (continuing) {
+      command = step(current, sign, error, nowMs);
+    } else {
+      command = start(operation, error);
+    }
+  }
+  lastUpdateMs_ = nowMs;
+
+  countStart(command);
+  lastOutput_ = command;
+  return command;
+}
+
+/**
+ * オン・オフ制御のプリセットをそのまま使う
+ */
+ACCommand SetpointModulator::pass(ACMode mode) {
+  active_ = ACOperation::OFF;
+  lastAction_ = ModulatorAction::PASS;
+  return ACCommand::fromMode(mode);
+}
+
+/**
+ * 運転開始（プリセットの設定温度から始め、積分項をその設定温度に合わせる）
+ */
+ACCommand SetpointModulator::start(ACOperation operation, float error) {
+  ACMode preset = operation == ACOperation::HEAT ? ACMode::HEATING_23_5 : ACMode::COOLING_25;
+  ACCommand command = ACCommand::fromMode(preset);
+  float sign = operation == ACOperation::HEAT ? 1.0f : -1.0f;
+  float offset = sign * (command.getSetpoint() - target_);
+  integral_ = clampf(offset - params_.kp * error, params_.offsetMin, params_.offsetMax);
+
+  active_ = operation;
+  lastAction_ = ModulatorAction::START;
+  return command;
+}
+
+/**
+ * PI 制御で設定温度を決め、現在の設定温度から MAX_STEP まで近づける
+ * 設定温度の幅の上限・下限に張り付いている間は、さらに張り付く向きには積分しません（ワインドアップ防止）。
+ */
+ACCommand SetpointModulator::step(const ACCommand& current, float sign, float error, uint32_t nowMs) {
+  uint32_t dtMs = nowMs - lastUpdateMs_;
+  if (dtMs > MAX_DT_MS) {
+    dtMs = MAX_DT_MS;
+  }
+  float next = integral_ + params_.kiPerHour * error * (dtMs / 3600000.0f);
+  float offset = params_.kp * error + next;
+  if ((offset <= params_.offsetMax || error < 0.0f) && (offset >= params_.offsetMin || error > 0.0f)) {
+    integral_ = next;
+  }
+  offset = clampf(params_.kp * error + integral_, params_.offsetMin, params_.offsetMax);
+
+  float desired = target_ + sign * offset;
+  float setpoint = current.getSetpoint();
+  if (desired > setpoint + HALF_QUANTUM + STEP_DEADBAND) {
+    setpoint += MAX_STEP;
+    lastAction_ = ModulatorAction::RAISE;
+  } else if (desired < setpoint - HALF_QUANTUM - STEP_DEADBAND) {
+    setpoint -= MAX_STEP;
+    lastAction_ = ModulatorAction::LOWER;
+  } else {
+    lastAction_ = ModulatorAction::KEEP;
+    return current;
+  }
+  setpointChanges_++;
+  return current.withSetpoint(setpoint);
+}
+
+void SetpointModulator::countStart(const ACCommand& command) {
+  if (command.isKnown() && !command.isOff() && (!lastOutput_.isKnown() || lastOutput_.isOff())) {
+    starts_++;
+  }
+}
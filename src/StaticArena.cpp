@@ -0,0 +1,53 @@
+/**
+ * StaticArena.cpp
+ *
+ * 起動時に確保する固定領域の実装
+ */
+
+#include "StaticArena.h"
+
+#include <stdlib.h>
+
+StaticArena::StaticArena()
+  : base_(nullptr),
+    capacity_(0),
+    used_(0),
+    peak_(0),
+    failures_(0) {
+}
+
+StaticArena::StaticArena(void* buffer, size_t size)
+  : base_(static_cast<uint8_t*>(buffer)),
+    capacity_(buffer ? size : 0),
+    used_(0),
+    peak_(0),
+    failures_(0) {
+}
+
+bool StaticArena::begin(size_t size) {
+  if (base_ != nullptr) {
+    return false;
+  }
+  base_ = static_cast<uint8_t*>(malloc(size));
+  capacity_ = base_ ? size : 0;
+  return base_ != nullptr;
+}
+
+void* StaticArena::allocate(size_t size, size_t align) {
+  size_t start = (used_ + align - 1) & ~(align - 1);
+  if (base_ == nullptr || start > capacity_ || size > capacity_ - start) {
+    failures_++;
+    return nullptr;
+  }
+  used_ = start + size;
+  if (used_ > peak_) {
+    peak_ = used_;
+  }
+  return base_ + start;
+}
+
+void StaticArena::rewind(size_t position) {
+  if (position < used_) {
+    used_ = position;
+  }
+}
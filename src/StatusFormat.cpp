@@ -0,0 +1,295 @@
+/**
+ * StatusFormat.cpp
+ *
+ * ステータスのJSON・Prometheusテキスト形式への書き出しの実装
+ */
+
+#include "StatusFormat.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// ========================================
+// ResponseWriter
+// ========================================
+
+ResponseWriter::ResponseWriter(char* buffer, size_t size, ResponseSink sink, void* context)
+  : buffer_(buffer),
+    size_(size),
+    used_(0),
+    total_(0),
+    sink_(sink),
+    context_(context),
+    failed_(false) {
+}
+
+void ResponseWriter::write(const char* text) {
+  write(text, strlen(text));
+}
+
+void ResponseWriter::write(const char* data, size_t length) {
+  while (length > 0 && !failed_) {
+    if (used_ == size_ && !flush()) {
+      return;
+    }
+    size_t chunk = size_ - used_;
+    if (chunk > length) {
+      chunk = length;
+    }
+    memcpy(buffer_ + used_, data, chunk);
+    used_ += chunk;
+    total_ += chunk;
+    data += chunk;
+    length -= chunk;
+  }
+}
+
+void ResponseWriter::printf(const char* format, ...) {
+  if (failed_) {
+    return;
+  }
+
+  // 残り領域に直接書式化し、収まらなければ送信してからやり直す
+  for (int attempt = 0; attempt < 2; attempt++) {
+    size_t remaining = size_ - used_;
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer_ + used_, remaining, format, args);
+    va_end(args);
+
+    if (length < 0) {
+      return;
+    }
+    if (static_cast<size_t>(length) < remaining) {
+      used_ += length;
+      total_ += length;
+      return;
+    }
+    if (used_ == 0) {
+      // バッファ全体より長い行は切り詰める（終端文字の分を除く）
+      used_ = size_ - 1;
+      total_ += used_;
+      return;
+    }
+    if (!flush()) {
+      return;
+    }
+  }
+}
+
+bool ResponseWriter::flush() {
+  if (failed_) {
+    return false;
+  }
+  if (used_ > 0 && !sink_(buffer_, used_, context_)) {
+    failed_ = true;
+    return false;
+  }
+  used_ = 0;
+  return true;
+}
+
+// ========================================
+// StatusFormat
+// ========================================
+
+namespace {
+  inline float cyclesToUs(uint32_t cycles, uint32_t mhz) {
+    return static_cast<float>(cycles) / (mhz ? mhz : 1);
+  }
+
+  // 無効な値は JSON の null として出力
+  void writeJsonNumber(ResponseWriter& out, const char* key, bool valid, float value, bool last = false) {
+    if (valid) {
+      out.printf("\"%s\":%.1f%s", key, value, last ? "" : ",");
+    } else {
+      out.printf("\"%s\":null%s", key, last ? "" : ",");
+    }
+  }
+
+  void writeMetricHeader(ResponseWriter& out, const char* name, const char* type, const char* help) {
+    out.printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+  }
+
+  void writeGauge(ResponseWriter& out, const char* name, const char* help, float value) {
+    writeMetricHeader(out, name, "gauge", help);
+    out.printf("%s %.2f\n", name, value);
+  }
+
+  void writeGauge(ResponseWriter& out, const char* name, const char* help, uint32_t value) {
+    writeMetricHeader(out, name, "gauge", help);
+    out.printf("%s %lu\n", name, static_cast<unsigned long>(value));
+  }
+
+  const ACMode MODES[] = {
+    ACMode::OFF, ACMode::HEATING_23_5, ACMode::HEATING_18, ACMode::COOLING_25, ACMode::DEHUMID_MINUS_1_5
+  };
+}
+
+const char* StatusFormat::modeName(ACMode mode) {
+  switch (mode) {
+    case ACMode::OFF:               return "off";
+    case ACMode::HEATING_23_5:      return "heating_23_5";
+    case ACMode::HEATING_18:        return "heating_18";
+    case ACMode::COOLING_25:        return "cooling_25";
+    case ACMode::DEHUMID_MINUS_1_5: return "dehumid_minus_1_5";
+    default:                        return "none";
+  }
+}
+
+void StatusFormat::writeJson(const StatusSnapshot& status, ResponseWriter& out) {
+  out.printf("{\"uptime_ms\":%lu,", static_cast<unsigned long>(status.uptimeMs));
+
+  out.printf("\"sensor\":{\"valid\":%s,", status.sensorValid ? "true" : "false");
+  writeJsonNumber(out, "temperature", status.sensorValid, status.temperature);
+  writeJsonNumber(out, "humidity", status.sensorValid, status.humidity);
+  writeJsonNumber(out, "discomfort_index", status.sensorValid, status.discomfortIndex);
+  out.printf("\"interval_ms\":%lu,\"reads_per_hour\":%.1f,\"reads\":%lu,\"saved_reads\":%lu},",
+             static_cast<unsigned long>(status.sensorIntervalMs), status.sensorReadsPerHour,
+             static_cast<unsigned long>(status.sensorReads), static_cast<unsigned long>(status.sensorReadsSaved));
+
+  out.printf("\"weather\":{\"valid\":%s,", status.weatherValid ? "true" : "false");
+  writeJsonNumber(out, "temp_max", status.weatherValid, status.tempMax);
+  writeJsonNumber(out, "temp_min", status.weatherValid, status.tempMin);
+  if (status.weatherValid) {
+    out.printf("\"code\":%d,\"age_ms\":%lu,\"source\":\"%s\",", status.weatherCode,
+               static_cast<unsigned long>(status.weatherAgeMs),
+               status.weatherSource != nullptr ? status.weatherSource : "unknown");
+  } else {
+    out.write("\"code\":null,\"age_ms\":null,\"source\":null,");
+  }
+  out.printf("\"refresh_failures\":%lu},", static_cast<unsigned long>(status.weatherRefreshFailures));
+
+  out.printf("\"ac\":{\"mode\":\"%s\",\"setpoint\":%.1f,\"modulated\":%s,\"compressor_starts\":%lu,"
+             "\"baseline_starts\":%lu},",
+             modeName(status.acMode), status.acSetpoint, status.acModulated ? "true" : "false",
+             static_cast<unsigned long>(status.compressorStarts), static_cast<unsigned long>(status.baselineStarts));
+
+  out.printf("\"energy\":{\"power_w\":%.1f,\"today_kwh\":%.3f,\"today_cost\":%.1f,"
+             "\"month_kwh\":%.2f,\"month_cost\":%.0f,\"price\":%.2f,\"peak\":%s},",
+             status.powerW, status.energyTodayKWh, status.costToday, status.energyMonthKWh, status.costMonth,
+             status.pricePerKWh, status.tariffPeak ? "true" : "false");
+
+  out.printf("\"loop\":{\"cpu_mhz\":%lu,\"active_duty\":%.4f,\"phases\":{",
+             static_cast<unsigned long>(status.cpuMHz), status.activeDuty);
+  for (size_t i = 0; i < StatusSnapshot::PHASE_COUNT; i++) {
+    const PhaseStats& s = status.phases[i];
+    out.printf("%s\"%s\":{\"count\":%lu,\"min_us\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f}",
+               i ? "," : "", LoopProfiler::phaseName(static_cast<LoopPhase>(i)),
+               static_cast<unsigned long>(s.count),
+               s.count ? cyclesToUs(s.min, status.cpuMHz) : 0.0f,
+               cyclesToUs(s.p50, status.cpuMHz), cyclesToUs(s.p99, status.cpuMHz),
+               cyclesToUs(s.max, status.cpuMHz));
+  }
+  out.write("}},");
+
+  out.printf("\"heap\":{\"free\":%lu,\"min_free\":%lu,\"max_alloc\":%lu,\"min_max_alloc\":%lu,"
+             "\"max_alloc_trend_per_day\":%.0f},",
+             static_cast<unsigned long>(status.freeHeap),
+             static_cast<unsigned long>(status.minFreeHeap),
+             static_cast<unsigned long>(status.maxAllocHeap),
+             static_cast<unsigned long>(status.minMaxAllocHeap),
+             status.maxAllocTrendPerDay);
+  out.printf("\"boot\":{\"first_control_ms\":%lu,\"network_ms\":%lu},",
+             static_cast<unsigned long>(status.bootFirstControlMs),
+             static_cast<unsigned long>(status.bootNetworkMs));
+  out.printf("\"log\":{\"dropped\":%lu}}\n", static_cast<unsigned long>(status.logDropped));
+}
+
+void StatusFormat::writePrometheus(const StatusSnapshot& status, ResponseWriter& out) {
+  writeGauge(out, "aircon_uptime_seconds", "Time since boot.", status.uptimeMs / 1000);
+
+  writeGauge(out, "aircon_sensor_valid", "1 if the last indoor sensor reading succeeded.",
+             static_cast<uint32_t>(status.sensorValid));
+  if (status.sensorValid) {
+    writeGauge(out, "aircon_sensor_temperature_celsius", "Indoor temperature.", status.temperature);
+    writeGauge(out, "aircon_sensor_humidity_percent", "Indoor relative humidity.", status.humidity);
+    writeGauge(out, "aircon_sensor_discomfort_index", "Indoor discomfort index.", status.discomfortIndex);
+  }
+
+  writeGauge(out, "aircon_sensor_interval_seconds", "Current indoor sensor sampling interval (adaptive).",
+             status.sensorIntervalMs / 1000.0f);
+  writeGauge(out, "aircon_sensor_reads_per_hour", "Average indoor sensor reads per hour since boot.",
+             status.sensorReadsPerHour);
+  writeMetricHeader(out, "aircon_sensor_reads_total", "counter", "Indoor sensor reads.");
+  out.printf("aircon_sensor_reads_total %lu\n", static_cast<unsigned long>(status.sensorReads));
+  writeMetricHeader(out, "aircon_sensor_reads_saved_total", "counter",
+                    "Reads skipped compared with sampling at the minimum interval.");
+  out.printf("aircon_sensor_reads_saved_total %lu\n", static_cast<unsigned long>(status.sensorReadsSaved));
+
+  writeGauge(out, "aircon_weather_valid", "1 if a weather forecast is available.",
+             static_cast<uint32_t>(status.weatherValid));
+  if (status.weatherValid) {
+    writeGauge(out, "aircon_weather_temp_max_celsius", "Forecast maximum temperature for today.", status.tempMax);
+    writeGauge(out, "aircon_weather_temp_min_celsius", "Forecast minimum temperature for today.", status.tempMin);
+    writeGauge(out, "aircon_weather_code", "Forecast WMO weather code.", static_cast<uint32_t>(status.weatherCode));
+    writeGauge(out, "aircon_weather_age_seconds", "Time since the forecast was fetched.", status.weatherAgeMs / 1000);
+  }
+  writeGauge(out, "aircon_weather_refresh_failures", "Consecutive failed forecast refreshes (retrying with backoff).",
+             status.weatherRefreshFailures);
+
+  writeMetricHeader(out, "aircon_ac_mode", "gauge", "Current air conditioner mode (1 for the active mode).");
+  for (ACMode mode : MODES) {
+    out.printf("aircon_ac_mode{mode=\"%s\"} %d\n", modeName(mode), status.acMode == mode ? 1 : 0);
+  }
+
+  writeGauge(out, "aircon_ac_setpoint_celsius", "Current air conditioner setpoint (0 when off).", status.acSetpoint);
+  if (status.acModulated) {
+    writeMetricHeader(out, "aircon_compressor_starts_total", "counter",
+                      "Compressor starts (off to running) commanded by the setpoint modulator.");
+    out.printf("aircon_compressor_starts_total %lu\n", static_cast<unsigned long>(status.compressorStarts));
+    writeMetricHeader(out, "aircon_compressor_starts_baseline_total", "counter",
+                      "Compressor starts the on/off threshold policy would have made (shadow baseline).");
+    out.printf("aircon_compressor_starts_baseline_total %lu\n", static_cast<unsigned long>(status.baselineStarts));
+  }
+
+  writeGauge(out, "aircon_power_watts", "Estimated air conditioner power draw.", status.powerW);
+  writeGauge(out, "aircon_energy_today_kwh", "Energy used today.", status.energyTodayKWh);
+  writeGauge(out, "aircon_energy_today_cost", "Electricity cost today (tariff currency).", status.costToday);
+  writeGauge(out, "aircon_energy_month_kwh", "Energy used this month.", status.energyMonthKWh);
+  writeGauge(out, "aircon_energy_month_cost", "Electricity cost this month (tariff currency).", status.costMonth);
+  writeGauge(out, "aircon_tariff_price", "Current time-of-use price per kWh.", status.pricePerKWh);
+  writeGauge(out, "aircon_tariff_peak", "1 during peak tariff hours.", static_cast<uint32_t>(status.tariffPeak));
+
+  writeMetricHeader(out, "aircon_loop_phase_microseconds", "gauge",
+                    "loop() phase duration statistics over the recent window.");
+  for (size_t i = 0; i < StatusSnapshot::PHASE_COUNT; i++) {
+    const PhaseStats& s = status.phases[i];
+    const char* name = LoopProfiler::phaseName(static_cast<LoopPhase>(i));
+    out.printf("aircon_loop_phase_microseconds{phase=\"%s\",stat=\"p50\"} %.1f\n", name, cyclesToUs(s.p50, status.cpuMHz));
+    out.printf("aircon_loop_phase_microseconds{phase=\"%s\",stat=\"p99\"} %.1f\n", name, cyclesToUs(s.p99, status.cpuMHz));
+    out.printf("aircon_loop_phase_microseconds{phase=\"%s\",stat=\"max\"} %.1f\n", name, cyclesToUs(s.max, status.cpuMHz));
+  }
+
+  writeMetricHeader(out, "aircon_loop_phase_seconds_total", "counter", "Cumulative time spent in each loop() phase.");
+  for (size_t i = 0; i < StatusSnapshot::PHASE_COUNT; i++) {
+    double seconds = static_cast<double>(status.phases[i].totalCycles) / (status.cpuMHz ? status.cpuMHz : 1) / 1e6;
+    out.printf("aircon_loop_phase_seconds_total{phase=\"%s\"} %.6f\n",
+               LoopProfiler::phaseName(static_cast<LoopPhase>(i)), seconds);
+  }
+
+  writeMetricHeader(out, "aircon_loop_active_ratio", "gauge",
+                    "Fraction of time the loop() task was awake since the last report.");
+  out.printf("aircon_loop_active_ratio %.4f\n", status.activeDuty);
+
+  writeGauge(out, "aircon_heap_free_bytes", "Free heap.", status.freeHeap);
+  writeGauge(out, "aircon_heap_min_free_bytes", "Lowest free heap since boot.", status.minFreeHeap);
+  writeGauge(out, "aircon_heap_max_alloc_bytes", "Largest allocatable heap block.", status.maxAllocHeap);
+  writeGauge(out, "aircon_heap_max_alloc_min_bytes", "Lowest largest allocatable heap block since boot.",
+             status.minMaxAllocHeap);
+  writeGauge(out, "aircon_heap_max_alloc_trend_bytes_per_day",
+             "Trend of the largest allocatable heap block (negative means fragmentation).", status.maxAllocTrendPerDay);
+
+  if (status.bootFirstControlMs != 0) {
+    writeGauge(out, "aircon_boot_first_control_seconds", "Time from boot to the first air conditioner command.",
+               status.bootFirstControlMs / 1000.0f);
+  }
+  if (status.bootNetworkMs != 0) {
+    writeGauge(out, "aircon_boot_network_seconds", "Time from boot until WiFi, NTP and forecast setup finished.",
+               status.bootNetworkMs / 1000.0f);
+  }
+
+  writeMetricHeader(out, "aircon_log_dropped_total", "counter", "Log records dropped because the ring buffer was full.");
+  out.printf("aircon_log_dropped_total %lu\n", static_cast<unsigned long>(status.logDropped));
+}
@@ -0,0 +1,466 @@
+/**
+ * StatusServer.cpp
+ *
+ * ステータス・メトリクスを返す軽量HTTPサーバーの実装
+ */
+
+#include "StatusServer.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "ConfigManager.h"
+#include "Logger.h"
+#include "StatusFormat.h"
+
+#ifdef ARDUINO
+#include <freertos/task.h>
+#include <lwip/sockets.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+#ifdef ARDUINO
+  constexpr uint32_t TASK_STACK_SIZE = 4096;
+  constexpr UBaseType_t TASK_PRIORITY = 1;
+  constexpr BaseType_t TASK_CORE = 0;
+#endif
+  constexpr int LISTEN_BACKLOG = 2;
+  constexpr uint32_t TASK_POLL_MS = 1000;
+
+  const char* const JSON_HEADER =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/json\r\n"
+    "Cache-Control: no-store\r\n"
+    "Connection: close\r\n\r\n";
+
+  const char* const METRICS_HEADER =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+    "Connection: close\r\n\r\n";
+
+  const char* const TRACE_HEADER =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/octet-stream\r\n"
+    "Content-Disposition: attachment; filename=\"control.trace\"\r\n"
+    "Cache-Control: no-store\r\n"
+    "Connection: close\r\n\r\n";
+
+  const char* const NOT_FOUND_RESPONSE =
+    "HTTP/1.1 404 Not Found\r\n"
+    "Content-Type: text/plain\r\n"
+    "Connection: close\r\n\r\n"
+    "not found\n";
+
+  const char* const METHOD_NOT_ALLOWED_RESPONSE =
+    "HTTP/1.1 405 Method Not Allowed\r\n"
+    "Allow: GET, POST\r\n"
+    "Connection: close\r\n\r\n";
+
+  const char* const TOO_LARGE_RESPONSE =
+    "HTTP/1.1 413 Payload Too Large\r\n"
+    "Content-Type: text/plain\r\n"
+    "Connection: close\r\n\r\n"
+    "request too large\n";
+
+  const char* const UNAUTHORIZED_RESPONSE =
+    "HTTP/1.1 401 Unauthorized\r\n"
+    "WWW-Authenticate: Bearer\r\n"
+    "Content-Type: text/plain\r\n"
+    "Connection: close\r\n\r\n"
+    "unauthorized\n";
+
+  const char* const FORBIDDEN_RESPONSE =
+    "HTTP/1.1 403 Forbidden\r\n"
+    "Content-Type: text/plain\r\n"
+    "Connection: close\r\n\r\n"
+    "config writes disabled\n";
+
+  const char* const BAD_REQUEST_HEADER =
+    "HTTP/1.1 400 Bad Request\r\n"
+    "Content-Type: text/plain; charset=utf-8\r\n"
+    "Connection: close\r\n\r\n";
+
+  enum class Route {
+    STATUS,
+    METRICS,
+    CONFIG_GET,
+    CONFIG_POST,
+    TRACE,
+    NOT_FOUND,
+    BAD_METHOD,
+    UNAUTHORIZED,  // POST /config のトークンが違う
+    FORBIDDEN      // POST /config が無効（トークン未設定）
+  };
+
+  // リクエスト行（"GET /metrics HTTP/1.1"）からルートを判定
+  Route parseRoute(const char* request) {
+    bool post = false;
+    const char* path;
+    if (strncmp(request, "GET ", 4) == 0) {
+      path = request + 4;
+    } else if (strncmp(request, "POST ", 5) == 0) {
+      path = request + 5;
+      post = true;
+    } else {
+      return Route::BAD_METHOD;
+    }
+    size_t length = strcspn(path, " ?\r\n");
+    if (length == 7 && strncmp(path, "/config", 7) == 0) {
+      return post ? Route::CONFIG_POST : Route::CONFIG_GET;
+    }
+    if (post) {
+      return Route::BAD_METHOD;
+    }
+    if ((length == 1 && path[0] == '/') || (length == 7 && strncmp(path, "/status", 7) == 0)) {
+      return Route::STATUS;
+    }
+    if (length == 8 && strncmp(path, "/metrics", 8) == 0) {
+      return Route::METRICS;
+    }
+    if (length == 6 && strncmp(path, "/trace", 6) == 0) {
+      return Route::TRACE;
+    }
+    return Route::NOT_FOUND;
+  }
+
+  const char* routeName(Route route) {
+    switch (route) {
+      case Route::STATUS:      return "/status";
+      case Route::METRICS:     return "/metrics";
+      case Route::CONFIG_GET:  return "GET /config";
+      case Route::CONFIG_POST: return "POST /config";
+      case Route::TRACE:       return "/trace";
+      case Route::NOT_FOUND:   return "404";
+      case Route::UNAUTHORIZED: return "401";
+      case Route::FORBIDDEN:   return "403";
+      default:                 return "405";
+    }
+  }
+
+  // ヘッダーの値の先頭（前の空白は除く、ない場合は nullptr）
+  const char* findHeader(const char* headers, const char* name) {
+    size_t nameLength = strlen(name);
+    for (const char* line = strstr(headers, "\r\n"); line; line = strstr(line + 2, "\r\n")) {
+      if (line[2] == '\r') {
+        break;  // ヘッダーの終端
+      }
+      if (strncasecmp(line + 2, name, nameLength) == 0 && line[2 + nameLength] == ':') {
+        const char* value = line + 3 + nameLength;
+        while (*value == ' ') {
+          value++;
+        }
+        return value;
+      }
+    }
+    return nullptr;
+  }
+
+  // ヘッダーから Content-Length を取得（ない場合は0）
+  size_t parseContentLength(const char* headers) {
+    const char* value = findHeader(headers, "Content-Length");
+    return value ? static_cast<size_t>(strtoul(value, nullptr, 10)) : 0;
+  }
+
+  /**
+   * "Authorization: Bearer <トークン>" が token と一致するか
+   * 比較は一致した文字数で時間が変わらないよう、トークンの長さ分を常に比べます。
+   */
+  bool isAuthorized(const char* headers, const char* token) {
+    const char* value = findHeader(headers, "Authorization");
+    if (!value || strncasecmp(value, "Bearer ", 7) != 0) {
+      return false;
+    }
+    value += 7;
+    size_t length = strcspn(value, "\r\n");
+    size_t tokenLength = strlen(token);
+    uint8_t diff = length != tokenLength;
+    for (size_t i = 0; i < tokenLength; i++) {
+      diff |= static_cast<uint8_t>(token[i] ^ (i < length ? value[i] : 0));
+    }
+    return diff == 0;
+  }
+
+  void setTimeout(int sock, int option, uint32_t ms) {
+    struct timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    setsockopt(sock, SOL_SOCKET, option, &tv, sizeof(tv));
+  }
+}
+
+/**
+ * コンストラクタ
+ */
+StatusServer::StatusServer(uint16_t port)
+  : port_(port),
+    listenSocket_(-1),
+    requestCount_(0),
+    snapshot_(),
+    config_(nullptr),
+    writeToken_(nullptr),
+    traceSource_(nullptr),
+    traceContext_(nullptr) {
+#ifdef ARDUINO
+  portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+  lock_ = unlocked;
+#endif
+  snapshot_.acMode = ACMode::NONE;
+}
+
+StatusServer::~StatusServer() {
+  if (listenSocket_ >= 0) {
+    close(listenSocket_);
+  }
+}
+
+bool StatusServer::begin() {
+  listenSocket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (listenSocket_ < 0) {
+    LOG(HTTP_SOCKET_FAIL, "socket", errno);
+    return false;
+  }
+
+  int reuse = 1;
+  setsockopt(listenSocket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port_);
+  if (bind(listenSocket_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      listen(listenSocket_, LISTEN_BACKLOG) < 0) {
+    LOG(HTTP_SOCKET_FAIL, "bind", errno);
+    close(listenSocket_);
+    listenSocket_ = -1;
+    return false;
+  }
+
+  // ポート0の場合は割り当てられた番号を取得
+  socklen_t addrLength = sizeof(addr);
+  if (getsockname(listenSocket_, reinterpret_cast<struct sockaddr*>(&addr), &addrLength) == 0) {
+    port_ = ntohs(addr.sin_port);
+  }
+
+#ifdef ARDUINO
+  xTaskCreatePinnedToCore(serverTask, "http", TASK_STACK_SIZE, this, TASK_PRIORITY, nullptr, TASK_CORE);
+#endif
+  LOG(HTTP_STARTED, port_);
+  return true;
+}
+
+#ifdef ARDUINO
+void StatusServer::serverTask(void* param) {
+  StatusServer* server = static_cast<StatusServer*>(param);
+  for (;;) {
+    server->poll(TASK_POLL_MS);
+  }
+}
+#endif
+
+/**
+ * 公開する状態を更新（コピーのみ、数µs）
+ */
+void StatusServer::publish(const StatusSnapshot& snapshot) {
+#ifdef ARDUINO
+  portENTER_CRITICAL(&lock_);
+  snapshot_ = snapshot;
+  portEXIT_CRITICAL(&lock_);
+#else
+  std::lock_guard<std::mutex> guard(lock_);
+  snapshot_ = snapshot;
+#endif
+}
+
+void StatusServer::copySnapshot(StatusSnapshot& out) {
+#ifdef ARDUINO
+  portENTER_CRITICAL(&lock_);
+  out = snapshot_;
+  portEXIT_CRITICAL(&lock_);
+#else
+  std::lock_guard<std::mutex> guard(lock_);
+  out = snapshot_;
+#endif
+}
+
+bool StatusServer::poll(uint32_t timeoutMs) {
+  if (listenSocket_ < 0) {
+    return false;
+  }
+
+  fd_set readSet;
+  FD_ZERO(&readSet);
+  FD_SET(listenSocket_, &readSet);
+  struct timeval tv;
+  tv.tv_sec = timeoutMs / 1000;
+  tv.tv_usec = (timeoutMs % 1000) * 1000;
+  if (select(listenSocket_ + 1, &readSet, nullptr, nullptr, &tv) <= 0) {
+    return false;
+  }
+
+  int client = accept(listenSocket_, nullptr, nullptr);
+  if (client < 0) {
+    return false;
+  }
+  setTimeout(client, SO_RCVTIMEO, SOCKET_TIMEOUT_MS);
+  setTimeout(client, SO_SNDTIMEO, SOCKET_TIMEOUT_MS);
+  handleClient(client);
+  close(client);
+  requestCount_ = requestCount_ + 1;
+  return true;
+}
+
+/**
+ * 1件のリクエストを処理
+ * ヘッダーの終端（空行）まで読み取ってから応答します（未読データを残して
+ * close すると RST が送られ、クライアント側で応答が欠けることがあるため）。
+ */
+void StatusServer::handleClient(int client) {
+  char request[REQUEST_BUFFER_SIZE];
+  size_t received = 0;
+  while (received < sizeof(request) - 1) {
+    ssize_t n = recv(client, request + received, sizeof(request) - 1 - received, 0);
+    if (n <= 0) {
+      break;
+    }
+    received += n;
+    request[received] = '\0';
+    if (strstr(request, "\r\n\r\n")) {
+      break;
+    }
+  }
+  if (received == 0) {
+    return;
+  }
+  request[received] = '\0';
+
+  Route route = parseRoute(request);
+  if ((route == Route::CONFIG_GET || route == Route::CONFIG_POST) && !config_) {
+    route = Route::NOT_FOUND;
+  }
+  if (route == Route::TRACE && !traceSource_) {
+    route = Route::NOT_FOUND;
+  }
+  char* body = nullptr;
+  bool bodyOk = route != Route::CONFIG_POST || readBody(client, request, received, body);
+  if (route == Route::CONFIG_POST) {
+    // 本文は読み終えてから拒否する（未読データを残すと RST で応答が欠けるため）
+    if (!writeToken_ || !writeToken_[0]) {
+      route = Route::FORBIDDEN;
+    } else if (!isAuthorized(request, writeToken_)) {
+      route = Route::UNAUTHORIZED;
+    }
+    if (route != Route::CONFIG_POST) {
+      LOG(HTTP_CONFIG_DENIED, routeName(route));
+    }
+  }
+
+  ResponseWriter out(responseBuffer_, sizeof(responseBuffer_), sendAll, &client);
+  switch (route) {
+    case Route::STATUS:
+    case Route::METRICS: {
+      StatusSnapshot status;
+      copySnapshot(status);
+      if (route == Route::STATUS) {
+        out.write(JSON_HEADER);
+        StatusFormat::writeJson(status, out);
+      } else {
+        out.write(METRICS_HEADER);
+        StatusFormat::writePrometheus(status, out);
+      }
+      break;
+    }
+    case Route::CONFIG_GET:
+      out.write(JSON_HEADER);
+      RuntimeConfigSchema::writeJson(config_->get(), out);
+      break;
+    case Route::CONFIG_POST: {
+      const char* error = nullptr;
+      if (!bodyOk) {
+        out.write(TOO_LARGE_RESPONSE);
+      } else if (config_->applyText(body, &error)) {
+        out.write(JSON_HEADER);
+        RuntimeConfigSchema::writeJson(config_->get(), out);
+      } else {
+        out.write(BAD_REQUEST_HEADER);
+        out.printf("%s\n", error);
+      }
+      break;
+    }
+    case Route::TRACE:
+      out.write(TRACE_HEADER);
+      traceSource_(out, traceContext_);
+      break;
+    case Route::NOT_FOUND:
+      out.write(NOT_FOUND_RESPONSE);
+      break;
+    case Route::BAD_METHOD:
+      out.write(METHOD_NOT_ALLOWED_RESPONSE);
+      break;
+    case Route::UNAUTHORIZED:
+      out.write(UNAUTHORIZED_RESPONSE);
+      break;
+    case Route::FORBIDDEN:
+      out.write(FORBIDDEN_RESPONSE);
+      break;
+  }
+  out.flush();
+  shutdown(client, SHUT_WR);
+
+  if (out.failed()) {
+    LOG(HTTP_SEND_FAIL, errno);
+  } else {
+    LOG(HTTP_REQUEST, routeName(route), out.getTotal());
+  }
+}
+
+/**
+ * POST の本文を Content-Length 分まで読み取る（リクエストバッファに収まる分のみ）
+ * @param body 本文の先頭（null終端）
+ * @return false: ヘッダーが不完全、または本文が大きすぎる
+ */
+bool StatusServer::readBody(int client, char* request, size_t& received, char*& body) {
+  char* headerEnd = strstr(request, "\r\n\r\n");
+  if (!headerEnd) {
+    return false;
+  }
+  body = headerEnd + 4;
+  size_t headerLength = body - request;
+  size_t contentLength = parseContentLength(request);
+  if (headerLength + contentLength > REQUEST_BUFFER_SIZE - 1) {
+    return false;
+  }
+  while (received < headerLength + contentLength) {
+    ssize_t n = recv(client, request + received, headerLength + contentLength - received, 0);
+    if (n <= 0) {
+      break;
+    }
+    received += n;
+  }
+  request[received] = '\0';
+  return true;
+}
+
+bool StatusServer::sendAll(const char* data, size_t length, void* context) {
+  int client = *static_cast<int*>(context);
+  while (length > 0) {
+    ssize_t n = send(client, data, length, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    length -= n;
+  }
+  return true;
+}
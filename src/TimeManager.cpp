@@ -6,6 +6,9 @@
 
 #include "TimeManager.h"
 
+#include <sys/time.h>
+#include "Logger.h"
+
 /**
  * コンストラクタ
  * NTPサーバーとタイムゾーン設定を初期化します。
@@ -17,42 +20,87 @@ TimeManager::TimeManager(const char* ntpServer, long gmtOffsetSec, int daylightO
 }
 
 /**
- * NTPサーバーから時刻を同期
- * WiFi接続後に呼び出してください。
+ * NTP同期を開始
  */
-bool TimeManager::syncTime() {
-  Serial.println("[Time] NTP時刻同期を開始...");
+void TimeManager::startSync() {
+  LOG(TIME_SYNC_START);
 
   // NTPサーバーと接続して時刻を設定
   // configTime(GMTオフセット秒, サマータイムオフセット秒, NTPサーバー)
   configTime(gmtOffsetSec_, daylightOffsetSec_, ntpServer_);
+}
+
+/**
+ * NTPサーバーから時刻を同期
+ * WiFi接続後に呼び出してください。
+ */
+bool TimeManager::syncTime() {
+  startSync();
 
   // 時刻同期が完了するまで待機（最大10秒）
   int retryCount = 0;
   struct tm timeinfo;
   while (!getLocalTime(&timeinfo) && retryCount < 10) {
-    Serial.print(".");
     delay(1000);
     retryCount++;
+    LOG(TIME_SYNC_WAITING, retryCount);
   }
 
   if (retryCount >= 10) {
-    Serial.println("\n[Time] 時刻同期失敗");
+    LOG(TIME_SYNC_FAIL);
     return false;
   }
 
   // 同期成功：現在の日時を表示
-  Serial.println("\n[Time] 時刻同期成功");
+  LOG(TIME_SYNC_OK);
   printCurrentTime();
 
   return true;
 }
 
+/**
+ * タイムゾーンのみ設定
+ * POSIX の TZ はUTCより東を負で表します（日本時間は "UTC-09:00"）。
+ */
+void TimeManager::restoreTimeZone() {
+  long west = -gmtOffsetSec_;
+  long absWest = west < 0 ? -west : west;
+  char tz[32];
+  snprintf(tz, sizeof(tz), "UTC%c%02ld:%02ld", west < 0 ? '-' : '+', absWest / 3600, (absWest % 3600) / 60);
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+/**
+ * UNIX時刻を直接設定
+ */
+void TimeManager::setEpochTime(uint32_t epoch) {
+  restoreTimeZone();
+  struct timeval tv;
+  tv.tv_sec = static_cast<time_t>(epoch);
+  tv.tv_usec = 0;
+  settimeofday(&tv, nullptr);
+}
+
 /**
  * 現在の時刻情報を取得
  */
 bool TimeManager::getCurrentTime(struct tm& timeinfo) {
-  return getLocalTime(&timeinfo);
+  // 同期前は待たずに失敗を返す（既定では最大5秒待つため、起動直後の表示・制御が止まる）
+  return getLocalTime(&timeinfo, 0);
+}
+
+/**
+ * 現在のUNIX時刻を取得
+ * NTP同期前は1970年起点の時刻になるため、2020年より前は未同期とみなします。
+ */
+bool TimeManager::getEpochTime(uint32_t& epoch) {
+  time_t now = time(nullptr);
+  if (now < MIN_VALID_EPOCH) {
+    return false;
+  }
+  epoch = static_cast<uint32_t>(now);
+  return true;
 }
 
 /**
@@ -89,36 +137,22 @@ bool TimeManager::isSummerSeason() {
 }
 
 /**
- * 現在の日時をシリアル出力
+ * 現在の日時をログ出力
  */
 void TimeManager::printCurrentTime() {
   struct tm timeinfo;
   if (!getCurrentTime(timeinfo)) {
-    Serial.println("[Time] 時刻取得失敗");
+    LOG(TIME_GET_FAIL);
     return;
   }
 
-  Serial.printf("[Time] 現在時刻: %04d/%02d/%02d %02d:%02d:%02d\n",
-                timeinfo.tm_year + 1900,  // 年（1900年からの経過年数）
-                timeinfo.tm_mon + 1,       // 月（0-11なので+1）
-                timeinfo.tm_mday,          // 日
-                timeinfo.tm_hour,          // 時
-                timeinfo.tm_min,           // 分
-                timeinfo.tm_sec);          // 秒
-}
-
-/**
- * フォーマットされた日時文字列を取得
- */
-String TimeManager::getFormattedTime(const char* format) {
-  struct tm timeinfo;
-  if (!getCurrentTime(timeinfo)) {
-    return "";  // 時刻取得失敗時は空文字列を返す
-  }
-
-  char buffer[64];
-  strftime(buffer, sizeof(buffer), format, &timeinfo);
-  return String(buffer);
+  LOG(TIME_NOW,
+      timeinfo.tm_year + 1900,  // 年（1900年からの経過年数）
+      timeinfo.tm_mon + 1,       // 月（0-11なので+1）
+      timeinfo.tm_mday,          // 日
+      timeinfo.tm_hour,          // 時
+      timeinfo.tm_min,           // 分
+      timeinfo.tm_sec);          // 秒
 }
 
 /**
@@ -0,0 +1,377 @@
+/**
+ * TraceCodec.cpp
+ *
+ * 制御の入力トレースの圧縮形式の実装
+ */
+
+#include "TraceCodec.h"
+
+#include <string.h>
+
+namespace {
+  inline uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+  }
+
+  inline int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+  }
+
+  inline uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  inline float bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  constexpr uint8_t KIND_BITS = 3;
+  constexpr uint8_t KIND_MASK = (1 << KIND_BITS) - 1;
+}
+
+// ========================================
+// TraceValueTable
+// ========================================
+
+uint8_t TraceValueTable::find(uint32_t value) const {
+  for (uint8_t i = 0; i < count; i++) {
+    if (values[i] == value) {
+      return i;
+    }
+  }
+  return LITERAL;
+}
+
+uint32_t TraceValueTable::use(uint8_t index) {
+  uint32_t value = values[index];
+  memmove(values + 1, values, sizeof(values[0]) * index);
+  values[0] = value;
+  return value;
+}
+
+void TraceValueTable::push(uint32_t value) {
+  if (count < SIZE) {
+    count++;
+  }
+  memmove(values + 1, values, sizeof(values[0]) * (count - 1));
+  values[0] = value;
+}
+
+// ========================================
+// TraceBlockHeader
+// ========================================
+
+void TraceBlockHeader::serialize(uint8_t* out) const {
+  out[0] = MAGIC;
+  out[1] = VERSION;
+  memcpy(out + 2, &payloadLength, 2);
+  memcpy(out + 4, &recordCount, 2);
+  memcpy(out + 6, &startMs, 4);
+}
+
+bool TraceBlockHeader::deserialize(const uint8_t* in) {
+  if (in[0] != MAGIC || in[1] != VERSION) {
+    return false;
+  }
+  memcpy(&payloadLength, in + 2, 2);
+  memcpy(&recordCount, in + 4, 2);
+  memcpy(&startMs, in + 6, 4);
+  return payloadLength <= TraceEncoder::CAPACITY;
+}
+
+// ========================================
+// TraceEncoder
+// ========================================
+
+TraceEncoder::TraceEncoder() {
+  reset();
+}
+
+void TraceEncoder::reset() {
+  header_.payloadLength = 0;
+  header_.recordCount = 0;
+  header_.startMs = 0;
+  lastTime_ = 0;
+  lastSampleTime_ = 0;
+  lastSampleInterval_ = 0;
+  temperatures_.clear();
+  humidities_.clear();
+}
+
+void TraceEncoder::putVarint(uint64_t value) {
+  while (value >= 0x80) {
+    putByte(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  putByte(static_cast<uint8_t>(value));
+}
+
+void TraceEncoder::putSigned(int32_t value) {
+  putVarint(zigzag(value));
+}
+
+void TraceEncoder::putFloat(float value) {
+  uint32_t bits = floatBits(value);
+  memcpy(payload_ + header_.payloadLength, &bits, 4);
+  header_.payloadLength += 4;
+}
+
+/**
+ * 表の位置を返して先頭へ移動（表にない値は literal に表の先頭との差分を入れて追加）
+ */
+uint8_t TraceEncoder::encodeValue(TraceValueTable& table, uint32_t value, int32_t& literal) {
+  uint8_t index = table.find(value);
+  if (index == TraceValueTable::LITERAL) {
+    literal = static_cast<int32_t>(value - table.front());
+    table.push(value);
+  } else {
+    table.use(index);
+  }
+  return index;
+}
+
+bool TraceEncoder::append(const TraceEvent& event) {
+  if (header_.payloadLength + MAX_RECORD_SIZE > CAPACITY || header_.recordCount == UINT16_MAX) {
+    return false;
+  }
+
+  if (header_.recordCount == 0) {
+    header_.startMs = event.timeMs;
+    lastTime_ = event.timeMs;
+    lastSampleTime_ = event.timeMs;
+  }
+
+  // 読み取りは前回と同じ間隔なら経過0になる
+  uint64_t elapsed = event.timeMs - lastTime_;
+  if (event.kind == TraceKind::SAMPLE) {
+    uint32_t interval = event.timeMs - lastSampleTime_;
+    elapsed = zigzag(static_cast<int32_t>(interval - lastSampleInterval_));
+    lastSampleTime_ = event.timeMs;
+    lastSampleInterval_ = interval;
+  }
+  putVarint((elapsed << KIND_BITS) | static_cast<uint8_t>(event.kind));
+
+  switch (event.kind) {
+    case TraceKind::SAMPLE: {
+      int32_t temperature = 0;
+      int32_t humidity = 0;
+      uint8_t temperatureIndex = encodeValue(temperatures_, floatBits(event.temperature), temperature);
+      uint8_t humidityIndex = encodeValue(humidities_, floatBits(event.humidity), humidity);
+      putByte(static_cast<uint8_t>(temperatureIndex | (humidityIndex << 4)));
+      if (temperatureIndex == TraceValueTable::LITERAL) {
+        putSigned(temperature);
+      }
+      if (humidityIndex == TraceValueTable::LITERAL) {
+        putSigned(humidity);
+      }
+      break;
+    }
+    case TraceKind::CONTROL:
+      putByte(event.flags);
+      putVarint(static_cast<uint32_t>(event.timeinfo.tm_year));
+      putByte(static_cast<uint8_t>(event.timeinfo.tm_mon));
+      putByte(static_cast<uint8_t>(event.timeinfo.tm_mday));
+      putByte(static_cast<uint8_t>(event.timeinfo.tm_hour));
+      putByte(static_cast<uint8_t>(event.timeinfo.tm_min));
+      putByte(static_cast<uint8_t>(event.timeinfo.tm_sec));
+      putByte(static_cast<uint8_t>(event.timeinfo.tm_wday));
+      putByte(event.mode);
+      putVarint(event.result);
+      break;
+    case TraceKind::WEATHER:
+      putByte(event.weatherValid ? 1 : 0);
+      putFloat(event.tempMax);
+      putFloat(event.tempMin);
+      putSigned(event.weatherCode);
+      break;
+    case TraceKind::THRESHOLDS:
+      putFloat(event.thresholds.tempLower);
+      putFloat(event.thresholds.tempUpper);
+      putFloat(event.thresholds.tempHysteresis);
+      putFloat(event.thresholds.humidityUpper);
+      break;
+    case TraceKind::MODE:
+      putByte(event.mode);
+      break;
+    case TraceKind::IR:
+      putSigned(event.irProtocol);
+      putVarint(event.irBits);
+      putVarint(event.irValue);
+      break;
+    case TraceKind::BOOT:
+      break;
+  }
+
+  lastTime_ = event.timeMs;
+  header_.recordCount++;
+  return true;
+}
+
+// ========================================
+// TraceDecoder
+// ========================================
+
+TraceDecoder::TraceDecoder(const TraceBlockHeader& header, const uint8_t* payload)
+  : payload_(payload),
+    length_(header.payloadLength),
+    pos_(0),
+    remaining_(header.recordCount),
+    lastTime_(header.startMs),
+    lastSampleTime_(header.startMs),
+    lastSampleInterval_(0),
+    temperatures_(),
+    humidities_() {
+}
+
+bool TraceDecoder::getByte(uint8_t& value) {
+  if (pos_ >= length_) {
+    return false;
+  }
+  value = payload_[pos_++];
+  return true;
+}
+
+bool TraceDecoder::getVarint(uint64_t& value) {
+  value = 0;
+  for (uint8_t shift = 0; shift < 70; shift += 7) {
+    uint8_t byte;
+    if (!getByte(byte)) {
+      return false;
+    }
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TraceDecoder::getVarint32(uint32_t& value) {
+  uint64_t raw;
+  if (!getVarint(raw) || raw > UINT32_MAX) {
+    return false;
+  }
+  value = static_cast<uint32_t>(raw);
+  return true;
+}
+
+bool TraceDecoder::getSigned(int32_t& value) {
+  uint32_t raw;
+  if (!getVarint32(raw)) {
+    return false;
+  }
+  value = unzigzag(raw);
+  return true;
+}
+
+bool TraceDecoder::getFloat(float& value) {
+  if (pos_ + 4 > length_) {
+    return false;
+  }
+  uint32_t bits;
+  memcpy(&bits, payload_ + pos_, 4);
+  pos_ += 4;
+  value = bitsFloat(bits);
+  return true;
+}
+
+/**
+ * 表の位置（LITERAL の場合は続く差分）から値を復元して先頭へ移動
+ */
+bool TraceDecoder::decodeValue(TraceValueTable& table, uint8_t code, float& value) {
+  if (code == TraceValueTable::LITERAL) {
+    int32_t delta;
+    if (!getSigned(delta)) {
+      return false;
+    }
+    uint32_t bits = table.front() + static_cast<uint32_t>(delta);
+    table.push(bits);
+    value = bitsFloat(bits);
+    return true;
+  }
+  if (code >= table.count) {
+    return false;
+  }
+  value = bitsFloat(table.use(code));
+  return true;
+}
+
+bool TraceDecoder::next(TraceEvent& event) {
+  if (remaining_ == 0) {
+    return false;
+  }
+
+  uint64_t head;
+  if (!getVarint(head)) {
+    return false;
+  }
+  memset(&event, 0, sizeof(event));
+  event.kind = static_cast<TraceKind>(head & KIND_MASK);
+  if (event.kind == TraceKind::SAMPLE) {
+    uint32_t interval = lastSampleInterval_ + static_cast<uint32_t>(unzigzag(static_cast<uint32_t>(head >> KIND_BITS)));
+    event.timeMs = lastSampleTime_ + interval;
+    lastSampleTime_ = event.timeMs;
+    lastSampleInterval_ = interval;
+  } else {
+    event.timeMs = lastTime_ + static_cast<uint32_t>(head >> KIND_BITS);
+  }
+
+  int32_t a;
+  uint32_t c;
+  uint8_t fields[6];
+  switch (event.kind) {
+    case TraceKind::SAMPLE: {
+      uint8_t codes;
+      if (!getByte(codes) || !decodeValue(temperatures_, codes & 0x0F, event.temperature) ||
+          !decodeValue(humidities_, codes >> 4, event.humidity)) return false;
+      break;
+    }
+    case TraceKind::CONTROL:
+      if (!getByte(event.flags) || !getVarint32(c)) return false;
+      for (uint8_t& field : fields) {
+        if (!getByte(field)) return false;
+      }
+      event.timeinfo.tm_year = static_cast<int>(c);
+      event.timeinfo.tm_mon = fields[0];
+      event.timeinfo.tm_mday = fields[1];
+      event.timeinfo.tm_hour = fields[2];
+      event.timeinfo.tm_min = fields[3];
+      event.timeinfo.tm_sec = fields[4];
+      event.timeinfo.tm_wday = fields[5];
+      if (!getByte(event.mode) || !getVarint32(event.result)) return false;
+      break;
+    case TraceKind::WEATHER: {
+      uint8_t valid;
+      if (!getByte(valid) || !getFloat(event.tempMax) || !getFloat(event.tempMin) || !getSigned(a)) return false;
+      event.weatherValid = valid != 0;
+      event.weatherCode = a;
+      break;
+    }
+    case TraceKind::THRESHOLDS:
+      if (!getFloat(event.thresholds.tempLower) || !getFloat(event.thresholds.tempUpper) ||
+          !getFloat(event.thresholds.tempHysteresis) || !getFloat(event.thresholds.humidityUpper)) return false;
+      break;
+    case TraceKind::MODE:
+      if (!getByte(event.mode)) return false;
+      break;
+    case TraceKind::IR: {
+      uint32_t bits;
+      if (!getSigned(a) || !getVarint32(bits) || !getVarint(event.irValue)) return false;
+      event.irProtocol = static_cast<int16_t>(a);
+      event.irBits = static_cast<uint16_t>(bits);
+      break;
+    }
+    case TraceKind::BOOT:
+      break;
+    default:
+      return false;
+  }
+
+  lastTime_ = event.timeMs;
+  remaining_--;
+  return true;
+}
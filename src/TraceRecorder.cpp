@@ -0,0 +1,304 @@
+/**
+ * TraceRecorder.cpp
+ *
+ * 制御の入力トレースの記録クラスの実装
+ */
+
+#include "TraceRecorder.h"
+
+#include <LittleFS.h>
+#include "AllocCounter.h"
+#include "StatusFormat.h"
+#include "Logger.h"
+
+namespace {
+  const char* const TRACE_DIR = "/trace";
+  constexpr size_t READ_CHUNK = 256;  // writeTo() で1回に読むバイト数（HTTPサーバーのタスクのスタック）
+}
+
+TraceRecorder::TraceRecorder()
+  : encoder_(),
+    ready_(false),
+    firstSequence_(1),
+    lastSequence_(0),
+    lastSize_(0),
+    readingSequence_(0),
+    inputsRecorded_(false),
+    lastWeather_(),
+    lastThresholds_() {
+  portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+  lock_ = unlocked;
+}
+
+void TraceRecorder::filePath(uint32_t sequence, char* path, size_t size) {
+  snprintf(path, size, "%s/%08lu.bin", TRACE_DIR, static_cast<unsigned long>(sequence));
+}
+
+/**
+ * 既存のファイルの番号の範囲を調べ、上限を超えた分は古い方から削除
+ */
+bool TraceRecorder::begin(uint32_t nowMs) {
+  if (!LittleFS.exists(TRACE_DIR) && !LittleFS.mkdir(TRACE_DIR)) {
+    return false;
+  }
+
+  uint32_t first = 0;
+  uint32_t last = 0;
+  File dir = LittleFS.open(TRACE_DIR);
+  for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+    uint32_t sequence = strtoul(file.name(), nullptr, 10);
+    if (sequence == 0) {
+      continue;
+    }
+    if (first == 0 || sequence < first) {
+      first = sequence;
+    }
+    if (sequence > last) {
+      last = sequence;
+      lastSize_ = file.size();
+    }
+    file.close();
+  }
+  dir.close();
+
+  if (last != 0) {
+    while (last - first + 1 > MAX_FILES) {
+      char path[32];
+      filePath(first++, path, sizeof(path));
+      LittleFS.remove(path);
+    }
+    firstSequence_ = first;
+  }
+  lastSequence_ = last;
+  ready_ = true;
+  LOG(TRACE_READY, last != 0 ? last - first + 1 : 0, static_cast<uint32_t>(lastSize_ / 1024));
+
+  TraceEvent event = {};
+  event.timeMs = nowMs;
+  event.kind = TraceKind::BOOT;
+  append(event);
+  return true;
+}
+
+void TraceRecorder::recordSample(uint32_t nowMs, float temperature, float humidity) {
+  TraceEvent event = {};
+  event.timeMs = nowMs;
+  event.kind = TraceKind::SAMPLE;
+  event.temperature = temperature;
+  event.humidity = humidity;
+  append(event);
+}
+
+void TraceRecorder::recordControl(uint32_t nowMs, const struct tm* timeinfo, const WeatherData& weather,
+                                  const PolicyThresholds& thresholds, ACMode current, ACMode decided) {
+  recordInputs(nowMs, weather, thresholds);
+  recordDecision(nowMs, timeinfo, timeinfo ? TraceFlag::TIME_VALID : 0, current, static_cast<uint32_t>(decided));
+}
+
+void TraceRecorder::recordCommand(uint32_t nowMs, const struct tm& timeinfo, const WeatherData& weather,
+                                  const PolicyThresholds& thresholds, ACMode baseline, const ACCommand& decided) {
+  recordInputs(nowMs, weather, thresholds);
+  recordDecision(nowMs, &timeinfo, TraceFlag::TIME_VALID | TraceFlag::MODULATED, baseline, decided.packed());
+}
+
+void TraceRecorder::recordMode(uint32_t nowMs, ACMode mode) {
+  TraceEvent event = {};
+  event.timeMs = nowMs;
+  event.kind = TraceKind::MODE;
+  event.mode = static_cast<uint8_t>(mode);
+  append(event);
+}
+
+void TraceRecorder::recordIR(uint32_t nowMs, int16_t protocol, uint16_t bits, uint64_t value) {
+  TraceEvent event = {};
+  event.timeMs = nowMs;
+  event.kind = TraceKind::IR;
+  event.irProtocol = protocol;
+  event.irBits = bits;
+  event.irValue = value;
+  append(event);
+}
+
+/**
+ * 天気予報・閾値が前回の記録から変わっていれば記録（判定に使う項目のみ比較）
+ */
+void TraceRecorder::recordInputs(uint32_t nowMs, const WeatherData& weather, const PolicyThresholds& thresholds) {
+  TraceEvent event = {};
+  event.timeMs = nowMs;
+  if (!inputsRecorded_ || weather.isValid != lastWeather_.isValid || weather.tempMax != lastWeather_.tempMax ||
+      weather.tempMin != lastWeather_.tempMin || weather.weatherCode != lastWeather_.weatherCode) {
+    event.kind = TraceKind::WEATHER;
+    event.weatherValid = weather.isValid;
+    event.tempMax = weather.tempMax;
+    event.tempMin = weather.tempMin;
+    event.weatherCode = weather.weatherCode;
+    append(event);
+    lastWeather_ = weather;
+  }
+  if (!inputsRecorded_ || memcmp(&thresholds, &lastThresholds_, sizeof(thresholds)) != 0) {
+    event.kind = TraceKind::THRESHOLDS;
+    event.thresholds = thresholds;
+    append(event);
+    lastThresholds_ = thresholds;
+  }
+  inputsRecorded_ = true;
+}
+
+void TraceRecorder::recordDecision(uint32_t nowMs, const struct tm* timeinfo, uint8_t flags, ACMode current,
+                                   uint32_t result) {
+  TraceEvent event = {};
+  event.timeMs = nowMs;
+  event.kind = TraceKind::CONTROL;
+  if (timeinfo) {
+    event.timeinfo = *timeinfo;
+  }
+  event.flags = flags;
+  event.mode = static_cast<uint8_t>(current);
+  event.result = result;
+  append(event);
+}
+
+/**
+ * ブロックに追加（満杯・書き出し間隔の経過で書き出す）
+ */
+void TraceRecorder::append(const TraceEvent& event) {
+  if (!ready_) {
+    return;
+  }
+  if (!encoder_.append(event)) {
+    writeBlock();
+    encoder_.append(event);
+  }
+  if (event.timeMs - encoder_.getHeader().startMs >= FLUSH_INTERVAL_MS) {
+    writeBlock();
+  }
+}
+
+void TraceRecorder::flush() {
+  writeBlock();
+}
+
+/**
+ * RAM上のブロックを書き込み中のファイルに追記（上限を超える場合は次のファイル）
+ */
+bool TraceRecorder::writeBlock() {
+  if (!ready_ || encoder_.isEmpty()) {
+    return true;
+  }
+
+  const TraceBlockHeader& header = encoder_.getHeader();
+  size_t blockSize = TraceBlockHeader::SIZE + header.payloadLength;
+  if (lastSequence_ == 0 || lastSize_ + blockSize > FILE_SIZE) {
+    portENTER_CRITICAL(&lock_);
+    lastSequence_++;
+    lastSize_ = 0;
+    portEXIT_CRITICAL(&lock_);
+  }
+  removeOldFiles();
+
+  char path[32];
+  filePath(lastSequence_, path, sizeof(path));
+
+  uint8_t raw[TraceBlockHeader::SIZE];
+  header.serialize(raw);
+
+  bool ok;
+  {
+    AllocExemption exemption;
+    File file = LittleFS.open(path, FILE_APPEND);
+    ok = file &&
+         file.write(raw, sizeof(raw)) == sizeof(raw) &&
+         file.write(encoder_.getPayload(), header.payloadLength) == header.payloadLength;
+    if (file) {
+      file.close();
+    }
+  }
+
+  if (ok) {
+    // 書き込みが終わってから増やす（writeTo() は書き出し済みのブロックまでを読む）
+    portENTER_CRITICAL(&lock_);
+    lastSize_ += blockSize;
+    portEXIT_CRITICAL(&lock_);
+  } else {
+    LOG(TRACE_WRITE_FAIL, path);
+  }
+
+  // 失敗した場合もブロックは破棄（同じブロックで書き込みを繰り返さない）
+  encoder_.reset();
+  return ok;
+}
+
+/**
+ * MAX_FILES を超えた古いファイルを削除（writeTo() が読み取り中のファイルは次の書き出しまで残す）
+ */
+void TraceRecorder::removeOldFiles() {
+  for (;;) {
+    portENTER_CRITICAL(&lock_);
+    bool remove = lastSequence_ - firstSequence_ + 1 > MAX_FILES && readingSequence_ != firstSequence_;
+    uint32_t sequence = firstSequence_;
+    if (remove) {
+      firstSequence_++;  // 先に範囲を進め、writeTo() が削除するファイルを開かないようにする
+    }
+    portEXIT_CRITICAL(&lock_);
+    if (!remove) {
+      return;
+    }
+
+    char path[32];
+    filePath(sequence, path, sizeof(path));
+    {
+      AllocExemption exemption;  // LittleFS のファイル操作は内部で確保する
+      LittleFS.remove(path);
+    }
+    LOG(TRACE_FILE_REMOVED, path);
+  }
+}
+
+/**
+ * ファイルを番号順に読み、そのまま出力（削除済みの番号は読み飛ばす）
+ * 開始時点の書き込み中のファイルまでを出力し、各ファイルは開く前に読み取り中として登録します。
+ */
+void TraceRecorder::writeTo(ResponseWriter& out) const {
+  portENTER_CRITICAL(&lock_);
+  uint32_t sequence = firstSequence_;
+  uint32_t last = lastSequence_;
+  portEXIT_CRITICAL(&lock_);
+  if (!ready_ || last == 0) {
+    return;
+  }
+
+  char buffer[READ_CHUNK];
+  for (; sequence <= last && !out.failed(); sequence++) {
+    size_t limit = FILE_SIZE;
+    portENTER_CRITICAL(&lock_);
+    if (sequence < firstSequence_) {
+      sequence = firstSequence_;  // 読んでいる間に削除された
+    }
+    readingSequence_ = sequence;
+    if (sequence == lastSequence_) {
+      limit = lastSize_;
+    }
+    portEXIT_CRITICAL(&lock_);
+    if (sequence > last) {
+      break;
+    }
+
+    char path[32];
+    filePath(sequence, path, sizeof(path));
+    File file = LittleFS.open(path, FILE_READ);
+    if (file) {
+      size_t remaining = limit;
+      size_t length;
+      while (remaining > 0 && !out.failed() &&
+             (length = file.read(reinterpret_cast<uint8_t*>(buffer), remaining < sizeof(buffer) ? remaining : sizeof(buffer))) > 0) {
+        out.write(buffer, length);
+        remaining -= length;
+      }
+      file.close();
+    }
+  }
+
+  portENTER_CRITICAL(&lock_);
+  readingSequence_ = 0;
+  portEXIT_CRITICAL(&lock_);
+}
@@ -0,0 +1,44 @@
+/**
+ * WeatherData.cpp
+ *
+ * 天気の分類の実装
+ */
+
+#include "WeatherData.h"
+
+#include <stddef.h>
+
+namespace {
+  // WeatherCategory の順（const のためフラッシュに配置）
+  const char* const CATEGORY_NAMES[] = {
+    "Unknown",
+    "Clear",
+    "Cloudy",
+    "Fog",
+    "Rain",
+    "Snow",
+    "Storm",
+  };
+}
+
+WeatherCategory weatherCategoryFromCode(int code) {
+  if (code == 0) {
+    return WeatherCategory::CLEAR;
+  } else if (code >= 1 && code <= 3) {
+    return WeatherCategory::CLOUDY;
+  } else if (code == 45 || code == 48) {
+    return WeatherCategory::FOG;
+  } else if (code >= 51 && code <= 67) {
+    return WeatherCategory::RAIN;
+  } else if (code >= 71 && code <= 77) {
+    return WeatherCategory::SNOW;
+  } else if (code >= 80 && code <= 99) {
+    return WeatherCategory::STORM;
+  }
+  return WeatherCategory::UNKNOWN;
+}
+
+const char* weatherCategoryName(WeatherCategory category) {
+  size_t index = static_cast<size_t>(category);
+  return index < sizeof(CATEGORY_NAMES) / sizeof(CATEGORY_NAMES[0]) ? CATEGORY_NAMES[index] : CATEGORY_NAMES[0];
+}
@@ -1,138 +1,268 @@
 #include "WeatherForecast.h"
 #include "TimeManager.h"
+#include "Logger.h"
 
-WeatherForecast::WeatherForecast(float latitude, float longitude)
-  : lastUpdateHour_(-1) {
-  // API URLを構築
-  apiUrl_ = "https://api.open-meteo.com/v1/forecast?latitude=" + String(latitude, 6) +
-            "&longitude=" + String(longitude, 6) +
-            "&daily=weather_code,temperature_2m_max,temperature_2m_min" +
-            "&timezone=Asia/Tokyo&forecast_days=1";
+namespace {
+  // 現在のUNIX時刻（時刻の同期前は 0: 取得時刻は不明として扱う）
+  uint32_t currentEpoch() {
+    time_t now = time(nullptr);
+    return now >= TimeManager::MIN_VALID_EPOCH ? static_cast<uint32_t>(now) : 0;
+  }
+}
 
+WeatherForecast::WeatherForecast(float latitude, float longitude)
+  : latitude_(latitude),
+    longitude_(longitude),
+    openMeteo_(latitude, longitude),
+    providers_(),
+    providerCount_(0),
+    source_("none"),
+    schedule_(REFRESH_INTERVAL_SEC, REFRESH_JITTER_SEC, RETRY_BASE_SEC, RETRY_MAX_SEC, esp_random()),
+    staleLogged_(false),
+    worker_(nullptr),
+    fetchTask_(*this),
+    locationPending_(false),
+    fetched_(),
+    fetchedSource_(nullptr),
+    body_(nullptr),
+    jsonAllocator_(jsonArena_) {
   // 天気データを初期化
   weatherData_.isValid = false;
   weatherData_.tempMax = 0.0f;
   weatherData_.tempMin = 0.0f;
   weatherData_.weatherCode = 0;
-  weatherData_.weatherString = "N/A";
+  weatherData_.category = WeatherCategory::UNKNOWN;
   weatherData_.lastUpdate = 0;
+  weatherData_.fetchedEpoch = 0;
+
+  addProvider(&openMeteo_);
+  LOG(WEATHER_READY);
+  setLocation(latitude, longitude);
+}
+
+void WeatherForecast::setLocation(float latitude, float longitude) {
+  latitude_ = latitude;
+  longitude_ = longitude;
+  if (isFetching()) {
+    locationPending_ = true;  // 取得元は別タスクで使用中
+  } else {
+    applyLocation();
+  }
+  schedule_.expedite();  // 新しい地点の予報を次の確認ですぐに取得
 
-  Serial.println("[Weather] WeatherForecast初期化完了");
-  Serial.print("[Weather] API URL: ");
-  Serial.println(apiUrl_);
+  LOG(WEATHER_LOCATION, latitude, longitude);
+}
+
+void WeatherForecast::applyLocation() {
+  for (size_t i = 0; i < providerCount_; i++) {
+    providers_[i]->setLocation(latitude_, longitude_);
+  }
+  locationPending_ = false;
+}
+
+bool WeatherForecast::reserveBuffers(StaticArena& arena) {
+  char* body = static_cast<char*>(arena.allocate(BODY_SIZE, 1));
+  void* pool = arena.allocate(JSON_POOL_SIZE);
+  if (body == nullptr || pool == nullptr) {
+    return false;
+  }
+  body_ = body;
+  jsonArena_ = StaticArena(pool, JSON_POOL_SIZE);
+  return true;
+}
+
+bool WeatherForecast::addProvider(ForecastProvider* provider) {
+  if (providerCount_ >= MAX_PROVIDERS) {
+    return false;
+  }
+  provider->setLocation(latitude_, longitude_);
+  providers_[providerCount_++] = provider;
+  return true;
+}
+
+void WeatherForecast::restore(const WeatherData& cached) {
+  if (!cached.isValid) {
+    return;
+  }
+  weatherData_ = cached;
+  weatherData_.lastUpdate = millis();
+  source_ = "cache";
+  LOG(WEATHER_RESTORED, cached.tempMax, cached.tempMin, cached.fetchedEpoch);
 }
 
 bool WeatherForecast::begin() {
-  Serial.println("[Weather] 初回天気予報データ取得開始");
-  return fetchWeatherData();
+  LOG(WEATHER_INITIAL_FETCH);
+  return fetchAndReschedule();
+}
+
+bool WeatherForecast::attach(BackgroundWorker& worker, CoroutineScheduler& scheduler) {
+  if (!scheduler.add(&fetchTask_)) {
+    return false;
+  }
+  worker_ = &worker;
+  return true;
 }
 
 void WeatherForecast::update(TimeManager& timeMgr) {
-  // 現在の時刻を取得
-  struct tm timeinfo;
-  if (!timeMgr.getCurrentTime(timeinfo)) {
-    // 時刻取得失敗時はスキップ
+  // 時刻の同期前は期限を判定できないためスキップ
+  uint32_t epoch;
+  if (!timeMgr.getEpochTime(epoch)) {
     return;
   }
 
-  int currentHour = timeinfo.tm_hour;
-  int currentMinute = timeinfo.tm_min;
-
-  // 毎時0分かつ前回更新時と異なる時間帯の場合に更新
-  if (currentMinute == 0 && currentHour != lastUpdateHour_) {
-    Serial.printf("[Weather] 定期更新: %02d:00 天気予報データ取得開始\n", currentHour);
-    if (fetchWeatherData()) {
-      lastUpdateHour_ = currentHour;
+  // 期限を過ぎていれば取得（loop() が止まっていて期限を過ぎた場合も取りこぼさない）
+  // 別タスクで取得中は、完了時に次の期限を決めるまで判定しない
+  if (!isFetching() && schedule_.isDue(epoch)) {
+    uint32_t next = schedule_.getNextEpoch();
+    LOG(WEATHER_SCHEDULED_FETCH, next != 0 ? epoch - next : 0);
+    if (worker_ != nullptr) {
+      fetchTask_.start(millis());
+    } else {
+      fetchAndReschedule();
     }
   }
+  checkAge(epoch);
 }
 
-WeatherData WeatherForecast::getData() const {
-  return weatherData_;
+void WeatherForecast::setExternalData(float tempMax, float tempMin, int weatherCode, bool isValid) {
+  weatherData_.tempMax = tempMax;
+  weatherData_.tempMin = tempMin;
+  weatherData_.weatherCode = weatherCode;
+  weatherData_.category = weatherCategoryFromCode(weatherCode);
+  weatherData_.isValid = isValid;
+  weatherData_.lastUpdate = millis();
+  weatherData_.fetchedEpoch = currentEpoch();
+  source_ = "mesh";
+  staleLogged_ = false;
 }
 
-bool WeatherForecast::fetchWeatherData() {
-  HTTPClient http;
+uint32_t WeatherForecast::getAgeSec(uint32_t nowEpoch) const {
+  if (weatherData_.fetchedEpoch == 0 || nowEpoch < weatherData_.fetchedEpoch) {
+    return 0;
+  }
+  return nowEpoch - weatherData_.fetchedEpoch;
+}
 
-  Serial.print("[Weather] APIリクエスト送信: ");
-  Serial.println(apiUrl_);
+/**
+ * 取得に失敗し続けている間の予報の古さを確認
+ * STALE_SEC を超えたら1回だけ警告し、EXPIRE_SEC を超えたら無効にします
+ * （前日の最低気温は当日の目安として使えるが、それより古い値で制御しない）。
+ */
+void WeatherForecast::checkAge(uint32_t nowEpoch) {
+  if (!weatherData_.isValid) {
+    return;
+  }
+  uint32_t age = getAgeSec(nowEpoch);
+  if (age >= EXPIRE_SEC) {
+    weatherData_.isValid = false;
+    source_ = "none";
+    LOG(WEATHER_EXPIRED, age / 3600);
+  } else if (age >= STALE_SEC && !staleLogged_) {
+    staleLogged_ = true;
+    LOG(WEATHER_STALE, source_, age / 3600);
+  }
+}
 
-  http.begin(apiUrl_);
-  int httpResponseCode = http.GET();
+/**
+ * 取得して結果に応じて次の期限を決める（取得の完了まで待つ）
+ */
+bool WeatherForecast::fetchAndReschedule() {
+  ForecastValues values;
+  const char* source = fetchValues(values);
+  return reschedule(applyFetched(source, values));
+}
 
-  if (httpResponseCode == 200) {
-    String payload = http.getString();
-    Serial.println("[Weather] APIレスポンス受信成功");
+/**
+ * 別タスクで取得し、完了を確認したら loop() で反映する
+ * 取得元の呼び出し（HTTP 通信・ファイル読み込み）は worker_ のタスクで行い、
+ * 天気データ・次の期限は loop() のみが書き込みます。
+ */
+bool WeatherForecast::FetchTask::run(uint32_t nowMs) {
+  CO_BEGIN();
+  while (!owner_.worker_->submit(fetchJob, &owner_)) {
+    CO_SLEEP(FETCH_POLL_MS);  // 前の処理が残っている間は待つ
+  }
+  CO_WAIT_UNTIL(owner_.worker_->isIdle(), FETCH_POLL_MS);
 
-    // JSONパース
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, payload);
+  owner_.reschedule(owner_.applyFetched(owner_.fetchedSource_, owner_.fetched_));
+  if (owner_.locationPending_) {
+    owner_.applyLocation();
+    owner_.schedule_.expedite();  // 取得中に変わった地点の予報をすぐに取得
+  }
+  CO_END();
+}
 
-    if (error) {
-      Serial.print("[Weather] JSONパースエラー: ");
-      Serial.println(error.c_str());
-      http.end();
-      return false;
+void WeatherForecast::fetchJob(void* context) {
+  WeatherForecast* self = static_cast<WeatherForecast*>(context);
+  self->fetchedSource_ = self->fetchValues(self->fetched_);
+}
+
+/**
+ * 結果に応じて次の期限を決める
+ * 時刻の同期前は期限を決められないため、同期後の最初の update() で取得し直します。
+ */
+bool WeatherForecast::reschedule(bool fetched) {
+  uint32_t epoch = currentEpoch();
+  if (epoch == 0) {
+    return fetched;
+  }
+  if (fetched) {
+    schedule_.onSuccess(epoch);
+  } else {
+    schedule_.onFailure(epoch);
+    LOG(WEATHER_RETRY, schedule_.getFailures(), schedule_.getNextEpoch() - epoch);
+  }
+  return fetched;
+}
+
+/**
+ * 取得元を登録順に試し、最初に成功した取得元を返す
+ * 天気データには書き込まないため、別タスクから呼び出せます。
+ * @return 成功した取得元の名前（nullptr: すべて失敗）
+ */
+const char* WeatherForecast::fetchValues(ForecastValues& values) {
+  for (size_t i = 0; i < providerCount_; i++) {
+    // JSONの確保先は取得元ごとに空に戻す（固定領域があればそこから確保）
+    ForecastScratch scratch;
+    scratch.body = body_;
+    scratch.bodySize = BODY_SIZE;
+    scratch.allocator = nullptr;
+    if (body_ != nullptr) {
+      jsonAllocator_.reset();
+      scratch.allocator = &jsonAllocator_;
     }
 
-    // データ抽出
-    JsonArray timeArray = doc["daily"]["time"];
-    JsonArray weatherCodeArray = doc["daily"]["weather_code"];
-    JsonArray tempMaxArray = doc["daily"]["temperature_2m_max"];
-    JsonArray tempMinArray = doc["daily"]["temperature_2m_min"];
-
-    if (timeArray.size() > 0 && weatherCodeArray.size() > 0 &&
-        tempMaxArray.size() > 0 && tempMinArray.size() > 0) {
-
-      weatherData_.weatherCode = weatherCodeArray[0];
-      weatherData_.tempMax = tempMaxArray[0];
-      weatherData_.tempMin = tempMinArray[0];
-      weatherData_.weatherString = weatherCodeToString(weatherData_.weatherCode);
-      weatherData_.isValid = true;
-      weatherData_.lastUpdate = millis();
-
-      Serial.println("[Weather] 天気予報データ更新完了");
-      Serial.print("  - 最高気温: ");
-      Serial.print(weatherData_.tempMax, 1);
-      Serial.println(" °C");
-      Serial.print("  - 最低気温: ");
-      Serial.print(weatherData_.tempMin, 1);
-      Serial.println(" °C");
-      Serial.print("  - 天気コード: ");
-      Serial.println(weatherData_.weatherCode);
-      Serial.print("  - 天気: ");
-      Serial.println(weatherData_.weatherString);
-
-      http.end();
-      return true;
-    } else {
-      Serial.println("[Weather] JSONデータが不完全です");
-      http.end();
-      return false;
+    if (providers_[i]->fetch(scratch, values)) {
+      return providers_[i]->name();
     }
-  } else {
-    Serial.print("[Weather] HTTPエラー: ");
-    Serial.println(httpResponseCode);
-    http.end();
-    return false;
   }
+  return nullptr;
 }
 
-String WeatherForecast::weatherCodeToString(int code) const {
-  // 天気コードを文字列に変換（表示領域に合わせて省略形を使用）
-  if (code == 0) {
-    return "Clear";        // 快晴
-  } else if (code >= 1 && code <= 3) {
-    return "Cloudy";       // 晴れ〜曇り
-  } else if (code == 45 || code == 48) {
-    return "Fog";          // 霧
-  } else if (code >= 51 && code <= 67) {
-    return "Rain";         // 雨
-  } else if (code >= 71 && code <= 77) {
-    return "Snow";         // 雪
-  } else if (code >= 80 && code <= 99) {
-    return "Storm";        // 雷雨・シャワー
-  } else {
-    return "Unknown";      // 不明
+/**
+ * 取得した値を天気データに反映
+ * すべて失敗した場合は現在の値（保存しておいた予報など）をそのまま使い続けます。
+ */
+bool WeatherForecast::applyFetched(const char* source, const ForecastValues& values) {
+  if (source == nullptr) {
+    LOG(WEATHER_ALL_FAILED, weatherData_.isValid ? source_ : "none");
+    return false;
   }
+
+  weatherData_.weatherCode = values.weatherCode;
+  weatherData_.tempMax = values.tempMax;
+  weatherData_.tempMin = values.tempMin;
+  weatherData_.category = weatherCategoryFromCode(weatherData_.weatherCode);
+  weatherData_.isValid = true;
+  weatherData_.lastUpdate = millis();
+  weatherData_.fetchedEpoch = currentEpoch();
+  source_ = source;
+  staleLogged_ = false;
+
+  LOG(WEATHER_UPDATED, source_);
+  LOG(WEATHER_TEMP_MAX, weatherData_.tempMax);
+  LOG(WEATHER_TEMP_MIN, weatherData_.tempMin);
+  LOG(WEATHER_CODE, weatherData_.weatherCode);
+  LOG(WEATHER_STRING, weatherCategoryName(weatherData_.category));
+  return true;
 }
@@ -0,0 +1,111 @@
+/**
+ * WeatherParser.cpp
+ *
+ * Open-Meteo APIレスポンス解析の実装
+ */
+
+#include "WeatherParser.h"
+
+#include <string.h>
+
+namespace {
+  // ブロックの先頭に置くサイズ（reallocate でのコピー用）
+  constexpr size_t BLOCK_HEADER = StaticArena::DEFAULT_ALIGN;
+
+  size_t blockSize(void* pointer) {
+    size_t size;
+    memcpy(&size, static_cast<uint8_t*>(pointer) - BLOCK_HEADER, sizeof(size));
+    return size;
+  }
+}
+
+// ========================================
+// ArenaJsonAllocator
+// ========================================
+
+ArenaJsonAllocator::ArenaJsonAllocator(StaticArena& arena)
+  : arena_(arena),
+    start_(arena.mark()),
+    lastBlock_(nullptr),
+    lastMark_(0) {
+}
+
+void* ArenaJsonAllocator::allocate(size_t size) {
+  size_t mark = arena_.mark();
+  uint8_t* block = static_cast<uint8_t*>(arena_.allocate(BLOCK_HEADER + size));
+  if (block == nullptr) {
+    return nullptr;
+  }
+  memcpy(block, &size, sizeof(size));
+  lastBlock_ = block + BLOCK_HEADER;
+  lastMark_ = mark;
+  return lastBlock_;
+}
+
+void ArenaJsonAllocator::deallocate(void* pointer) {
+  if (pointer != nullptr && pointer == lastBlock_) {
+    arena_.rewind(lastMark_);
+    lastBlock_ = nullptr;
+  }
+}
+
+void* ArenaJsonAllocator::reallocate(void* pointer, size_t newSize) {
+  if (pointer == nullptr) {
+    return allocate(newSize);
+  }
+  size_t oldSize = blockSize(pointer);
+
+  // 最後のブロックはその場で伸縮（同じ位置から割り当て直すため内容はそのまま）
+  if (pointer == lastBlock_) {
+    arena_.rewind(lastMark_);
+    if (allocate(newSize) == nullptr) {
+      allocate(oldSize);  // 元の大きさに戻す（直前まで収まっていたため必ず成功）
+      return nullptr;
+    }
+    return pointer;
+  }
+
+  void* fresh = allocate(newSize);
+  if (fresh != nullptr) {
+    memcpy(fresh, pointer, oldSize < newSize ? oldSize : newSize);
+  }
+  return fresh;
+}
+
+void ArenaJsonAllocator::reset() {
+  arena_.rewind(start_);
+  lastBlock_ = nullptr;
+}
+
+// ========================================
+// WeatherParser
+// ========================================
+
+ParseResult WeatherParser::parseDaily(const char* json, size_t length, ForecastValues& out,
+                                      ArduinoJson::Allocator* allocator, const char** errorMessage) {
+  JsonDocument doc(allocator ? allocator : ArduinoJson::detail::DefaultAllocator::instance());
+  DeserializationError error = deserializeJson(doc, json, length);
+
+  if (error) {
+    if (errorMessage) {
+      *errorMessage = error.c_str();
+    }
+    return ParseResult::JSON_ERROR;
+  }
+
+  // データ抽出
+  JsonArray timeArray = doc["daily"]["time"];
+  JsonArray weatherCodeArray = doc["daily"]["weather_code"];
+  JsonArray tempMaxArray = doc["daily"]["temperature_2m_max"];
+  JsonArray tempMinArray = doc["daily"]["temperature_2m_min"];
+
+  if (timeArray.size() == 0 || weatherCodeArray.size() == 0 ||
+      tempMaxArray.size() == 0 || tempMinArray.size() == 0) {
+    return ParseResult::INCOMPLETE;
+  }
+
+  out.weatherCode = weatherCodeArray[0];
+  out.tempMax = tempMaxArray[0];
+  out.tempMin = tempMinArray[0];
+  return ParseResult::OK;
+}
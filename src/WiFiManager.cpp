@@ -5,6 +5,8 @@
  */
 
 #include "WiFiManager.h"
+#include "AllocCounter.h"
+#include "Logger.h"
 
 /**
  * コンストラクタ
@@ -13,21 +15,38 @@
 WiFiManager::WiFiManager(const char* ssid, const char* password, unsigned long timeoutMs)
   : ssid_(ssid),
     password_(password),
-    timeoutMs_(timeoutMs) {
+    timeoutMs_(timeoutMs),
+    reconnect_(*this),
+    attached_(false) {
 }
 
 /**
- * WiFiに接続
+ * WiFi接続を開始（完了は待たない）
  */
-bool WiFiManager::connect() {
-  Serial.println("\n[WiFi] WiFi接続を開始します...");
-  Serial.printf("[WiFi] SSID: %s\n", ssid_);
+void WiFiManager::beginConnect() {
+  LOG(WIFI_CONNECT_START);
+  LOG(WIFI_SSID, ssid_);
+
+  // 再接続（loop() から）でも、WiFi の設定・接続の開始は内部で確保する
+  AllocExemption exemption;
 
   // WiFiモードをステーションモード（クライアント）に設定
   WiFi.mode(WIFI_STA);
 
   // WiFi接続を開始（SSID、パスワードを指定）
   WiFi.begin(ssid_, password_);
+}
+
+void WiFiManager::onConnected() {
+  LOG(WIFI_CONNECTED);
+  printConnectionInfo();
+}
+
+/**
+ * WiFiに接続
+ */
+bool WiFiManager::connect() {
+  beginConnect();
 
   // 接続試行の開始時刻を記録
   unsigned long startTime = millis();
@@ -37,32 +56,63 @@ bool WiFiManager::connect() {
   while (WiFi.status() != WL_CONNECTED) {
     // タイムアウトチェック
     if (millis() - startTime > timeoutMs_) {
-      Serial.println("\n[WiFi] 接続タイムアウト");
+      LOG(WIFI_TIMEOUT);
       return false;  // 接続失敗
     }
 
-    // 進捗表示（500msごとにドットを表示）
-    delay(500);
-    Serial.print(".");
+    // 進捗表示（500msごと、DEBUGレベル）
+    delay(POLL_MS);
+    LOG(WIFI_WAITING, millis() - startTime);
   }
 
   // 接続成功
-  Serial.println("\n[WiFi] WiFi接続成功！");
-  printConnectionInfo();
-
+  onConnected();
   return true;
 }
 
+bool WiFiManager::attach(CoroutineScheduler& scheduler) {
+  attached_ = scheduler.add(&reconnect_);
+  return attached_;
+}
+
+/**
+ * 再接続（connect() と同じ手順を、待つところで loop() に戻りながら行う）
+ */
+bool WiFiManager::ReconnectTask::run(uint32_t nowMs) {
+  CO_BEGIN();
+  owner_.beginConnect();
+  startMs_ = nowMs;
+
+  while (WiFi.status() != WL_CONNECTED) {
+    if (nowMs - startMs_ > owner_.timeoutMs_) {
+      LOG(WIFI_TIMEOUT);
+      CO_EXIT();  // 次の checkConnection() でやり直す
+    }
+    CO_SLEEP(POLL_MS);
+    LOG(WIFI_WAITING, static_cast<unsigned long>(nowMs - startMs_));
+  }
+
+  owner_.onConnected();
+  CO_END();
+}
+
 /**
  * WiFi接続状態を確認し、切断時は再接続を試みる
  */
 bool WiFiManager::checkConnection() {
   // WiFi.status()で現在の接続状態を確認
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("[WiFi] WiFi切断を検出、再接続を試みます...");
-    return connect();  // 再接続を試みる
+  if (WiFi.status() == WL_CONNECTED) {
+    return true;  // 接続中
+  }
+  if (!attached_) {
+    LOG(WIFI_LOST);
+    return connect();  // 再接続を試みる（完了まで待つ）
+  }
+  if (!reconnect_.isRunning()) {
+    LOG(WIFI_LOST);
+    reconnect_.start(millis());  // 次の CoroutineScheduler::run() から再接続
   }
-  return true;  // 接続中
+  return false;
 }
 
 /**
@@ -76,9 +126,7 @@ bool WiFiManager::isConnected() {
  * 接続情報を表示
  */
 void WiFiManager::printConnectionInfo() {
-  Serial.print("[WiFi] IPアドレス: ");
-  Serial.println(WiFi.localIP());  // 取得したIPアドレスを表示
-  Serial.print("[WiFi] 電波強度 (RSSI): ");
-  Serial.print(WiFi.RSSI());       // 電波強度を表示（dBm）
-  Serial.println(" dBm");
+  IPAddress ip = WiFi.localIP();  // 取得したIPアドレスを表示
+  LOG(WIFI_IP, ip[0], ip[1], ip[2], ip[3]);
+  LOG(WIFI_RSSI, WiFi.RSSI());    // 電波強度を表示（dBm）
 }
@@ -0,0 +1,131 @@
+/**
+ * ZoneManager.cpp
+ *
+ * 複数ゾーンのエアコン制御クラスの実装
+ */
+
+#include "ZoneManager.h"
+#include "Logger.h"
+
+/**
+ * コンストラクタ
+ */
+ZoneManager::ZoneManager(ZoneSentHandler handler, void* context)
+  : zones_(),
+    count_(0),
+    nextZone_(0),
+    lastTransmitEnd_(0),
+    handler_(handler),
+    context_(context),
+    startGate_(nullptr),
+    startGateContext_(nullptr) {
+}
+
+int ZoneManager::addZone(const char* name, AirConditionerController* ac, EnvironmentSensor* sensor,
+                         bool autoControl) {
+  if (count_ >= MAX_ZONES) {
+    LOG(ZONE_FULL, name, MAX_ZONES);
+    return -1;
+  }
+  Zone& zone = zones_[count_];
+  zone.name = name;
+  zone.ac = ac;
+  zone.sensor = sensor;
+  zone.autoControl = autoControl;
+  zone.pending = ACCommand();
+  LOG(ZONE_ADDED, count_, name, sensor ? "専用" : "共有", autoControl ? "自動" : "手動");
+  return count_++;
+}
+
+void ZoneManager::setThresholds(const PolicyThresholds& thresholds) {
+  for (uint8_t i = 0; i < count_; i++) {
+    zones_[i].ac->getPolicy().setThresholds(thresholds);
+  }
+}
+
+/**
+ * 自動制御のゾーンをまとめて判定
+ * センサーの読み取りもここでまとめて行います（DHT22 は1台あたり数ms）。
+ */
+void ZoneManager::evaluate(const struct tm& timeinfo, const WeatherData& weather, const SensorData& mainReading) {
+  for (uint8_t i = 0; i < count_; i++) {
+    Zone& zone = zones_[i];
+    if (!zone.autoControl) {
+      continue;
+    }
+    SensorData reading = zone.sensor ? zone.sensor->read() : mainReading;
+    if (!reading.isValid) {
+      LOG(ZONE_SENSOR_INVALID, zone.name);
+      continue;
+    }
+    ACMode mode = zone.ac->determineOptimalMode(reading.temperature, reading.humidity, timeinfo, weather);
+    requestMode(i, mode);
+  }
+}
+
+bool ZoneManager::requestMode(uint8_t zone, ACMode mode) {
+  return requestCommand(zone, ACCommand::fromMode(mode));
+}
+
+bool ZoneManager::requestCommand(uint8_t zone, const ACCommand& command) {
+  if (zone >= count_ || !command.isKnown()) {
+    return false;
+  }
+  Zone& target = zones_[zone];
+  if (command == target.ac->getCurrentCommand()) {
+    target.pending = ACCommand();  // 未送信の変更は取り消し
+    return false;
+  }
+  if (target.pending.isKnown() && target.pending != command) {
+    LOG(ZONE_REPLACED, target.name, ControlPolicy::modeToString(target.pending.nearestMode()));
+  }
+  target.pending = command;
+  return true;
+}
+
+bool ZoneManager::hasPending() const {
+  for (uint8_t i = 0; i < count_; i++) {
+    if (zones_[i].pending.isKnown()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * 送信待ちを1フレーム送信
+ * 送信（IRsend）は完了まで戻らないため、同時に2つのフレームが出ることはありません。
+ * さらに前のフレームとの間隔を空け、他の部屋のエアコンが受信途中の信号と混ざらないようにします。
+ */
+bool ZoneManager::service() {
+  if (millis() - lastTransmitEnd_ < IR_FRAME_GAP_MS) {
+    return false;
+  }
+  for (uint8_t n = 0; n < count_; n++) {
+    uint8_t i = (nextZone_ + n) % count_;
+    Zone& zone = zones_[i];
+    if (!zone.pending.isKnown()) {
+      continue;
+    }
+    ACCommand command = zone.pending;
+    const ACCommand& current = zone.ac->getCurrentCommand();
+    ACMode previous = current.nearestMode();
+    bool starting = (!current.isKnown() || current.isOff()) && !command.isOff();
+    if (starting && startGate_ && !startGate_(i, command.nearestMode(), startGateContext_)) {
+      continue;  // 起動の順番待ち（他のゾーンの送信は続ける）
+    }
+    zone.pending = ACCommand();
+    nextZone_ = (i + 1) % count_;
+
+    LOG(ZONE_TRANSMIT, zone.name);
+    zone.ac->setCommand(command);
+    lastTransmitEnd_ = millis();
+
+    ACMode mode = zone.ac->getCurrentCommand().nearestMode();
+    if (mode != previous && handler_) {
+      handler_(i, mode, context_);
+    }
+    return true;
+  }
+  return false;
+}
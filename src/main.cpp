@@ -7,12 +7,40 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <esp_system.h>
 #include "AirConditionerController.h"
 #include "EnvironmentSensor.h"
+#include "SetpointModulator.h"
+#include "AdaptiveSampler.h"
 #include "DisplayController.h"
 #include "WiFiManager.h"
 #include "TimeManager.h"
 #include "WeatherForecast.h"
+#include "FileForecastProvider.h"
+#include "LoopProfiler.h"
+#include "AllocCounter.h"
+#include "StaticArena.h"
+#include "HeapTrend.h"
+#include "BootSequence.h"
+#include "BootCache.h"
+#include "DataBus.h"
+#include "Coroutine.h"
+#include "BackgroundWorker.h"
+#include "SerialConsole.h"
+#include "StatusFormat.h"
+#include "HistoryStore.h"
+#include "TraceRecorder.h"
+#include "StatusServer.h"
+#include "MqttClient.h"
+#include "ConfigManager.h"
+#include "PowerManager.h"
+#include "DeepSleepManager.h"
+#include "ZoneManager.h"
+#include "MeshTransport.h"
+#include "MeshCoordinator.h"
+#include "EnergyModel.h"
+#include "PulseMeter.h"
+#include "Logger.h"
 #include "secrets.h"  // WiFi認証情報（Gitにコミットされない）
 
 // ========================================
@@ -23,10 +51,11 @@
 namespace HardwareConfig {
   constexpr uint8_t DHT_PIN = 32;
   constexpr uint8_t IR_RECV_PIN = 18;
+  constexpr uint8_t IR_WAKE_PIN = PowerManager::NO_PIN;  // ライトスリープからの起床用（受信モジュールの出力を並列に接続）
   constexpr uint8_t IR_SEND_PIN = 5;
 }
 
-// センサーオフセット
+// センサーオフセット（初期値。実行中は /config で変更可能）
 namespace SensorConfig {
   constexpr float TEMP_OFFSET = -1.6f;
   constexpr float HUM_OFFSET = -1.0f;
@@ -52,19 +81,120 @@ namespace DisplayConfig {
   constexpr uint8_t SCREEN_ADDRESS = 0x3C;
 }
 
-// タイミング設定
+// タイミング設定（初期値。実行中は /config で変更可能）
 namespace TimingConfig {
-  constexpr unsigned long SENSOR_READ_INTERVAL_MS = 2000;   // センサー読み取り間隔
+  constexpr unsigned long SENSOR_READ_INTERVAL_MS = 2000;   // センサー読み取り間隔（変化中・境界付近の最短間隔）
+  constexpr unsigned long SENSOR_READ_MAX_INTERVAL_MS = 30000;  // 安定時の最長の読み取り間隔（/config 対象外）
   constexpr unsigned long CONTROL_INTERVAL_MS = 300000;      // エアコン制御間隔
-  constexpr unsigned long STARTUP_DELAY_MS = 2000;          // 起動時の待機時間
+  constexpr unsigned long PROFILE_REPORT_INTERVAL_MS = 600000;  // loop計測結果の出力間隔
 }
 
-// 天気予報設定（東京の座標）
+// HTTPステータスサーバー設定
+namespace StatusConfig {
+  constexpr uint16_t PORT = 80;  // GET /status（JSON）, GET /metrics（Prometheus）
+}
+
+// MQTT設定（認証情報は secrets.h の MqttSecrets）
+namespace MqttConfig {
+  const char* BROKER_HOST = "homeassistant.local";
+  constexpr uint16_t BROKER_PORT = 1883;
+  const char* CLIENT_ID = "aircon-living";
+  const char* BASE_TOPIC = "aircon/living";                // 送信: sensor, mode, health, status / 受信: cmd/mode, cmd/setpoint
+  constexpr unsigned long HEALTH_INTERVAL_MS = 60000;      // 稼働状況の送信間隔
+  constexpr unsigned long MANUAL_HOLD_MS = 3600000;        // モード指定コマンド後に自動制御を止める時間
+}
+
+// ゾーン設定（1台の ESP32 で複数の部屋のエアコンを制御）
+namespace ZoneConfig {
+  constexpr uint8_t MAIN_ZONE = 0;            // HardwareConfig のピンを使うメインのゾーン
+  constexpr size_t EXTRA_ZONE_COUNT = 0;      // 使用する追加ゾーンの数（EXTRA_ZONES の先頭から）
+  // 追加ゾーン（名前, IR送信ピン, DHT22ピン）。SHARED_SENSOR はメインのセンサー値を使用
+  const ZoneDefinition EXTRA_ZONES[] = {
+    {"bedroom", 4, 33},
+    {"study", 16, ZoneDefinition::SHARED_SENSOR},
+  };
+  static_assert(EXTRA_ZONE_COUNT <= sizeof(EXTRA_ZONES) / sizeof(EXTRA_ZONES[0]), "EXTRA_ZONES が不足しています");
+}
+
+// 設定温度の調整（メインのゾーン。停止・起動を繰り返さず、運転を続けて設定温度を0.5℃単位で変更）
+namespace ModulationConfig {
+  constexpr bool ENABLED = false;  // true: 調整する, false: 従来のオン・オフ制御（プリセットの発停）
+}
+
+// 省電力設定
+namespace PowerConfig {
+  constexpr bool LIGHT_SLEEP = true;  // 処理のない間は自動ライトスリープ（電源管理が有効なビルドのみ。false: 待機のみ）
+}
+
+// ディープスリープ設定（電池駆動ノード用）
+namespace DeepSleepConfig {
+  constexpr bool ENABLED = false;                        // true: 起床→計測・制御→スリープを繰り返す
+  constexpr uint32_t WAKE_INTERVAL_SEC = 300;            // 起床間隔
+  constexpr uint32_t FORECAST_MAX_AGE_SEC = 6 * 3600;    // 天気予報の再取得間隔（日付が変わった場合も再取得）
+}
+
+// 複数台の連携設定（ESP-NOW）
+namespace MeshConfig {
+  constexpr bool ENABLED = false;                            // true: 同じチャンネルの他ノードと連携
+  constexpr bool FORECAST_SOURCE = true;                     // true: このノードが天気予報・時刻を取得して配信
+  constexpr unsigned long FORECAST_STALE_MS = 3 * 3600000UL; // 受信が途絶えたら自分で取得する時間
+  constexpr int32_t TIME_TOLERANCE_SEC = 2;                  // 受信した時刻とのずれがこれ以下なら時計を変更しない
+  constexpr int32_t MAX_TIME_JUMP_SEC = 600;                 // 時計が合っている場合、これより大きいずれの受信は無視
+}
+
+// 消費電力量・電気代の設定
+namespace EnergyConfig {
+  // ACMode ごとの推定消費電力（W）。電力量計があれば計測値で補正
+  constexpr float MODE_WATTS[] = {
+    0.0f,    // NONE
+    1.0f,    // OFF（待機電力）
+    650.0f,  // HEATING_23_5
+    450.0f,  // HEATING_18
+    550.0f,  // COOLING_25
+    400.0f,  // DEHUMID_MINUS_1_5
+  };
+  static_assert(sizeof(MODE_WATTS) / sizeof(MODE_WATTS[0]) == EnergyModel::MODE_COUNT, "MODE_WATTS の数が ACMode と一致しません");
+
+  // 時間帯別の料金表（開始時, 円/kWh, ピーク）
+  const TariffBand TARIFF[] = {
+    {0, 26.0f, false},   // 夜間
+    {8, 34.0f, false},   // 昼間
+    {13, 42.0f, true},   // ピーク（13〜16時）
+    {16, 34.0f, false},  // 昼間
+    {22, 26.0f, false},  // 夜間
+  };
+
+  constexpr uint8_t METER_PIN = PulseMeter::NO_PIN;  // 電力量計のパルス入力（NO_PIN: なし）
+  constexpr uint32_t METER_PULSES_PER_KWH = 1000;    // 電力量計の imp/kWh
+  constexpr float PEAK_SETBACK = 0.5f;               // ピーク時間帯に目標範囲を上下に広げる幅（℃、0: 無効）
+}
+
+// メモリ設定（長く使うバッファは起動直後に固定領域から割り当て、以降はヒープを使わない）
+namespace MemoryConfig {
+  constexpr size_t ARENA_SIZE = 6 * 1024;             // 固定領域（天気予報の受信・JSON解析）
+  constexpr uint32_t HEAP_TREND_INTERVAL_SEC = 1800;  // 最大ブロックの記録間隔（48件で直近24時間）
+}
+
+// 天気予報設定（東京の座標。初期値）
 namespace WeatherConfig {
   constexpr float LATITUDE = 35.653204f;
   constexpr float LONGITUDE = 139.688272f;
+  const char* FALLBACK_FILE = "/forecast.json";  // API が使えない場合に読む予報ファイル（LittleFS、Open-Meteo 形式）
+  constexpr uint32_t FETCH_TASK_STACK = 8192;    // 定期取得のタスク（HTTPS の TLS を含むため大きめ）
 }
 
+// 実行時設定の初期値（NVS に保存された設定がない場合に使用）
+const RuntimeConfig DEFAULT_CONFIG = {
+  DEFAULT_THRESHOLDS,
+  SensorConfig::TEMP_OFFSET,
+  SensorConfig::HUM_OFFSET,
+  TimingConfig::SENSOR_READ_INTERVAL_MS,
+  TimingConfig::CONTROL_INTERVAL_MS,
+  TimingConfig::PROFILE_REPORT_INTERVAL_MS,
+  WeatherConfig::LATITUDE,
+  WeatherConfig::LONGITUDE,
+};
+
 // ========================================
 // グローバルオブジェクト
 // ========================================
@@ -72,58 +202,864 @@ namespace WeatherConfig {
 // デバイス制御
 AirConditionerController airConditioner(HardwareConfig::IR_SEND_PIN, HardwareConfig::IR_RECV_PIN);
 EnvironmentSensor sensor(HardwareConfig::DHT_PIN, DHT22, SensorConfig::TEMP_OFFSET, SensorConfig::HUM_OFFSET);
+AdaptiveSampler sampler(TimingConfig::SENSOR_READ_INTERVAL_MS, TimingConfig::SENSOR_READ_MAX_INTERVAL_MS);
+SetpointModulator modulator;
 DisplayController displayCtrl(DisplayConfig::SCREEN_WIDTH, DisplayConfig::SCREEN_HEIGHT,
                                &Wire, DisplayConfig::OLED_RESET, DisplayConfig::SCREEN_ADDRESS);
 
+// サブシステム間の値の受け渡し（センサー値・天気予報・モード）
+DataBus bus;
+TopicReader<SensorData> displaySensor(bus.sensor);    // 表示の更新判定用
+TopicReader<WeatherData> displayWeather(bus.weather);
+TopicReader<ACMode> displayMode(bus.mode);
+TopicReader<WeatherData> historyWeather(bus.weather); // 履歴への天気予報の記録用
+TopicReader<ACMode> historyMode(bus.mode);            // 履歴・MQTTへのモードの記録用
+
+// 待ち時間のある処理（IR送信後の受信再開・WiFi再接続・天気予報の定期取得）のコルーチン
+CoroutineScheduler scheduler;
+BackgroundWorker forecastWorker("forecast", WeatherConfig::FETCH_TASK_STACK);
+
+// ゾーン（送信完了時に onZoneSent を呼ぶ）
+void onZoneSent(uint8_t zone, ACMode mode, void* context);
+ZoneManager zones(onZoneSent);
+
 // 機能管理クラス
+ConfigManager configMgr(DEFAULT_CONFIG);
 WiFiManager wifiMgr(WiFiSecrets::SSID, WiFiSecrets::PASSWORD, WiFiConfig::CONNECT_TIMEOUT_MS);
 TimeManager timeMgr(TimeConfig::NTP_SERVER, TimeConfig::GMT_OFFSET_SEC, TimeConfig::DAYLIGHT_OFFSET_SEC);
 WeatherForecast weatherForecast(WeatherConfig::LATITUDE, WeatherConfig::LONGITUDE);
+FileForecastProvider forecastFile(WeatherConfig::FALLBACK_FILE);
+LoopProfiler loopProfiler;
+StaticArena arena;
+HeapTrend heapTrend(MemoryConfig::HEAP_TREND_INTERVAL_SEC);
+BootSequence boot;
+BootCache bootCache;
+PowerManager power(HardwareConfig::IR_RECV_PIN, HardwareConfig::IR_WAKE_PIN, PowerConfig::LIGHT_SLEEP);
+DeepSleepManager deepSleep(DeepSleepConfig::WAKE_INTERVAL_SEC, DeepSleepConfig::FORECAST_MAX_AGE_SEC);
+HistoryStore history;
+TraceRecorder trace;
+EnergyModel energy(EnergyConfig::MODE_WATTS);
+PulseMeter energyMeter(EnergyConfig::METER_PIN, EnergyConfig::METER_PULSES_PER_KWH);
+MeshTransport meshTransport;
+MeshCoordinator mesh(meshTransport, MeshConfig::FORECAST_SOURCE, MeshSecrets::KEY);
+StatusServer statusServer(StatusConfig::PORT);
+MqttClient mqtt(MqttConfig::BROKER_HOST, MqttConfig::BROKER_PORT, MqttConfig::CLIENT_ID, MqttConfig::BASE_TOPIC,
+                MqttSecrets::USERNAME, MqttSecrets::PASSWORD);
 
 // タイミング管理
 unsigned long lastSensorReadTime = 0;
 unsigned long lastControlTime = 0;
+unsigned long lastProfileReportTime = 0;
+unsigned long lastHealthPublishTime = 0;
+uint32_t appliedConfigGeneration = 0;  // 各クラスに反映済みの設定の世代
+unsigned long manualHoldStart = 0;     // MQTTでモードを指定した時刻
+bool manualHold = false;               // 自動制御を一時停止中
+bool autoControl = true;               // false: シリアルコンソールで自動制御を止めている（auto on まで）
+bool tariffPeak = false;               // ピーク時間帯（目標範囲を広げている）
+bool meshActive = false;               // 複数台の連携を開始済み
+uint32_t appliedMeshGeneration = 0;    // 反映済みの受信天気予報の番号
+unsigned long lastMeshForecast = 0;    // 配信した（取得担当）・受信した（その他）天気予報の時刻
+bool meshFallback = false;             // 受信が途絶えたため自分で天気予報を取得中
+bool networkReady = false;             // 起動用タスクが終了し、ネットワークを使う処理を開始済み
+bool provisionalControl = false;       // 前回保存した時刻（仮の時刻）で制御を判定した
+char displayedTime[20] = "";           // 表示中の時刻（分が変わったら再描画）
+
+// ========================================
+// 実行時設定
+// ========================================
+
+/**
+ * 制御に使う閾値
+ * ピーク時間帯は目標範囲を広げ、暖房・冷房の開始を料金の安い時間帯へ遅らせます。
+ */
+PolicyThresholds effectiveThresholds(const RuntimeConfig& config) {
+  PolicyThresholds thresholds = config.thresholds;
+  if (tariffPeak) {
+    thresholds.tempLower -= EnergyConfig::PEAK_SETBACK;
+    thresholds.tempUpper += EnergyConfig::PEAK_SETBACK;
+  }
+  return thresholds;
+}
+
+/**
+ * 設定を各クラスに反映
+ * 制御・出力の間隔は loop() が configMgr.get() から直接読むため、ここではセンサー読み取りの最短間隔のみ扱います。
+ */
+void applyConfig(const RuntimeConfig& config) {
+  PolicyThresholds thresholds = effectiveThresholds(config);
+  airConditioner.getPolicy().setThresholds(thresholds);
+  zones.setThresholds(thresholds);
+  sampler.setThresholds(thresholds);
+  sampler.setMinInterval(config.sensorReadIntervalMs);
+  sensor.setTemperatureOffset(config.tempOffset);
+  sensor.setHumidityOffset(config.humOffset);
+  if (!weatherForecast.isLocation(config.latitude, config.longitude)) {
+    weatherForecast.setLocation(config.latitude, config.longitude);
+  }
+}
+
+// ========================================
+// ステータス公開
+// ========================================
+
+/**
+ * HTTPステータスサーバーに現在の状態を渡す
+ * 書式化・送信はサーバータスク側で行うため、ここでは値のコピーのみです。
+ */
+void publishStatus(const SensorData& sensorData, const WeatherData& weatherData, ACMode acMode) {
+  StatusSnapshot status;
+  status.uptimeMs = millis();
+  status.sensorValid = sensorData.isValid;
+  status.temperature = sensorData.temperature;
+  status.humidity = sensorData.humidity;
+  status.discomfortIndex = sensorData.discomfortIndex;
+  status.sensorIntervalMs = sampler.getIntervalMs();
+  status.sensorReadsPerHour = sampler.getReadsPerHour(status.uptimeMs);
+  status.sensorReads = sampler.getReads();
+  status.sensorReadsSaved = sampler.getSavedReads();
+  status.weatherValid = weatherData.isValid;
+  status.tempMax = weatherData.tempMax;
+  status.tempMin = weatherData.tempMin;
+  status.weatherCode = static_cast<int16_t>(weatherData.weatherCode);
+  uint32_t epoch;
+  status.weatherAgeMs = weatherData.fetchedEpoch != 0 && timeMgr.getEpochTime(epoch)
+    ? weatherForecast.getAgeSec(epoch) * 1000 : millis() - weatherData.lastUpdate;
+  status.weatherSource = networkReady ? weatherForecast.getSource() : "cache";
+  status.weatherRefreshFailures = networkReady ? weatherForecast.getRefreshFailures() : 0;
+  status.acMode = acMode;
+  const ACCommand& command = airConditioner.getCurrentCommand();
+  status.acSetpoint = command.isKnown() && !command.isOff() ? command.getSetpoint() : 0.0f;
+  status.acModulated = ModulationConfig::ENABLED;
+  status.compressorStarts = modulator.getStarts();
+  status.baselineStarts = modulator.getBaselineStarts();
+  const EnergyTotals& today = energy.getToday();
+  const EnergyTotals& month = energy.getMonth();
+  status.powerW = energy.getPowerW();
+  status.energyTodayKWh = today.kWh;
+  status.costToday = today.cost;
+  status.energyMonthKWh = month.kWh;
+  status.costMonth = month.cost;
+  int hour = timeMgr.getCurrentHour();
+  status.pricePerKWh = hour >= 0 ? energy.getPrice(hour) : 0.0f;
+  status.tariffPeak = tariffPeak;
+  status.cpuMHz = loopProfiler.getCpuMHz();
+  status.activeDuty = power.getActiveDuty();
+  for (size_t i = 0; i < StatusSnapshot::PHASE_COUNT; i++) {
+    loopProfiler.getStats(static_cast<LoopPhase>(i), status.phases[i]);
+  }
+  status.freeHeap = ESP.getFreeHeap();
+  status.minFreeHeap = ESP.getMinFreeHeap();
+  status.maxAllocHeap = ESP.getMaxAllocHeap();
+  status.minMaxAllocHeap = heapTrend.getMinLargestBlock();
+  status.maxAllocTrendPerDay = heapTrend.getSlopePerDay();
+  status.logDropped = Logger::getDroppedCount();
+  status.bootFirstControlMs = boot.getMs(BootMilestone::FIRST_CONTROL);
+  status.bootNetworkMs = boot.getMs(BootMilestone::NETWORK_DONE);
+  statusServer.publish(status);
+
+  // MQTT の稼働状況も同じスナップショットから送信
+  if (millis() - lastHealthPublishTime >= MqttConfig::HEALTH_INTERVAL_MS) {
+    lastHealthPublishTime = millis();
+    mqtt.publishHealth(status);
+  }
+}
+
+// ========================================
+// モード変更
+// ========================================
+
+/**
+ * メインのエアコンのモード変更を依頼（送信は ZoneManager が他のゾーンと重ならないよう行う）
+ */
+void applyMode(ACMode mode) {
+  zones.requestMode(ZoneConfig::MAIN_ZONE, mode);
+}
+
+/**
+ * 送信完了時の処理（メインのゾーンのモードを公開）
+ */
+void onZoneSent(uint8_t zone, ACMode mode, void* context) {
+  if (zone != ZoneConfig::MAIN_ZONE) {
+    return;
+  }
+  boot.mark(BootMilestone::FIRST_CONTROL);
+  bus.mode.publish(mode);
+}
+
+/**
+ * モードの変更を履歴とMQTTに記録
+ * 変更は送信（IR_RECEIVE のフェーズ）で公開されますが、履歴のファイル書き込みとMQTTの送信キューへの追加は
+ * ヒープを確保し得るため、直後の HISTORY のフェーズで行います（送信は loop() 1回に1フレームのため取りこぼしません）。
+ * @return true: 記録した
+ */
+bool recordModeChange() {
+  if (!historyMode.changed()) {
+    return false;
+  }
+  ACMode mode = historyMode.get();
+  uint32_t epoch;
+  if (timeMgr.getEpochTime(epoch)) {
+    history.recordMode(epoch, mode);
+  }
+  mqtt.publishMode(mode);
+  return true;
+}
+
+/**
+ * 温湿度をMQTT送信キューに追加（bus.sensor の購読者。値が変わった場合のみ、送信は通信タスクがまとめて行う）
+ */
+void onSensorChanged(const SensorData& data, void* context) {
+  if (data.isValid) {
+    mqtt.publishSample(data);
+  }
+}
+
+/**
+ * 受信した赤外線信号をトレースに記録（AirConditionerController の受信処理から呼ばれる）
+ */
+void onIRReceived(int16_t protocol, uint16_t bits, uint64_t value, void* context) {
+  trace.recordIR(millis(), protocol, bits, value);
+}
+
+/**
+ * GET /trace の本文（HTTPサーバーのタスクから呼ばれる）
+ */
+void serveTrace(ResponseWriter& out, void* context) {
+  trace.writeTo(out);
+}
+
+/**
+ * 表示を更新（センサー値・天気予報・モード・時刻（分）のいずれかが変わった場合のみ描画・転送）
+ */
+void updateDisplay() {
+  char formattedTime[20];  // "YYYY-MM-DD HH:MM" = 16文字 + null終端
+  timeMgr.getFormattedTime(TimeManager::FORMAT_DATETIME, formattedTime, sizeof(formattedTime));
+  bool redraw = displaySensor.changed();
+  redraw |= displayWeather.changed();
+  redraw |= displayMode.changed();
+  redraw |= strcmp(formattedTime, displayedTime) != 0;
+  if (!redraw) {
+    return;
+  }
+  strcpy(displayedTime, formattedTime);
+  displayCtrl.showSensorDataWithWeatherAndAC(displaySensor.get(), formattedTime, displayWeather.get(),
+                                             displayMode.get());
+}
+
+/**
+ * ゾーンを登録（メイン＋ ZoneConfig の追加ゾーン）
+ * 追加ゾーンは送信専用（IR受信はメインのみ）で、センサーの補正値は0です。
+ */
+void setupZones() {
+  zones.addZone("main", &airConditioner, &sensor, false);
+  for (size_t i = 0; i < ZoneConfig::EXTRA_ZONE_COUNT; i++) {
+    const ZoneDefinition& def = ZoneConfig::EXTRA_ZONES[i];
+    AirConditionerController* ac = new AirConditionerController(def.irSendPin, AirConditionerController::NO_RECEIVER);
+    ac->begin();
+    EnvironmentSensor* zoneSensor = nullptr;
+    if (def.dhtPin != ZoneDefinition::SHARED_SENSOR) {
+      zoneSensor = new EnvironmentSensor(def.dhtPin, DHT22);
+      zoneSensor->begin();
+    }
+    zones.addZone(def.name, ac, zoneSensor, true);
+  }
+  zones.setThresholds(configMgr.get().thresholds);
+}
+
+// MQTTの目標室温を実行時設定に反映（ConfigManager::modify() の編集関数）
+bool setTargetTemperature(RuntimeConfig& config, void* context, const char** /*error*/) {
+  const MqttCommand* command = static_cast<const MqttCommand*>(context);
+  config.thresholds.tempLower = command->tempLower;
+  config.thresholds.tempUpper = command->tempUpper;
+  return true;
+}
+
+/**
+ * MQTTで受信したコマンドを反映
+ * - モード指定: すぐに送信し、MANUAL_HOLD_MS の間は自動制御を止める
+ * - 目標室温: 実行時設定の閾値を変更（NVS にも保存）し、次のセンサー読み取りで自動制御を再判定
+ */
+void handleMqttCommands() {
+  MqttCommand command;
+  while (mqtt.pollCommand(command)) {
+    if (command.type == MqttCommandType::MODE) {
+      trace.recordMode(millis(), command.mode);
+      applyMode(command.mode);
+      manualHold = true;
+      manualHoldStart = millis();
+    } else {
+      const char* error;
+      if (!configMgr.modify(setTargetTemperature, &command, &error)) {
+        continue;
+      }
+      manualHold = false;
+      lastControlTime = millis() - configMgr.get().controlIntervalMs;
+    }
+  }
+}
+
+/**
+ * 再起動の直前の処理（esp_restart() から呼ばれる）
+ * RAM 上の履歴・トレースのブロックは通常30分・10分ごとに書き出すため、ここで書き出さないと失われます。
+ */
+void onShutdown() {
+  history.flush();
+  trace.flush();
+  Logger::flush();
+}
+
+// ========================================
+// シリアルコンソール
+// ========================================
+
+/**
+ * mode <モード名>: モードを送信し、auto on まで自動制御を止める
+ */
+bool consoleMode(char* args, void* context) {
+  static const ACMode MODES[] = {
+    ACMode::OFF, ACMode::HEATING_23_5, ACMode::HEATING_18, ACMode::COOLING_25, ACMode::DEHUMID_MINUS_1_5
+  };
+  for (ACMode mode : MODES) {
+    if (strcmp(args, StatusFormat::modeName(mode)) == 0) {
+      trace.recordMode(millis(), mode);
+      applyMode(mode);
+      autoControl = false;
+      LOG(CONSOLE_MODE, StatusFormat::modeName(mode));
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * auto <on|off>: 自動制御の再開・停止（再開時はすぐに判定し、MQTT の手動指定も解除）
+ */
+bool consoleAuto(char* args, void* context) {
+  if (strcmp(args, "on") == 0) {
+    autoControl = true;
+    manualHold = false;
+    lastControlTime = millis() - configMgr.get().controlIntervalMs;
+  } else if (strcmp(args, "off") == 0) {
+    autoControl = false;
+  } else {
+    return false;
+  }
+  LOG(CONSOLE_AUTO, args);
+  return true;
+}
+
+// loop: loop() の計測結果・稼働率・コルーチンをすぐに出力
+bool consoleLoop(char* args, void* context) {
+  loopProfiler.printSummary();
+  power.printSummary();
+  LOG(CO_STATS, static_cast<uint32_t>(scheduler.getRunning()), scheduler.getResumes());
+  return true;
+}
+
+// heap: ヒープの空き・最大ブロック
+bool consoleHeap(char* args, void* context) {
+  LOG(CONSOLE_HEAP, ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap());
+  return true;
+}
+
+/**
+ * weather: 次の update() で天気予報を取得（別タスクで取得し、完了は待たない）
+ */
+bool consoleWeather(char* args, void* context) {
+  if (meshActive && !mesh.isForecastSource() && !meshFallback) {
+    LOG(CONSOLE_WEATHER, "取得担当ノードから受信するため取得しない");
+  } else if (weatherForecast.isFetching()) {
+    LOG(CONSOLE_WEATHER, "取得中");
+  } else {
+    weatherForecast.expedite();
+    LOG(CONSOLE_WEATHER, networkReady ? "次の loop() で取得" : "起動用タスクの終了後に取得");
+  }
+  return true;
+}
+
+/**
+ * offset <温度℃> [湿度%]: センサー補正をすぐに変更（保存しない。設定を変更すると設定の値に戻る）
+ */
+bool consoleOffset(char* args, void* context) {
+  char* end = nullptr;
+  float temp = strtof(args, &end);
+  if (end == args) {
+    return false;
+  }
+  float hum = sensor.getHumidityOffset();
+  char* rest = end;
+  if (*rest != '\0') {
+    hum = strtof(rest, &end);
+    if (end == rest || *end != '\0') {
+      return false;
+    }
+  }
+  sensor.setTemperatureOffset(temp);
+  sensor.setHumidityOffset(hum);
+  LOG(CONSOLE_OFFSET, temp, hum);
+  return true;
+}
+
+/**
+ * set <名前=値>[&名前=値...]: 実行時設定を変更（HTTP の POST /config と同じ形式、NVS に保存）
+ */
+bool consoleSet(char* args, void* context) {
+  if (*args == '\0') {
+    return false;
+  }
+  const char* error = nullptr;
+  if (!configMgr.applyText(args, &error)) {
+    LOG(CONSOLE_SET_FAIL, error);
+  }
+  return true;
+}
+
+/**
+ * history の集計
+ * 長い期間を一度に検索するとフラッシュの読み取りで loop() が止まるため、コマンドでは開始するだけにして、
+ * loop() ごとに HISTORY_STEP_SEC ずつ検索します（serviceHistorySummary()）。
+ */
+constexpr uint32_t HISTORY_STEP_SEC = 3600;
+constexpr unsigned long HISTORY_MAX_HOURS = 24 * 31;
+
+struct HistorySummary {
+  bool active;
+  uint32_t hours;
+  uint32_t next;  // 次に検索する範囲の開始時刻
+  uint32_t end;   // 検索する範囲の終了時刻（コマンドの実行時刻）
+  uint32_t samples;
+  uint32_t modes;
+  uint32_t forecasts;
+  int16_t tempMin;
+  int16_t tempMax;
+};
+HistorySummary historySummary = {};
+
+bool summarizeHistory(const HistoryEvent& event, void* context) {
+  HistorySummary* summary = static_cast<HistorySummary*>(context);
+  switch (event.kind) {
+    case HistoryKind::SAMPLE:
+      if (summary->samples == 0 || event.temperature < summary->tempMin) summary->tempMin = event.temperature;
+      if (summary->samples == 0 || event.temperature > summary->tempMax) summary->tempMax = event.temperature;
+      summary->samples++;
+      break;
+    case HistoryKind::MODE:
+      summary->modes++;
+      break;
+    case HistoryKind::FORECAST:
+      summary->forecasts++;
+      break;
+  }
+  return true;
+}
+
+/**
+ * history [時間]: 直近の履歴（既定1時間、未書き出しの分を含む）の集計を開始（結果は数 loop() 後に出力）
+ */
+bool consoleHistory(char* args, void* context) {
+  char* end = nullptr;
+  unsigned long hours = *args ? strtoul(args, &end, 10) : 1;
+  if ((*args && *end != '\0') || hours == 0 || hours > HISTORY_MAX_HOURS) {
+    return false;
+  }
+  uint32_t epoch;
+  if (!timeMgr.getEpochTime(epoch)) {
+    LOG(CONSOLE_HISTORY_NO_TIME);
+    return true;
+  }
+  uint32_t span = static_cast<uint32_t>(hours) * 3600;
+  historySummary = {};
+  historySummary.active = true;
+  historySummary.hours = static_cast<uint32_t>(hours);
+  historySummary.next = epoch > span ? epoch - span : 0;
+  historySummary.end = epoch;
+  return true;
+}
+
+// 集計中の history を HISTORY_STEP_SEC だけ進め、終わったら出力
+void serviceHistorySummary() {
+  HistorySummary& summary = historySummary;
+  if (!summary.active) {
+    return;
+  }
+  uint32_t to = summary.end - summary.next >= HISTORY_STEP_SEC ? summary.next + HISTORY_STEP_SEC - 1 : summary.end;
+  history.query(summary.next, to, summarizeHistory, &summary);
+  if (to < summary.end) {
+    summary.next = to + 1;
+    return;
+  }
+  summary.active = false;
+  LOG(CONSOLE_HISTORY, summary.hours, summary.samples, summary.tempMin / 10.0f,
+      summary.tempMax / 10.0f, summary.modes, summary.forecasts);
+}
+
+// reboot: 未書き出しの履歴・トレースを書き出して再起動
+bool consoleReboot(char* args, void* context) {
+  LOG(CONSOLE_REBOOT);
+  ESP.restart();  // onShutdown() で書き出す
+  return true;
+}
+
+// コマンド表（help は SerialConsole の組み込み）
+const ConsoleCommand CONSOLE_COMMANDS[] = {
+  {"mode",    "<off|heating_23_5|heating_18|cooling_25|dehumid_minus_1_5>", consoleMode},
+  {"auto",    "<on|off>",                                                   consoleAuto},
+  {"loop",    "",                                                           consoleLoop},
+  {"heap",    "",                                                           consoleHeap},
+  {"weather", "",                                                           consoleWeather},
+  {"offset",  "<温度℃> [湿度%]",                                            consoleOffset},
+  {"set",     "<名前=値>[&名前=値...]",                                     consoleSet},
+  {"history", "[時間（744まで）]",                                           consoleHistory},
+  {"reboot",  "",                                                           consoleReboot},
+};
+SerialConsole console(CONSOLE_COMMANDS, sizeof(CONSOLE_COMMANDS) / sizeof(CONSOLE_COMMANDS[0]));
+
+// ========================================
+// 複数台の連携
+// ========================================
+
+/**
+ * 停止中のゾーンを運転させる前に、他ノードと起動時刻が重ならないよう予約
+ */
+bool meshStartGate(uint8_t zone, ACMode mode, void* context) {
+  return mesh.requestStart(millis());
+}
+
+/**
+ * 連携を開始（WiFi の STA 起動後に呼び出す）
+ */
+void setupMesh() {
+  if (!MeshProtocol::isKeySet(MeshSecrets::KEY)) {
+    LOG(MESH_NO_KEY);
+    return;
+  }
+  meshActive = meshTransport.begin();
+  if (meshActive) {
+    zones.setStartGate(meshStartGate, nullptr);
+  }
+}
+
+/**
+ * 連携のメッセージ処理と天気予報・時刻の共有
+ * - 取得担当: 天気予報を更新したら配信
+ * - その他: 受信した天気予報・時刻を反映（受信が途絶えたら自分で取得）
+ *   時計が合っているのに MAX_TIME_JUMP_SEC より離れた時刻は、古いメッセージの再送とみなして無視します
+ *   （取得担当の時計が大きく補正された場合は、受信の途絶として自分で取得に切り替わります）。
+ */
+void serviceMesh() {
+  unsigned long now = millis();
+  mesh.service(now);
+
+  if (mesh.isForecastSource()) {
+    const WeatherData& weatherData = weatherForecast.getData();
+    uint32_t epoch;
+    if (weatherData.isValid && weatherData.lastUpdate != lastMeshForecast && timeMgr.getEpochTime(epoch)) {
+      MeshForecast forecast;
+      forecast.epoch = epoch;
+      forecast.tempMax = weatherData.tempMax;
+      forecast.tempMin = weatherData.tempMin;
+      forecast.weatherCode = static_cast<uint8_t>(weatherData.weatherCode);
+      forecast.valid = true;
+      mesh.publishForecast(forecast, now);
+      lastMeshForecast = weatherData.lastUpdate;
+    }
+  } else if (mesh.getForecastGeneration() != appliedMeshGeneration) {
+    appliedMeshGeneration = mesh.getForecastGeneration();
+    MeshForecast forecast;
+    uint32_t ageMs;
+    if (mesh.getForecast(forecast, ageMs, now)) {
+      uint32_t epoch;
+      int32_t drift = timeMgr.getEpochTime(epoch) ? static_cast<int32_t>(epoch - forecast.epoch) : INT32_MAX;
+      if (drift != INT32_MAX && (drift > MeshConfig::MAX_TIME_JUMP_SEC || drift < -MeshConfig::MAX_TIME_JUMP_SEC)) {
+        LOG(MESH_TIME_REJECTED, drift);
+      } else {
+        if (drift > MeshConfig::TIME_TOLERANCE_SEC || drift < -MeshConfig::TIME_TOLERANCE_SEC) {
+          timeMgr.setEpochTime(forecast.epoch);
+          LOG(MESH_TIME_SET, drift == INT32_MAX ? 0 : drift);
+        }
+        weatherForecast.setExternalData(forecast.tempMax, forecast.tempMin, forecast.weatherCode, forecast.valid);
+        lastMeshForecast = now;
+        meshFallback = false;
+      }
+    }
+  } else if (!meshFallback && now - lastMeshForecast >= MeshConfig::FORECAST_STALE_MS) {
+    meshFallback = true;
+    LOG(MESH_FORECAST_STALE, static_cast<uint32_t>(MeshConfig::FORECAST_STALE_MS / 60000));
+    // 同期・取得の完了は待たない（取得は時刻の同期後の update() で別タスクから行う）
+    if (wifiMgr.isConnected()) {
+      timeMgr.startSync();
+      weatherForecast.expedite();
+    }
+  }
+
+  // 送信待ちがなくなった（判定が停止に戻った等）場合は予約を取り消す
+  if (mesh.isClaiming() && !zones.hasPending()) {
+    mesh.cancelStart();
+  }
+}
+
+// ========================================
+// 起動
+// ========================================
+
+/**
+ * 起動用タスクで行うネットワークの準備（WiFi接続・NTP同期・天気予報の取得）
+ * 終了（networkReady）までは loop() が WiFi・天気予報を使わないため、同じオブジェクトを共有しません。
+ */
+void bootNetwork(void* context) {
+  if (!wifiMgr.connect()) {
+    LOG(SYS_WIFI_FAIL);
+    return;
+  }
+  boot.mark(BootMilestone::WIFI_CONNECTED);
+  LOG(SYS_WIFI_OK);
+
+  // 連携する場合、時刻・天気予報は取得担当ノードから受信
+  if (MeshConfig::ENABLED && !MeshConfig::FORECAST_SOURCE) {
+    return;
+  }
+  if (timeMgr.syncTime()) {
+    boot.mark(BootMilestone::TIME_SYNCED);
+  }
+  if (weatherForecast.begin()) {
+    boot.mark(BootMilestone::WEATHER_READY);
+  }
+}
+
+/**
+ * 起動用タスクの終了後、ネットワークを使う処理を開始（loop() から1回だけ呼び出す）
+ */
+void finishNetworkBoot() {
+  networkReady = true;
+
+  // 複数台の連携（ESP-NOW は WiFi の STA 起動後に開始）
+  if (MeshConfig::ENABLED) {
+    setupMesh();
+  }
+
+  // 省電力設定（WiFi接続後に行う）
+  power.begin();
+
+  // HTTPステータスサーバー起動（WiFi再接続後もそのまま待ち受けを継続）
+  statusServer.attachConfig(&configMgr, HttpSecrets::CONFIG_TOKEN);
+  statusServer.attachTrace(serveTrace, nullptr);
+  statusServer.begin();
+
+  // MQTT通信タスク起動（WiFi接続中のみ接続を試み、切断時は自動で再接続）
+  mqtt.begin();
+}
+
+/**
+ * 制御・表示に使う天気予報
+ * 起動用タスクの終了までは前回保存した予報（取得中の値は読まない）
+ */
+const WeatherData& currentWeather() {
+  return networkReady ? weatherForecast.getData() : bootCache.getForecast();
+}
+
+// ========================================
+// 待機
+// ========================================
+
+/**
+ * 各処理の次の期限のうち最も早いもの
+ * 制御・履歴・MQTT送信・手動モードの期限確認はセンサー読み取りと同じタイミングで行うため、
+ * センサー読み取りと計測結果の出力の期限に、送信待ちとコルーチンの再開時刻を加えて見ます。
+ */
+unsigned long nextDeadline(const RuntimeConfig& config) {
+  unsigned long now = millis();
+  unsigned long untilSensor = lastSensorReadTime + sampler.getIntervalMs() - now;
+  unsigned long untilReport = lastProfileReportTime + config.profileReportIntervalMs - now;
+  if (zones.hasPending()) {
+    unsigned long untilTransmit = zones.getNextTransmitTime() - now;
+    // 起動の順番待ちの間は予約時刻まで待つ（受信は PowerManager の待機上限ごとに確認）
+    if (meshActive && mesh.isClaiming()) {
+      unsigned long untilDecide = mesh.getClaimDecideTime() - now;
+      if (static_cast<long>(untilDecide) > static_cast<long>(untilTransmit)) {
+        untilTransmit = untilDecide;
+      }
+    }
+    if (static_cast<long>(untilTransmit) < static_cast<long>(untilReport)) {
+      untilReport = untilTransmit;
+    }
+  }
+  // 待機中のコルーチンの再開時刻
+  uint32_t wakeMs;
+  if (scheduler.getNextWakeMs(now, wakeMs)) {
+    unsigned long untilWake = wakeMs - now;
+    if (static_cast<long>(untilWake) < static_cast<long>(untilReport)) {
+      untilReport = untilWake;
+    }
+  }
+  // 期限を過ぎている場合は差が負（unsigned では巨大な値）になるため、符号付きで比較
+  long wait = static_cast<long>(untilSensor) < static_cast<long>(untilReport)
+                ? static_cast<long>(untilSensor) : static_cast<long>(untilReport);
+  return now + (wait > 0 ? wait : 0);
+}
+
+/**
+ * loop() 1回分の計測を終え、次の期限まで待機
+ */
+void finishLoop(const RuntimeConfig& config) {
+  loopProfiler.endLoop();
+  power.idleUntil(nextDeadline(config));
+}
+
+// ========================================
+// ディープスリープ（電池駆動ノード）
+// ========================================
+
+/**
+ * 起床1回分の処理を行い、ディープスリープに入る（戻らない）
+ * 起床時間を短くするため、ディスプレイ・HTTP・MQTT・履歴は使用せず、
+ * WiFi は時刻未設定または天気予報が古い場合のみ接続します。
+ * 赤外線信号はモードが変わった場合のみ送信します。
+ */
+void runDeepSleepCycle() {
+  configMgr.begin();
+  applyConfig(configMgr.get());
+  deepSleep.begin();
+  timeMgr.restoreTimeZone();
+  airConditioner.restoreMode(deepSleep.getMode());
+
+  sensor.begin();
+  SensorData sensorData = sensor.read();
+
+  uint32_t epoch = 0;
+  bool timeValid = timeMgr.getEpochTime(epoch);
+  WeatherData weatherData = deepSleep.getForecast();
+  if (deepSleep.needsNetwork(epoch, timeValid)) {
+    LOG(DEEPSLEEP_NETWORK);
+    deepSleep.markWifiWake();
+    if (wifiMgr.connect()) {
+      timeMgr.syncTime();
+      timeValid = timeMgr.getEpochTime(epoch);
+      if (weatherForecast.begin() && timeValid) {
+        weatherData = weatherForecast.getData();
+        deepSleep.setForecast(weatherData, epoch);
+      }
+    }
+    WiFi.disconnect(true);
+  }
+
+  if (sensorData.isValid && timeValid) {
+    ACMode optimalMode = airConditioner.determineOptimalMode(
+      sensorData.temperature, sensorData.humidity, timeMgr, weatherData);
+    if (optimalMode != airConditioner.getCurrentMode()) {
+      airConditioner.begin();
+      airConditioner.setMode(optimalMode);
+      deepSleep.setMode(airConditioner.getCurrentMode());
+    }
+  } else {
+    LOG(DEEPSLEEP_SKIP_CONTROL);
+  }
+
+  deepSleep.sleep();
+}
 
 // ========================================
 // セットアップ
 // ========================================
 
+/**
+ * 長く使うバッファを固定領域から割り当てる（断片化する前の起動直後に呼び出す）
+ * 領域が不足した場合、そのモジュールは従来どおり使うたびにヒープを確保します。
+ */
+void setupArena() {
+  if (!arena.begin(MemoryConfig::ARENA_SIZE) || !weatherForecast.reserveBuffers(arena)) {
+    LOG(MEM_ARENA_FAIL, static_cast<uint32_t>(MemoryConfig::ARENA_SIZE));
+    return;
+  }
+  LOG(MEM_ARENA_READY, static_cast<uint32_t>(arena.getUsed()), static_cast<uint32_t>(arena.getCapacity()));
+}
+
 void setup() {
   // シリアル通信開始
   Serial.begin(115200);
-  Serial.println("\n========================================");
-  Serial.println("エアコン自動制御システム起動");
-  Serial.println("========================================");
-
-  // WiFi接続
-  if (wifiMgr.connect()) {
-    Serial.println("[System] WiFi接続完了");
-    // WiFi接続成功後、時刻を同期
-    timeMgr.syncTime();
-    // 天気予報を取得
-    weatherForecast.begin();
-  } else {
-    Serial.println("[System] WiFi接続失敗 - WiFiなしで継続");
+  Logger::begin();
+  LOG(SYS_SEPARATOR);
+  LOG(SYS_TITLE);
+  LOG(SYS_SEPARATOR);
+
+  // 固定領域の割り当て（ディープスリープの起床ごとの処理でも使用）
+  setupArena();
+
+  // 電池駆動ノードは1回処理してディープスリープ（setup() から戻らない）
+  if (DeepSleepConfig::ENABLED) {
+    runDeepSleepCycle();
   }
 
+  // 実行時設定の読み込み（NVS）
+  configMgr.begin();
+  applyConfig(configMgr.get());
+  appliedConfigGeneration = configMgr.getGeneration();
+
+  // 履歴ストア初期化（LittleFS。予備の予報ファイルを起動用タスクから読むため先にマウント）
+  history.begin();
+
+  // 制御の入力トレース（履歴と同じ LittleFS に記録、tools/replay で再生）
+  trace.begin(millis());
+
+  // 再起動（esp_restart()）の直前に RAM 上のブロックを書き出す
+  esp_register_shutdown_handler(onShutdown);
+
+  // 前回の時刻・天気予報（時刻の同期前の最初の制御判定と、取得に失敗した場合の予報に使用）
+  bootCache.begin();
+  weatherForecast.addProvider(&forecastFile);
+  weatherForecast.restore(bootCache.getForecast());
+
+  // WiFi接続・NTP同期・天気予報の取得はバックグラウンドで行い、その間に制御の準備を進める
+  boot.startNetwork(bootNetwork, nullptr);
+
   // センサー初期化
   sensor.begin();
+  boot.mark(BootMilestone::SENSOR_READY);
 
-  // ディスプレイ初期化
+  // エアコンコントローラー初期化
+  airConditioner.begin();
+  airConditioner.setReceiveHandler(onIRReceived, nullptr);
+  setupZones();
+  boot.mark(BootMilestone::IR_READY);
+
+  // ディスプレイ初期化（起動画面は最初のセンサー値の表示まで残す）
   if (!displayCtrl.begin()) {
-    Serial.println("[System] ディスプレイ初期化失敗 - 継続");
+    LOG(SYS_DISPLAY_FAIL);
   }
   displayCtrl.showStartupScreen();
-  delay(TimingConfig::STARTUP_DELAY_MS);
+  boot.mark(BootMilestone::DISPLAY_READY);
 
-  // 起動画面表示後、ディスプレイをクリア
-  Serial.println("[System] スタートアップ完了、ディスプレイをクリア");
+  // 消費電力量の推定（料金表・電力量計）
+  energy.setTariff(EnergyConfig::TARIFF, sizeof(EnergyConfig::TARIFF) / sizeof(EnergyConfig::TARIFF[0]));
+  energyMeter.begin();
+  if (energyMeter.isEnabled()) {
+    power.addSleepPrepare(PulseMeter::prepareSleep, &energyMeter);  // ライトスリープ中もパルスで起床
+  }
 
-  // エアコンコントローラー初期化
-  airConditioner.begin();
+  // 待ち時間のある処理は loop() を止めずにコルーチンで待つ
+  // （起動用タスク・ディープスリープの起床時は従来どおり完了まで待つ）
+  airConditioner.attach(scheduler);
+  wifiMgr.attach(scheduler);
+  forecastWorker.begin();
+  weatherForecast.attach(forecastWorker, scheduler);
+
+  LOG(SYS_READY);
+  LOG(CONSOLE_READY);
+  LOG(SYS_SEPARATOR);
 
-  Serial.println("[System] システム起動完了");
-  Serial.println("========================================\n");
+  // 値の変化を受け取る処理（表示・履歴の天気予報・制御は loop() で版を確認）
+  bus.sensor.subscribe(onSensorChanged);
+
+  // 最初の有効なセンサー値ですぐに制御を判定する
+  lastControlTime = millis() - configMgr.get().controlIntervalMs;
+  boot.mark(BootMilestone::SETUP_DONE);
+
+  // 以降の loop() でのヒープ確保を数え、全タスクの確保を呼び出し元ごとに記録
+  // （ALLOC_COUNTER を有効にしたビルドのみ）
+  AllocCounter::watchCurrentTask();
+  AllocCounter::seal();
+
+  // 初期化後のヒープの状態（断片化の傾向の基準）
+  heapTrend.sample(millis() / 1000, ESP.getMaxAllocHeap(), ESP.getFreeHeap());
 }
 
 // ========================================
@@ -131,54 +1067,199 @@ void setup() {
 // ========================================
 
 void loop() {
-  // WiFi接続状態の監視（切断時は再接続を試みる）
-  wifiMgr.checkConnection();
+  loopProfiler.beginLoop();
+
+  // 実行時設定（ループ1回分はこのコピーを使い、途中の変更の影響を受けない）
+  // 世代はコピーの前に読む（間に変更されても、次の回で世代の違いとして反映される）
+  uint32_t generation = configMgr.getGeneration();
+  const RuntimeConfig config = configMgr.get();
+  if (generation != appliedConfigGeneration) {
+    appliedConfigGeneration = generation;
+    applyConfig(config);
+  }
+
+  // 起動用タスクの終了後に、WiFi・天気予報を使う処理を開始
+  if (!networkReady && boot.isNetworkDone()) {
+    finishNetworkBoot();
+  }
 
-  // 赤外線受信処理（常時監視）
+  // 待機中のコルーチンの再開（IR受信の再開・WiFi再接続の確認・天気予報の取得完了）
+  scheduler.run(millis());
+
+  // WiFi接続状態の監視（切断時は再接続のコルーチンを開始）
+  if (networkReady) {
+    wifiMgr.checkConnection();
+  }
+  loopProfiler.mark(LoopPhase::WIFI_CHECK);
+
+  // 赤外線受信処理（常時監視）と送信待ちの送信
   airConditioner.handleIRReceive();
+  zones.service();
+  loopProfiler.mark(LoopPhase::IR_RECEIVE);
+  if (recordModeChange()) {
+    loopProfiler.mark(LoopPhase::HISTORY);
+  }
+
+  // MQTTコマンドの反映（設定の変更は次のループで反映）
+  handleMqttCommands();
+  loopProfiler.mark(LoopPhase::MQTT_COMMAND);
+
+  // シリアルコンソール（受信済みの分だけ読み、1回に1コマンド）
+  console.poll(Serial);
+  serviceHistorySummary();
+  loopProfiler.mark(LoopPhase::CONSOLE);
 
-  // 天気予報の定期更新（毎時0分）
-  weatherForecast.update(timeMgr);
+  // 複数台の連携
+  if (meshActive) {
+    serviceMesh();
+  }
+  loopProfiler.mark(LoopPhase::MESH);
+
+  // 天気予報の定期更新（毎時0分。連携中は取得担当のみ）
+  if (networkReady && (!meshActive || mesh.isForecastSource() || meshFallback)) {
+    weatherForecast.update(timeMgr);
+  }
+  bus.weather.publish(currentWeather());  // 取得・受信・破棄・起動用の予報からの切り替えで変わる
+  loopProfiler.mark(LoopPhase::WEATHER_UPDATE);
 
   // 現在時刻を取得
   unsigned long currentTime = millis();
 
-  // センサー読み取りと制御処理
-  if (currentTime - lastSensorReadTime >= TimingConfig::SENSOR_READ_INTERVAL_MS) {
+  // loop計測結果の定期出力
+  if (currentTime - lastProfileReportTime >= config.profileReportIntervalMs) {
+    lastProfileReportTime = currentTime;
+    loopProfiler.printSummary();
+    power.printSummary();
+    LOG(SENSOR_SAMPLING, sampler.getIntervalMs(), sampler.getReadsPerHour(currentTime), sampler.getSavedReads());
+    LOG(BUS_STATS, bus.sensor.getVersion(), bus.sensor.getPublished(), bus.weather.getVersion(), bus.mode.getVersion());
+    LOG(CO_STATS, static_cast<uint32_t>(scheduler.getRunning()), scheduler.getResumes());
+    if (ModulationConfig::ENABLED) {
+      LOG(MOD_STARTS, modulator.getStarts(), modulator.getBaselineStarts(), modulator.getSetpointChanges());
+    }
+    AllocCounter::printSites();
+    heapTrend.sample(currentTime / 1000, ESP.getMaxAllocHeap(), ESP.getFreeHeap());
+    loopProfiler.mark(LoopPhase::REPORT);
+  }
+
+  // センサー読み取りと制御処理（間隔は温湿度の変化に応じて調整）
+  if (currentTime - lastSensorReadTime >= sampler.getIntervalMs()) {
     lastSensorReadTime = currentTime;
 
-    // センサーデータ読み取り
-    SensorData sensorData = sensor.read();
+    // センサーデータ読み取り（値が変わった場合のみ購読者へ通知。以降はバスのスロットを参照）
+    bus.sensor.publish(sensor.read());
+    const SensorData& sensorData = bus.sensor.get();
+    sampler.onReading(currentTime, sensorData.isValid, sensorData.temperature, sensorData.humidity);
+    loopProfiler.mark(LoopPhase::SENSOR_READ);
 
-    // ディスプレイ更新（天気予報とエアコン状態付き）
-    char formattedTime[20];  // "YYYY-MM-DD HH:MM" = 16文字 + null終端
-    timeMgr.getFormattedTime(TimeManager::FORMAT_DATETIME, formattedTime, 20);
-    WeatherData weatherData = weatherForecast.getData();
-    ACMode currentACMode = airConditioner.getCurrentMode();
-    displayCtrl.showSensorDataWithWeatherAndAC(sensorData, formattedTime, weatherData, currentACMode);
+    // ディスプレイ更新（天気予報とエアコン状態付き、変化があった場合のみ）
+    const WeatherData& weatherData = bus.weather.get();
+    ACMode currentACMode = bus.mode.get();
+    updateDisplay();
+    publishStatus(sensorData, weatherData, currentACMode);
+    loopProfiler.mark(LoopPhase::DISPLAY);
 
     // センサーエラー時は制御スキップ
     if (!sensorData.isValid) {
+      finishLoop(config);
       return;
     }
+    boot.mark(BootMilestone::FIRST_READING);
+    modulator.onReading(currentTime, sensorData.temperature);
+    trace.recordSample(currentTime, sensorData.temperature, sensorData.humidity);
+
+    // 履歴に記録（時刻同期前は記録しない）
+    uint32_t epoch;
+    bool epochValid = timeMgr.getEpochTime(epoch);
+    if (epochValid) {
+      history.addSample(epoch, sensorData.temperature, sensorData.humidity);
+      if (historyWeather.changed() && weatherData.isValid) {
+        history.recordForecast(epoch, weatherData);
+      }
+
+      // 消費電力量・電気代の積算（電力量計のパルスは時刻同期まで保留）
+      time_t now = static_cast<time_t>(epoch);
+      struct tm local;
+      localtime_r(&now, &local);
+      energy.accumulate(epoch, local, currentACMode, energyMeter.takeWh());
+
+      // 次回の起動用に時刻・天気予報を保存（更新時または一定間隔ごと）
+      bootCache.update(epoch, weatherData);
+    }
+    loopProfiler.mark(LoopPhase::HISTORY);
+
+    // MQTTでのモード指定後は一定時間自動制御を止める
+    if (manualHold && currentTime - manualHoldStart >= MqttConfig::MANUAL_HOLD_MS) {
+      manualHold = false;
+      lastControlTime = currentTime - config.controlIntervalMs;  // すぐに自動制御を再開
+    }
+
+    // 仮の時刻で判定した後に時刻が確定したら、すぐに判定し直す
+    if (provisionalControl && epochValid) {
+      provisionalControl = false;
+      lastControlTime = currentTime - config.controlIntervalMs;
+    }
 
     // エアコン制御判定（制御間隔チェック）
-    if (currentTime - lastControlTime >= TimingConfig::CONTROL_INTERVAL_MS) {
+    if (currentTime - lastControlTime >= config.controlIntervalMs) {
       lastControlTime = currentTime;
 
-      // 天気予報データを取得
-      WeatherData weatherData = weatherForecast.getData();
+      // 天気予報データと現在時刻を取得（全ゾーン共通）
+      // 同期前は前回保存した時刻から経過時間で推定した仮の時刻で判定（ピーク時間帯の判定には使わない）
+      struct tm timeinfo;
+      bool synced = timeMgr.getCurrentTime(timeinfo);
+      bool timeValid = synced;
+      if (!synced) {
+        timeValid = bootCache.provisionalTime(currentTime, timeinfo);
+        provisionalControl = timeValid;
+        if (timeValid) {
+          LOG(BOOT_PROVISIONAL, timeinfo.tm_mon + 1, timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min);
+        } else {
+          LOG(AC_TIME_FAIL);
+        }
+      }
 
-      // 最適なモードを決定（季節・時間帯・温湿度・天気予報ベース）
-      ACMode optimalMode = airConditioner.determineOptimalMode(
-        sensorData.temperature,
-        sensorData.humidity,
-        timeMgr,
-        weatherData
-      );
+      // ピーク時間帯の切り替え（目標範囲を広げる・戻す）
+      bool peak = synced && EnergyConfig::PEAK_SETBACK > 0.0f && energy.isPeak(timeinfo.tm_hour);
+      if (peak != tariffPeak) {
+        tariffPeak = peak;
+        if (peak) {
+          LOG(ENERGY_PEAK_START, energy.getPrice(timeinfo.tm_hour), EnergyConfig::PEAK_SETBACK);
+        } else {
+          LOG(ENERGY_PEAK_END);
+        }
+        applyConfig(config);
+      }
 
-      // モード設定（変更がある場合のみ送信）
-      airConditioner.setMode(optimalMode);
+      // メイン: 最適なモードを決定（季節・時間帯・温湿度・天気予報ベース、MQTTでの手動指定中・コンソールで停止中は除く）
+      // 判定に渡した現在のモード・閾値と結果はトレースに記録（tools/replay で同じ判定を再生）
+      bool automatic = !manualHold && autoControl;
+      const PolicyThresholds& thresholds = airConditioner.getPolicy().getThresholds();
+      if (automatic && ModulationConfig::ENABLED && timeValid) {
+        // 設定温度を調整（運転を続け、設定温度のみ変更）
+        ACMode baseline = modulator.getBaselineMode();
+        ACCommand command = airConditioner.determineCommand(
+          sensorData.temperature, sensorData.humidity, timeinfo, weatherData, modulator, currentTime);
+        trace.recordCommand(currentTime, timeinfo, weatherData, thresholds, baseline, command);
+        zones.requestCommand(ZoneConfig::MAIN_ZONE, command);
+      } else if (automatic) {
+        ACMode current = airConditioner.getCurrentMode();
+        ACMode optimalMode = timeValid
+          ? airConditioner.determineOptimalMode(sensorData.temperature, sensorData.humidity, timeinfo, weatherData)
+          : ACMode::OFF;
+        trace.recordControl(currentTime, timeValid ? &timeinfo : nullptr, weatherData, thresholds, current, optimalMode);
+        applyMode(optimalMode);  // 変更がある場合のみ送信
+      }
+
+      // 追加ゾーンをまとめて判定
+      if (timeValid) {
+        zones.evaluate(timeinfo, weatherData, sensorData);
+      }
+      loopProfiler.mark(LoopPhase::CONTROL);
+
+      // 全フェーズの初期化が一巡したので、以降は確保しない（定常状態）
+      loopProfiler.setAllocationCheck(true);
     }
   }
+
+  finishLoop(config);
 }
@@ -0,0 +1,261 @@
+/**
+ * main.cpp（履歴データの確認）
+ *
+ * 使い方:
+ *   history <segment.bin>...   セグメントファイル（LittleFS の /history/NNNNNNNN.bin）を CSV で出力
+ *   history --check            圧縮形式の符号化・復号と範囲検索を確認して終了（成功時は OK）
+ *
+ * --check は1分ごとの温湿度・モードの変更・天気予報の更新に、時刻の戻り（NTP での補正）と
+ * 大きな飛び（停電からの復帰）を混ぜた1週間分を HistoryStore と同じ手順でブロックに書き出し、
+ * すべてのブロックを読めること・復号した値が元と一致すること・ブロック内の時刻がヘッダーの範囲に収まること・
+ * 範囲検索の件数が全件の走査と一致することを確認します。
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "HistoryCodec.h"
+
+namespace {
+  constexpr uint32_t FLUSH_INTERVAL_SEC = 30 * 60;  // HistoryStore::FLUSH_INTERVAL_SEC
+  constexpr uint32_t CHECK_START = 1767225600;       // 2026-01-01 00:00 UTC
+  constexpr uint32_t CHECK_DAYS = 7;
+
+  void printUsage() {
+    std::fprintf(stderr, "使い方: history <segment.bin>... | history --check\n");
+  }
+
+  /**
+   * ブロックを順に復号して visitor に渡す（HistoryStore::querySegment() と同じ読み飛ばし）
+   * @return 読んだバイト数（length 未満: その位置のブロックが壊れている）
+   */
+  template <typename Visitor>
+  size_t forEachBlock(const std::vector<uint8_t>& data, uint32_t from, uint32_t to, Visitor visitor) {
+    size_t pos = 0;
+    HistoryBlockHeader header;
+    while (pos + HistoryBlockHeader::SIZE <= data.size() && header.deserialize(&data[pos])) {
+      size_t next = pos + HistoryBlockHeader::SIZE + header.payloadLength;
+      if (next > data.size()) {
+        break;
+      }
+      if (header.endTime >= from && header.startTime <= to) {
+        HistoryDecoder decoder(header, &data[pos + HistoryBlockHeader::SIZE]);
+        HistoryEvent event;
+        while (decoder.next(event)) {
+          if (event.time < from) continue;
+          if (event.time > to) break;
+          visitor(event);
+        }
+      }
+      pos = next;
+    }
+    return pos;
+  }
+
+  // HistoryStore::append() と同じ手順でブロックに追加（満杯・時刻の戻りで書き出し、一定時間ごとに書き出し）
+  class BlockWriter {
+  public:
+    explicit BlockWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void append(const HistoryEvent& event) {
+      if (!encoder_.append(event)) {
+        flush();
+        encoder_.append(event);
+      }
+      if (static_cast<int32_t>(event.time - encoder_.getHeader().startTime) >= static_cast<int32_t>(FLUSH_INTERVAL_SEC)) {
+        flush();
+      }
+    }
+
+    void flush() {
+      if (encoder_.isEmpty()) {
+        return;
+      }
+      uint8_t raw[HistoryBlockHeader::SIZE];
+      encoder_.getHeader().serialize(raw);
+      out_.insert(out_.end(), raw, raw + sizeof(raw));
+      out_.insert(out_.end(), encoder_.getPayload(), encoder_.getPayload() + encoder_.getHeader().payloadLength);
+      encoder_.reset();
+      blocks_++;
+    }
+
+    uint32_t getBlocks() const { return blocks_; }
+
+  private:
+    std::vector<uint8_t>& out_;
+    HistoryEncoder encoder_;
+    uint32_t blocks_ = 0;
+  };
+
+  bool sameEvent(const HistoryEvent& a, const HistoryEvent& b) {
+    if (a.time != b.time || a.kind != b.kind) {
+      return false;
+    }
+    switch (a.kind) {
+      case HistoryKind::SAMPLE:   return a.temperature == b.temperature && a.humidity == b.humidity;
+      case HistoryKind::MODE:     return a.mode == b.mode;
+      case HistoryKind::FORECAST: return a.tempMax == b.tempMax && a.tempMin == b.tempMin && a.weatherCode == b.weatherCode;
+    }
+    return false;
+  }
+
+  // 確認用の1週間分（2日目に1時間の戻り、4日目に2日間の停止、5日目に数秒の戻り）
+  std::vector<HistoryEvent> makeEvents() {
+    std::vector<HistoryEvent> events;
+    uint32_t random = 1;
+    int16_t temperature = 220;
+    int16_t humidity = 450;
+    uint32_t time = CHECK_START;
+    for (uint32_t minute = 0; minute < CHECK_DAYS * 24 * 60; minute++) {
+      if (minute == 1 * 24 * 60 + 600) {
+        time -= 3600;
+      } else if (minute == 3 * 24 * 60) {
+        time += 2 * 86400;
+      } else if (minute == 4 * 24 * 60 + 30) {
+        time -= 5;
+      }
+      random = random * 1664525u + 1013904223u;
+      HistoryEvent event = {};
+      event.time = time;
+      event.kind = HistoryKind::SAMPLE;
+      temperature = static_cast<int16_t>(temperature + static_cast<int>(random >> 30) - 1);
+      humidity = static_cast<int16_t>(humidity + static_cast<int>((random >> 28) & 3) - 1);
+      event.temperature = temperature;
+      event.humidity = humidity;
+      events.push_back(event);
+
+      if (minute % 97 == 0) {
+        event = HistoryEvent();
+        event.time = time;
+        event.kind = HistoryKind::MODE;
+        event.mode = static_cast<uint8_t>(minute % 5);
+        events.push_back(event);
+      }
+      if (minute % 60 == 0) {
+        event = HistoryEvent();
+        event.time = time;
+        event.kind = HistoryKind::FORECAST;
+        event.tempMax = 95;
+        event.tempMin = static_cast<int16_t>(-20 + minute / 1440);
+        event.weatherCode = static_cast<uint8_t>(minute / 60 % 4);
+        events.push_back(event);
+      }
+      time += HistoryEncoder::SAMPLE_INTERVAL_SEC + (random >> 31);  // 読み取り時刻の揺れ
+    }
+    return events;
+  }
+
+  int runCheck() {
+    std::vector<HistoryEvent> events = makeEvents();
+    std::vector<uint8_t> data;
+    BlockWriter writer(data);
+    for (const HistoryEvent& event : events) {
+      writer.append(event);
+    }
+    writer.flush();
+
+    bool ok = true;
+    std::vector<HistoryEvent> decoded;
+    size_t used = forEachBlock(data, 0, UINT32_MAX, [&](const HistoryEvent& event) { decoded.push_back(event); });
+    std::printf("[Check] %zu 件 → %u ブロック %zu バイト（1件 %.2f バイト）\n", events.size(), writer.getBlocks(),
+                data.size(), static_cast<double>(data.size()) / events.size());
+    if (used != data.size()) {
+      std::printf("[Check] NG: %zu バイト目のブロックを読めません\n", used);
+      ok = false;
+    }
+    if (decoded.size() != events.size()) {
+      std::printf("[Check] NG: 復号した件数 %zu（元は %zu 件）\n", decoded.size(), events.size());
+      ok = false;
+    }
+    for (size_t i = 0; i < decoded.size() && i < events.size(); i++) {
+      if (!sameEvent(decoded[i], events[i])) {
+        std::printf("[Check] NG: %zu 件目（時刻 %u）が一致しません\n", i, events[i].time);
+        ok = false;
+        break;
+      }
+    }
+
+    // ブロック内は昇順で、ヘッダーの開始・終了時刻の範囲に収まる（範囲検索の読み飛ばしの前提）
+    for (size_t pos = 0; pos + HistoryBlockHeader::SIZE <= data.size();) {
+      HistoryBlockHeader header;
+      header.deserialize(&data[pos]);
+      HistoryDecoder decoder(header, &data[pos + HistoryBlockHeader::SIZE]);
+      HistoryEvent event;
+      uint32_t last = header.startTime;
+      while (decoder.next(event)) {
+        if (event.time < last || event.time > header.endTime) {
+          std::printf("[Check] NG: ブロック %zu バイト目の時刻 %u が範囲 %u〜%u の外\n", pos, event.time,
+                      header.startTime, header.endTime);
+          ok = false;
+          break;
+        }
+        last = event.time;
+      }
+      pos += HistoryBlockHeader::SIZE + header.payloadLength;
+    }
+
+    // 範囲検索（時刻の戻りをまたぐ範囲を含む）の件数が全件の走査と一致する
+    const uint32_t ranges[][2] = {
+      {CHECK_START + 86400 + 30000, CHECK_START + 86400 + 40000},
+      {CHECK_START + 5 * 86400, CHECK_START + 6 * 86400},
+      {CHECK_START, CHECK_START + 600},
+    };
+    for (const auto& range : ranges) {
+      size_t expected = 0;
+      for (const HistoryEvent& event : events) {
+        expected += event.time >= range[0] && event.time <= range[1];
+      }
+      size_t found = 0;
+      forEachBlock(data, range[0], range[1], [&](const HistoryEvent&) { found++; });
+      if (found != expected || expected == 0) {
+        std::printf("[Check] NG: 範囲 %u〜%u の件数 %zu（全件の走査では %zu 件）\n", range[0], range[1], found, expected);
+        ok = false;
+      }
+    }
+
+    std::printf("[Check] %s\n", ok ? "OK" : "NG");
+    return ok ? 0 : 1;
+  }
+
+  void printEvent(const HistoryEvent& event) {
+    switch (event.kind) {
+      case HistoryKind::SAMPLE:
+        std::printf("%u,sample,%.1f,%.1f\n", event.time, event.temperature / 10.0, event.humidity / 10.0);
+        break;
+      case HistoryKind::MODE:
+        std::printf("%u,mode,%u\n", event.time, event.mode);
+        break;
+      case HistoryKind::FORECAST:
+        std::printf("%u,forecast,%.1f,%.1f,%u\n", event.time, event.tempMax / 10.0, event.tempMin / 10.0, event.weatherCode);
+        break;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printUsage();
+    return 1;
+  }
+  if (std::strcmp(argv[1], "--check") == 0) {
+    return runCheck();
+  }
+
+  int result = 0;
+  for (int i = 1; i < argc; i++) {
+    std::ifstream file(argv[i], std::ios::binary);
+    if (!file) {
+      std::fprintf(stderr, "[History] %s を開けません\n", argv[i]);
+      return 1;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t used = forEachBlock(data, 0, UINT32_MAX, printEvent);
+    if (used != data.size()) {
+      std::fprintf(stderr, "[History] %s: %zu バイト目のブロックが壊れているため以降を無視\n", argv[i], used);
+      result = 2;
+    }
+  }
+  return result;
+}
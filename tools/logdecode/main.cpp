@@ -0,0 +1,165 @@
+/**
+ * main.cpp（ログデコーダー）
+ *
+ * ファームウェアが出力するバイナリログをテキストに復元します。
+ * フレーム以外のバイト（ブートローダーの出力・パニック時のダンプなど）はそのまま表示します。
+ * シリアルポートから読み取る場合は、標準入力に入力した行をそのままポートへ送ります
+ * （シリアルコンソールのコマンド。応答はログとして表示されます）。
+ *
+ * 使い方:
+ *   logdecode [シリアルデバイス|ファイル] [-b ボーレート]
+ *
+ * 例:
+ *   logdecode /dev/ttyUSB0          # シリアルポートから直接読み取り（115200bps、入力した行はコマンドとして送信）
+ *   logdecode capture.bin           # 保存したバイナリを復元
+ *   cat capture.bin | logdecode     # 標準入力から読み取り
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "LogFormat.h"
+
+namespace {
+  struct DecoderState {
+    uint32_t tableHash;
+    bool hashWarned;
+  };
+
+  void printUsage() {
+    std::fprintf(stderr, "使い方: logdecode [シリアルデバイス|ファイル] [-b ボーレート]\n");
+  }
+
+  speed_t toSpeed(long baud) {
+    switch (baud) {
+      case 9600:   return B9600;
+      case 57600:  return B57600;
+      case 115200: return B115200;
+      case 230400: return B230400;
+      case 460800: return B460800;
+      case 921600: return B921600;
+      default:     return 0;
+    }
+  }
+
+  // シリアルポートを生データ（raw）モードに設定
+  bool configureSerial(int fd, speed_t speed) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+      return false;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+  }
+
+  void onRecord(const LogRecord& record, void* context) {
+    DecoderState& state = *static_cast<DecoderState*>(context);
+
+    // 起動時のレコードで表の一致を確認
+    if (record.id == static_cast<uint16_t>(LogId::LOG_STARTED) && record.length >= 5 && !state.hashWarned) {
+      uint32_t firmwareHash;
+      std::memcpy(&firmwareHash, record.payload + 1, sizeof(firmwareHash));
+      if (firmwareHash != state.tableHash) {
+        std::fprintf(stderr, "[logdecode] 警告: メッセージ表が一致しません（ファームウェア %08x, デコーダー %08x）\n",
+                     firmwareHash, state.tableHash);
+        state.hashWarned = true;
+      }
+    }
+
+    char line[512];
+    size_t length = LogFormat::formatLine(record, line, sizeof(line));
+    std::fwrite(line, 1, length, stdout);
+    std::fflush(stdout);
+  }
+
+  void onText(const uint8_t* data, size_t length, void*) {
+    std::fwrite(data, 1, length, stdout);
+    if (std::memchr(data, '\n', length)) {
+      std::fflush(stdout);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  long baud = 115200;
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      baud = std::strtol(argv[++i], nullptr, 10);
+    } else if (argv[i][0] == '-') {
+      printUsage();
+      return 1;
+    } else {
+      path = argv[i];
+    }
+  }
+
+  int fd = STDIN_FILENO;
+  bool forwardInput = false;  // 標準入力の行をシリアルポートへ送る
+  if (path) {
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+      fd = open(path, O_RDONLY | O_NOCTTY);
+    }
+    if (fd < 0) {
+      std::perror(path);
+      return 1;
+    }
+    if (isatty(fd)) {
+      speed_t speed = toSpeed(baud);
+      if (speed == 0 || !configureSerial(fd, speed)) {
+        std::fprintf(stderr, "[logdecode] シリアルポートを設定できません（%ld bps）\n", baud);
+        return 1;
+      }
+      forwardInput = (fcntl(fd, F_GETFL) & O_ACCMODE) == O_RDWR;
+    }
+  }
+
+  DecoderState state = {LogTable::hash(), false};
+  LogFrameParser parser(onRecord, onText, &state);
+
+  uint8_t buffer[512];
+  for (;;) {
+    if (forwardInput) {
+      struct pollfd fds[2] = {{fd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+      if (poll(fds, 2, -1) < 0) {
+        break;
+      }
+      if (fds[1].revents & (POLLIN | POLLHUP)) {
+        ssize_t typed = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (typed > 0) {
+          if (write(fd, buffer, static_cast<size_t>(typed)) != typed) {
+            std::fprintf(stderr, "[logdecode] コマンドを送信できません\n");
+          }
+        } else {
+          forwardInput = false;  // 標準入力の終了後は読み取りのみ
+        }
+      }
+      if (!(fds[0].revents & (POLLIN | POLLHUP | POLLERR))) {
+        continue;
+      }
+    }
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n <= 0) {
+      break;
+    }
+    for (ssize_t i = 0; i < n; i++) {
+      parser.feed(buffer[i]);
+    }
+  }
+
+  if (parser.getErrorCount() > 0) {
+    std::fprintf(stderr, "[logdecode] 破損フレーム: %u件\n", static_cast<unsigned>(parser.getErrorCount()));
+  }
+  return 0;
+}
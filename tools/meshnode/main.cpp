@@ -0,0 +1,232 @@
+/**
+ * main.cpp（複数台の連携のホスト実行）
+ *
+ * ファームウェアと同じ MeshCoordinator を UDP ブロードキャストで動かします。
+ * 1台の PC で複数のプロセスを起動すると、天気予報の共有とコンプレッサー起動の分散を確認できます。
+ *
+ * 使い方:
+ *   meshnode [-source] [-id ノードID] [-i 起動要求の間隔（秒）] [-p UDPポート]
+ *   meshnode --check    # 1プロセス内で3ノードを動かし、予報の受信と起動の分散・鍵の違うノードと再送の拒否を確認して終了
+ *
+ * 鍵はすべてのプロセスで共通の NODE_KEY を使います。
+ *
+ * 例:
+ *   meshnode -source -id 1 &
+ *   meshnode -id 2 &
+ *   meshnode -id 3
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include "Logger.h"
+#include "MeshCoordinator.h"
+#include "MeshTransport.h"
+
+namespace {
+  constexpr uint32_t SOURCE_PUBLISH_INTERVAL_MS = 600000;  // 天気予報の更新（実機は1時間ごと）
+  constexpr uint32_t CHECK_DURATION_MS = 3000;
+  constexpr size_t CHECK_NODES = 3;
+  constexpr size_t CHECK_CAPTURES = 32;       // 再送の確認用に記録するメッセージ数
+  constexpr uint32_t REPLAY_DURATION_MS = 300;
+
+  // ホスト実行用の共有鍵（実機は secrets.h の MeshSecrets::KEY）
+  const uint8_t NODE_KEY[MeshProtocol::KEY_SIZE] = {
+    0x6d, 0x65, 0x73, 0x68, 0x6e, 0x6f, 0x64, 0x65, 0x2d, 0x63, 0x68, 0x65, 0x63, 0x6b, 0x00, 0x01,
+  };
+  const uint8_t ROGUE_KEY[MeshProtocol::KEY_SIZE] = {1};  // 鍵を知らないノード
+
+  void printUsage() {
+    std::fprintf(stderr, "使い方: meshnode [-source] [-id ノードID] [-i 起動要求の間隔（秒）] [-p UDPポート] [--check]\n");
+  }
+
+  uint32_t nowMs() {
+    static const auto start = std::chrono::steady_clock::now();
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  }
+
+  MeshForecast dummyForecast() {
+    MeshForecast forecast;
+    forecast.epoch = static_cast<uint32_t>(std::time(nullptr));
+    forecast.tempMax = 31.4f;
+    forecast.tempMin = -0.5f;
+    forecast.weatherCode = 3;
+    forecast.valid = true;
+    return forecast;
+  }
+
+  /**
+   * 3ノードが同時に起動を要求し、CHECK_DURATION_MS の間に起動できるのが1台だけか、
+   * 取得担当以外のノードが天気予報を受信したかを確認
+   * 鍵の違うノードが後から送る天気予報・起動の予約は、どのノードにも反映されないことも確認します。
+   * 最後に、記録しておいた正しいメッセージ（天気予報・予約・起動）をそのまま再送し、
+   * 再送として破棄される（天気予報の受信回数が増えない）ことを確認します。
+   */
+  int runCheck(uint16_t port) {
+    // MAC は SipHash-2-4 の参照値（鍵 00..0f、メッセージ 00..0f。ヘッダーと同じ16バイト）と一致する
+    uint8_t key[MeshProtocol::KEY_SIZE];
+    uint8_t vector[MeshProtocol::HEADER_SIZE + MeshProtocol::MAC_SIZE] = {};
+    const uint8_t expectedMac[MeshProtocol::MAC_SIZE] = {0xdb, 0x9b, 0xc2, 0x57, 0x7f, 0xcc, 0x2a, 0x3f};
+    for (size_t i = 0; i < sizeof(key); i++) {
+      key[i] = static_cast<uint8_t>(i);
+    }
+    for (size_t i = 0; i < MeshProtocol::HEADER_SIZE; i++) {
+      vector[i] = static_cast<uint8_t>(i);
+    }
+    std::memcpy(vector + MeshProtocol::HEADER_SIZE, expectedMac, sizeof(expectedMac));
+    bool ok = MeshProtocol::verify(key, vector, sizeof(vector)) && !MeshProtocol::verify(ROGUE_KEY, vector, sizeof(vector));
+    if (!ok) {
+      std::printf("MAC が SipHash-2-4 の参照値と一致しません\n");
+    }
+
+    MeshTransport* transports[CHECK_NODES + 1];
+    MeshCoordinator* nodes[CHECK_NODES + 1];
+    for (size_t i = 0; i <= CHECK_NODES; i++) {
+      transports[i] = new MeshTransport(port);
+      transports[i]->setNodeId(static_cast<uint32_t>(i + 1));
+      if (!transports[i]->begin()) {
+        Logger::flush();
+        return 1;
+      }
+      nodes[i] = new MeshCoordinator(*transports[i], i == 0 || i == CHECK_NODES, i == CHECK_NODES ? ROGUE_KEY : NODE_KEY);
+    }
+    MeshCoordinator& rogue = *nodes[CHECK_NODES];
+
+    // 送信されたメッセージを記録するだけのノード
+    MeshTransport sniffer(port);
+    sniffer.setNodeId(0xFFFF);
+    if (!sniffer.begin()) {
+      Logger::flush();
+      return 1;
+    }
+    uint8_t captured[CHECK_CAPTURES][MeshProtocol::MAX_MESSAGE_SIZE];
+    size_t capturedLength[CHECK_CAPTURES];
+    size_t captureCount = 0;
+
+    nodes[0]->publishForecast(dummyForecast(), nowMs());
+    MeshForecast forged = dummyForecast();
+    forged.epoch += 86400;
+    forged.tempMin = 40.0f;
+    rogue.publishForecast(forged, nowMs());
+    bool started[CHECK_NODES] = {};
+    size_t startCount = 0;
+    rogue.requestStart(nowMs());
+    while (nowMs() < CHECK_DURATION_MS) {
+      rogue.service(nowMs());
+      size_t length;
+      while (captureCount < CHECK_CAPTURES && (length = sniffer.receive(captured[captureCount])) > 0) {
+        capturedLength[captureCount++] = length;
+      }
+      for (size_t i = 0; i < CHECK_NODES; i++) {
+        nodes[i]->service(nowMs());
+        if (!started[i] && nodes[i]->requestStart(nowMs())) {
+          started[i] = true;
+          startCount++;
+          std::printf("ノード %zu: 起動 (%u ms)\n", i + 1, nowMs());
+        }
+      }
+      Logger::drain();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ok = ok && startCount == MeshCoordinator::MAX_STARTS_PER_WINDOW;
+    for (size_t i = 1; i < CHECK_NODES; i++) {
+      MeshForecast forecast;
+      uint32_t ageMs;
+      bool received = nodes[i]->getForecast(forecast, ageMs, nowMs());
+      std::printf("ノード %zu: 天気予報 %s, ピア %zu 台\n", i + 1, received ? "受信" : "未受信",
+                  nodes[i]->getPeerCount(nowMs()));
+      ok = ok && received && forecast.tempMin == -0.5f && nodes[i]->getForecastGeneration() == 1 &&
+           nodes[i]->getPeerCount(nowMs()) <= CHECK_NODES - 1;  // 鍵の違うノードは数えない
+    }
+
+    // 記録したメッセージの再送
+    for (size_t i = 0; i < captureCount; i++) {
+      sniffer.broadcast(captured[i], capturedLength[i]);
+    }
+    uint32_t replayEnd = nowMs() + REPLAY_DURATION_MS;
+    while (static_cast<int32_t>(nowMs() - replayEnd) < 0) {
+      for (size_t i = 0; i < CHECK_NODES; i++) {
+        nodes[i]->service(nowMs());
+      }
+      Logger::drain();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (size_t i = 1; i < CHECK_NODES; i++) {
+      std::printf("ノード %zu: 再送として破棄 %u 件\n", i + 1, nodes[i]->getReplayedCount());
+      ok = ok && nodes[i]->getReplayedCount() > 0 && nodes[i]->getForecastGeneration() == 1;
+    }
+    std::printf("記録したメッセージ %zu 件を再送\n", captureCount);
+    Logger::flush();
+    std::printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  bool source = false;
+  bool check = false;
+  uint32_t nodeId = 0;
+  uint32_t startIntervalSec = 45;
+  uint16_t port = MeshTransport::DEFAULT_UDP_PORT;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "-source") == 0) {
+      source = true;
+    } else if (std::strcmp(argv[i], "--check") == 0) {
+      check = true;
+    } else if (std::strcmp(argv[i], "-id") == 0 && i + 1 < argc) {
+      nodeId = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+    } else if (std::strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+      startIntervalSec = static_cast<uint32_t>(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      port = static_cast<uint16_t>(std::atoi(argv[++i]));
+    } else {
+      printUsage();
+      return 1;
+    }
+  }
+
+  Logger::begin();
+  if (check) {
+    return runCheck(port);
+  }
+
+  MeshTransport transport(port);
+  transport.setNodeId(nodeId);
+  if (!transport.begin()) {
+    Logger::flush();
+    return 1;
+  }
+  MeshCoordinator node(transport, source, NODE_KEY);
+
+  uint32_t lastPublish = 0;
+  uint32_t lastStart = 0;
+  bool wantStart = false;
+  if (source) {
+    node.publishForecast(dummyForecast(), nowMs());
+  }
+  for (;;) {
+    uint32_t now = nowMs();
+    node.service(now);
+    if (source && now - lastPublish >= SOURCE_PUBLISH_INTERVAL_MS) {
+      lastPublish = now;
+      node.publishForecast(dummyForecast(), now);
+    }
+    // 一定間隔で停止→運転を繰り返す想定で起動を要求
+    if (!wantStart && now - lastStart >= startIntervalSec * 1000) {
+      wantStart = true;
+    }
+    if (wantStart && node.requestStart(now)) {
+      wantStart = false;
+      lastStart = now;
+      std::printf("起動 (%u 秒, ピア %zu 台)\n", now / 1000, node.getPeerCount(now));
+      std::fflush(stdout);
+    }
+    Logger::drain();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+}
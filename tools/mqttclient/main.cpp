@@ -0,0 +1,109 @@
+/**
+ * main.cpp（MQTTクライアントのホスト実行）
+ *
+ * ファームウェアと同じ MqttClient をホストで動かし、ローカルのブローカー（mosquitto など）に
+ * ダミーの温湿度・稼働状況を送信します。受信したコマンドはモード変更として送り返します。
+ *
+ * 使い方:
+ *   mqttclient [-h ホスト] [-p ポート] [-t ベーストピック] [-s 実行秒数]
+ *
+ * 例:
+ *   mosquitto -p 1883 &
+ *   mosquitto_sub -t 'aircon/#' -v &
+ *   mqttclient -t aircon/test &
+ *   mosquitto_pub -t aircon/test/cmd/mode -m cooling_25 -q 1
+ *   mosquitto_pub -t aircon/test/cmd/setpoint -m 24.0,26.0
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Logger.h"
+#include "MqttClient.h"
+#include "StatusFormat.h"
+
+namespace {
+  constexpr uint32_t SAMPLE_INTERVAL_MS = 2000;   // ファームウェアのセンサー読み取り間隔
+  constexpr uint32_t HEALTH_INTERVAL_MS = 10000;
+
+  void printUsage() {
+    std::fprintf(stderr, "使い方: mqttclient [-h ホスト] [-p ポート] [-t ベーストピック] [-s 実行秒数]\n");
+  }
+
+  uint32_t elapsedMs(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const char* host = "localhost";
+  uint16_t port = 1883;
+  const char* baseTopic = "aircon/test";
+  uint32_t durationSec = 0;
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) {
+      printUsage();
+      return 1;
+    }
+    if (std::strcmp(argv[i], "-h") == 0) {
+      host = argv[++i];
+    } else if (std::strcmp(argv[i], "-p") == 0) {
+      port = static_cast<uint16_t>(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "-t") == 0) {
+      baseTopic = argv[++i];
+    } else if (std::strcmp(argv[i], "-s") == 0) {
+      durationSec = static_cast<uint32_t>(std::atoi(argv[++i]));
+    } else {
+      printUsage();
+      return 1;
+    }
+  }
+
+  Logger::begin();
+  MqttClient mqtt(host, port, "aircon-host", baseTopic);
+  mqtt.publishMode(ACMode::OFF);
+
+  const auto start = std::chrono::steady_clock::now();
+  uint32_t lastSample = 0;
+  uint32_t lastHealth = 0;
+  while (durationSec == 0 || elapsedMs(start) < durationSec * 1000) {
+    mqtt.service(100);
+    Logger::drain();
+
+    uint32_t now = elapsedMs(start);
+    if (now - lastSample >= SAMPLE_INTERVAL_MS) {
+      lastSample = now;
+      float t = now / 1000.0f;
+      SensorData data(25.0f + 1.5f * std::sin(t / 60.0f), 55.0f + 5.0f * std::cos(t / 90.0f), true);
+      data.discomfortIndex = discomfortIndex(data.temperature, data.humidity);
+      mqtt.publishSample(data);
+    }
+    if (now - lastHealth >= HEALTH_INTERVAL_MS) {
+      lastHealth = now;
+      StatusSnapshot status = {};
+      status.uptimeMs = now;
+      status.cpuMHz = 1;
+      status.logDropped = Logger::getDroppedCount();
+      mqtt.publishHealth(status);
+    }
+
+    // loop() と同様にコマンドを取り出して反映
+    MqttCommand command;
+    while (mqtt.pollCommand(command)) {
+      if (command.type == MqttCommandType::MODE) {
+        std::printf("コマンド: モード %s\n", StatusFormat::modeName(command.mode));
+        mqtt.publishMode(command.mode);
+      } else {
+        std::printf("コマンド: 目標室温 %.1f〜%.1f℃\n", command.tempLower, command.tempUpper);
+      }
+      std::fflush(stdout);
+    }
+  }
+
+  Logger::flush();
+  std::printf("送信キュー残り %zu 件, 破棄 %u 件\n", mqtt.getQueuedCount(), mqtt.getDroppedCount());
+  return 0;
+}
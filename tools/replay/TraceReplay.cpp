@@ -0,0 +1,170 @@
+/**
+ * TraceReplay.cpp
+ *
+ * 制御の入力トレースの再生の実装
+ */
+
+#include "TraceReplay.h"
+
+TraceReplay::TraceReplay(const ModulatorParams& params)
+  : params_(params),
+    policy_(),
+    modulator_(params),
+    overridden_(false),
+    stats_(),
+    diffHandler_(nullptr),
+    diffContext_(nullptr) {
+  reset();
+}
+
+void TraceReplay::setThresholdOverride(const PolicyThresholds& thresholds) {
+  policy_.setThresholds(thresholds);
+  overridden_ = true;
+}
+
+/**
+ * 起動直後の状態に戻す（ファームウェアの再起動と同じく、モード・調整の状態は引き継がない）
+ */
+void TraceReplay::reset() {
+  modulator_ = SetpointModulator(params_);
+  mode_ = ACMode::NONE;
+  command_ = ACCommand();
+  temperature_ = 0.0f;
+  humidity_ = 0.0f;
+  weather_ = WeatherData();
+  started_ = false;
+  lastTimeMs_ = 0;
+  hasDecided_ = false;
+  lastRecorded_ = 0;
+  lastReplayed_ = 0;
+}
+
+size_t TraceReplay::replay(const uint8_t* data, size_t length) {
+  size_t pos = 0;
+  while (pos + TraceBlockHeader::SIZE <= length) {
+    TraceBlockHeader header;
+    if (!header.deserialize(data + pos) || pos + TraceBlockHeader::SIZE + header.payloadLength > length) {
+      break;
+    }
+    TraceDecoder decoder(header, data + pos + TraceBlockHeader::SIZE);
+    TraceEvent event;
+    uint16_t decoded = 0;
+    while (decoder.next(event)) {
+      feed(event);
+      decoded++;
+    }
+    if (decoded != header.recordCount) {
+      break;
+    }
+    pos += TraceBlockHeader::SIZE + header.payloadLength;
+  }
+  return pos;
+}
+
+void TraceReplay::feed(const TraceEvent& event) {
+  stats_.records++;
+  if (event.kind == TraceKind::BOOT) {
+    stats_.boots++;
+    reset();
+  }
+  if (started_) {
+    stats_.spanMs += event.timeMs - lastTimeMs_;
+  }
+  started_ = true;
+  lastTimeMs_ = event.timeMs;
+
+  switch (event.kind) {
+    case TraceKind::SAMPLE:
+      stats_.samples++;
+      temperature_ = event.temperature;
+      humidity_ = event.humidity;
+      modulator_.onReading(event.timeMs, event.temperature);
+      break;
+    case TraceKind::CONTROL:
+      decide(event);
+      break;
+    case TraceKind::WEATHER:
+      weather_.isValid = event.weatherValid;
+      weather_.tempMax = event.tempMax;
+      weather_.tempMin = event.tempMin;
+      weather_.weatherCode = event.weatherCode;
+      break;
+    case TraceKind::THRESHOLDS:
+      if (!overridden_) {
+        policy_.setThresholds(event.thresholds);
+      }
+      break;
+    case TraceKind::MODE:
+      stats_.manualModes++;
+      applyCommand(ACCommand::fromMode(static_cast<ACMode>(event.mode)));
+      break;
+    case TraceKind::IR:
+      stats_.irFrames++;
+      break;
+    case TraceKind::BOOT:
+      break;
+  }
+}
+
+/**
+ * ファームウェアの制御周期1回分（determineOptimalMode() / determineCommand() と setMode() / setCommand()）
+ */
+void TraceReplay::decide(const TraceEvent& event) {
+  stats_.decisions++;
+  bool modulated = (event.flags & TraceFlag::MODULATED) != 0;
+
+  // 判定に渡した現在のモードが記録と異なる場合、閾値が同じなら記録に合わせる
+  // （送信待ちの間に判定した場合など。合わせないと以降の判定がすべてずれる）
+  ACMode current = modulated ? modulator_.getBaselineMode() : mode_;
+  if (static_cast<uint8_t>(current) != event.mode) {
+    stats_.stateDrifts++;
+    if (!overridden_ && !modulated) {
+      mode_ = static_cast<ACMode>(event.mode);
+      current = mode_;
+    }
+  }
+
+  ReplayDiff diff = {&event, modulated, event.result, 0, PolicyReason::TIME_UNAVAILABLE, temperature_, humidity_};
+  if (!(event.flags & TraceFlag::TIME_VALID)) {
+    diff.replayed = static_cast<uint32_t>(ACMode::OFF);
+    applyCommand(ACCommand::fromMode(ACMode::OFF));
+  } else {
+    PolicyInput input = ControlPolicy::makeInput(temperature_, humidity_, event.timeinfo, weather_);
+    PolicyDecision decision = policy_.decide(input, current);
+    diff.reason = decision.reason;
+    if (modulated) {
+      ACCommand command = modulator_.update(decision, temperature_, policy_.getThresholds(), command_, event.timeMs);
+      diff.replayed = command.packed();
+      applyCommand(command);
+    } else {
+      diff.replayed = static_cast<uint32_t>(decision.mode);
+      applyCommand(ACCommand::fromMode(decision.mode));
+    }
+  }
+
+  if (hasDecided_) {
+    stats_.recordedChanges += diff.recorded != lastRecorded_ ? 1 : 0;
+    stats_.replayedChanges += diff.replayed != lastReplayed_ ? 1 : 0;
+  }
+  hasDecided_ = true;
+  lastRecorded_ = diff.recorded;
+  lastReplayed_ = diff.replayed;
+
+  if (diff.replayed != diff.recorded) {
+    stats_.mismatches++;
+    if (diffHandler_) {
+      diffHandler_(diff, diffContext_);
+    }
+  }
+}
+
+/**
+ * 指令を反映（AirConditionerController::setCommand() と同じく、同じ指令・不明な指令は変更しない）
+ */
+void TraceReplay::applyCommand(const ACCommand& command) {
+  if (!command.isKnown() || command.diff(command_) == 0) {
+    return;
+  }
+  command_ = command;
+  mode_ = command.toMode();
+}
@@ -0,0 +1,103 @@
+/**
+ * TraceReplay.h
+ *
+ * 制御の入力トレースの再生
+ * 記録した入力をファームウェアと同じ順番で ControlPolicy・SetpointModulator に渡し、
+ * 判定の結果を記録と比べます。判定した結果は setMode() / setCommand() と同じく
+ * 現在のモード・指令に反映し、次の判定に渡します（待機なしで実行するため実時間より速く再生できます）。
+ *
+ * 閾値を差し替えた場合は記録の閾値（設定の変更・ピーク時間帯）の代わりに使い、
+ * 判定が記録とどう変わるかを数えます。
+ */
+
+#ifndef REPLAY_TRACE_REPLAY_H
+#define REPLAY_TRACE_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "TraceCodec.h"
+#include "ControlPolicy.h"
+#include "ACCommand.h"
+#include "SetpointModulator.h"
+#include "WeatherData.h"
+
+// 再生の集計
+struct ReplayStats {
+  uint32_t records = 0;          // 復号したレコード数
+  uint32_t samples = 0;          // センサーの読み取り
+  uint32_t decisions = 0;        // 判定
+  uint32_t mismatches = 0;       // 記録と異なる判定
+  uint32_t stateDrifts = 0;      // 判定に渡した現在のモードが記録と異なる（送信待ちの間の判定など）
+  uint32_t boots = 0;
+  uint32_t manualModes = 0;      // 手動のモード指定
+  uint32_t irFrames = 0;         // 受信した赤外線信号
+  uint32_t recordedChanges = 0;  // 記録の判定の結果が前回の判定から変わった回数
+  uint32_t replayedChanges = 0;  // 再生の判定の結果が前回の判定から変わった回数
+  uint64_t spanMs = 0;           // 記録の期間（起動ごとの合計）
+};
+
+// 記録と異なる判定（1件ごとに呼ばれる）
+struct ReplayDiff {
+  const TraceEvent* event;  // CONTROL のレコード
+  bool modulated;           // true: recorded / replayed は ACCommand::packed()、false: ACMode
+  uint32_t recorded;
+  uint32_t replayed;
+  PolicyReason reason;      // 再生のオン・オフ制御の判定理由
+  float temperature;
+  float humidity;
+};
+
+typedef void (*ReplayDiffHandler)(const ReplayDiff& diff, void* context);
+
+class TraceReplay {
+public:
+  explicit TraceReplay(const ModulatorParams& params = DEFAULT_MODULATOR_PARAMS);
+
+  // 記録の閾値の代わりに使う閾値（差し替えた場合、判定に渡す現在のモードは記録に合わせない）
+  void setThresholdOverride(const PolicyThresholds& thresholds);
+
+  // 記録と異なる判定を受け取る関数
+  void setDiffHandler(ReplayDiffHandler handler, void* context) {
+    diffHandler_ = handler;
+    diffContext_ = context;
+  }
+
+  /**
+   * ブロックを順に復号して再生
+   * @return 再生したバイト数（length 未満: その位置のブロックが壊れている）
+   */
+  size_t replay(const uint8_t* data, size_t length);
+
+  // 1件分を再生
+  void feed(const TraceEvent& event);
+
+  const ReplayStats& getStats() const { return stats_; }
+
+private:
+  void reset();
+  void decide(const TraceEvent& event);
+  void applyCommand(const ACCommand& command);
+
+  ModulatorParams params_;
+  ControlPolicy policy_;
+  SetpointModulator modulator_;
+  bool overridden_;
+
+  // 起動ごとの状態（BOOT で初期化）
+  ACMode mode_;        // AirConditionerController::getCurrentMode() 相当
+  ACCommand command_;  // AirConditionerController::getCurrentCommand() 相当
+  float temperature_;
+  float humidity_;
+  WeatherData weather_;
+  bool started_;       // 起動後のレコードを受け取った
+  uint32_t lastTimeMs_;
+  bool hasDecided_;    // 起動後に判定した（変更回数の比較用）
+  uint32_t lastRecorded_;
+  uint32_t lastReplayed_;
+
+  ReplayStats stats_;
+  ReplayDiffHandler diffHandler_;
+  void* diffContext_;
+};
+
+#endif // REPLAY_TRACE_REPLAY_H
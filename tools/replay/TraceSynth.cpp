@@ -0,0 +1,232 @@
+/**
+ * TraceSynth.cpp
+ *
+ * 確認用の入力トレースの生成の実装
+ */
+
+#include "TraceSynth.h"
+
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+namespace {
+  // ファームウェアの設定（main.cpp の TimingConfig・SensorConfig・MqttConfig・EnergyConfig と同じ値）
+  constexpr uint32_t BOOT_MS = 3000;                 // 起動から記録の開始まで
+  constexpr uint32_t SENSOR_MIN_INTERVAL_MS = 2000;
+  constexpr uint32_t SENSOR_MAX_INTERVAL_MS = 30000;
+  constexpr uint32_t CONTROL_INTERVAL_MS = 300000;
+  constexpr uint32_t MANUAL_HOLD_MS = 3600000;
+  constexpr uint32_t FLUSH_INTERVAL_MS = 10 * 60000; // TraceRecorder::FLUSH_INTERVAL_MS
+  constexpr float TEMP_OFFSET = -1.6f;
+  constexpr float HUM_OFFSET = -1.0f;
+  constexpr int PEAK_START_HOUR = 13;
+  constexpr int PEAK_END_HOUR = 16;
+  constexpr float PEAK_SETBACK = 0.5f;
+
+  // 外気（東京の月平均気温、日較差は OUTDOOR_SWING の2倍）
+  constexpr float OUTDOOR_MEAN[12] = {5.4f, 6.1f, 9.4f, 14.3f, 18.8f, 21.9f, 25.7f, 26.9f, 23.3f, 18.0f, 12.5f, 7.7f};
+  constexpr float OUTDOOR_SWING = 4.0f;
+  constexpr float OUTDOOR_HUMIDITY = 65.0f;
+  constexpr float SENSOR_NOISE = 0.1f;  // 読み取りの揺らぎの幅（℃・%）
+
+  // 手動のモード指定（開始から2日目の21時にリモコンで停止し、MQTT で停止を指定）
+  constexpr int MANUAL_DAY = 2;
+  constexpr int MANUAL_HOUR = 21;
+  constexpr int16_t IR_PROTOCOL_DAIKIN = 16;  // decode_type_t::DAIKIN
+  constexpr uint16_t IR_BITS_DAIKIN = 280;
+}
+
+TraceSynth::TraceSynth(const SynthConfig& config)
+  : config_(config),
+    out_(nullptr),
+    encoder_(),
+    records_(0),
+    room_(RoomParams(), ACParams()),
+    sampler_(SENSOR_MIN_INTERVAL_MS, SENSOR_MAX_INTERVAL_MS),
+    policy_(),
+    modulator_(),
+    mode_(ACMode::NONE),
+    command_(),
+    temperature_(0.0f),
+    humidity_(0.0f),
+    random_(config.seed),
+    inputsRecorded_(false),
+    lastThresholds_(),
+    lastTempMin_(0.0f) {
+}
+
+uint32_t TraceSynth::run(std::vector<uint8_t>& out) {
+  out_ = &out;
+  records_ = 0;
+
+  struct tm start = {};
+  start.tm_year = config_.year - 1900;
+  start.tm_mon = config_.month - 1;
+  start.tm_mday = 1;
+  time_t startEpoch = timegm(&start);  // 日本時間をそのまま UTC として扱う（gmtime_r で戻す）
+  float outdoorMean = OUTDOOR_MEAN[(config_.month - 1) % 12];
+  room_.reset(outdoorMean, 50.0f);
+
+  uint32_t nowMs = BOOT_MS;
+  TraceEvent event = {};
+  event.timeMs = nowMs;
+  event.kind = TraceKind::BOOT;
+  append(event);
+
+  uint32_t endMs = BOOT_MS + static_cast<uint32_t>(config_.days) * 86400000u;
+  uint32_t lastReadMs = nowMs;
+  uint32_t lastControlMs = nowMs - CONTROL_INTERVAL_MS;
+  uint32_t manualHoldStart = 0;
+  bool manualHold = false;
+  bool manualDone = false;
+  for (nowMs += SENSOR_MIN_INTERVAL_MS; nowMs < endMs; nowMs += sampler_.getIntervalMs()) {
+    time_t epoch = startEpoch + (nowMs - BOOT_MS) / 1000;
+    struct tm timeinfo;
+    gmtime_r(&epoch, &timeinfo);
+    float hour = timeinfo.tm_hour + timeinfo.tm_min / 60.0f;
+    float outdoor = outdoorMean + OUTDOOR_SWING * std::sin((hour - 9.0f) / 24.0f * 2.0f * static_cast<float>(M_PI));
+    room_.step((nowMs - lastReadMs) / 1000.0f, outdoor, OUTDOOR_HUMIDITY, hour, RoomModel::settingFor(command_));
+    lastReadMs = nowMs;
+
+    // DHT22 の 0.1 単位の値に補正を加える（EnvironmentSensor と同じ）
+    temperature_ = std::lround((room_.temperature() + noise()) * 10.0f) * 0.1f + TEMP_OFFSET;
+    humidity_ = std::lround((room_.humidity() + noise()) * 10.0f) * 0.1f + HUM_OFFSET;
+    sampler_.onReading(nowMs, true, temperature_, humidity_);
+    modulator_.onReading(nowMs, temperature_);
+    event = TraceEvent();
+    event.timeMs = nowMs;
+    event.kind = TraceKind::SAMPLE;
+    event.temperature = temperature_;
+    event.humidity = humidity_;
+    append(event);
+
+    if (!manualDone && timeinfo.tm_mday - 1 == MANUAL_DAY && timeinfo.tm_hour == MANUAL_HOUR) {
+      manualDone = true;
+      event = TraceEvent();
+      event.timeMs = nowMs;
+      event.kind = TraceKind::IR;
+      event.irProtocol = IR_PROTOCOL_DAIKIN;
+      event.irBits = IR_BITS_DAIKIN;
+      append(event);
+      event.kind = TraceKind::MODE;
+      event.mode = static_cast<uint8_t>(ACMode::OFF);
+      append(event);
+      applyCommand(ACCommand::fromMode(ACMode::OFF));
+      manualHold = true;
+      manualHoldStart = nowMs;
+    }
+    if (manualHold && nowMs - manualHoldStart >= MANUAL_HOLD_MS) {
+      manualHold = false;
+      lastControlMs = nowMs - CONTROL_INTERVAL_MS;
+    }
+    if (!manualHold && nowMs - lastControlMs >= CONTROL_INTERVAL_MS) {
+      lastControlMs = nowMs;
+      control(nowMs, timeinfo);
+    }
+  }
+
+  writeBlock();
+  out_ = nullptr;
+  return records_;
+}
+
+/**
+ * 制御周期1回分（ピーク時間帯の閾値・日ごとの天気予報を入力として記録してから判定）
+ */
+void TraceSynth::control(uint32_t nowMs, const struct tm& timeinfo) {
+  PolicyThresholds thresholds = DEFAULT_THRESHOLDS;
+  if (timeinfo.tm_hour >= PEAK_START_HOUR && timeinfo.tm_hour < PEAK_END_HOUR) {
+    thresholds.tempLower -= PEAK_SETBACK;
+    thresholds.tempUpper += PEAK_SETBACK;
+  }
+  policy_.setThresholds(thresholds);
+  sampler_.setThresholds(thresholds);
+
+  float outdoorMean = OUTDOOR_MEAN[(config_.month - 1) % 12];
+  WeatherData weather = {};
+  weather.isValid = true;
+  weather.tempMax = outdoorMean + OUTDOOR_SWING;
+  weather.tempMin = outdoorMean - OUTDOOR_SWING - 2.0f + (timeinfo.tm_mday % 4) * 1.5f;
+  weather.weatherCode = timeinfo.tm_mday % 3 == 0 ? 61 : 1;
+
+  TraceEvent event = {};
+  event.timeMs = nowMs;
+  if (!inputsRecorded_ || weather.tempMin != lastTempMin_) {
+    event.kind = TraceKind::WEATHER;
+    event.weatherValid = weather.isValid;
+    event.tempMax = weather.tempMax;
+    event.tempMin = weather.tempMin;
+    event.weatherCode = weather.weatherCode;
+    append(event);
+    lastTempMin_ = weather.tempMin;
+  }
+  if (!inputsRecorded_ || memcmp(&thresholds, &lastThresholds_, sizeof(thresholds)) != 0) {
+    event.kind = TraceKind::THRESHOLDS;
+    event.thresholds = thresholds;
+    append(event);
+    lastThresholds_ = thresholds;
+  }
+  inputsRecorded_ = true;
+
+  event = TraceEvent();
+  event.timeMs = nowMs;
+  event.kind = TraceKind::CONTROL;
+  event.timeinfo = timeinfo;
+  event.flags = TraceFlag::TIME_VALID;
+  PolicyInput input = ControlPolicy::makeInput(temperature_, humidity_, timeinfo, weather);
+  if (config_.modulated) {
+    ACMode baseline = modulator_.getBaselineMode();
+    PolicyDecision decision = policy_.decide(input, baseline);
+    ACCommand command = modulator_.update(decision, temperature_, thresholds, command_, nowMs);
+    event.flags |= TraceFlag::MODULATED;
+    event.mode = static_cast<uint8_t>(baseline);
+    event.result = command.packed();
+    applyCommand(command);
+  } else {
+    PolicyDecision decision = policy_.decide(input, mode_);
+    event.mode = static_cast<uint8_t>(mode_);
+    event.result = static_cast<uint32_t>(decision.mode);
+    applyCommand(ACCommand::fromMode(decision.mode));
+  }
+  append(event);
+}
+
+void TraceSynth::applyCommand(const ACCommand& command) {
+  if (command.isKnown() && command.diff(command_) != 0) {
+    command_ = command;
+    mode_ = command.toMode();
+  }
+}
+
+/**
+ * ブロックに追加（TraceRecorder::append() と同じく、満杯・書き出し間隔の経過で書き出す）
+ */
+void TraceSynth::append(const TraceEvent& event) {
+  if (!encoder_.append(event)) {
+    writeBlock();
+    encoder_.append(event);
+  }
+  records_++;
+  if (event.timeMs - encoder_.getHeader().startMs >= FLUSH_INTERVAL_MS) {
+    writeBlock();
+  }
+}
+
+void TraceSynth::writeBlock() {
+  if (encoder_.isEmpty()) {
+    return;
+  }
+  const TraceBlockHeader& header = encoder_.getHeader();
+  uint8_t raw[TraceBlockHeader::SIZE];
+  header.serialize(raw);
+  out_->insert(out_->end(), raw, raw + sizeof(raw));
+  out_->insert(out_->end(), encoder_.getPayload(), encoder_.getPayload() + header.payloadLength);
+  encoder_.reset();
+}
+
+// 読み取りの揺らぎ（±SENSOR_NOISE/2、線形合同法）
+float TraceSynth::noise() {
+  random_ = random_ * 1664525u + 1013904223u;
+  return ((random_ >> 8) / 16777216.0f - 0.5f) * SENSOR_NOISE;
+}
@@ -0,0 +1,71 @@
+/**
+ * TraceSynth.h
+ *
+ * 確認用の入力トレースの生成
+ * 部屋モデル（tools/simulator の RoomModel）をファームウェアと同じ手順
+ * （AdaptiveSampler の間隔での読み取り・5分ごとの判定・ピーク時間帯の閾値・手動のモード指定）で動かし、
+ * TraceRecorder と同じ形式・同じ書き出し間隔のトレースを作ります。
+ * 判定の結果も記録するため、再生すればすべて一致するはずです（--check で確認）。
+ */
+
+#ifndef REPLAY_TRACE_SYNTH_H
+#define REPLAY_TRACE_SYNTH_H
+
+#include <stdint.h>
+#include <vector>
+#include "TraceCodec.h"
+#include "ControlPolicy.h"
+#include "ACCommand.h"
+#include "SetpointModulator.h"
+#include "AdaptiveSampler.h"
+#include "WeatherData.h"
+#include "RoomModel.h"
+
+// 生成の設定
+struct SynthConfig {
+  int year = 2026;
+  int month = 7;             // 開始月（1日 0:00 から）
+  int days = 7;
+  bool modulated = false;    // true: 設定温度を調整する制御
+  uint32_t seed = 1;         // センサーの揺らぎの乱数
+};
+
+class TraceSynth {
+public:
+  explicit TraceSynth(const SynthConfig& config);
+
+  /**
+   * トレースを生成して out に追加
+   * @return 記録したレコード数
+   */
+  uint32_t run(std::vector<uint8_t>& out);
+
+private:
+  void append(const TraceEvent& event);
+  void writeBlock();
+  void control(uint32_t nowMs, const struct tm& timeinfo);
+  void applyCommand(const ACCommand& command);
+  float noise();
+
+  SynthConfig config_;
+  std::vector<uint8_t>* out_;
+  TraceEncoder encoder_;
+  uint32_t records_;
+
+  RoomModel room_;
+  AdaptiveSampler sampler_;
+  ControlPolicy policy_;
+  SetpointModulator modulator_;
+  ACMode mode_;
+  ACCommand command_;
+  float temperature_;
+  float humidity_;
+  uint32_t random_;
+
+  // TraceRecorder と同じく、変わった場合のみ記録する入力
+  bool inputsRecorded_;
+  PolicyThresholds lastThresholds_;
+  float lastTempMin_;
+};
+
+#endif // REPLAY_TRACE_SYNTH_H
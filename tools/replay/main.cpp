@@ -0,0 +1,252 @@
+/**
+ * main.cpp（入力トレースの再生）
+ *
+ * 使い方:
+ *   replay [--policy 下限,上限,ヒステリシス,湿度上限] [-v] <trace>...
+ *   replay --synth <出力> [--month 月] [--days 日数] [--modulate]
+ *   replay --check
+ *
+ * 例:
+ *   curl -o week.trace http://aircon.local/trace
+ *   replay week.trace                        記録と同じ判定になるか確認（不一致を表示）
+ *   replay --policy 24.0,26.8,0.6,65 week.trace   閾値を変えた場合に判定がどう変わるか
+ *
+ * トレースは GET /trace の出力（ブロックを古い順に連結したもの）です。複数指定した場合は順に再生します。
+ * --synth は部屋モデルで生成した確認用のトレースを書き出します。
+ * --check は1週間分のトレースを生成・再生し、すべての判定が一致し1秒未満で再生できることを確認します。
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "TraceReplay.h"
+#include "TraceSynth.h"
+
+namespace {
+  constexpr uint32_t MAX_PRINTED_DIFFS = 20;  // -v なしで表示する不一致の件数
+  constexpr double CHECK_LIMIT_SEC = 1.0;     // --check の再生時間の上限（1週間分）
+
+  void printUsage() {
+    std::fprintf(stderr,
+      "使い方: replay [--policy 下限,上限,ヒステリシス,湿度上限] [-v] <trace>...\n"
+      "        replay --synth <出力> [--month 月] [--days 日数] [--modulate]\n"
+      "        replay --check\n");
+  }
+
+  // "下限,上限,ヒステリシス,湿度上限" を解析（省略した項目は現在の閾値）
+  bool parsePolicy(const char* spec, PolicyThresholds& th) {
+    th = DEFAULT_THRESHOLDS;
+    return std::sscanf(spec, "%f,%f,%f,%f", &th.tempLower, &th.tempUpper, &th.tempHysteresis,
+                       &th.humidityUpper) >= 1;
+  }
+
+  bool readFile(const char* path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+  }
+
+  bool writeFile(const char* path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+  }
+
+  // 判定の結果の表示（例: "cooling_25"、調整時は "冷房 26.5℃"）
+  void formatResult(bool modulated, uint32_t value, char* out, size_t size) {
+    if (!modulated) {
+      std::snprintf(out, size, "%s", ControlPolicy::modeToString(static_cast<ACMode>(value)));
+      return;
+    }
+    ACCommand command = ACCommand::fromPacked(value);
+    if (!command.isKnown() || command.isOff()) {
+      std::snprintf(out, size, "%s", command.isOff() ? "停止" : "不明");
+    } else {
+      std::snprintf(out, size, "%s %.1f℃", ACCommand::operationToString(command.getOperation()),
+                    command.getSetpoint());
+    }
+  }
+
+  struct DiffPrinter {
+    bool verbose;
+    uint32_t printed;
+  };
+
+  void printDiff(const ReplayDiff& diff, void* context) {
+    DiffPrinter* printer = static_cast<DiffPrinter*>(context);
+    if (!printer->verbose && printer->printed >= MAX_PRINTED_DIFFS) {
+      return;
+    }
+    printer->printed++;
+    const struct tm& t = diff.event->timeinfo;
+    char recorded[32];
+    char replayed[32];
+    formatResult(diff.modulated, diff.recorded, recorded, sizeof(recorded));
+    formatResult(diff.modulated, diff.replayed, replayed, sizeof(replayed));
+    std::printf("  %04d-%02d-%02d %02d:%02d  室温 %5.2f℃ 湿度 %5.1f%%  記録: %-20s 再生: %s\n",
+                t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min,
+                diff.temperature, diff.humidity, recorded, replayed);
+  }
+
+  /**
+   * トレースを再生して結果を表示
+   * @return 再生にかかった時間（秒）
+   */
+  double replayAndReport(const char* name, const std::vector<uint8_t>& data, TraceReplay& replay,
+                         bool& complete) {
+    auto start = std::chrono::steady_clock::now();
+    size_t used = replay.replay(data.data(), data.size());
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    complete = used == data.size();
+    if (!complete) {
+      std::fprintf(stderr, "[Replay] %s: %zu バイト目のブロックが壊れているため以降を無視\n", name, used);
+    }
+    return elapsed;
+  }
+
+  void printSummary(const ReplayStats& s, size_t bytes, double elapsed, bool overridden, uint32_t printed) {
+    if (s.mismatches > printed) {
+      std::printf("  ...（ほか %u 件、-v ですべて表示）\n", s.mismatches - printed);
+    }
+    double days = s.spanMs / 86400000.0;
+    std::printf("[Replay] %zu バイト, %u 件（センサー %u, 判定 %u, 起動 %u, 手動 %u, 赤外線 %u）, 記録 %.2f 日分\n",
+                bytes, s.records, s.samples, s.decisions, s.boots, s.manualModes, s.irFrames, days);
+    std::printf("[Replay] 判定 %u 件: 一致 %u, %s %u, 現在のモードのずれ %u\n",
+                s.decisions, s.decisions - s.mismatches, overridden ? "変化" : "不一致", s.mismatches, s.stateDrifts);
+    std::printf("[Replay] 判定の切り替え: 記録 %u 回, 再生 %u 回\n", s.recordedChanges, s.replayedChanges);
+    std::printf("[Replay] 再生時間 %.1f ms（%.0f 倍速）\n", elapsed * 1000.0,
+                elapsed > 0.0 ? s.spanMs / 1000.0 / elapsed : 0.0);
+  }
+
+  /**
+   * 1週間分を生成して再生し、すべて一致・1秒未満を確認（冬のオン・オフ制御と夏の設定温度の調整）
+   */
+  int runCheck() {
+    const SynthConfig configs[] = {
+      {2026, 1, 7, false, 1},
+      {2026, 7, 7, true, 2},
+    };
+    bool ok = true;
+    for (const SynthConfig& config : configs) {
+      std::vector<uint8_t> data;
+      uint32_t records = TraceSynth(config).run(data);
+
+      TraceReplay replay;
+      bool complete;
+      double elapsed = replayAndReport("check", data, replay, complete);
+      const ReplayStats& s = replay.getStats();
+      std::printf("[Check] %d月 %s: %u 件 %zu バイト, 判定 %u 件（不一致 %u, ずれ %u, 切り替え %u 回）, 再生 %.1f ms\n",
+                  config.month, config.modulated ? "調整" : "オン・オフ", records, data.size(),
+                  s.decisions, s.mismatches, s.stateDrifts, s.recordedChanges, elapsed * 1000.0);
+      if (!complete || s.records != records || s.decisions == 0 || s.mismatches != 0 || s.stateDrifts != 0 ||
+          s.recordedChanges == 0 || s.manualModes != 1 || s.irFrames != 1) {
+        std::printf("[Check] NG: 再生の結果が記録と一致しません\n");
+        ok = false;
+      }
+      if (elapsed >= CHECK_LIMIT_SEC) {
+        std::printf("[Check] NG: 1週間分の再生に %.3f 秒（上限 %.1f 秒）\n", elapsed, CHECK_LIMIT_SEC);
+        ok = false;
+      }
+
+      // 閾値を下げると判定が変わる（差し替えが効いている）
+      PolicyThresholds lower = DEFAULT_THRESHOLDS;
+      lower.tempLower -= 3.0f;
+      lower.tempUpper -= 1.0f;
+      TraceReplay whatIf;
+      whatIf.setThresholdOverride(lower);
+      whatIf.replay(data.data(), data.size());
+      if (whatIf.getStats().mismatches == 0) {
+        std::printf("[Check] NG: 閾値を変えても判定が変わりません\n");
+        ok = false;
+      }
+    }
+    std::printf("[Check] %s\n", ok ? "OK" : "NG");
+    return ok ? 0 : 1;
+  }
+}
+
+int main(int argc, char** argv) {
+  PolicyThresholds thresholds;
+  bool overridden = false;
+  bool verbose = false;
+  const char* synthPath = nullptr;
+  SynthConfig synth;
+  std::vector<const char*> paths;
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--check") == 0) {
+      return runCheck();
+    } else if (std::strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+      if (!parsePolicy(argv[++i], thresholds)) {
+        printUsage();
+        return 1;
+      }
+      overridden = true;
+    } else if (std::strcmp(argv[i], "--synth") == 0 && i + 1 < argc) {
+      synthPath = argv[++i];
+    } else if (std::strcmp(argv[i], "--month") == 0 && i + 1 < argc) {
+      synth.month = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--days") == 0 && i + 1 < argc) {
+      synth.days = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--modulate") == 0) {
+      synth.modulated = true;
+    } else if (std::strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (argv[i][0] == '-') {
+      printUsage();
+      return 1;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+
+  if (synthPath) {
+    if (synth.month < 1 || synth.month > 12 || synth.days < 1) {
+      printUsage();
+      return 1;
+    }
+    std::vector<uint8_t> data;
+    uint32_t records = TraceSynth(synth).run(data);
+    if (!writeFile(synthPath, data)) {
+      std::fprintf(stderr, "[Replay] %s に書き込めません\n", synthPath);
+      return 1;
+    }
+    std::printf("[Replay] %s: %d日分 %u 件 %zu バイト\n", synthPath, synth.days, records, data.size());
+    return 0;
+  }
+
+  if (paths.empty()) {
+    printUsage();
+    return 1;
+  }
+
+  TraceReplay replay;
+  if (overridden) {
+    replay.setThresholdOverride(thresholds);
+  }
+  DiffPrinter printer = {verbose, 0};
+  replay.setDiffHandler(printDiff, &printer);
+
+  size_t bytes = 0;
+  double elapsed = 0.0;
+  for (const char* path : paths) {
+    std::vector<uint8_t> data;
+    if (!readFile(path, data)) {
+      std::fprintf(stderr, "[Replay] %s を開けません\n", path);
+      return 1;
+    }
+    bool complete;
+    elapsed += replayAndReport(path, data, replay, complete);
+    bytes += data.size();
+  }
+  printSummary(replay.getStats(), bytes, elapsed, overridden, printer.printed);
+  return !overridden && replay.getStats().mismatches != 0 ? 2 : 0;
+}
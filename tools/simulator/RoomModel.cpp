@@ -0,0 +1,111 @@
+/**
+ * RoomModel.cpp
+ *
+ * 部屋の熱・湿気モデルとエアコン能力モデルの実装
+ */
+
+#include "RoomModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  constexpr float ATMOSPHERIC_PRESSURE = 101325.0f;  // 大気圧（Pa）
+  constexpr float LATENT_HEAT = 2.45e6f;             // 水の蒸発潜熱（J/kg）
+  constexpr float COMPRESSOR_MIN_OUTPUT = 50.0f;     // 圧縮機運転とみなす最小能力（W）
+  constexpr float PI = 3.14159265f;
+}
+
+RoomModel::RoomModel(const RoomParams& room, const ACParams& ac)
+  : room_(room), ac_(ac), temperature_(20.0f), humidityRatio_(0.008f),
+    electricPower_(0.0f), compressorRunning_(false) {
+}
+
+void RoomModel::reset(float temperature, float humidity) {
+  temperature_ = temperature;
+  humidityRatio_ = humidityRatioFrom(temperature, humidity);
+  electricPower_ = 0.0f;
+  compressorRunning_ = false;
+}
+
+/**
+ * 飽和水蒸気圧（Pa、Magnus式）
+ */
+float RoomModel::saturationPressure(float temperature) {
+  return 610.94f * std::exp(17.625f * temperature / (temperature + 243.04f));
+}
+
+/**
+ * 相対湿度から絶対湿度（kg/kg）へ変換
+ */
+float RoomModel::humidityRatioFrom(float temperature, float relativeHumidity) {
+  float vapor = saturationPressure(temperature) * relativeHumidity / 100.0f;
+  return 0.622f * vapor / (ATMOSPHERIC_PRESSURE - vapor);
+}
+
+float RoomModel::humidity() const {
+  float vapor = humidityRatio_ * ATMOSPHERIC_PRESSURE / (0.622f + humidityRatio_);
+  return std::min(100.0f, 100.0f * vapor / saturationPressure(temperature_));
+}
+
+ACSetting RoomModel::settingFor(const ACCommand& command) {
+  if (!command.isKnown()) {
+    return {false, false, false, 0.0f};
+  }
+  float setpoint = command.getSetpoint();
+  switch (command.getOperation()) {
+    case ACOperation::HEAT: return {true, true, false, setpoint};
+    case ACOperation::COOL: return {true, false, false, setpoint};
+    case ACOperation::DRY:  return {true, false, true, setpoint};
+    default:                return {false, false, false, 0.0f};
+  }
+}
+
+void RoomModel::step(float dtSec, float outdoorTemp, float outdoorHumidity, float hour, const ACSetting& setting) {
+  // 内部発熱と日射（6〜18時の正弦波）
+  bool daytime = hour >= 7.0f && hour < 23.0f;
+  float gains = daytime ? room_.internalGainDay : room_.internalGainNight;
+  if (hour > 6.0f && hour < 18.0f) {
+    gains += room_.solarGainPeak * std::sin(PI * (hour - 6.0f) / 12.0f);
+  }
+
+  // エアコンの能力（正: 加熱, 負: 冷却）と消費電力
+  float sensible = 0.0f;
+  float latent = 0.0f;
+  electricPower_ = ac_.standbyPower;
+  compressorRunning_ = false;
+
+  if (setting.power) {
+    float output;
+    float cop;
+    if (setting.heating) {
+      output = std::min(ac_.heatCapacityMax, std::max(0.0f, ac_.capacityGain * (setting.setpoint - temperature_)));
+      cop = std::max(1.8f, 4.5f - 0.06f * (20.0f - outdoorTemp));
+      sensible = output;
+    } else {
+      float maxCapacity = ac_.coolCapacityMax * (setting.dry ? ac_.dryCapacityRatio : 1.0f);
+      float ratio = setting.dry ? ac_.drySensibleRatio : ac_.coolSensibleRatio;
+      output = std::min(maxCapacity, std::max(0.0f, ac_.capacityGain * (temperature_ - setting.setpoint)));
+      // 除湿運転は設定温度付近でも最低限の能力で運転を続ける
+      if (setting.dry) {
+        output = std::max(output, maxCapacity * 0.5f);
+      }
+      cop = std::max(2.0f, 4.0f - 0.07f * (outdoorTemp - 25.0f));
+      sensible = -output * ratio;
+      latent = output * (1.0f - ratio);
+    }
+    compressorRunning_ = output >= COMPRESSOR_MIN_OUTPUT;
+    electricPower_ = ac_.fanPower + output / cop;
+  }
+
+  // 室温の更新
+  float heatFlow = room_.heatLossUA * (outdoorTemp - temperature_) + gains + sensible;
+  temperature_ += heatFlow * dtSec / room_.heatCapacity;
+
+  // 絶対湿度の更新（換気・発湿・除湿）
+  float outdoorRatio = humidityRatioFrom(outdoorTemp, outdoorHumidity);
+  float ventilation = room_.airMass * room_.airChangesPerHour / 3600.0f;  // kg/s
+  float moistureFlow = ventilation * (outdoorRatio - humidityRatio_) + room_.moistureGain - latent / LATENT_HEAT;
+  humidityRatio_ += moistureFlow * dtSec / (room_.airMass * room_.moistureBuffer);
+  humidityRatio_ = std::max(0.0005f, humidityRatio_);
+}
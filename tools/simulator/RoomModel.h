@@ -0,0 +1,91 @@
+/**
+ * RoomModel.h
+ *
+ * 部屋の熱・湿気モデルとエアコン（インバーター機）の能力モデル
+ *
+ * - 室温: 1質点の熱容量モデル C·dT/dt = UA·(Tout − Tin) + 内部発熱 + 日射 + エアコン能力
+ * - 湿度: 絶対湿度の収支（換気・人体発湿・エアコンの除湿）
+ * - エアコン: 設定温度との差に比例した能力（最大能力で頭打ち）、外気温依存のCOP
+ */
+
+#ifndef SIM_ROOM_MODEL_H
+#define SIM_ROOM_MODEL_H
+
+#include "ControlPolicy.h"
+#include "ACCommand.h"
+
+// 部屋のパラメーター
+struct RoomParams {
+  float heatCapacity = 2.0e6f;      // 熱容量（J/K、空気＋家具＋内壁の実効値）
+  float heatLossUA = 60.0f;         // 熱損失係数（W/K）
+  float internalGainDay = 150.0f;   // 日中の内部発熱（W）
+  float internalGainNight = 80.0f;  // 夜間の内部発熱（W）
+  float solarGainPeak = 300.0f;     // 日射取得の最大値（W、正午）
+  float airMass = 60.0f;            // 室内空気の質量（kg）
+  float moistureBuffer = 10.0f;     // 内装材の吸放湿による湿気容量の倍率
+  float airChangesPerHour = 0.5f;   // 換気回数（回/h）
+  float moistureGain = 1.4e-5f;     // 人体・生活による発湿（kg/s ≒ 50g/h）
+};
+
+// エアコンのパラメーター
+struct ACParams {
+  float heatCapacityMax = 3600.0f;  // 最大暖房能力（W）
+  float coolCapacityMax = 2800.0f;  // 最大冷房能力（W）
+  float capacityGain = 1500.0f;     // 設定温度差あたりの能力（W/K）
+  float fanPower = 20.0f;           // 運転中の送風機電力（W）
+  float standbyPower = 1.0f;        // 待機電力（W）
+  float coolSensibleRatio = 0.75f;  // 冷房の顕熱比
+  float dryCapacityRatio = 0.4f;    // 除湿運転の能力比
+  float drySensibleRatio = 0.5f;    // 除湿運転の顕熱比
+};
+
+// エアコンの運転指令（モードから変換）
+struct ACSetting {
+  bool power;      // 電源
+  bool heating;    // 暖房（falseなら冷房系）
+  bool dry;        // 除湿運転
+  float setpoint;  // 設定温度（℃）
+};
+
+// 部屋モデルクラス
+class RoomModel {
+public:
+  RoomModel(const RoomParams& room, const ACParams& ac);
+
+  // 初期状態を設定
+  void reset(float temperature, float humidity);
+
+  /**
+   * 1ステップ進める
+   * @param dtSec 経過時間（秒）
+   * @param outdoorTemp 外気温（℃）
+   * @param outdoorHumidity 外気湿度（%）
+   * @param hour 時（日射・内部発熱の計算用）
+   * @param setting エアコンの運転指令
+   */
+  void step(float dtSec, float outdoorTemp, float outdoorHumidity, float hour, const ACSetting& setting);
+
+  // 現在の室温（℃）・相対湿度（%）
+  float temperature() const { return temperature_; }
+  float humidity() const;
+
+  // 直近ステップのエアコン消費電力（W）と能力出力有無
+  float electricPower() const { return electricPower_; }
+  bool compressorRunning() const { return compressorRunning_; }
+
+  // 指令をエアコンの運転指令に変換（送風・自動は停止として扱う）
+  static ACSetting settingFor(const ACCommand& command);
+
+private:
+  RoomParams room_;
+  ACParams ac_;
+  float temperature_;       // 室温（℃）
+  float humidityRatio_;     // 絶対湿度（kg/kg）
+  float electricPower_;     // 消費電力（W）
+  bool compressorRunning_;  // 圧縮機が能力を出しているか
+
+  static float saturationPressure(float temperature);
+  static float humidityRatioFrom(float temperature, float relativeHumidity);
+};
+
+#endif // SIM_ROOM_MODEL_H
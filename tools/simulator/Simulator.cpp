@@ -0,0 +1,118 @@
+/**
+ * Simulator.cpp
+ *
+ * 加速時間シミュレーターの実装
+ */
+
+#include "Simulator.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace {
+  // 評価用の快適帯（README の目標範囲）
+  constexpr float COMFORT_TEMP_LOWER = Threshold::TEMP_LOWER;
+  constexpr float COMFORT_TEMP_UPPER = Threshold::TEMP_UPPER;
+  constexpr float COMFORT_HUM_LOWER = Threshold::HUMIDITY_LOWER;
+  constexpr float COMFORT_HUM_UPPER = Threshold::HUMIDITY_UPPER;
+
+  // DHT22 の分解能（0.1）に丸める
+  float quantize(float value) {
+    return std::round(value * 10.0f) / 10.0f;
+  }
+}
+
+Simulator::Simulator(WeatherReplay& weather, const SimConfig& config)
+  : weather_(weather), config_(config) {
+}
+
+SimResult Simulator::run(SimPolicy& policy) {
+  auto wallStart = std::chrono::steady_clock::now();
+
+  SimResult result;
+  result.policyName = policy.name();
+
+  RoomModel room(config_.room, config_.ac);
+  room.reset(config_.initialTemperature, config_.initialHumidity);
+  weather_.rewind();
+
+  const double tick = config_.tickSec;
+  const double tickHours = tick / 3600.0;
+  const int64_t start = weather_.startEpoch();
+  const int64_t end = weather_.endEpoch();
+  const uint64_t ticks = static_cast<uint64_t>((end - start) / tick);
+  const uint64_t controlEvery = static_cast<uint64_t>(config_.controlIntervalSec / tick + 0.5);
+
+  ACCommand current;
+  ACSetting setting = RoomModel::settingFor(current);
+  bool wasRunning = false;
+  double tempSum = 0.0;
+  CivilTime civil = WeatherReplay::fromEpoch(start);
+  int64_t civilMinute = start / 60;
+
+  for (uint64_t i = 0; i < ticks; i++) {
+    double elapsed = static_cast<double>(i) * tick;
+    int64_t now = start + static_cast<int64_t>(elapsed);
+
+    // 暦の計算は分が変わったときだけ行う
+    if (now / 60 != civilMinute) {
+      civilMinute = now / 60;
+      civil = WeatherReplay::fromEpoch(now);
+    }
+    float hour = civil.hour + civil.minute / 60.0f;
+
+    float outdoorTemp;
+    float outdoorHum;
+    weather_.sample(now, outdoorTemp, outdoorHum);
+
+    // millis() 相当（ファームウェアと同じく約49日で一周する）
+    uint32_t nowMs = static_cast<uint32_t>(static_cast<uint64_t>(elapsed * 1000.0));
+    policy.observe(nowMs, quantize(room.temperature()));
+
+    // 制御周期ごとにポリシーを実行（ファームウェアと同じく初回は即時）
+    if (i % controlEvery == 0) {
+      PolicyInput input;
+      input.temperature = quantize(room.temperature());
+      input.humidity = quantize(room.humidity());
+      input.month = civil.month;
+      input.hour = civil.hour;
+      input.extremeCold = ControlPolicy::isExtremeCold(true, weather_.dailyMin(now));
+
+      ACCommand next = policy.decide(input, current, nowMs);
+      // setCommand() と同じく、指令が変わったときだけ送信
+      if (next != current && next.isKnown()) {
+        current = next;
+        setting = RoomModel::settingFor(current);
+        result.irSends++;
+      }
+    }
+
+    room.step(static_cast<float>(tick), outdoorTemp, outdoorHum, hour, setting);
+
+    // 評価指標の集計
+    result.energyKWh += room.electricPower() * tickHours / 1000.0;
+    if (room.compressorRunning() && !wasRunning) {
+      result.compressorStarts++;
+    }
+    wasRunning = room.compressorRunning();
+
+    float t = room.temperature();
+    float h = room.humidity();
+    tempSum += t;
+    if (t < COMFORT_TEMP_LOWER || t > COMFORT_TEMP_UPPER) {
+      result.hoursTempOutside += tickHours;
+      result.degreeHours += (t < COMFORT_TEMP_LOWER ? COMFORT_TEMP_LOWER - t : t - COMFORT_TEMP_UPPER) * tickHours;
+      if (civil.hour >= 7 && civil.hour < 23) {
+        result.daytimeHoursTempOutside += tickHours;
+      }
+    }
+    if (h < COMFORT_HUM_LOWER || h > COMFORT_HUM_UPPER) {
+      result.hoursHumOutside += tickHours;
+    }
+  }
+
+  result.simulatedHours = ticks * tickHours;
+  result.meanTemperature = ticks > 0 ? tempSum / ticks : 0.0;
+  result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  return result;
+}
@@ -0,0 +1,111 @@
+/**
+ * Simulator.h
+ *
+ * 加速時間の離散イベントシミュレーター
+ * ファームウェアと同じ周期（センサー2秒・制御5分）で制御ポリシーを動かし、
+ * 部屋モデルと過去の天気データを使って1年分を数秒で再生します。
+ */
+
+#ifndef SIM_SIMULATOR_H
+#define SIM_SIMULATOR_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ControlPolicy.h"
+#include "ACCommand.h"
+#include "SetpointModulator.h"
+#include "RoomModel.h"
+#include "WeatherReplay.h"
+
+// シミュレーション対象のポリシー（ファームウェアの determineOptimalMode / determineCommand 相当）
+class SimPolicy {
+public:
+  virtual ~SimPolicy() {}
+  virtual const std::string& name() const = 0;
+
+  // センサーの読み取りごとに呼ばれる（室温を平滑化するポリシー用）
+  virtual void observe(uint32_t /*nowMs*/, float /*temperature*/) {}
+
+  // 制御周期ごとに送信する指令を決定
+  virtual ACCommand decide(const PolicyInput& input, const ACCommand& current, uint32_t nowMs) = 0;
+};
+
+// 閾値付きの標準ポリシー（ControlPolicy をそのまま使用）
+class ThresholdPolicy : public SimPolicy {
+public:
+  ThresholdPolicy(const std::string& name, const PolicyThresholds& thresholds)
+    : name_(name), policy_(thresholds) {}
+
+  const std::string& name() const override { return name_; }
+  ACCommand decide(const PolicyInput& input, const ACCommand& current, uint32_t /*nowMs*/) override {
+    return ACCommand::fromMode(policy_.decide(input, current.toMode()).mode);
+  }
+
+private:
+  std::string name_;
+  ControlPolicy policy_;
+};
+
+// 設定温度を調整するポリシー（SetpointModulator をそのまま使用）
+class ModulatingPolicy : public SimPolicy {
+public:
+  ModulatingPolicy(const std::string& name, const PolicyThresholds& thresholds,
+                   const ModulatorParams& params = DEFAULT_MODULATOR_PARAMS)
+    : name_(name), policy_(thresholds), modulator_(params) {}
+
+  const std::string& name() const override { return name_; }
+  void observe(uint32_t nowMs, float temperature) override {
+    modulator_.onReading(nowMs, temperature);
+  }
+  ACCommand decide(const PolicyInput& input, const ACCommand& current, uint32_t nowMs) override {
+    PolicyDecision baseline = policy_.decide(input, modulator_.getBaselineMode());
+    return modulator_.update(baseline, input.temperature, policy_.getThresholds(), current, nowMs);
+  }
+
+private:
+  std::string name_;
+  ControlPolicy policy_;
+  SetpointModulator modulator_;
+};
+
+// シミュレーション設定
+struct SimConfig {
+  float tickSec = 2.0f;             // センサー読み取り周期（秒）
+  float controlIntervalSec = 300.0f;  // 制御周期（秒）
+  float initialTemperature = 22.0f; // 初期室温（℃）
+  float initialHumidity = 50.0f;    // 初期湿度（%）
+  RoomParams room;
+  ACParams ac;
+};
+
+// シミュレーション結果
+struct SimResult {
+  std::string policyName;
+  double simulatedHours = 0.0;     // シミュレーション時間（h）
+  double energyKWh = 0.0;          // 消費電力量の推定（kWh）
+  uint32_t irSends = 0;            // 赤外線送信回数
+  uint32_t compressorStarts = 0;   // 圧縮機の起動回数
+  double hoursTempOutside = 0.0;   // 室温が快適帯の外にあった時間（h）
+  double hoursHumOutside = 0.0;    // 湿度が快適帯の外にあった時間（h）
+  double daytimeHoursTempOutside = 0.0;  // 日中（7〜23時）に室温が快適帯の外にあった時間（h）
+  double degreeHours = 0.0;        // 快適帯からの逸脱量の積分（℃·h）
+  double meanTemperature = 0.0;    // 平均室温（℃）
+  double wallSeconds = 0.0;        // 実行時間（秒）
+};
+
+// シミュレータークラス
+class Simulator {
+public:
+  Simulator(WeatherReplay& weather, const SimConfig& config);
+
+  // 指定ポリシーで全期間をシミュレーション
+  SimResult run(SimPolicy& policy);
+
+private:
+  WeatherReplay& weather_;
+  SimConfig config_;
+};
+
+#endif // SIM_SIMULATOR_H
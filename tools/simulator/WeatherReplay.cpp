@@ -0,0 +1,191 @@
+/**
+ * WeatherReplay.cpp
+ *
+ * Open-Meteo 過去データ（CSV）の読み込みと再生の実装
+ */
+
+#include "WeatherReplay.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+  constexpr int64_t SECONDS_PER_DAY = 86400;
+  constexpr float DEFAULT_HUMIDITY = 60.0f;  // 湿度列がない場合の既定値
+
+  // 日付（年月日）から 1970-01-01 起点の通算日数を計算
+  int64_t daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+  }
+
+  // 通算日数から日付（年月日）を計算
+  void civilFromDays(int64_t z, int& y, int& m, int& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = static_cast<int>(yoe + era * 400 + (m <= 2));
+  }
+
+  // カンマ区切りで分割
+  std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+      fields.push_back(field);
+    }
+    return fields;
+  }
+
+  // "2023-01-01T00:00" 形式の時刻を解析
+  bool parseIsoMinute(const std::string& text, CivilTime& t) {
+    return std::sscanf(text.c_str(), "%d-%d-%dT%d:%d", &t.year, &t.month, &t.day, &t.hour, &t.minute) == 5;
+  }
+}
+
+int64_t WeatherReplay::toEpoch(const CivilTime& t) {
+  return daysFromCivil(t.year, t.month, t.day) * SECONDS_PER_DAY + t.hour * 3600 + t.minute * 60;
+}
+
+CivilTime WeatherReplay::fromEpoch(int64_t epochSec) {
+  CivilTime t;
+  int64_t days = epochSec >= 0 ? epochSec / SECONDS_PER_DAY : (epochSec - SECONDS_PER_DAY + 1) / SECONDS_PER_DAY;
+  int64_t secOfDay = epochSec - days * SECONDS_PER_DAY;
+  civilFromDays(days, t.year, t.month, t.day);
+  t.hour = static_cast<int>(secOfDay / 3600);
+  t.minute = static_cast<int>((secOfDay % 3600) / 60);
+  return t;
+}
+
+bool WeatherReplay::loadCsv(const std::string& path, std::string& error) {
+  std::ifstream in(path);
+  if (!in) {
+    error = "ファイルを開けません: " + path;
+    return false;
+  }
+
+  int timeCol = -1;
+  int tempCol = -1;
+  int humCol = -1;
+  size_t loaded = 0;
+  std::string line;
+
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+
+    // ヘッダー行（"time," で始まる行）から列位置を決定
+    if (line.compare(0, 5, "time,") == 0) {
+      std::vector<std::string> header = splitCsv(line);
+      timeCol = tempCol = humCol = -1;
+      for (size_t i = 0; i < header.size(); i++) {
+        if (header[i] == "time") {
+          timeCol = static_cast<int>(i);
+        } else if (header[i].compare(0, 14, "temperature_2m") == 0) {
+          tempCol = static_cast<int>(i);
+        } else if (header[i].compare(0, 20, "relative_humidity_2m") == 0) {
+          humCol = static_cast<int>(i);
+        }
+      }
+      continue;
+    }
+
+    // メタデータ行（緯度・経度など）はヘッダー前なので読み飛ばす
+    if (timeCol < 0 || tempCol < 0) {
+      continue;
+    }
+
+    std::vector<std::string> fields = splitCsv(line);
+    if (static_cast<int>(fields.size()) <= tempCol) {
+      continue;
+    }
+
+    CivilTime t;
+    if (!parseIsoMinute(fields[timeCol], t) || fields[tempCol].empty()) {
+      continue;  // 欠測値は補間に任せる
+    }
+
+    WeatherSample s;
+    s.epochSec = toEpoch(t);
+    s.temperature = std::strtof(fields[tempCol].c_str(), nullptr);
+    s.humidity = (humCol >= 0 && humCol < static_cast<int>(fields.size()) && !fields[humCol].empty())
+               ? std::strtof(fields[humCol].c_str(), nullptr) : DEFAULT_HUMIDITY;
+    samples_.push_back(s);
+    loaded++;
+  }
+
+  if (loaded == 0) {
+    error = "有効なデータ行がありません（temperature_2m 列が必要）: " + path;
+    return false;
+  }
+
+  std::sort(samples_.begin(), samples_.end(),
+            [](const WeatherSample& a, const WeatherSample& b) { return a.epochSec < b.epochSec; });
+  buildDailyMin();
+  rewind();
+  return true;
+}
+
+void WeatherReplay::buildDailyMin() {
+  firstDay_ = samples_.front().epochSec / SECONDS_PER_DAY;
+  int64_t lastDay = samples_.back().epochSec / SECONDS_PER_DAY;
+  dailyMin_.assign(static_cast<size_t>(lastDay - firstDay_ + 1), 1000.0f);
+  for (const WeatherSample& s : samples_) {
+    float& m = dailyMin_[static_cast<size_t>(s.epochSec / SECONDS_PER_DAY - firstDay_)];
+    m = std::min(m, s.temperature);
+  }
+}
+
+void WeatherReplay::sample(int64_t epochSec, float& temperature, float& humidity) {
+  // 範囲外は端の値を使用
+  if (epochSec <= samples_.front().epochSec) {
+    temperature = samples_.front().temperature;
+    humidity = samples_.front().humidity;
+    return;
+  }
+  if (epochSec >= samples_.back().epochSec) {
+    temperature = samples_.back().temperature;
+    humidity = samples_.back().humidity;
+    return;
+  }
+
+  // 時刻は単調増加なのでカーソルを進めるだけでよい
+  if (cursor_ >= samples_.size() - 1 || samples_[cursor_].epochSec > epochSec) {
+    cursor_ = 0;
+  }
+  while (samples_[cursor_ + 1].epochSec <= epochSec) {
+    cursor_++;
+  }
+
+  const WeatherSample& a = samples_[cursor_];
+  const WeatherSample& b = samples_[cursor_ + 1];
+  float ratio = static_cast<float>(epochSec - a.epochSec) / static_cast<float>(b.epochSec - a.epochSec);
+  temperature = a.temperature + (b.temperature - a.temperature) * ratio;
+  humidity = a.humidity + (b.humidity - a.humidity) * ratio;
+}
+
+float WeatherReplay::dailyMin(int64_t epochSec) const {
+  int64_t index = epochSec / SECONDS_PER_DAY - firstDay_;
+  if (index < 0 || index >= static_cast<int64_t>(dailyMin_.size())) {
+    return 1000.0f;
+  }
+  return dailyMin_[static_cast<size_t>(index)];
+}
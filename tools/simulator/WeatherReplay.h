@@ -0,0 +1,74 @@
+/**
+ * WeatherReplay.h
+ *
+ * Open-Meteo 過去データ（CSV）の読み込みと再生
+ * 毎時の外気温・湿度を線形補間して、任意の時刻の外気条件を返します。
+ */
+
+#ifndef SIM_WEATHER_REPLAY_H
+#define SIM_WEATHER_REPLAY_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// 1時間分の外気データ
+struct WeatherSample {
+  int64_t epochSec;   // ローカル時刻の通算秒（1970-01-01 00:00 起点）
+  float temperature;  // 外気温（℃）
+  float humidity;     // 外気湿度（%）
+};
+
+// 暦情報（ローカル時刻）
+struct CivilTime {
+  int year;
+  int month;   // 1-12
+  int day;     // 1-31
+  int hour;    // 0-23
+  int minute;  // 0-59
+};
+
+// 天気データ再生クラス
+class WeatherReplay {
+public:
+  /**
+   * Open-Meteo の CSV ファイルを読み込み（複数回呼び出すと連結）
+   * "time,temperature_2m (°C),relative_humidity_2m (%)" 形式のヘッダー行以降を解析します。
+   * @return true: 1行以上読み込み成功, false: 失敗
+   */
+  bool loadCsv(const std::string& path, std::string& error);
+
+  // データが存在するか
+  bool empty() const { return samples_.empty(); }
+
+  // 再生範囲（通算秒）
+  int64_t startEpoch() const { return samples_.front().epochSec; }
+  int64_t endEpoch() const { return samples_.back().epochSec; }
+  size_t size() const { return samples_.size(); }
+
+  /**
+   * 指定時刻の外気条件を取得（線形補間）
+   * 時刻は単調増加で呼び出すことを前提に、内部カーソルで探索を省略します。
+   */
+  void sample(int64_t epochSec, float& temperature, float& humidity);
+
+  // 指定日の最低気温（極寒日判定用の「完全な予報」）
+  float dailyMin(int64_t epochSec) const;
+
+  // カーソルを先頭に戻す
+  void rewind() { cursor_ = 0; }
+
+  // 通算秒と暦の相互変換
+  static int64_t toEpoch(const CivilTime& t);
+  static CivilTime fromEpoch(int64_t epochSec);
+
+private:
+  std::vector<WeatherSample> samples_;
+  std::vector<float> dailyMin_;  // 日ごとの最低気温（firstDay_ 起点）
+  int64_t firstDay_ = 0;
+  size_t cursor_ = 0;
+
+  void buildDailyMin();
+};
+
+#endif // SIM_WEATHER_REPLAY_H
@@ -0,0 +1,118 @@
+/**
+ * main.cpp（シミュレーター）
+ *
+ * 使い方:
+ *   simulator [--policy 名前,下限,上限,ヒステリシス,湿度上限]... [--modulate 名前,...]... <open-meteo.csv>...
+ *
+ * 例:
+ *   simulator --policy default,24.2,26.5,0.3,62 --policy wide,24.0,26.8,0.6,65 tokyo_2024.csv
+ *   simulator --policy default --modulate modulate tokyo_2024.csv
+ *
+ * --modulate は同じ閾値で設定温度を調整する制御（SetpointModulator）を実行します。
+ * 省略した場合は、現在のファームウェアの閾値と比較用の2種類、設定温度の調整を実行します。
+ * CSV は Open-Meteo Historical Weather API の CSV 出力
+ * （hourly=temperature_2m,relative_humidity_2m, timezone=Asia/Tokyo）を想定しています。
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Simulator.h"
+
+namespace {
+  void printUsage() {
+    std::fprintf(stderr,
+      "使い方: simulator [--policy 名前,下限,上限,ヒステリシス,湿度上限]... [--modulate 名前,...]... <open-meteo.csv>...\n");
+  }
+
+  // "名前,下限,上限,ヒステリシス,湿度上限" を解析
+  bool parsePolicy(const char* spec, std::string& name, PolicyThresholds& th) {
+    char buf[64];
+    th = DEFAULT_THRESHOLDS;
+    int fields = std::sscanf(spec, "%63[^,],%f,%f,%f,%f", buf, &th.tempLower, &th.tempUpper,
+                             &th.tempHysteresis, &th.humidityUpper);
+    if (fields < 1) {
+      return false;
+    }
+    name = buf;
+    return true;
+  }
+
+  void printResult(const SimResult& r) {
+    std::printf("%-12s %9.1f %8u %8u %9.1f %9.1f %9.1f %9.1f %7.2f %7.3f\n",
+                r.policyName.c_str(), r.energyKWh, r.irSends, r.compressorStarts,
+                100.0 * r.hoursTempOutside / r.simulatedHours,
+                100.0 * r.daytimeHoursTempOutside / r.simulatedHours,
+                100.0 * r.hoursHumOutside / r.simulatedHours,
+                r.degreeHours, r.meanTemperature, r.wallSeconds);
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<std::unique_ptr<SimPolicy>> policies;
+  WeatherReplay weather;
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+      std::string name;
+      PolicyThresholds th;
+      if (!parsePolicy(argv[++i], name, th)) {
+        printUsage();
+        return 1;
+      }
+      policies.emplace_back(new ThresholdPolicy(name, th));
+    } else if (std::strcmp(argv[i], "--modulate") == 0 && i + 1 < argc) {
+      std::string name;
+      PolicyThresholds th;
+      if (!parsePolicy(argv[++i], name, th)) {
+        printUsage();
+        return 1;
+      }
+      policies.emplace_back(new ModulatingPolicy(name, th));
+    } else if (argv[i][0] == '-') {
+      printUsage();
+      return 1;
+    } else {
+      std::string error;
+      if (!weather.loadCsv(argv[i], error)) {
+        std::fprintf(stderr, "[Sim] %s\n", error.c_str());
+        return 1;
+      }
+    }
+  }
+
+  if (weather.empty()) {
+    printUsage();
+    return 1;
+  }
+
+  // ポリシー未指定時は現在の閾値とヒステリシス違い・設定温度の調整を比較
+  if (policies.empty()) {
+    PolicyThresholds narrow = DEFAULT_THRESHOLDS;
+    narrow.tempHysteresis = 0.1f;
+    PolicyThresholds wide = DEFAULT_THRESHOLDS;
+    wide.tempHysteresis = 0.6f;
+    policies.emplace_back(new ThresholdPolicy("default", DEFAULT_THRESHOLDS));
+    policies.emplace_back(new ThresholdPolicy("hyst0.1", narrow));
+    policies.emplace_back(new ThresholdPolicy("hyst0.6", wide));
+    policies.emplace_back(new ModulatingPolicy("modulate", DEFAULT_THRESHOLDS));
+  }
+
+  CivilTime from = WeatherReplay::fromEpoch(weather.startEpoch());
+  CivilTime to = WeatherReplay::fromEpoch(weather.endEpoch());
+  std::printf("[Sim] 天気データ: %zu 時間分 (%04d-%02d-%02d 〜 %04d-%02d-%02d)\n",
+              weather.size(), from.year, from.month, from.day, to.year, to.month, to.day);
+
+  SimConfig config;
+  Simulator simulator(weather, config);
+
+  std::printf("%-12s %9s %8s %8s %9s %9s %9s %9s %7s %7s\n",
+              "policy", "kWh", "IR送信", "起動", "温度外%", "日中外%", "湿度外%", "℃·h", "平均℃", "秒");
+  for (auto& policy : policies) {
+    printResult(simulator.run(*policy));
+  }
+  return 0;
+}
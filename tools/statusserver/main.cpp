@@ -0,0 +1,223 @@
+/**
+ * main.cpp（ステータスサーバーのホスト実行）
+ *
+ * ファームウェアと同じ StatusServer をホストで起動し、ダミーの状態を1秒ごとに公開します。
+ * curl や Prometheus から /status・/metrics・/config を確認できます。
+ *
+ * 使い方:
+ *   statusserver [-p ポート]   # 待ち受けを続ける（既定 8080）
+ *   statusserver --check       # 空きポートで起動し、内蔵クライアントで各エンドポイントを確認して終了
+ *
+ * 例:
+ *   statusserver -p 8080 &
+ *   curl -s localhost:8080/status
+ *   curl -s localhost:8080/metrics
+ *   curl -s -X POST -H 'Authorization: Bearer check-token' -d 'tempLower=24.0&tempUpper=26.0' localhost:8080/config
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "ConfigManager.h"
+#include "Logger.h"
+#include "LoopProfiler.h"
+#include "SensorData.h"
+#include "StatusServer.h"
+
+namespace {
+  constexpr uint16_t DEFAULT_PORT = 8080;
+  constexpr uint32_t PUBLISH_INTERVAL_MS = 1000;
+  const char* const CONFIG_TOKEN = "check-token";  // POST /config のトークン
+
+  void printUsage() {
+    std::fprintf(stderr, "使い方: statusserver [-p ポート] [--check]\n");
+  }
+
+  // 時間とともに変化するダミーの状態を作成
+  void buildSnapshot(StatusSnapshot& status, uint32_t uptimeMs, const LoopProfiler& profiler) {
+    float t = uptimeMs / 1000.0f;
+    status.uptimeMs = uptimeMs;
+    status.sensorValid = true;
+    status.temperature = 25.0f + 1.5f * std::sin(t / 60.0f);
+    status.humidity = 55.0f + 5.0f * std::cos(t / 90.0f);
+    status.discomfortIndex = discomfortIndex(status.temperature, status.humidity);
+    status.sensorIntervalMs = 16000;
+    status.sensorReadsPerHour = 412.0f;
+    status.sensorReads = uptimeMs / 8000;
+    status.sensorReadsSaved = uptimeMs / 2000 - uptimeMs / 8000;
+    status.weatherValid = true;
+    status.tempMax = 31.2f;
+    status.tempMin = 24.8f;
+    status.weatherCode = 3;
+    status.weatherAgeMs = uptimeMs % 3600000;
+    status.weatherSource = "open-meteo";
+    status.weatherRefreshFailures = 0;
+    status.acMode = status.temperature > 26.0f ? ACMode::COOLING_25 : ACMode::OFF;
+    status.acSetpoint = status.acMode == ACMode::OFF ? 0.0f : 25.0f;
+    status.acModulated = true;
+    status.compressorStarts = 3;
+    status.baselineStarts = 11;
+    status.powerW = status.acMode == ACMode::OFF ? 1.0f : 550.0f;
+    status.energyTodayKWh = 2.345f;
+    status.costToday = 78.4f;
+    status.energyMonthKWh = 41.2f;
+    status.costMonth = 1380.0f;
+    status.pricePerKWh = 31.0f;
+    status.tariffPeak = false;
+    status.cpuMHz = profiler.getCpuMHz();
+    status.activeDuty = 0.012f;
+    for (size_t i = 0; i < StatusSnapshot::PHASE_COUNT; i++) {
+      profiler.getStats(static_cast<LoopPhase>(i), status.phases[i]);
+    }
+    status.freeHeap = 180000;
+    status.minFreeHeap = 150000;
+    status.maxAllocHeap = 110000;
+    status.minMaxAllocHeap = 98000;
+    status.maxAllocTrendPerDay = -120.0f;
+    status.bootFirstControlMs = 2350;
+    status.bootNetworkMs = 9800;
+    status.logDropped = Logger::getDroppedCount();
+  }
+
+  // ファームウェアの DEFAULT_CONFIG と同じ初期値
+  const RuntimeConfig DEFAULT_CONFIG = {
+    DEFAULT_THRESHOLDS, -1.6f, -1.0f, 2000, 300000, 600000, 35.653204f, 139.688272f,
+  };
+
+  /**
+   * ローカルのクライアントでリクエストし、応答全体を表示
+   * @param body POST の本文（nullptr: GET）
+   * @param token POST の Authorization ヘッダーのトークン（nullptr: 付けない）
+   * @return 応答のステータスが expected と一致したか
+   */
+  bool fetch(uint16_t port, const char* path, const char* body = nullptr, int expected = 200,
+             const char* token = CONFIG_TOKEN) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+      return false;
+    }
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+      close(sock);
+      return false;
+    }
+
+    char request[256];
+    int length;
+    if (body) {
+      char authorization[64] = "";
+      if (token) {
+        std::snprintf(authorization, sizeof(authorization), "Authorization: Bearer %s\r\n", token);
+      }
+      length = std::snprintf(request, sizeof(request),
+                             "POST %s HTTP/1.1\r\nHost: localhost\r\n%sContent-Length: %zu\r\n\r\n%s",
+                             path, authorization, std::strlen(body), body);
+    } else {
+      length = std::snprintf(request, sizeof(request),
+                             "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", path);
+    }
+    send(sock, request, length, 0);
+
+    char buffer[4096];
+    ssize_t n;
+    bool ok = false;
+    bool first = true;
+    while ((n = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+      if (first) {
+        ok = n >= 12 && std::atoi(buffer + 9) == expected;
+        first = false;
+      }
+      std::fwrite(buffer, 1, n, stdout);
+    }
+    close(sock);
+    std::printf("\n");
+    return ok;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  uint16_t port = DEFAULT_PORT;
+  bool check = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      port = static_cast<uint16_t>(std::atoi(argv[++i]));
+    } else if (std::strcmp(argv[i], "--check") == 0) {
+      check = true;
+      port = 0;
+    } else {
+      printUsage();
+      return 1;
+    }
+  }
+
+  Logger::begin();
+  ConfigManager config(DEFAULT_CONFIG);
+  config.begin();
+  StatusServer server(port);
+  server.attachConfig(&config, CONFIG_TOKEN);
+  if (!server.begin()) {
+    Logger::flush();
+    return 1;
+  }
+
+  // loop() の代わりに短い処理を計測して、実際に近い統計値を作る
+  LoopProfiler profiler;
+  StatusSnapshot status = {};
+  for (int i = 0; i < 1000; i++) {
+    profiler.beginLoop();
+    std::this_thread::sleep_for(std::chrono::microseconds(20 + i % 50));
+    profiler.mark(LoopPhase::SENSOR_READ);
+    profiler.endLoop();
+  }
+  buildSnapshot(status, 0, profiler);
+  server.publish(status);
+
+  if (check) {
+    // サーバーはこのスレッドで poll し、クライアントは別スレッドで接続
+    bool ok = true;
+    std::thread client([&]() {
+      ok = fetch(server.getPort(), "/status") && ok;
+      ok = fetch(server.getPort(), "/metrics") && ok;
+      ok = fetch(server.getPort(), "/config") && ok;
+      ok = fetch(server.getPort(), "/config", "tempLower=24.0&tempUpper=26.5") && ok;
+      ok = fetch(server.getPort(), "/config", "tempLower=27.0", 400) && ok;  // 下限 > 上限
+      ok = fetch(server.getPort(), "/config", "unknown=1", 400) && ok;
+      ok = fetch(server.getPort(), "/config", "tempLower=20.0", 401, nullptr) && ok;  // トークンなし
+      ok = fetch(server.getPort(), "/config", "tempLower=20.0", 401, "check-toke") && ok;
+      ok = config.get().thresholds.tempLower == 24.0f && config.getGeneration() == 1 && ok;
+    });
+    while (server.getRequestCount() < 8) {
+      server.poll(100);
+    }
+    client.join();
+    Logger::flush();
+    std::printf("%s\n", ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  auto nextPublish = started;
+  for (;;) {
+    server.poll(100);
+    auto now = std::chrono::steady_clock::now();
+    if (now >= nextPublish) {
+      nextPublish += std::chrono::milliseconds(PUBLISH_INTERVAL_MS);
+      uint32_t uptimeMs = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - started).count());
+      buildSnapshot(status, uptimeMs, profiler);
+      server.publish(status);
+    }
+    Logger::drain();
+  }
+}